@@ -329,12 +329,16 @@
         'prefs/default_pref_store.h',
         'prefs/json_pref_store.cc',
         'prefs/json_pref_store.h',
+        'prefs/mapped_default_pref_store.cc',
+        'prefs/mapped_default_pref_store.h',
         'prefs/overlay_user_pref_store.cc',
         'prefs/overlay_user_pref_store.h',
         'prefs/persistent_pref_store.h',
         'prefs/pref_change_registrar.cc',
         'prefs/pref_change_registrar.h',
         'prefs/pref_filter.h',
+        'prefs/pref_key.cc',
+        'prefs/pref_key.h',
         'prefs/pref_member.cc',
         'prefs/pref_member.h',
         'prefs/pref_notifier.h',
@@ -470,11 +474,13 @@
         'environment_unittest.cc',
         'file_version_info_unittest.cc',
         'files/dir_reader_posix_unittest.cc',
+        'files/file_batch_reader_unittest.cc',
         'files/file_path_unittest.cc',
         'files/file_proxy_unittest.cc',
         'files/file_unittest.cc',
         'files/file_util_proxy_unittest.cc',
         'files/file_util_unittest.cc',
+        'files/important_file_commit_scheduler_unittest.cc',
         'files/important_file_writer_unittest.cc',
         'files/memory_mapped_file_unittest.cc',
         'files/scoped_temp_dir_unittest.cc',
@@ -494,11 +500,17 @@
         'i18n/time_formatting_unittest.cc',
         'i18n/timezone_unittest.cc',
         'ios/device_util_unittest.mm',
+        'json/binary_value_serializer_unittest.cc',
+        'json/json_document_unittest.cc',
         'json/json_parser_unittest.cc',
+        'json/json_path_query_unittest.cc',
         'json/json_reader_unittest.cc',
+        'json/json_sax_reader_unittest.cc',
+        'json/json_stream_writer_unittest.cc',
         'json/json_value_converter_unittest.cc',
         'json/json_value_serializer_unittest.cc',
         'json/json_writer_unittest.cc',
+        'json/ndjson_reader_unittest.cc',
         'json/string_escape_unittest.cc',
         'lazy_instance_unittest.cc',
         'logging_unittest.cc',
@@ -538,6 +550,8 @@
         'metrics/histogram_delta_serialization_unittest.cc',
         'metrics/histogram_snapshot_manager_unittest.cc',
         'metrics/histogram_unittest.cc',
+        'metrics/metrics_text_exporter_unittest.cc',
+        'metrics/rolling_histogram_unittest.cc',
         'metrics/sparse_histogram_unittest.cc',
         'metrics/stats_table_unittest.cc',
         'metrics/statistics_recorder_unittest.cc',
@@ -550,9 +564,11 @@
         'power_monitor/power_monitor_unittest.cc',
         'prefs/default_pref_store_unittest.cc',
         'prefs/json_pref_store_unittest.cc',
+        'prefs/mapped_default_pref_store_unittest.cc',
         'prefs/mock_pref_change_callback.h',
         'prefs/overlay_user_pref_store_unittest.cc',
         'prefs/pref_change_registrar_unittest.cc',
+        'prefs/pref_key_unittest.cc',
         'prefs/pref_member_unittest.cc',
         'prefs/pref_notifier_impl_unittest.cc',
         'prefs/pref_service_unittest.cc',
@@ -576,6 +592,7 @@
         'sequence_checker_unittest.cc',
         'sha1_unittest.cc',
         'stl_util_unittest.cc',
+        'strings/double_conversions_unittest.cc',
         'strings/nullable_string16_unittest.cc',
         'strings/safe_sprintf_unittest.cc',
         'strings/string16_unittest.cc',
@@ -813,12 +830,29 @@
       'type': '<(gtest_target_type)',
       'dependencies': [
         'base',
+        'base_prefs',
         'test_support_base',
         '../testing/gtest.gyp:gtest',
       ],
       'sources': [
         'threading/thread_perftest.cc',
         'message_loop/message_pump_perftest.cc',
+        'files/file_batch_reader_perftest.cc',
+        'files/file_util_perftest.cc',
+        'files/important_file_writer_perftest.cc',
+        'json/binary_value_serializer_perftest.cc',
+        'json/json_document_perftest.cc',
+        'json/json_parser_perftest.cc',
+        'json/json_path_query_perftest.cc',
+        'json/json_sax_reader_perftest.cc',
+        'json/json_stream_writer_perftest.cc',
+        'json/ndjson_reader_perftest.cc',
+        'metrics/histogram_delta_serialization_perftest.cc',
+        'metrics/metrics_text_exporter_perftest.cc',
+        'prefs/json_pref_store_perftest.cc',
+        'prefs/pref_service_perftest.cc',
+        'strings/double_conversions_perftest.cc',
+        'values_perftest.cc',
         'test/run_all_unittests.cc',
         '../testing/perf/perf_test.cc'
       ],
@@ -0,0 +1,125 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/files/file_batch_reader.h"
+
+#include <limits>
+#include <vector>
+
+#include "base/bind.h"
+#include "base/files/file_path.h"
+#include "base/files/file_util.h"
+#include "base/files/parallel_file_operation.h"
+#include "base/logging.h"
+
+namespace base {
+
+namespace {
+
+// The worker pool only pays off for enough files. The threads mostly wait
+// for the disk or the kernel, so there can be more of them than processors.
+const int kMinFilesPerThread = 4;
+const int kMaxThreads = 8;
+
+}  // namespace
+
+class FileBatchReader::Batch : public RefCountedThreadSafe<Batch> {
+ public:
+  struct Entry {
+    Entry(const FilePath& path, size_t max_size)
+        : path(path),
+          max_size(max_size),
+          succeeded(false) {
+    }
+
+    FilePath path;
+    size_t max_size;
+    std::string contents;
+    bool succeeded;
+  };
+
+  Batch() {}
+
+  // Before the files are read, only accessed by the reader; while they are,
+  // each file is only accessed by the thread which reads it.
+  std::vector<Entry> files;
+
+  scoped_refptr<internal::ParallelFileOperation> CreateOperation() {
+    return new internal::ParallelFileOperation(
+        files.size(), kMaxThreads, kMinFilesPerThread,
+        Bind(&Batch::ReadFile, this));
+  }
+
+ private:
+  friend class RefCountedThreadSafe<Batch>;
+
+  ~Batch() {}
+
+  // A file which can't be read doesn't stop the others from being read.
+  bool ReadFile(size_t index) {
+    Entry& file = files[index];
+    file.succeeded = ReadFileToString(file.path, &file.contents, file.max_size);
+    return true;
+  }
+
+  DISALLOW_COPY_AND_ASSIGN(Batch);
+};
+
+FileBatchReader::FileBatchReader()
+    : batch_(new Batch),
+      started_(false),
+      read_(false),
+      weak_factory_(this) {
+}
+
+FileBatchReader::~FileBatchReader() {
+}
+
+size_t FileBatchReader::AddFile(const FilePath& path) {
+  return AddFile(path, std::numeric_limits<size_t>::max());
+}
+
+size_t FileBatchReader::AddFile(const FilePath& path, size_t max_size) {
+  DCHECK(!started_);
+  batch_->files.push_back(Batch::Entry(path, max_size));
+  return batch_->files.size() - 1;
+}
+
+void FileBatchReader::Read() {
+  DCHECK(!started_);
+  started_ = true;
+  batch_->CreateOperation()->Run();
+  read_ = true;
+}
+
+void FileBatchReader::ReadAsync(const Closure& callback) {
+  DCHECK(!started_);
+  started_ = true;
+  batch_->CreateOperation()->RunAsync(
+      Bind(&FileBatchReader::OnFilesRead, weak_factory_.GetWeakPtr(),
+           callback));
+}
+
+size_t FileBatchReader::size() const {
+  return batch_->files.size();
+}
+
+bool FileBatchReader::succeeded(size_t index) const {
+  DCHECK(read_);
+  DCHECK_LT(index, batch_->files.size());
+  return batch_->files[index].succeeded;
+}
+
+const std::string& FileBatchReader::contents(size_t index) const {
+  DCHECK(read_);
+  DCHECK_LT(index, batch_->files.size());
+  return batch_->files[index].contents;
+}
+
+void FileBatchReader::OnFilesRead(const Closure& callback, bool succeeded) {
+  read_ = true;
+  callback.Run();
+}
+
+}  // namespace base
@@ -0,0 +1,82 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef BASE_FILES_FILE_BATCH_READER_H_
+#define BASE_FILES_FILE_BATCH_READER_H_
+
+#include <string>
+
+#include "base/base_export.h"
+#include "base/basictypes.h"
+#include "base/callback_forward.h"
+#include "base/memory/ref_counted.h"
+#include "base/memory/weak_ptr.h"
+
+namespace base {
+
+class FilePath;
+
+// Reads many files at once, e.g. the files of /proc for every process, as
+// ReadFileToString() would. Instead of waiting for each file in turn, the
+// files are read concurrently, on threads of the worker pool as well as the
+// calling thread, or only on threads of the pool with ReadAsync().
+//
+//   FileBatchReader reader;
+//   for (...)
+//     reader.AddFile(path);
+//   reader.Read();
+//   for (size_t i = 0; i < reader.size(); ++i) {
+//     if (reader.succeeded(i))
+//       Use(reader.contents(i));
+//   }
+class BASE_EXPORT FileBatchReader {
+ public:
+  FileBatchReader();
+  ~FileBatchReader();
+
+  // Adds the file at |path| to the batch, and returns its index. At most
+  // |max_size| bytes of it are read, as with ReadFileToString().
+  size_t AddFile(const FilePath& path);
+  size_t AddFile(const FilePath& path, size_t max_size);
+
+  // Reads the files of the batch. Blocks until they are all read: the calling
+  // thread must be allowed to wait, as well as to do IO, unless the batch is
+  // too small to use the worker pool. May only be called once.
+  void Read();
+
+  // Reads the files of the batch on threads of the worker pool, then runs
+  // |callback| on the calling thread, which must have a message loop. The
+  // callback isn't run if the reader is destroyed first. Only one of Read()
+  // and ReadAsync() may be called, once.
+  void ReadAsync(const Closure& callback);
+
+  // The number of files in the batch.
+  size_t size() const;
+
+  // Whether the file at |index| was read, and what could be read of it, as
+  // ReadFileToString() returns them. Only valid once the files are read.
+  bool succeeded(size_t index) const;
+  const std::string& contents(size_t index) const;
+
+ private:
+  class Batch;
+
+  void OnFilesRead(const Closure& callback, bool succeeded);
+
+  // Shared with the tasks of the worker pool, which may only run once all the
+  // files are read.
+  scoped_refptr<Batch> batch_;
+
+  // Whether Read() or ReadAsync() was called, and whether the files are read.
+  bool started_;
+  bool read_;
+
+  WeakPtrFactory<FileBatchReader> weak_factory_;
+
+  DISALLOW_COPY_AND_ASSIGN(FileBatchReader);
+};
+
+}  // namespace base
+
+#endif  // BASE_FILES_FILE_BATCH_READER_H_
@@ -0,0 +1,61 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <string>
+#include <vector>
+
+#include "base/files/file_batch_reader.h"
+#include "base/files/file_path.h"
+#include "base/files/file_util.h"
+#include "base/files/scoped_temp_dir.h"
+#include "base/strings/string_number_conversions.h"
+#include "base/time/time.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "testing/perf/perf_test.h"
+
+namespace base {
+
+namespace {
+
+const int kNumFiles = 2000;
+const int kFileSize = 4096;
+
+}  // namespace
+
+// Compares reading many small files one by one with ReadFileToString(), and
+// at once with a FileBatchReader.
+TEST(FileBatchReaderPerfTest, Read) {
+  ScopedTempDir temp_dir;
+  ASSERT_TRUE(temp_dir.CreateUniqueTempDir());
+  const std::string data(kFileSize, 'x');
+  std::vector<FilePath> paths;
+  for (int i = 0; i < kNumFiles; ++i) {
+    paths.push_back(temp_dir.path().AppendASCII(IntToString(i)));
+    ASSERT_EQ(kFileSize, WriteFile(paths.back(), data.data(), kFileSize));
+  }
+
+  TimeTicks start = TimeTicks::HighResNow();
+  for (int i = 0; i < kNumFiles; ++i) {
+    std::string contents;
+    ASSERT_TRUE(ReadFileToString(paths[i], &contents));
+  }
+  TimeDelta one_by_one = TimeTicks::HighResNow() - start;
+
+  start = TimeTicks::HighResNow();
+  FileBatchReader reader;
+  for (int i = 0; i < kNumFiles; ++i)
+    reader.AddFile(paths[i]);
+  reader.Read();
+  TimeDelta batch = TimeTicks::HighResNow() - start;
+  for (int i = 0; i < kNumFiles; ++i)
+    ASSERT_TRUE(reader.succeeded(i));
+
+  perf_test::PrintResult("read_files", "", "one_by_one",
+                         kNumFiles / one_by_one.InSecondsF(), "files/s",
+                         true);
+  perf_test::PrintResult("read_files", "", "batch",
+                         kNumFiles / batch.InSecondsF(), "files/s", true);
+}
+
+}  // namespace base
@@ -0,0 +1,113 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/files/file_batch_reader.h"
+
+#include <string>
+#include <vector>
+
+#include "base/files/file_path.h"
+#include "base/files/file_util.h"
+#include "base/files/scoped_temp_dir.h"
+#include "base/message_loop/message_loop.h"
+#include "base/run_loop.h"
+#include "base/strings/string_number_conversions.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace base {
+
+namespace {
+
+class FileBatchReaderTest : public testing::Test {
+ protected:
+  virtual void SetUp() override {
+    ASSERT_TRUE(temp_dir_.CreateUniqueTempDir());
+  }
+
+  // Writes a file of |size| bytes whose contents depend on |name|, and
+  // returns its path.
+  FilePath CreateFile(const std::string& name, size_t size) {
+    FilePath path = temp_dir_.path().AppendASCII(name);
+    std::string contents;
+    while (contents.size() < size)
+      contents.append(name);
+    contents.resize(size);
+    EXPECT_EQ(static_cast<int>(size),
+              WriteFile(path, contents.data(), static_cast<int>(size)));
+    return path;
+  }
+
+  ScopedTempDir temp_dir_;
+};
+
+}  // namespace
+
+TEST_F(FileBatchReaderTest, Read) {
+  // Enough files for several threads to read them.
+  const int kNumFiles = 100;
+  FileBatchReader reader;
+  std::vector<std::string> expected_contents;
+  for (int i = 0; i < kNumFiles; ++i) {
+    FilePath path = CreateFile("file" + IntToString(i), i * 1000);
+    std::string contents;
+    ASSERT_TRUE(ReadFileToString(path, &contents));
+    expected_contents.push_back(contents);
+    EXPECT_EQ(static_cast<size_t>(i), reader.AddFile(path));
+  }
+  ASSERT_EQ(static_cast<size_t>(kNumFiles), reader.size());
+
+  reader.Read();
+  for (int i = 0; i < kNumFiles; ++i) {
+    EXPECT_TRUE(reader.succeeded(i));
+    EXPECT_TRUE(expected_contents[i] == reader.contents(i));
+  }
+}
+
+TEST_F(FileBatchReaderTest, Errors) {
+  FileBatchReader reader;
+  size_t missing = reader.AddFile(temp_dir_.path().AppendASCII("missing"));
+  size_t truncated = reader.AddFile(CreateFile("truncated", 100), 10);
+  size_t read = reader.AddFile(CreateFile("read", 100), 100);
+  reader.Read();
+
+  EXPECT_FALSE(reader.succeeded(missing));
+  EXPECT_EQ("", reader.contents(missing));
+  EXPECT_FALSE(reader.succeeded(truncated));
+  EXPECT_EQ("truncatedt", reader.contents(truncated));
+  EXPECT_TRUE(reader.succeeded(read));
+  EXPECT_EQ(100u, reader.contents(read).size());
+}
+
+TEST_F(FileBatchReaderTest, ReadAsync) {
+  MessageLoop message_loop;
+  const int kNumFiles = 20;
+  FileBatchReader reader;
+  for (int i = 0; i < kNumFiles; ++i)
+    reader.AddFile(CreateFile("file" + IntToString(i), 1000));
+
+  RunLoop run_loop;
+  reader.ReadAsync(run_loop.QuitClosure());
+  run_loop.Run();
+  for (int i = 0; i < kNumFiles; ++i) {
+    EXPECT_TRUE(reader.succeeded(i));
+    EXPECT_EQ(1000u, reader.contents(i).size());
+  }
+}
+
+TEST_F(FileBatchReaderTest, ReadAsyncEmpty) {
+  MessageLoop message_loop;
+  FileBatchReader reader;
+  RunLoop run_loop;
+  reader.ReadAsync(run_loop.QuitClosure());
+  run_loop.Run();
+  EXPECT_EQ(0u, reader.size());
+}
+
+TEST_F(FileBatchReaderTest, Empty) {
+  FileBatchReader reader;
+  reader.Read();
+  EXPECT_EQ(0u, reader.size());
+}
+
+}  // namespace base
@@ -8,7 +8,10 @@
 #include <io.h>
 #endif
 #include <stdio.h>
+#include <sys/stat.h>
+#include <sys/types.h>
 
+#include <algorithm>
 #include <fstream>
 #include <limits>
 
@@ -31,6 +34,22 @@ namespace {
 // Also used by code that cleans up said files.
 static const int kMaxUniqueFiles = 100;
 
+// Sets |file_size| to the size of the open |file|, without looking its path up
+// again.
+bool GetFileSizeOfOpenFile(FILE* file, int64* file_size) {
+#if defined(OS_WIN)
+  struct _stat64 file_info;
+  if (_fstat64(_fileno(file), &file_info) != 0)
+    return false;
+#else
+  struct stat file_info;
+  if (fstat(fileno(file), &file_info) != 0)
+    return false;
+#endif
+  *file_size = file_info.st_size;
+  return true;
+}
+
 }  // namespace
 
 int64 ComputeDirectorySize(const FilePath& root_path) {
@@ -139,14 +158,39 @@ bool ReadFileToString(const FilePath& path,
     return false;
   }
 
-  char buf[1 << 16];
-  size_t len;
   size_t size = 0;
   bool read_status = true;
+  bool read_all = false;
+
+  // When the size of the file is known, it is read in one go, straight into
+  // |contents|; reading one more byte than the size finds the end of the file.
+  // Without a limit from the caller, a bogus size mustn't make |contents|
+  // huge up front: past kMaxPresize, the rest is read in chunks below.
+  const uint64 kMaxPresize = 64 * 1024 * 1024;
+  int64 file_size = 0;
+  if (contents && GetFileSizeOfOpenFile(file, &file_size) && file_size > 0) {
+    uint64 presize = std::min<uint64>(file_size, max_size);
+    if (max_size == std::numeric_limits<size_t>::max())
+      presize = std::min(presize, kMaxPresize);
+    size_t read_size = static_cast<size_t>(presize) + 1;
+    contents->resize(read_size);
+    size = fread(&(*contents)[0], 1, read_size, file);
+    read_all = size < read_size;
+    if (size > max_size) {
+      size = max_size;
+      read_status = false;
+      read_all = true;
+    }
+    contents->resize(size);
+  }
+
+  char buf[1 << 16];
+  size_t len;
 
   // Many files supplied in |path| have incorrect size (proc files etc).
-  // Hence, the file is read sequentially as opposed to a one-shot read.
-  while ((len = fread(buf, 1, sizeof(buf), file)) > 0) {
+  // Hence, the rest of the file is read sequentially as opposed to a one-shot
+  // read.
+  while (!read_all && (len = fread(buf, 1, sizeof(buf), file)) > 0) {
     if (contents)
       contents->append(buf, std::min(len, max_size - size));
 
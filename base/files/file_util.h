@@ -111,6 +111,10 @@ BASE_EXPORT bool CopyFile(const FilePath& from_path, const FilePath& to_path);
 // This function calls into CopyFile() so the same behavior w.r.t. metadata
 // applies.
 //
+// On POSIX, a directory with many files has them copied on threads of the
+// worker pool too, and the calling thread waits for them: it must be allowed
+// to wait as well as to do IO (see base/threading/thread_restrictions.h).
+//
 // If you only need to copy a file use CopyFile, it's faster.
 BASE_EXPORT bool CopyDirectory(const FilePath& from_path,
                                const FilePath& to_path,
@@ -0,0 +1,101 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <string>
+
+#include "base/files/file_path.h"
+#include "base/files/file_util.h"
+#include "base/files/scoped_temp_dir.h"
+#include "base/strings/string_number_conversions.h"
+#include "base/time/time.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "testing/perf/perf_test.h"
+
+namespace base {
+
+namespace {
+
+const int kLargeFileSize = 64 * 1024 * 1024;
+const int kNumLargeFileCopies = 5;
+
+// A tree about the size of a profile directory.
+const int kNumSubdirs = 20;
+const int kNumFilesPerSubdir = 100;
+const int kSmallFileSize = 4096;
+
+}  // namespace
+
+TEST(FileUtilPerfTest, CopyFile) {
+  ScopedTempDir temp_dir;
+  ASSERT_TRUE(temp_dir.CreateUniqueTempDir());
+  FilePath src = temp_dir.path().Append(FILE_PATH_LITERAL("src"));
+  const std::string data(kLargeFileSize, 'x');
+  ASSERT_EQ(kLargeFileSize, WriteFile(src, data.data(), kLargeFileSize));
+
+  TimeDelta elapsed;
+  for (int i = 0; i < kNumLargeFileCopies; ++i) {
+    FilePath dst = temp_dir.path().Append(
+        FilePath::FromUTF8Unsafe("dst" + IntToString(i)));
+    TimeTicks start = TimeTicks::HighResNow();
+    ASSERT_TRUE(CopyFile(src, dst));
+    elapsed += TimeTicks::HighResNow() - start;
+  }
+
+  perf_test::PrintResult(
+      "copy_file", "", "64MB",
+      kNumLargeFileCopies * (kLargeFileSize / 1e9) / elapsed.InSecondsF(),
+      "GB/s", true);
+}
+
+TEST(FileUtilPerfTest, ReadFileToString) {
+  ScopedTempDir temp_dir;
+  ASSERT_TRUE(temp_dir.CreateUniqueTempDir());
+  FilePath path = temp_dir.path().Append(FILE_PATH_LITERAL("file"));
+  const std::string data(kLargeFileSize, 'x');
+  ASSERT_EQ(kLargeFileSize, WriteFile(path, data.data(), kLargeFileSize));
+
+  TimeDelta elapsed;
+  for (int i = 0; i < kNumLargeFileCopies; ++i) {
+    std::string contents;
+    TimeTicks start = TimeTicks::HighResNow();
+    ASSERT_TRUE(ReadFileToString(path, &contents));
+    elapsed += TimeTicks::HighResNow() - start;
+    ASSERT_EQ(data.size(), contents.size());
+  }
+
+  perf_test::PrintResult(
+      "read_file_to_string", "", "64MB",
+      kNumLargeFileCopies * (kLargeFileSize / 1e9) / elapsed.InSecondsF(),
+      "GB/s", true);
+}
+
+TEST(FileUtilPerfTest, CopyDirectory) {
+  ScopedTempDir temp_dir;
+  ASSERT_TRUE(temp_dir.CreateUniqueTempDir());
+  FilePath src = temp_dir.path().Append(FILE_PATH_LITERAL("src"));
+  const std::string data(kSmallFileSize, 'x');
+  for (int i = 0; i < kNumSubdirs; ++i) {
+    FilePath subdir =
+        src.Append(FilePath::FromUTF8Unsafe("subdir" + IntToString(i)));
+    ASSERT_TRUE(CreateDirectory(subdir));
+    for (int j = 0; j < kNumFilesPerSubdir; ++j) {
+      ASSERT_EQ(kSmallFileSize,
+                WriteFile(subdir.Append(
+                              FilePath::FromUTF8Unsafe(IntToString(j))),
+                          data.data(), kSmallFileSize));
+    }
+  }
+
+  FilePath dst = temp_dir.path().Append(FILE_PATH_LITERAL("dst"));
+  TimeTicks start = TimeTicks::HighResNow();
+  ASSERT_TRUE(CopyDirectory(src, dst, true));
+  TimeDelta elapsed = TimeTicks::HighResNow() - start;
+
+  perf_test::PrintResult(
+      "copy_directory", "", "4KB_files",
+      kNumSubdirs * kNumFilesPerSubdir / elapsed.InSecondsF(), "files/s",
+      true);
+}
+
+}  // namespace base
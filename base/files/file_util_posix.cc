@@ -21,6 +21,12 @@
 #include <time.h>
 #include <unistd.h>
 
+#if defined(OS_LINUX) || defined(OS_ANDROID)
+#include <sys/ioctl.h>
+#include <sys/sendfile.h>
+#include <sys/syscall.h>
+#endif
+
 #if defined(OS_MACOSX)
 #include <AvailabilityMacros.h>
 #include "base/mac/foundation_util.h"
@@ -28,13 +34,18 @@
 #include <glib.h>  // for g_get_home_dir()
 #endif
 
+#include <algorithm>
 #include <fstream>
+#include <utility>
 
 #include "base/basictypes.h"
+#include "base/bind.h"
 #include "base/files/file_enumerator.h"
 #include "base/files/file_path.h"
+#include "base/files/parallel_file_operation.h"
 #include "base/files/scoped_file.h"
 #include "base/logging.h"
+#include "base/memory/ref_counted.h"
 #include "base/memory/scoped_ptr.h"
 #include "base/memory/singleton.h"
 #include "base/path_service.h"
@@ -57,6 +68,10 @@
 #include <grp.h>
 #endif
 
+#if (defined(OS_LINUX) || defined(OS_ANDROID)) && !defined(FICLONE)
+#define FICLONE _IOW(0x94, 9, int)
+#endif
+
 namespace base {
 
 #if !defined(__native_client_nonsfi__)
@@ -185,6 +200,128 @@ bool DetermineDevShmExecutable() {
 }
 #endif  // defined(OS_LINUX)
 
+#if !defined(OS_MACOSX)
+#if defined(OS_LINUX) || defined(OS_ANDROID)
+// Returns whether |error|, set by copy_file_range() or sendfile(), means
+// that the kernel can't copy between the two files, rather than that the
+// copy itself failed.
+bool IsKernelCopyUnsupported(int error) {
+  return error == ENOSYS || error == EPERM || error == EXDEV ||
+         error == EINVAL || error == EOPNOTSUPP || error == EBADF;
+}
+
+// Copies what is left of |infile| to |outfile| in the kernel, without moving
+// the data through user space. Copies as much as the kernel and the file
+// systems can, and leaves the offsets of both files past it. Returns false on
+// an I/O error, in which case the copy must not be retried.
+bool CopyFileContentsInKernel(int infile, int outfile) {
+  // The most a call copies.
+  const size_t kMaxCopySize = 0x7ffff000;
+  ssize_t bytes_copied = 0;
+#if defined(__NR_copy_file_range)
+  // copy_file_range() lets the file system do the copy, e.g. on the server
+  // for network file systems. It fails on kernels older than 4.5, and across
+  // file systems on kernels older than 5.3.
+  do {
+    bytes_copied = HANDLE_EINTR(syscall(__NR_copy_file_range, infile, NULL,
+                                        outfile, NULL, kMaxCopySize, 0));
+  } while (bytes_copied > 0);
+  if (bytes_copied == 0)
+    return true;
+  if (!IsKernelCopyUnsupported(errno))
+    return false;
+#endif
+  do {
+    bytes_copied = HANDLE_EINTR(sendfile(outfile, infile, NULL, kMaxCopySize));
+  } while (bytes_copied > 0);
+  return bytes_copied == 0 || IsKernelCopyUnsupported(errno);
+}
+#endif  // defined(OS_LINUX) || defined(OS_ANDROID)
+
+// Copies |infile| to the empty |outfile|.
+bool CopyFileContents(int infile, int outfile) {
+#if defined(OS_LINUX) || defined(OS_ANDROID)
+  // File systems which can share blocks between files, like btrfs and XFS,
+  // clone the file without copying it.
+  if (ioctl(outfile, FICLONE, infile) == 0)
+    return true;
+  // The loop below copies what the kernel doesn't, like the files of /proc,
+  // whose size is unknown, or all of the file if the kernel can't copy it.
+  if (!CopyFileContentsInKernel(infile, outfile))
+    return false;
+#endif
+
+  const size_t kBufferSize = 32768;
+  std::vector<char> buffer(kBufferSize);
+
+  for (;;) {
+    ssize_t bytes_read = HANDLE_EINTR(read(infile, &buffer[0], buffer.size()));
+    if (bytes_read < 0)
+      return false;
+    if (bytes_read == 0)
+      return true;
+    // Allow for partial writes
+    ssize_t bytes_written_per_read = 0;
+    do {
+      ssize_t bytes_written_partial = HANDLE_EINTR(write(
+          outfile,
+          &buffer[bytes_written_per_read],
+          bytes_read - bytes_written_per_read));
+      if (bytes_written_partial < 0)
+        return false;
+      bytes_written_per_read += bytes_written_partial;
+    } while (bytes_written_per_read < bytes_read);
+  }
+}
+#endif  // !defined(OS_MACOSX)
+
+// Copies files for CopyDirectory(), on threads of the worker pool along with
+// the calling thread.
+class ParallelFileCopier : public RefCountedThreadSafe<ParallelFileCopier> {
+ public:
+  ParallelFileCopier() {}
+
+  void AddFile(const FilePath& from_path, const FilePath& to_path) {
+    copies_.push_back(std::make_pair(from_path, to_path));
+  }
+
+  // Copies the files added with AddFile(), and returns whether they all were.
+  // Stops early once a copy fails.
+  bool CopyFiles() {
+    // The threads of the pool only pay off for enough files; copying is
+    // mostly bound by the disk.
+    const int kMinFilesPerThread = 8;
+    const int kMaxThreads = 4;
+    scoped_refptr<internal::ParallelFileOperation> operation(
+        new internal::ParallelFileOperation(
+            copies_.size(),
+            std::min(SysInfo::NumberOfProcessors(), kMaxThreads),
+            kMinFilesPerThread,
+            Bind(&ParallelFileCopier::CopyFileAt, this)));
+    return operation->Run();
+  }
+
+ private:
+  friend class RefCountedThreadSafe<ParallelFileCopier>;
+
+  ~ParallelFileCopier() {}
+
+  bool CopyFileAt(size_t index) {
+    const std::pair<FilePath, FilePath>& copy = copies_[index];
+    if (!CopyFile(copy.first, copy.second)) {
+      DLOG(ERROR) << "CopyDirectory() couldn't create file: "
+                  << copy.second.value();
+      return false;
+    }
+    return true;
+  }
+
+  // The source and target paths of the files.
+  std::vector<std::pair<FilePath, FilePath> > copies_;
+
+  DISALLOW_COPY_AND_ASSIGN(ParallelFileCopier);
+};
+
 }  // namespace
 
 FilePath MakeAbsoluteFilePath(const FilePath& input) {
@@ -309,6 +446,12 @@ bool CopyDirectory(const FilePath& from_path,
   // TODO(maruel): This is not necessary anymore.
   DCHECK(recursive || S_ISDIR(from_stat.st_mode));
 
+  // The directories are created as they are enumerated. The files of a
+  // directory are copied together, before the enumeration moves on to the
+  // next directory, so that a directory which can't be created doesn't stop
+  // the files enumerated before it from being copied.
+  scoped_refptr<ParallelFileCopier> file_copier(new ParallelFileCopier);
+  FilePath file_copier_dir;
   bool success = true;
   while (success && !current.empty()) {
     // current is the source path, including from_path, so append
@@ -329,11 +472,13 @@ bool CopyDirectory(const FilePath& from_path,
         success = false;
       }
     } else if (S_ISREG(from_stat.st_mode)) {
-      if (!CopyFile(current, target_path)) {
-        DLOG(ERROR) << "CopyDirectory() couldn't create file: "
-                    << target_path.value();
-        success = false;
+      if (current.DirName() != file_copier_dir) {
+        success = file_copier->CopyFiles();
+        file_copier = new ParallelFileCopier;
+        file_copier_dir = current.DirName();
       }
+      if (success)
+        file_copier->AddFile(current, target_path);
     } else {
       DLOG(WARNING) << "CopyDirectory() skipping non-regular file: "
                     << current.value();
@@ -344,7 +489,9 @@ bool CopyDirectory(const FilePath& from_path,
       from_stat = traversal.GetInfo().stat();
   }
 
-  return success;
+  // The files enumerated before a failure are still copied.
+  bool copied = file_copier->CopyFiles();
+  return success && copied;
 }
 #endif  // !defined(__native_client_nonsfi__)
 
@@ -888,32 +1035,7 @@ bool CopyFileUnsafe(const FilePath& from_path, const FilePath& to_path) {
     return false;
   }
 
-  const size_t kBufferSize = 32768;
-  std::vector<char> buffer(kBufferSize);
-  bool result = true;
-
-  while (result) {
-    ssize_t bytes_read = HANDLE_EINTR(read(infile, &buffer[0], buffer.size()));
-    if (bytes_read < 0) {
-      result = false;
-      break;
-    }
-    if (bytes_read == 0)
-      break;
-    // Allow for partial writes
-    ssize_t bytes_written_per_read = 0;
-    do {
-      ssize_t bytes_written_partial = HANDLE_EINTR(write(
-          outfile,
-          &buffer[bytes_written_per_read],
-          bytes_read - bytes_written_per_read));
-      if (bytes_written_partial < 0) {
-        result = false;
-        break;
-      }
-      bytes_written_per_read += bytes_written_partial;
-    } while (bytes_written_per_read < bytes_read);
-  }
+  bool result = CopyFileContents(infile, outfile);
 
   if (IGNORE_EINTR(close(infile)) < 0)
     result = false;
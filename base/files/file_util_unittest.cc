@@ -30,6 +30,7 @@
 #include "base/files/scoped_file.h"
 #include "base/files/scoped_temp_dir.h"
 #include "base/path_service.h"
+#include "base/strings/string_number_conversions.h"
 #include "base/strings/utf_string_conversions.h"
 #include "base/test/test_file_util.h"
 #include "base/threading/platform_thread.h"
@@ -1491,6 +1492,75 @@ TEST_F(FileUtilTest, CopyFileACL) {
   ASSERT_FALSE(IsReadOnly(dst));
 }
 
+TEST_F(FileUtilTest, CopyLargeFile) {
+  // Bigger than a chunk of the copy loop, and not made of a repeated chunk.
+  std::string file_contents;
+  for (int i = 0; file_contents.size() < 1024 * 1024 + 17; ++i)
+    file_contents.append(IntToString(i));
+  FilePath src = temp_dir_.path().Append(FILE_PATH_LITERAL("src.bin"));
+  int file_size = static_cast<int>(file_contents.size());
+  ASSERT_EQ(file_size, WriteFile(src, file_contents.data(), file_size));
+
+  // The copy replaces a bigger file.
+  FilePath dst = temp_dir_.path().Append(FILE_PATH_LITERAL("dst.bin"));
+  const std::string bigger_contents(2 * file_size, 'x');
+  ASSERT_EQ(2 * file_size,
+            WriteFile(dst, bigger_contents.data(), 2 * file_size));
+
+  ASSERT_TRUE(CopyFile(src, dst));
+  std::string read_contents;
+  ASSERT_TRUE(ReadFileToString(dst, &read_contents));
+  EXPECT_TRUE(file_contents == read_contents);
+}
+
+#if defined(OS_LINUX)
+TEST_F(FileUtilTest, CopyFileOfUnknownSize) {
+  // The files of /proc report a size of 0, but aren't empty.
+  FilePath src(FILE_PATH_LITERAL("/proc/self/cmdline"));
+  FilePath dst = temp_dir_.path().Append(FILE_PATH_LITERAL("cmdline"));
+  ASSERT_TRUE(CopyFile(src, dst));
+
+  std::string src_contents, dst_contents;
+  ASSERT_TRUE(ReadFileToString(src, &src_contents));
+  ASSERT_TRUE(ReadFileToString(dst, &dst_contents));
+  EXPECT_FALSE(dst_contents.empty());
+  EXPECT_EQ(src_contents, dst_contents);
+}
+#endif
+
+TEST_F(FileUtilTest, CopyDirectoryWithManyFiles) {
+  // Enough files for CopyDirectory() to copy them on several threads.
+  const int kNumSubdirs = 4;
+  const int kNumFilesPerSubdir = 50;
+  FilePath dir_name_from =
+      temp_dir_.path().Append(FILE_PATH_LITERAL("Copy_From_Subdir"));
+  std::vector<FilePath> relative_paths;
+  for (int i = 0; i < kNumSubdirs; ++i) {
+    FilePath subdir(FilePath::FromUTF8Unsafe("Subdir" + IntToString(i)));
+    ASSERT_TRUE(CreateDirectory(dir_name_from.Append(subdir)));
+    for (int j = 0; j < kNumFilesPerSubdir; ++j) {
+      FilePath relative_path = subdir.Append(
+          FilePath::FromUTF8Unsafe("File" + IntToString(j) + ".txt"));
+      std::string contents = relative_path.MaybeAsASCII();
+      int size = static_cast<int>(contents.size());
+      ASSERT_EQ(size, WriteFile(dir_name_from.Append(relative_path),
+                                contents.data(), size));
+      relative_paths.push_back(relative_path);
+    }
+  }
+
+  FilePath dir_name_to =
+      temp_dir_.path().Append(FILE_PATH_LITERAL("Copy_To_Subdir"));
+  ASSERT_TRUE(CopyDirectory(dir_name_from, dir_name_to, true));
+
+  for (size_t i = 0; i < relative_paths.size(); ++i) {
+    std::string contents;
+    EXPECT_TRUE(ReadFileToString(dir_name_to.Append(relative_paths[i]),
+                                 &contents));
+    EXPECT_EQ(relative_paths[i].MaybeAsASCII(), contents);
+  }
+}
+
 // file_util winds up using autoreleased objects on the Mac, so this needs
 // to be a PlatformTest.
 typedef PlatformTest ReadOnlyFileUtilTest;
@@ -2087,6 +2157,19 @@ TEST_F(FileUtilTest, ReadFileToString) {
   EXPECT_EQ(0u, data.length());
 }
 
+#if defined(OS_LINUX)
+TEST_F(FileUtilTest, ReadFileToStringOfUnknownSize) {
+  // The files of /proc report a size of 0, but aren't empty.
+  FilePath file_path(FILE_PATH_LITERAL("/proc/self/status"));
+  std::string data;
+  EXPECT_TRUE(ReadFileToString(file_path, &data));
+  EXPECT_EQ(0u, data.find("Name:"));
+
+  EXPECT_FALSE(ReadFileToString(file_path, &data, 4));
+  EXPECT_EQ("Name", data);
+}
+#endif
+
 TEST_F(FileUtilTest, TouchFile) {
   FilePath data_dir =
       temp_dir_.path().Append(FILE_PATH_LITERAL("FilePathTest"));
@@ -0,0 +1,274 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/files/important_file_commit_scheduler.h"
+
+#if defined(OS_LINUX)
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include <algorithm>
+#include <set>
+
+#include "base/bind.h"
+#include "base/critical_closure.h"
+#include "base/files/file.h"
+#include "base/files/file_util.h"
+#include "base/files/important_file_writer.h"
+#include "base/logging.h"
+#include "base/memory/scoped_vector.h"
+#include "base/metrics/histogram.h"
+#include "base/sequenced_task_runner.h"
+#include "base/strings/string_util.h"
+
+namespace base {
+
+namespace {
+
+const int kDefaultCommitIntervalMs = 10000;
+
+void LogFailure(const FilePath& path, const std::string& message) {
+  DPLOG(WARNING) << "group commit failure: " << path.value().c_str()
+                 << " : " << message;
+}
+
+// Flushes the contents of |files|, skipping the NULL ones. On Linux, one
+// syncfs() flushes the files of a whole file system, which beats flushing a
+// group of files one by one.
+void FlushFiles(const std::vector<File*>& files) {
+#if defined(OS_LINUX)
+  size_t file_count = files.size() - std::count(files.begin(), files.end(),
+                                                static_cast<File*>(NULL));
+  std::set<dev_t> synced_devices;
+  for (size_t i = 0; i < files.size(); ++i) {
+    if (!files[i])
+      continue;
+    struct stat file_info;
+    if (file_count > 1 && fstat(files[i]->GetPlatformFile(), &file_info) == 0) {
+      if (synced_devices.count(file_info.st_dev))
+        continue;
+      if (syncfs(files[i]->GetPlatformFile()) == 0) {
+        synced_devices.insert(file_info.st_dev);
+        continue;
+      }
+    }
+    files[i]->Flush();  // Ignore return value, as WriteFileAtomically does.
+  }
+#else
+  for (size_t i = 0; i < files.size(); ++i) {
+    if (files[i])
+      files[i]->Flush();  // Ignore return value, as WriteFileAtomically does.
+  }
+#endif
+}
+
+}  // namespace
+
+// The files of a commit, and what is needed to report on them.
+struct ImportantFileCommitScheduler::Group
+    : public RefCountedThreadSafe<ImportantFileCommitScheduler::Group> {
+  std::vector<FileWrite> writes;
+  // The producers of the writes whose data is serialized on the task runner.
+  std::vector<ImportantFileWriter::BackgroundDataSerializer::DataProducer>
+      producers;
+  std::vector<WeakPtr<ImportantFileWriter> > writers;
+  std::vector<TimeTicks> schedule_times;
+  std::vector<TimeDelta> latencies;
+
+ private:
+  friend class RefCountedThreadSafe<Group>;
+  ~Group() {}
+};
+
+ImportantFileCommitScheduler::FileWrite::FileWrite() : succeeded(false) {
+}
+
+ImportantFileCommitScheduler::FileWrite::~FileWrite() {
+}
+
+// static
+void ImportantFileCommitScheduler::WriteFilesAtomically(
+    std::vector<FileWrite>* writes) {
+  // Write every temporary file before flushing any, so that the flushes can
+  // be batched.
+  std::vector<FilePath> tmp_file_paths(writes->size());
+  ScopedVector<File> tmp_files;
+  for (size_t i = 0; i < writes->size(); ++i) {
+    FileWrite& write = (*writes)[i];
+    write.succeeded = false;
+    tmp_files.push_back(NULL);
+    if (!CreateTemporaryFileInDir(write.path.DirName(), &tmp_file_paths[i])) {
+      LogFailure(write.path, "could not create temporary file");
+      continue;
+    }
+    scoped_ptr<File> tmp_file(
+        new File(tmp_file_paths[i], File::FLAG_OPEN | File::FLAG_WRITE));
+    CHECK_LE(write.data.length(), static_cast<size_t>(kint32max));
+    int size = static_cast<int>(write.data.length());
+    if (!tmp_file->IsValid() ||
+        tmp_file->Write(0, write.data.data(), size) != size) {
+      LogFailure(write.path, "could not write temporary file");
+      tmp_file.reset();
+      DeleteFile(tmp_file_paths[i], false);
+      continue;
+    }
+    tmp_files[i] = tmp_file.release();
+    write.succeeded = true;
+  }
+
+  // The new contents must be durable before any file is replaced.
+  FlushFiles(tmp_files.get());
+  tmp_files.clear();
+
+  std::set<FilePath> dirs;
+  for (size_t i = 0; i < writes->size(); ++i) {
+    FileWrite& write = (*writes)[i];
+    if (!write.succeeded)
+      continue;
+    if (!ReplaceFile(tmp_file_paths[i], write.path, NULL)) {
+      LogFailure(write.path, "could not rename temporary file");
+      DeleteFile(tmp_file_paths[i], false);
+      write.succeeded = false;
+      continue;
+    }
+    dirs.insert(write.path.DirName());
+  }
+
+#if defined(OS_POSIX)
+  // Flush the renames, once per directory.
+  for (std::set<FilePath>::const_iterator it = dirs.begin(); it != dirs.end();
+       ++it) {
+    File dir(*it, File::FLAG_OPEN | File::FLAG_READ);
+    if (dir.IsValid())
+      dir.Flush();
+  }
+#endif
+}
+
+ImportantFileCommitScheduler::ImportantFileCommitScheduler(
+    const scoped_refptr<SequencedTaskRunner>& task_runner)
+    : task_runner_(task_runner),
+      commit_interval_(TimeDelta::FromMilliseconds(kDefaultCommitIntervalMs)) {
+  DCHECK(task_runner_.get());
+}
+
+ImportantFileCommitScheduler::~ImportantFileCommitScheduler() {
+  DCHECK(!HasPendingCommit());
+}
+
+bool ImportantFileCommitScheduler::HasPendingCommit() const {
+  DCHECK(CalledOnValidThread());
+  return !pending_writers_.empty();
+}
+
+void ImportantFileCommitScheduler::CommitNow() {
+  DCHECK(CalledOnValidThread());
+  timer_.Stop();
+
+  scoped_refptr<Group> group(new Group);
+  for (size_t i = 0; i < pending_writers_.size(); ++i) {
+    ImportantFileWriter* writer = pending_writers_[i].get();
+    FileWrite write;
+    ImportantFileWriter::BackgroundDataSerializer::DataProducer producer;
+    TimeTicks schedule_time;
+    // Writers which have written their data with WriteNow() since they were
+    // scheduled have nothing left to write.
+    if (!writer ||
+        !writer->SerializeForCommit(&write.data, &producer, &schedule_time)) {
+      continue;
+    }
+    write.path = writer->path();
+    group->writes.push_back(write);
+    group->producers.push_back(producer);
+    group->writers.push_back(pending_writers_[i]);
+    group->schedule_times.push_back(schedule_time);
+  }
+  pending_writers_.clear();
+  if (group->writes.empty())
+    return;
+
+  if (!task_runner_->PostTaskAndReply(
+          FROM_HERE,
+          MakeCriticalClosure(
+              Bind(&ImportantFileCommitScheduler::WriteGroup, group)),
+          Bind(&ImportantFileCommitScheduler::OnGroupWritten, group))) {
+    // Posting the task to background message loop is not expected
+    // to fail, but if it does, avoid losing data and just hit the disk
+    // on the current thread.
+    NOTREACHED();
+
+    WriteGroup(group);
+    OnGroupWritten(group);
+  }
+}
+
+void ImportantFileCommitScheduler::ScheduleCommit(ImportantFileWriter* writer) {
+  DCHECK(CalledOnValidThread());
+  pending_writers_.push_back(writer->weak_factory_.GetWeakPtr());
+  if (!timer_.IsRunning()) {
+    timer_.Start(FROM_HERE, commit_interval_, this,
+                 &ImportantFileCommitScheduler::CommitNow);
+  }
+}
+
+// static
+void ImportantFileCommitScheduler::WriteGroup(
+    const scoped_refptr<Group>& group) {
+  // Serialize the data which was left to the task runner, and leave out the
+  // files whose data can't be.
+  std::vector<FileWrite> writes;
+  std::vector<size_t> write_indices;
+  for (size_t i = 0; i < group->writes.size(); ++i) {
+    FileWrite& write = group->writes[i];
+    write.succeeded = false;
+    const ImportantFileWriter::BackgroundDataSerializer::DataProducer&
+        producer = group->producers[i];
+    if (!producer.is_null() && !producer.Run(&write.data)) {
+      DLOG(WARNING) << "failed to serialize data to be saved in "
+                    << write.path.value().c_str();
+      continue;
+    }
+    writes.push_back(FileWrite());
+    writes.back().path = write.path;
+    writes.back().data.swap(write.data);
+    write_indices.push_back(i);
+  }
+  WriteFilesAtomically(&writes);
+  for (size_t i = 0; i < writes.size(); ++i)
+    group->writes[write_indices[i]].succeeded = writes[i].succeeded;
+
+  TimeTicks now = TimeTicks::Now();
+  for (size_t i = 0; i < group->writes.size(); ++i) {
+    TimeDelta latency = now - group->schedule_times[i];
+    group->latencies.push_back(latency);
+
+    std::string spaceless_basename;
+    ReplaceChars(group->writes[i].path.BaseName().MaybeAsASCII(), " ", "_",
+                 &spaceless_basename);
+    // The histogram below is an expansion of the UMA_HISTOGRAM_TIMES macro
+    // adapted to allow for a dynamically suffixed histogram name.
+    // Note: The factory creates and owns the histogram.
+    HistogramBase* histogram = Histogram::FactoryTimeGet(
+        "ImportantFile.CommitLatency." + spaceless_basename,
+        TimeDelta::FromMilliseconds(1),
+        TimeDelta::FromSeconds(10),
+        50,
+        HistogramBase::kUmaTargetedHistogramFlag);
+    histogram->AddTime(latency);
+  }
+}
+
+// static
+void ImportantFileCommitScheduler::OnGroupWritten(
+    const scoped_refptr<Group>& group) {
+  for (size_t i = 0; i < group->writers.size(); ++i) {
+    if (group->writers[i]) {
+      group->writers[i]->OnCommitted(group->writes[i].succeeded,
+                                     group->latencies[i]);
+    }
+  }
+}
+
+}  // namespace base
@@ -0,0 +1,115 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef BASE_FILES_IMPORTANT_FILE_COMMIT_SCHEDULER_H_
+#define BASE_FILES_IMPORTANT_FILE_COMMIT_SCHEDULER_H_
+
+#include <string>
+#include <vector>
+
+#include "base/base_export.h"
+#include "base/basictypes.h"
+#include "base/files/file_path.h"
+#include "base/memory/ref_counted.h"
+#include "base/memory/weak_ptr.h"
+#include "base/threading/non_thread_safe.h"
+#include "base/time/time.h"
+#include "base/timer/timer.h"
+
+namespace base {
+
+class ImportantFileWriter;
+class SequencedTaskRunner;
+
+// Commits the scheduled writes of many ImportantFileWriters together. Each
+// writer on its own flushes and renames its temporary file on every commit, so
+// a process which owns dozens of important files pays for dozens of flushes
+// per commit interval. Writers which are handed to a scheduler with
+// ImportantFileWriter::set_commit_scheduler() instead join the next group
+// commit, in which the temporary files of all the writers are written, then
+// flushed together, then renamed, then their directories are flushed once
+// each. Every file is still replaced atomically: its new contents are durable
+// before the rename.
+//
+// The time from the first ScheduleWrite() of a writer to the end of the
+// commit which wrote it is reported in the "ImportantFile.CommitLatency"
+// histogram, suffixed with the base name of the file, and by
+// ImportantFileWriter::last_commit_latency().
+//
+// All the writes of the writers, including those of WriteNow(), are done on
+// the task runner of the scheduler. The scheduler must outlive its writers,
+// and be used on their thread.
+class BASE_EXPORT ImportantFileCommitScheduler : public NonThreadSafe {
+ public:
+  // A file to write in a group, and whether it was written.
+  struct BASE_EXPORT FileWrite {
+    FileWrite();
+    ~FileWrite();
+
+    FilePath path;
+    std::string data;
+    bool succeeded;
+  };
+
+  // Writes each of |writes| as ImportantFileWriter::WriteFileAtomically()
+  // does, but with the flushes of all the files batched, and sets their
+  // |succeeded|. Blocks and writes data on the current thread.
+  static void WriteFilesAtomically(std::vector<FileWrite>* writes);
+
+  // |task_runner| is where the group commits are done. It should block
+  // shutdown.
+  explicit ImportantFileCommitScheduler(
+      const scoped_refptr<SequencedTaskRunner>& task_runner);
+
+  // There must be no pending commit at the moment of destruction.
+  ~ImportantFileCommitScheduler();
+
+  const scoped_refptr<SequencedTaskRunner>& task_runner() const {
+    return task_runner_;
+  }
+
+  // Returns true if a writer is waiting for the next commit.
+  bool HasPendingCommit() const;
+
+  // Serializes the data of the waiting writers, or takes a snapshot of it for
+  // those with a BackgroundDataSerializer, and writes them as one group on the
+  // task runner. Does not block.
+  void CommitNow();
+
+  // The time after which the scheduled writes are committed, from the first
+  // one since the last commit.
+  TimeDelta commit_interval() const { return commit_interval_; }
+  void set_commit_interval(const TimeDelta& interval) {
+    commit_interval_ = interval;
+  }
+
+ private:
+  friend class ImportantFileWriter;
+
+  struct Group;
+
+  // Adds |writer| to the next commit. Called by ImportantFileWriter.
+  void ScheduleCommit(ImportantFileWriter* writer);
+
+  // Writes |group| on the task runner.
+  static void WriteGroup(const scoped_refptr<Group>& group);
+
+  // Tells the writers of |group| how their write went.
+  static void OnGroupWritten(const scoped_refptr<Group>& group);
+
+  const scoped_refptr<SequencedTaskRunner> task_runner_;
+
+  // The writers waiting for the next commit. They are weak, as a writer may
+  // have been destroyed since, though it shouldn't.
+  std::vector<WeakPtr<ImportantFileWriter> > pending_writers_;
+
+  OneShotTimer<ImportantFileCommitScheduler> timer_;
+  TimeDelta commit_interval_;
+
+  DISALLOW_COPY_AND_ASSIGN(ImportantFileCommitScheduler);
+};
+
+}  // namespace base
+
+#endif  // BASE_FILES_IMPORTANT_FILE_COMMIT_SCHEDULER_H_
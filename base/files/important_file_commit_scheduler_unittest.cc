@@ -0,0 +1,156 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/files/important_file_commit_scheduler.h"
+
+#include <string>
+#include <vector>
+
+#include "base/bind.h"
+#include "base/files/file_path.h"
+#include "base/files/file_util.h"
+#include "base/files/important_file_writer.h"
+#include "base/files/scoped_temp_dir.h"
+#include "base/message_loop/message_loop.h"
+#include "base/run_loop.h"
+#include "base/time/time.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace base {
+
+namespace {
+
+std::string GetFileContent(const FilePath& path) {
+  std::string content;
+  if (!ReadFileToString(path, &content))
+    return "<unreadable>";
+  return content;
+}
+
+class DataSerializer : public ImportantFileWriter::DataSerializer {
+ public:
+  explicit DataSerializer(const std::string& data) : data_(data) {
+  }
+
+  virtual bool SerializeData(std::string* output) override {
+    output->assign(data_);
+    return true;
+  }
+
+ private:
+  const std::string data_;
+};
+
+void SetTrue(bool* flag) {
+  *flag = true;
+}
+
+}  // namespace
+
+class ImportantFileCommitSchedulerTest : public testing::Test {
+ public:
+  virtual void SetUp() override {
+    ASSERT_TRUE(temp_dir_.CreateUniqueTempDir());
+  }
+
+ protected:
+  MessageLoop loop_;
+  ScopedTempDir temp_dir_;
+};
+
+TEST_F(ImportantFileCommitSchedulerTest, WriteFilesAtomically) {
+  FilePath subdir = temp_dir_.path().AppendASCII("subdir");
+  ASSERT_TRUE(CreateDirectory(subdir));
+  std::vector<ImportantFileCommitScheduler::FileWrite> writes(4);
+  writes[0].path = temp_dir_.path().AppendASCII("a");
+  writes[0].data = "a";
+  writes[1].path = subdir.AppendASCII("b");
+  writes[1].data = "b";
+  writes[2].path = temp_dir_.path().AppendASCII("missing").AppendASCII("c");
+  writes[2].data = "c";
+  writes[3].path = temp_dir_.path().AppendASCII("d");
+  writes[3].data = std::string(100000, 'd');
+  ASSERT_EQ(1, WriteFile(writes[3].path, "x", 1));
+
+  ImportantFileCommitScheduler::WriteFilesAtomically(&writes);
+  EXPECT_TRUE(writes[0].succeeded);
+  EXPECT_TRUE(writes[1].succeeded);
+  EXPECT_FALSE(writes[2].succeeded);
+  EXPECT_TRUE(writes[3].succeeded);
+  EXPECT_EQ("a", GetFileContent(writes[0].path));
+  EXPECT_EQ("b", GetFileContent(writes[1].path));
+  EXPECT_FALSE(PathExists(writes[2].path));
+  EXPECT_EQ(writes[3].data, GetFileContent(writes[3].path));
+}
+
+TEST_F(ImportantFileCommitSchedulerTest, GroupCommit) {
+  ImportantFileCommitScheduler scheduler(MessageLoopProxy::current());
+  scheduler.set_commit_interval(TimeDelta::FromMilliseconds(25));
+  ImportantFileWriter writer1(temp_dir_.path().AppendASCII("file1"),
+                              MessageLoopProxy::current());
+  ImportantFileWriter writer2(temp_dir_.path().AppendASCII("file2"),
+                              MessageLoopProxy::current());
+  writer1.set_commit_scheduler(&scheduler);
+  writer2.set_commit_scheduler(&scheduler);
+  bool written1 = false;
+  writer1.RegisterOnNextSuccessfulWriteCallback(Bind(&SetTrue, &written1));
+
+  DataSerializer foo("foo"), bar("bar"), baz("baz");
+  writer1.ScheduleWrite(&foo);
+  writer2.ScheduleWrite(&bar);
+  writer1.ScheduleWrite(&baz);
+  EXPECT_TRUE(writer1.HasPendingWrite());
+  EXPECT_TRUE(writer2.HasPendingWrite());
+  EXPECT_TRUE(scheduler.HasPendingCommit());
+  MessageLoop::current()->PostDelayedTask(
+      FROM_HERE,
+      MessageLoop::QuitWhenIdleClosure(),
+      TimeDelta::FromMilliseconds(100));
+  MessageLoop::current()->Run();
+
+  EXPECT_FALSE(writer1.HasPendingWrite());
+  EXPECT_FALSE(writer2.HasPendingWrite());
+  EXPECT_FALSE(scheduler.HasPendingCommit());
+  EXPECT_EQ("baz", GetFileContent(writer1.path()));
+  EXPECT_EQ("bar", GetFileContent(writer2.path()));
+  EXPECT_TRUE(written1);
+  EXPECT_GE(writer1.last_commit_latency(), TimeDelta::FromMilliseconds(25));
+}
+
+TEST_F(ImportantFileCommitSchedulerTest, DoScheduledWriteCommitsGroup) {
+  ImportantFileCommitScheduler scheduler(MessageLoopProxy::current());
+  ImportantFileWriter writer1(temp_dir_.path().AppendASCII("file1"),
+                              MessageLoopProxy::current());
+  ImportantFileWriter writer2(temp_dir_.path().AppendASCII("file2"),
+                              MessageLoopProxy::current());
+  writer1.set_commit_scheduler(&scheduler);
+  writer2.set_commit_scheduler(&scheduler);
+
+  DataSerializer foo("foo"), bar("bar");
+  writer1.ScheduleWrite(&foo);
+  writer2.ScheduleWrite(&bar);
+  writer1.DoScheduledWrite();
+  EXPECT_FALSE(writer1.HasPendingWrite());
+  EXPECT_FALSE(writer2.HasPendingWrite());
+  RunLoop().RunUntilIdle();
+  EXPECT_EQ("foo", GetFileContent(writer1.path()));
+  EXPECT_EQ("bar", GetFileContent(writer2.path()));
+}
+
+TEST_F(ImportantFileCommitSchedulerTest, WriteNowCancelsCommit) {
+  ImportantFileCommitScheduler scheduler(MessageLoopProxy::current());
+  ImportantFileWriter writer(temp_dir_.path().AppendASCII("file"),
+                             MessageLoopProxy::current());
+  writer.set_commit_scheduler(&scheduler);
+
+  DataSerializer foo("foo");
+  writer.ScheduleWrite(&foo);
+  writer.WriteNow("bar");
+  EXPECT_FALSE(writer.HasPendingWrite());
+  scheduler.CommitNow();
+  RunLoop().RunUntilIdle();
+  EXPECT_EQ("bar", GetFileContent(writer.path()));
+}
+
+}  // namespace base
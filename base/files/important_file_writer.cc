@@ -6,6 +6,13 @@
 
 #include <stdio.h>
 
+#if defined(OS_LINUX)
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
 #include <string>
 
 #include "base/bind.h"
@@ -13,20 +20,37 @@
 #include "base/files/file.h"
 #include "base/files/file_path.h"
 #include "base/files/file_util.h"
+#include "base/files/important_file_commit_scheduler.h"
 #include "base/logging.h"
 #include "base/metrics/histogram.h"
+#include "base/rand_util.h"
+#include "base/sequenced_task_runner.h"
 #include "base/strings/string_number_conversions.h"
 #include "base/task_runner.h"
 #include "base/task_runner_util.h"
 #include "base/threading/thread.h"
 #include "base/time/time.h"
 
+#if defined(OS_LINUX)
+#include "base/files/scoped_file.h"
+#include "base/posix/eintr_wrapper.h"
+#include "base/strings/stringprintf.h"
+
+// Older C libraries don't define it. Kernels older than 3.11 don't support it,
+// and fail to open the directory for writing instead.
+#if !defined(O_TMPFILE)
+#define O_TMPFILE (020000000 | O_DIRECTORY)
+#endif
+#endif
+
 namespace base {
 
 namespace {
 
 const int kDefaultCommitIntervalMs = 10000;
 
+bool g_unnamed_temporary_files_enabled = true;
+
 enum TempFileFailure {
   FAILED_CREATING,
   FAILED_OPENING,
@@ -44,11 +68,117 @@ void LogFailure(const FilePath& path, TempFileFailure failure_code,
                  << " : " << message;
 }
 
+// Flushes the entries of |dir|, so that a file renamed into it survives a
+// power loss.
+void FlushDirectory(const FilePath& dir) {
+#if defined(OS_POSIX)
+  File dir_file(dir, File::FLAG_OPEN | File::FLAG_READ);
+  if (dir_file.IsValid())
+    dir_file.Flush();  // Ignore return value, the file is already replaced.
+#endif
+}
+
+#if defined(OS_LINUX)
+enum UnnamedWriteResult {
+  UNNAMED_WRITE_SUCCEEDED,
+  UNNAMED_WRITE_FAILED,
+  UNNAMED_WRITE_UNSUPPORTED,
+};
+
+// Writes |data| to |path| through an unnamed temporary file in the directory
+// of |path|. The file only gets a name once its data is on disk, right before
+// it replaces |path|. Returns UNNAMED_WRITE_UNSUPPORTED, without touching
+// |path|, if the kernel or the file system can't create or link unnamed files.
+UnnamedWriteResult WriteFileAtomicallyWithUnnamedFile(const FilePath& path,
+                                                      const std::string& data) {
+  const FilePath dir = path.DirName();
+  ScopedFD tmp_fd(HANDLE_EINTR(open(dir.value().c_str(),
+                                    O_TMPFILE | O_WRONLY | O_CLOEXEC,
+                                    S_IRUSR | S_IWUSR)));
+  if (!tmp_fd.is_valid())
+    return UNNAMED_WRITE_UNSUPPORTED;
+
+  // Allocating the whole file up front lets the file system lay it out in one
+  // go, instead of extending it write by write. Not all of them support it.
+  if (!data.empty())
+    ignore_result(fallocate(tmp_fd.get(), 0, 0, data.length()));
+
+  // The file is new, so syncing its data also syncs the metadata needed to
+  // read it back; a full fsync() isn't needed.
+  if (!WriteFileDescriptor(tmp_fd.get(), data.data(),
+                           static_cast<int>(data.length())) ||
+      HANDLE_EINTR(fdatasync(tmp_fd.get())) != 0) {
+    LogFailure(path, FAILED_WRITING, "error writing unnamed temporary file");
+    return UNNAMED_WRITE_FAILED;
+  }
+
+  // linkat() can't replace |path|, so link the file under a temporary name,
+  // then rename it over |path|. Linking through /proc doesn't need the
+  // privileges AT_EMPTY_PATH does.
+  const std::string proc_path = StringPrintf("/proc/self/fd/%d", tmp_fd.get());
+  FilePath tmp_file_path;
+  const int kMaxLinkAttempts = 3;
+  for (int i = 0; i < kMaxLinkAttempts; ++i) {
+    tmp_file_path =
+        FilePath(path.value() + "." + Uint64ToString(RandUint64()));
+    if (linkat(AT_FDCWD, proc_path.c_str(), AT_FDCWD,
+               tmp_file_path.value().c_str(), AT_SYMLINK_FOLLOW) == 0) {
+      break;
+    }
+    if (errno != EEXIST)
+      return UNNAMED_WRITE_UNSUPPORTED;
+    tmp_file_path.clear();
+  }
+  if (tmp_file_path.empty()) {
+    LogFailure(path, FAILED_CREATING, "could not link unnamed temporary file");
+    return UNNAMED_WRITE_FAILED;
+  }
+
+  if (rename(tmp_file_path.value().c_str(), path.value().c_str()) != 0) {
+    LogFailure(path, FAILED_RENAMING, "could not rename temporary file");
+    unlink(tmp_file_path.value().c_str());
+    return UNNAMED_WRITE_FAILED;
+  }
+
+  FlushDirectory(dir);
+  return UNNAMED_WRITE_SUCCEEDED;
+}
+#endif  // defined(OS_LINUX)
+
+// Serializes the data of |producer| and writes it to |path|.
+bool ProduceAndWriteFileAtomically(
+    const FilePath& path,
+    const ImportantFileWriter::BackgroundDataSerializer::DataProducer&
+        producer) {
+  std::string data;
+  if (!producer.Run(&data)) {
+    DLOG(WARNING) << "failed to serialize data to be saved in "
+                  << path.value().c_str();
+    return false;
+  }
+  if (data.length() > static_cast<size_t>(kint32max)) {
+    NOTREACHED();
+    return false;
+  }
+  return ImportantFileWriter::WriteFileAtomically(path, data);
+}
+
 }  // namespace
 
 // static
 bool ImportantFileWriter::WriteFileAtomically(const FilePath& path,
                                               const std::string& data) {
+  // If this happens in the wild something really bad is going on.
+  CHECK_LE(data.length(), static_cast<size_t>(kint32max));
+
+#if defined(OS_LINUX)
+  if (g_unnamed_temporary_files_enabled) {
+    UnnamedWriteResult result = WriteFileAtomicallyWithUnnamedFile(path, data);
+    if (result != UNNAMED_WRITE_UNSUPPORTED)
+      return result == UNNAMED_WRITE_SUCCEEDED;
+  }
+#endif
+
   // Write the data to a temp file then rename to avoid data loss if we crash
   // while writing the file. Ensure that the temp file is on the same volume
   // as target file, so it can be moved in one step, and that the temp file
@@ -65,8 +195,6 @@ bool ImportantFileWriter::WriteFileAtomically(const FilePath& path,
     return false;
   }
 
-  // If this happens in the wild something really bad is going on.
-  CHECK_LE(data.length(), static_cast<size_t>(kint32max));
   int bytes_written = tmp_file.Write(0, data.data(),
                                      static_cast<int>(data.length()));
   tmp_file.Flush();  // Ignore return value.
@@ -85,16 +213,26 @@ bool ImportantFileWriter::WriteFileAtomically(const FilePath& path,
     return false;
   }
 
+  FlushDirectory(path.DirName());
   return true;
 }
 
+// static
+void ImportantFileWriter::SetUnnamedTemporaryFilesEnabledForTesting(
+    bool enabled) {
+  g_unnamed_temporary_files_enabled = enabled;
+}
+
 ImportantFileWriter::ImportantFileWriter(
     const FilePath& path,
     const scoped_refptr<base::SequencedTaskRunner>& task_runner)
     : path_(path),
       task_runner_(task_runner),
       serializer_(NULL),
+      background_serializer_(NULL),
       commit_interval_(TimeDelta::FromMilliseconds(kDefaultCommitIntervalMs)),
+      commit_scheduler_(NULL),
+      commit_scheduled_(false),
       weak_factory_(this) {
   DCHECK(CalledOnValidThread());
   DCHECK(task_runner_.get());
@@ -109,7 +247,7 @@ ImportantFileWriter::~ImportantFileWriter() {
 
 bool ImportantFileWriter::HasPendingWrite() const {
   DCHECK(CalledOnValidThread());
-  return timer_.IsRunning();
+  return timer_.IsRunning() || commit_scheduled_;
 }
 
 void ImportantFileWriter::WriteNow(const std::string& data) {
@@ -119,17 +257,8 @@ void ImportantFileWriter::WriteNow(const std::string& data) {
     return;
   }
 
-  if (HasPendingWrite())
-    timer_.Stop();
-
-  if (!PostWriteTask(data)) {
-    // Posting the task to background message loop is not expected
-    // to fail, but if it does, avoid losing data and just hit the disk
-    // on the current thread.
-    NOTREACHED();
-
-    WriteFileAtomically(path_, data);
-  }
+  WriteNowWithTask(Bind(&ImportantFileWriter::WriteFileAtomically, path_,
+                        data));
 }
 
 void ImportantFileWriter::ScheduleWrite(DataSerializer* serializer) {
@@ -137,6 +266,29 @@ void ImportantFileWriter::ScheduleWrite(DataSerializer* serializer) {
 
   DCHECK(serializer);
   serializer_ = serializer;
+  background_serializer_ = NULL;
+  ScheduleWriteInternal();
+}
+
+void ImportantFileWriter::ScheduleWriteWithBackgroundSerializer(
+    BackgroundDataSerializer* serializer) {
+  DCHECK(CalledOnValidThread());
+
+  DCHECK(serializer);
+  serializer_ = NULL;
+  background_serializer_ = serializer;
+  ScheduleWriteInternal();
+}
+
+void ImportantFileWriter::ScheduleWriteInternal() {
+  if (commit_scheduler_) {
+    if (!commit_scheduled_) {
+      commit_scheduled_ = true;
+      schedule_time_ = TimeTicks::Now();
+      commit_scheduler_->ScheduleCommit(this);
+    }
+    return;
+  }
 
   if (!timer_.IsRunning()) {
     timer_.Start(FROM_HERE, commit_interval_, this,
@@ -145,6 +297,18 @@ void ImportantFileWriter::ScheduleWrite(DataSerializer* serializer) {
 }
 
 void ImportantFileWriter::DoScheduledWrite() {
+  if (commit_scheduled_) {
+    commit_scheduler_->CommitNow();
+    return;
+  }
+
+  if (background_serializer_) {
+    WriteNowWithTask(Bind(&ProduceAndWriteFileAtomically, path_,
+                          background_serializer_->GetSerializedDataProducer()));
+    background_serializer_ = NULL;
+    return;
+  }
+
   DCHECK(serializer_);
   std::string data;
   if (serializer_->SerializeData(&data)) {
@@ -162,7 +326,69 @@ void ImportantFileWriter::RegisterOnNextSuccessfulWriteCallback(
   on_next_successful_write_ = on_next_successful_write;
 }
 
-bool ImportantFileWriter::PostWriteTask(const std::string& data) {
+void ImportantFileWriter::set_commit_scheduler(
+    ImportantFileCommitScheduler* commit_scheduler) {
+  DCHECK(CalledOnValidThread());
+  DCHECK(!HasPendingWrite());
+  commit_scheduler_ = commit_scheduler;
+}
+
+bool ImportantFileWriter::SerializeForCommit(
+    std::string* data,
+    BackgroundDataSerializer::DataProducer* producer,
+    TimeTicks* schedule_time) {
+  DCHECK(CalledOnValidThread());
+  if (!commit_scheduled_)
+    return false;
+  commit_scheduled_ = false;
+  *schedule_time = schedule_time_;
+
+  if (background_serializer_) {
+    *producer = background_serializer_->GetSerializedDataProducer();
+    background_serializer_ = NULL;
+    return true;
+  }
+
+  DCHECK(serializer_);
+  bool result = serializer_->SerializeData(data);
+  if (!result) {
+    DLOG(WARNING) << "failed to serialize data to be saved in "
+                  << path_.value().c_str();
+  }
+  serializer_ = NULL;
+  return result;
+}
+
+void ImportantFileWriter::OnCommitted(bool result, TimeDelta latency) {
+  DCHECK(CalledOnValidThread());
+  last_commit_latency_ = latency;
+  ForwardSuccessfulWrite(result);
+}
+
+void ImportantFileWriter::WriteNowWithTask(
+    const Callback<bool(void)>& write_task) {
+  if (HasPendingWrite()) {
+    timer_.Stop();
+    commit_scheduled_ = false;
+  }
+
+  if (!PostWriteTask(write_task)) {
+    // Posting the task to background message loop is not expected
+    // to fail, but if it does, avoid losing data and just hit the disk
+    // on the current thread.
+    NOTREACHED();
+
+    write_task.Run();
+  }
+}
+
+bool ImportantFileWriter::PostWriteTask(
+    const Callback<bool(void)>& write_task) {
+  // The writes of a writer with a commit scheduler are all done where the
+  // group commits are, so that they stay in order.
+  SequencedTaskRunner* task_runner = commit_scheduler_ ?
+      commit_scheduler_->task_runner().get() : task_runner_.get();
+
   // TODO(gab): This code could always use PostTaskAndReplyWithResult and let
   // ForwardSuccessfulWrite() no-op if |on_next_successful_write_| is null, but
   // PostTaskAndReply causes memory leaks in tests (crbug.com/371974) and
@@ -170,18 +396,15 @@ bool ImportantFileWriter::PostWriteTask(const std::string& data) {
   // using PostTask() in the typical scenario below.
   if (!on_next_successful_write_.is_null()) {
     return base::PostTaskAndReplyWithResult(
-        task_runner_.get(),
+        task_runner,
         FROM_HERE,
-        MakeCriticalClosure(
-            Bind(&ImportantFileWriter::WriteFileAtomically, path_, data)),
+        MakeCriticalClosure(write_task),
         Bind(&ImportantFileWriter::ForwardSuccessfulWrite,
              weak_factory_.GetWeakPtr()));
   }
-  return task_runner_->PostTask(
+  return task_runner->PostTask(
       FROM_HERE,
-      MakeCriticalClosure(
-          Bind(IgnoreResult(&ImportantFileWriter::WriteFileAtomically),
-               path_, data)));
+      MakeCriticalClosure(Bind(IgnoreResult(write_task))));
 }
 
 void ImportantFileWriter::ForwardSuccessfulWrite(bool result) {
@@ -12,12 +12,14 @@
 #include "base/callback.h"
 #include "base/files/file_path.h"
 #include "base/memory/ref_counted.h"
+#include "base/memory/weak_ptr.h"
 #include "base/threading/non_thread_safe.h"
 #include "base/time/time.h"
 #include "base/timer/timer.h"
 
 namespace base {
 
+class ImportantFileCommitScheduler;
 class SequencedTaskRunner;
 class Thread;
 
@@ -37,6 +39,11 @@ class Thread;
 //
 // If you want to know more about this approach and ext3/ext4 fsync issues, see
 // http://valhenson.livejournal.com/37921.html
+//
+// On Linux, the temporary file is created unnamed, with O_TMPFILE, and only
+// linked into the directory once its data is on disk, so a crash never leaves
+// it behind. On POSIX, the directory is flushed after the rename, so that the
+// new file survives a power loss too.
 class BASE_EXPORT ImportantFileWriter : public NonThreadSafe {
  public:
   // Used by ScheduleSave to lazily provide the data to be saved. Allows us
@@ -52,11 +59,33 @@ class BASE_EXPORT ImportantFileWriter : public NonThreadSafe {
     virtual ~DataSerializer() {}
   };
 
+  // Used by ScheduleWriteWithBackgroundSerializer() for data which is costly
+  // to serialize. Only a snapshot of the data is taken on the thread of the
+  // writer; it is serialized on the task runner, right before the write.
+  class BASE_EXPORT BackgroundDataSerializer {
+   public:
+    // Should put the serialized snapshot in |data| and return true on
+    // successful serialization. Will be called on the task runner.
+    typedef Callback<bool(std::string* data)> DataProducer;
+
+    // Should take an immutable snapshot of the data, cheaply, and return a
+    // DataProducer bound to it. Will be called on the same thread on which
+    // ImportantFileWriter has been created.
+    virtual DataProducer GetSerializedDataProducer() = 0;
+
+   protected:
+    virtual ~BackgroundDataSerializer() {}
+  };
+
   // Save |data| to |path| in an atomic manner (see the class comment above).
   // Blocks and writes data on the current thread.
   static bool WriteFileAtomically(const FilePath& path,
                                   const std::string& data);
 
+  // Makes WriteFileAtomically() write through a named temporary file even
+  // where unnamed ones are supported, to test and measure that path.
+  static void SetUnnamedTemporaryFilesEnabledForTesting(bool enabled);
+
   // Initialize the writer.
   // |path| is the name of file to write.
   // |task_runner| is the SequencedTaskRunner instance where on which we will
@@ -88,6 +117,12 @@ class BASE_EXPORT ImportantFileWriter : public NonThreadSafe {
   // ImportantFileWriter.
   void ScheduleWrite(DataSerializer* serializer);
 
+  // Same as ScheduleWrite(), except that only a snapshot of the data is taken
+  // on this thread when the write is done, and it is serialized on the task
+  // runner. Replaces the serializer of an earlier ScheduleWrite().
+  void ScheduleWriteWithBackgroundSerializer(
+      BackgroundDataSerializer* serializer);
+
   // Serialize data pending to be saved and execute write on backend thread.
   void DoScheduledWrite();
 
@@ -104,9 +139,44 @@ class BASE_EXPORT ImportantFileWriter : public NonThreadSafe {
     commit_interval_ = interval;
   }
 
+  // Hands the scheduled writes to |commit_scheduler|, which commits them along
+  // with those of other writers after its own commit interval, instead of
+  // committing them after commit_interval(). All the writes are then done on
+  // the task runner of |commit_scheduler|, and DoScheduledWrite() commits the
+  // writes of the other writers too. May be NULL. There must be no pending
+  // write.
+  void set_commit_scheduler(ImportantFileCommitScheduler* commit_scheduler);
+
+  // The time from the first ScheduleWrite() before the last group commit of
+  // the writer to the end of that commit.
+  TimeDelta last_commit_latency() const {
+    return last_commit_latency_;
+  }
+
  private:
-  // Helper method for WriteNow().
-  bool PostWriteTask(const std::string& data);
+  friend class ImportantFileCommitScheduler;
+
+  // Serializes the data of the scheduled write for a group commit into
+  // |data|, or sets |producer| to serialize it on the task runner, and sets
+  // |schedule_time| to the time it was first scheduled. Returns false if
+  // there is no scheduled write anymore, or the data can't be serialized.
+  bool SerializeForCommit(std::string* data,
+                          BackgroundDataSerializer::DataProducer* producer,
+                          TimeTicks* schedule_time);
+
+  // Called once the group commit of the scheduled write is done.
+  void OnCommitted(bool result, TimeDelta latency);
+
+  // Starts the timer, or joins the next commit of |commit_scheduler_|, for a
+  // scheduled write.
+  void ScheduleWriteInternal();
+
+  // Cancels the scheduled write, and runs |write_task|, which returns whether
+  // the file was written, on the task runner.
+  void WriteNowWithTask(const Callback<bool(void)>& write_task);
+
+  // Helper method for WriteNowWithTask().
+  bool PostWriteTask(const Callback<bool(void)>& write_task);
 
   // If |result| is true and |on_next_successful_write_| is set, invokes
   // |on_successful_write_| and then resets it; no-ops otherwise.
@@ -124,12 +194,24 @@ class BASE_EXPORT ImportantFileWriter : public NonThreadSafe {
   // Timer used to schedule commit after ScheduleWrite.
   OneShotTimer<ImportantFileWriter> timer_;
 
-  // Serializer which will provide the data to be saved.
+  // Serializer which will provide the data to be saved. At most one of them
+  // is set.
   DataSerializer* serializer_;
+  BackgroundDataSerializer* background_serializer_;
 
   // Time delta after which scheduled data will be written to disk.
   TimeDelta commit_interval_;
 
+  // Scheduler which commits the scheduled writes, if any.
+  ImportantFileCommitScheduler* commit_scheduler_;
+
+  // Whether |commit_scheduler_| is to commit the scheduled write, and when
+  // it was first scheduled.
+  bool commit_scheduled_;
+  TimeTicks schedule_time_;
+
+  TimeDelta last_commit_latency_;
+
   WeakPtrFactory<ImportantFileWriter> weak_factory_;
 
   DISALLOW_COPY_AND_ASSIGN(ImportantFileWriter);
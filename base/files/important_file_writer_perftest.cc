@@ -0,0 +1,168 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <string>
+
+#include "base/bind.h"
+#include "base/format_macros.h"
+#include "base/files/file_path.h"
+#include "base/files/file_util.h"
+#include "base/files/important_file_writer.h"
+#include "base/files/scoped_temp_dir.h"
+#include "base/json/json_string_value_serializer.h"
+#include "base/memory/scoped_ptr.h"
+#include "base/message_loop/message_loop.h"
+#include "base/run_loop.h"
+#include "base/strings/stringprintf.h"
+#include "base/time/time.h"
+#include "base/values.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "testing/perf/perf_test.h"
+
+namespace base {
+
+namespace {
+
+const int kNumPrefs = 50000;
+const int kNumWrites = 10;
+const int kNumAtomicWrites = 50;
+
+// Returns a dictionary shaped like a large preferences file.
+scoped_ptr<DictionaryValue> BuildPrefs() {
+  scoped_ptr<DictionaryValue> prefs(new DictionaryValue);
+  for (int i = 0; i < kNumPrefs; ++i) {
+    std::string section = StringPrintf("section%d", i % 100);
+    prefs->SetInteger(StringPrintf("%s.count%d", section.c_str(), i), i);
+    prefs->SetString(StringPrintf("%s.name%d", section.c_str(), i),
+                     StringPrintf("value of pref %d", i));
+  }
+  return prefs.Pass();
+}
+
+bool SerializeJSON(const DictionaryValue* prefs, std::string* output) {
+  JSONStringValueSerializer serializer(output);
+  serializer.set_pretty_print(true);
+  return serializer.Serialize(*prefs);
+}
+
+// Serializes the prefs on the thread of the writer.
+class ForegroundSerializer : public ImportantFileWriter::DataSerializer {
+ public:
+  explicit ForegroundSerializer(const DictionaryValue* prefs)
+      : prefs_(prefs) {
+  }
+
+  virtual bool SerializeData(std::string* output) override {
+    return SerializeJSON(prefs_, output);
+  }
+
+ private:
+  const DictionaryValue* prefs_;
+};
+
+// Only snapshots the prefs on the thread of the writer.
+class BackgroundSerializer
+    : public ImportantFileWriter::BackgroundDataSerializer {
+ public:
+  explicit BackgroundSerializer(const DictionaryValue* prefs)
+      : prefs_(prefs) {
+  }
+
+  virtual DataProducer GetSerializedDataProducer() override {
+    return Bind(&SerializeJSON, Owned(prefs_->DeepCopy()));
+  }
+
+ private:
+  const DictionaryValue* prefs_;
+};
+
+// Returns the time spent in DoScheduledWrite() on this thread, for the
+// writes scheduled by |schedule|. The writes themselves are not timed.
+TimeDelta TimeScheduledWrites(ImportantFileWriter* writer,
+                              const Closure& schedule) {
+  TimeDelta elapsed;
+  for (int i = 0; i < kNumWrites; ++i) {
+    schedule.Run();
+    TimeTicks start = TimeTicks::HighResNow();
+    writer->DoScheduledWrite();
+    elapsed += TimeTicks::HighResNow() - start;
+    RunLoop().RunUntilIdle();
+  }
+  return elapsed / kNumWrites;
+}
+
+// Returns the mean latency of WriteFileAtomically() for |size| bytes, through
+// unnamed temporary files where the platform supports them, if |unnamed|.
+TimeDelta TimeAtomicWrites(const FilePath& path, size_t size, bool unnamed) {
+  ImportantFileWriter::SetUnnamedTemporaryFilesEnabledForTesting(unnamed);
+  const std::string data(size, 'x');
+  TimeTicks start = TimeTicks::HighResNow();
+  for (int i = 0; i < kNumAtomicWrites; ++i)
+    EXPECT_TRUE(ImportantFileWriter::WriteFileAtomically(path, data));
+  TimeDelta elapsed = TimeTicks::HighResNow() - start;
+  ImportantFileWriter::SetUnnamedTemporaryFilesEnabledForTesting(true);
+  return elapsed / kNumAtomicWrites;
+}
+
+}  // namespace
+
+// Compares the time the thread of an ImportantFileWriter is blocked when it
+// serializes a large dictionary itself, and when it only takes a snapshot of
+// it for the task runner to serialize.
+TEST(ImportantFileWriterPerfTest, BackgroundSerialization) {
+  MessageLoop loop;
+  ScopedTempDir temp_dir;
+  ASSERT_TRUE(temp_dir.CreateUniqueTempDir());
+  scoped_ptr<DictionaryValue> prefs = BuildPrefs();
+
+  ImportantFileWriter foreground_writer(
+      temp_dir.path().AppendASCII("foreground"), MessageLoopProxy::current());
+  ForegroundSerializer foreground_serializer(prefs.get());
+  TimeDelta foreground = TimeScheduledWrites(
+      &foreground_writer,
+      Bind(&ImportantFileWriter::ScheduleWrite,
+           Unretained(&foreground_writer),
+           &foreground_serializer));
+
+  ImportantFileWriter background_writer(
+      temp_dir.path().AppendASCII("background"), MessageLoopProxy::current());
+  BackgroundSerializer background_serializer(prefs.get());
+  TimeDelta background = TimeScheduledWrites(
+      &background_writer,
+      Bind(&ImportantFileWriter::ScheduleWriteWithBackgroundSerializer,
+           Unretained(&background_writer),
+           &background_serializer));
+
+  std::string foreground_data, background_data;
+  ASSERT_TRUE(ReadFileToString(foreground_writer.path(), &foreground_data));
+  ASSERT_TRUE(ReadFileToString(background_writer.path(), &background_data));
+  EXPECT_EQ(foreground_data, background_data);
+
+  perf_test::PrintResult("important_file_writer", "", "foreground_serializer",
+                         foreground.InMillisecondsF(), "ms", true);
+  perf_test::PrintResult("important_file_writer", "", "background_serializer",
+                         background.InMillisecondsF(), "ms", true);
+}
+
+// Compares the latency of atomic writes of small and large files through named
+// temporary files, and through unnamed ones where they are supported.
+TEST(ImportantFileWriterPerfTest, WriteFileAtomically) {
+  ScopedTempDir temp_dir;
+  ASSERT_TRUE(temp_dir.CreateUniqueTempDir());
+  const FilePath path = temp_dir.path().AppendASCII("file");
+  const size_t kSizes[] = { 4 << 10, 256 << 10, 4 << 20 };
+  for (size_t i = 0; i < arraysize(kSizes); ++i) {
+    const std::string size = StringPrintf("_%" PRIuS "KB", kSizes[i] >> 10);
+    perf_test::PrintResult(
+        "write_file_atomically", size, "named_temporary_file",
+        TimeAtomicWrites(path, kSizes[i], false).InMillisecondsF(), "ms",
+        true);
+    perf_test::PrintResult(
+        "write_file_atomically", size, "unnamed_temporary_file",
+        TimeAtomicWrites(path, kSizes[i], true).InMillisecondsF(), "ms",
+        true);
+  }
+}
+
+}  // namespace base
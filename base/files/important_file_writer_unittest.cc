@@ -5,21 +5,36 @@
 #include "base/files/important_file_writer.h"
 
 #include "base/bind.h"
+#include "base/command_line.h"
 #include "base/compiler_specific.h"
+#include "base/files/file_enumerator.h"
 #include "base/files/file_path.h"
 #include "base/files/file_util.h"
 #include "base/files/scoped_temp_dir.h"
 #include "base/logging.h"
 #include "base/message_loop/message_loop.h"
+#include "base/process/kill.h"
+#include "base/process/launch.h"
+#include "base/rand_util.h"
 #include "base/run_loop.h"
+#include "base/test/multiprocess_test.h"
+#include "base/threading/platform_thread.h"
 #include "base/threading/thread.h"
 #include "base/time/time.h"
 #include "testing/gtest/include/gtest/gtest.h"
+#include "testing/multiprocess_func_list.h"
 
 namespace base {
 
 namespace {
 
+const char kPathSwitch[] = "path";
+const char kNamedTemporaryFilesSwitch[] = "named-temporary-files";
+
+// Big enough for the writes of the kill test to take a while.
+const size_t kKillTestDataSize = 1 << 18;
+const int kNumKills = 20;
+
 std::string GetFileContent(const FilePath& path) {
   std::string content;
   if (!ReadFileToString(path, &content)) {
@@ -42,6 +57,27 @@ class DataSerializer : public ImportantFileWriter::DataSerializer {
   const std::string data_;
 };
 
+bool ProduceData(const std::string& data, std::string* output) {
+  output->assign(data);
+  return true;
+}
+
+class BackgroundDataSerializer
+    : public ImportantFileWriter::BackgroundDataSerializer {
+ public:
+  explicit BackgroundDataSerializer(const std::string& data) : data_(data) {
+  }
+
+  void set_data(const std::string& data) { data_ = data; }
+
+  virtual DataProducer GetSerializedDataProducer() override {
+    return Bind(&ProduceData, data_);
+  }
+
+ private:
+  std::string data_;
+};
+
 class SuccessfulWriteObserver {
  public:
   SuccessfulWriteObserver() : successful_write_observed_(false) {}
@@ -176,6 +212,36 @@ TEST_F(ImportantFileWriterTest, DoScheduledWrite) {
   EXPECT_EQ("foo", GetFileContent(writer.path()));
 }
 
+TEST_F(ImportantFileWriterTest, ScheduleWriteWithBackgroundSerializer) {
+  ImportantFileWriter writer(file_, MessageLoopProxy::current().get());
+  BackgroundDataSerializer serializer("foo");
+  writer.ScheduleWriteWithBackgroundSerializer(&serializer);
+  EXPECT_TRUE(writer.HasPendingWrite());
+  writer.DoScheduledWrite();
+  EXPECT_FALSE(writer.HasPendingWrite());
+  // The data was snapshotted by DoScheduledWrite().
+  serializer.set_data("bar");
+  RunLoop().RunUntilIdle();
+  ASSERT_TRUE(PathExists(writer.path()));
+  EXPECT_EQ("foo", GetFileContent(writer.path()));
+}
+
+TEST_F(ImportantFileWriterTest, ScheduleWriteReplacesBackgroundSerializer) {
+  ImportantFileWriter writer(file_, MessageLoopProxy::current().get());
+  writer.set_commit_interval(TimeDelta::FromMilliseconds(25));
+  BackgroundDataSerializer foo("foo");
+  DataSerializer bar("bar");
+  writer.ScheduleWriteWithBackgroundSerializer(&foo);
+  writer.ScheduleWrite(&bar);
+  MessageLoop::current()->PostDelayedTask(
+      FROM_HERE,
+      MessageLoop::QuitWhenIdleClosure(),
+      TimeDelta::FromMilliseconds(100));
+  MessageLoop::current()->Run();
+  ASSERT_TRUE(PathExists(writer.path()));
+  EXPECT_EQ("bar", GetFileContent(writer.path()));
+}
+
 TEST_F(ImportantFileWriterTest, BatchingWrites) {
   ImportantFileWriter writer(file_, MessageLoopProxy::current().get());
   writer.set_commit_interval(TimeDelta::FromMilliseconds(25));
@@ -192,4 +258,78 @@ TEST_F(ImportantFileWriterTest, BatchingWrites) {
   EXPECT_EQ("baz", GetFileContent(writer.path()));
 }
 
+TEST_F(ImportantFileWriterTest, WriteFileAtomically) {
+  const std::string large_data(1 << 20, 'x');
+  for (int i = 0; i < 2; ++i) {
+    ImportantFileWriter::SetUnnamedTemporaryFilesEnabledForTesting(i == 0);
+    EXPECT_TRUE(ImportantFileWriter::WriteFileAtomically(file_, "foo"));
+    EXPECT_EQ("foo", GetFileContent(file_));
+    EXPECT_TRUE(ImportantFileWriter::WriteFileAtomically(file_, large_data));
+    EXPECT_EQ(large_data, GetFileContent(file_));
+    EXPECT_TRUE(ImportantFileWriter::WriteFileAtomically(file_, ""));
+    EXPECT_EQ("", GetFileContent(file_));
+
+    // No temporary file is left behind.
+    FileEnumerator files(file_.DirName(), false, FileEnumerator::FILES);
+    EXPECT_EQ(file_, files.Next());
+    EXPECT_EQ(FilePath(), files.Next());
+
+#if defined(OS_POSIX)
+    // The file is only accessible to the user, as CreateTemporaryFile() makes
+    // it.
+    int mode = 0;
+    EXPECT_TRUE(GetPosixFilePermissions(file_, &mode));
+    EXPECT_EQ(FILE_PERMISSION_READ_BY_USER | FILE_PERMISSION_WRITE_BY_USER,
+              mode);
+#endif
+
+    EXPECT_FALSE(ImportantFileWriter::WriteFileAtomically(
+        file_.DirName().AppendASCII("missing").AppendASCII("test-file"),
+        "foo"));
+    ASSERT_TRUE(DeleteFile(file_, false));
+  }
+  ImportantFileWriter::SetUnnamedTemporaryFilesEnabledForTesting(true);
+}
+
+// Writes two versions of the file at kPathSwitch in turn, until killed.
+MULTIPROCESS_TEST_MAIN(WriteFileAtomicallyUntilKilled) {
+  const CommandLine& command_line = *CommandLine::ForCurrentProcess();
+  ImportantFileWriter::SetUnnamedTemporaryFilesEnabledForTesting(
+      !command_line.HasSwitch(kNamedTemporaryFilesSwitch));
+  const FilePath path = command_line.GetSwitchValuePath(kPathSwitch);
+  const std::string first(kKillTestDataSize, 'a');
+  const std::string second(kKillTestDataSize, 'b');
+  for (;;) {
+    ImportantFileWriter::WriteFileAtomically(path, second);
+    ImportantFileWriter::WriteFileAtomically(path, first);
+  }
+  return 0;
+}
+
+// Kills processes writing the file at random times, as a crash would, and
+// checks that the file always holds one whole version.
+TEST_F(ImportantFileWriterTest, WriteFileAtomicallyWhenKilled) {
+  const std::string first(kKillTestDataSize, 'a');
+  const std::string second(kKillTestDataSize, 'b');
+  for (int i = 0; i < 2; ++i) {
+    CommandLine command_line(GetMultiProcessTestChildBaseCommandLine());
+    command_line.AppendSwitchPath(kPathSwitch, file_);
+    if (i == 1)
+      command_line.AppendSwitch(kNamedTemporaryFilesSwitch);
+    ASSERT_TRUE(ImportantFileWriter::WriteFileAtomically(file_, first));
+
+    for (int j = 0; j < kNumKills; ++j) {
+      ProcessHandle child = SpawnMultiProcessTestChild(
+          "WriteFileAtomicallyUntilKilled", command_line, LaunchOptions());
+      ASSERT_NE(kNullProcessHandle, child);
+      PlatformThread::Sleep(TimeDelta::FromMilliseconds(RandInt(0, 100)));
+      EXPECT_TRUE(KillProcess(child, 1, true));
+      CloseProcessHandle(child);
+
+      std::string content = GetFileContent(file_);
+      EXPECT_TRUE(content == first || content == second);
+    }
+  }
+}
+
 }  // namespace base
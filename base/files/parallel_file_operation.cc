@@ -0,0 +1,92 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/files/parallel_file_operation.h"
+
+#include <algorithm>
+
+#include "base/bind.h"
+#include "base/location.h"
+#include "base/logging.h"
+#include "base/single_thread_task_runner.h"
+#include "base/thread_task_runner_handle.h"
+#include "base/threading/worker_pool.h"
+
+namespace base {
+namespace internal {
+
+ParallelFileOperation::ParallelFileOperation(
+    size_t item_count,
+    int max_threads,
+    int min_items_per_thread,
+    const ItemCallback& item_callback)
+    : item_count_(item_count),
+      threads_(std::min(max_threads,
+                        static_cast<int>(item_count / min_items_per_thread))),
+      item_callback_(item_callback),
+      next_item_(0),
+      pending_items_(0),
+      failed_(false),
+      items_done_(&lock_) {
+  DCHECK_GT(max_threads, 0);
+  DCHECK_GT(min_items_per_thread, 0);
+}
+
+bool ParallelFileOperation::Run() {
+  PostTasks(threads_ - 1);
+  RunPendingItems();
+
+  AutoLock auto_lock(lock_);
+  while (pending_items_ > 0)
+    items_done_.Wait();
+  return !failed_;
+}
+
+void ParallelFileOperation::RunAsync(const DoneCallback& callback) {
+  DCHECK(!callback.is_null());
+  reply_task_runner_ = ThreadTaskRunnerHandle::Get();
+  if (item_count_ == 0) {
+    reply_task_runner_->PostTask(FROM_HERE, Bind(callback, true));
+    return;
+  }
+  done_callback_ = callback;
+  PostTasks(std::max(threads_, 1));
+}
+
+ParallelFileOperation::~ParallelFileOperation() {
+}
+
+void ParallelFileOperation::PostTasks(int tasks) {
+  for (int i = 0; i < tasks; ++i) {
+    WorkerPool::PostTask(
+        FROM_HERE, Bind(&ParallelFileOperation::RunPendingItems, this), true);
+  }
+}
+
+void ParallelFileOperation::RunPendingItems() {
+  AutoLock auto_lock(lock_);
+  while (next_item_ < item_count_ && !failed_) {
+    size_t item = next_item_++;
+    ++pending_items_;
+    bool succeeded;
+    {
+      AutoUnlock auto_unlock(lock_);
+      succeeded = item_callback_.Run(item);
+    }
+    failed_ |= !succeeded;
+    if (--pending_items_ > 0)
+      continue;
+    if (done_callback_.is_null()) {
+      items_done_.Broadcast();
+    } else if (next_item_ == item_count_ || failed_) {
+      // The last item is done: no other thread starts one anymore.
+      reply_task_runner_->PostTask(FROM_HERE,
+                                   Bind(done_callback_, !failed_));
+      done_callback_.Reset();
+    }
+  }
+}
+
+}  // namespace internal
+}  // namespace base
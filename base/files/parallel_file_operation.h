@@ -0,0 +1,89 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef BASE_FILES_PARALLEL_FILE_OPERATION_H_
+#define BASE_FILES_PARALLEL_FILE_OPERATION_H_
+
+#include "base/base_export.h"
+#include "base/basictypes.h"
+#include "base/callback.h"
+#include "base/memory/ref_counted.h"
+#include "base/synchronization/condition_variable.h"
+#include "base/synchronization/lock.h"
+
+namespace base {
+
+class SingleThreadTaskRunner;
+
+namespace internal {
+
+// Runs an operation, such as reading or copying a file, on each of a batch of
+// items at once, on threads of the worker pool. The threads mostly wait for
+// the disk or the kernel, so there can be more of them than processors. Used
+// by CopyDirectory() and FileBatchReader.
+//
+// Reference counted, as the tasks of the pool may only run once all the items
+// are done.
+class BASE_EXPORT ParallelFileOperation
+    : public RefCountedThreadSafe<ParallelFileOperation> {
+ public:
+  // Runs the operation on the item at an index, on any thread, and returns
+  // whether it succeeded. Once it fails, the items not started yet are
+  // skipped; an operation which should go on regardless returns true.
+  typedef Callback<bool(size_t)> ItemCallback;
+
+  // Called with whether the operation succeeded on every item.
+  typedef Callback<void(bool)> DoneCallback;
+
+  // Runs |item_callback| on the items from 0 to |item_count| - 1, on at most
+  // |max_threads| threads, each of which gets at least |min_items_per_thread|
+  // items.
+  ParallelFileOperation(size_t item_count,
+                        int max_threads,
+                        int min_items_per_thread,
+                        const ItemCallback& item_callback);
+
+  // Runs the operation on the calling thread along with threads of the pool,
+  // and blocks until it is done. Returns whether it succeeded on every item.
+  // Only waits, as ThreadRestrictions checks, when the pool is used. Only one
+  // of Run() and RunAsync() may be called, once.
+  bool Run();
+
+  // Runs the operation on threads of the pool only, then posts |callback| to
+  // the calling thread, which must have a message loop.
+  void RunAsync(const DoneCallback& callback);
+
+ private:
+  friend class RefCountedThreadSafe<ParallelFileOperation>;
+
+  ~ParallelFileOperation();
+
+  // Posts |tasks| tasks to the pool, each of which runs RunPendingItems().
+  void PostTasks(int tasks);
+
+  // Runs the operation on items until none is left.
+  void RunPendingItems();
+
+  const size_t item_count_;
+  const int threads_;
+  const ItemCallback item_callback_;
+
+  // Set by RunAsync().
+  scoped_refptr<SingleThreadTaskRunner> reply_task_runner_;
+  DoneCallback done_callback_;
+
+  // Protects the members below, once the operation runs.
+  Lock lock_;
+  size_t next_item_;
+  int pending_items_;
+  bool failed_;
+  ConditionVariable items_done_;
+
+  DISALLOW_COPY_AND_ASSIGN(ParallelFileOperation);
+};
+
+}  // namespace internal
+}  // namespace base
+
+#endif  // BASE_FILES_PARALLEL_FILE_OPERATION_H_
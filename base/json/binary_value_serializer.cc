@@ -0,0 +1,418 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/json/binary_value_serializer.h"
+
+#include <string.h>
+
+#include <vector>
+
+#include "base/containers/hash_tables.h"
+#include "base/logging.h"
+#include "base/memory/scoped_ptr.h"
+#include "base/strings/string_util.h"
+#include "base/sys_byteorder.h"
+
+using base::StringPiece;
+
+namespace {
+
+// The header starts with a byte which can't start a JSON text, even one with
+// a UTF-8 byte order mark, and ends with the version of the format.
+const char kHeader[] = "\x89" "BV\x01";
+const size_t kHeaderSize = arraysize(kHeader) - 1;
+
+// Like JSONReader, reject input nested deeper than this.
+const int kStackMaxDepth = 100;
+
+// The first byte of each value, which is followed by:
+enum Tag {
+  TAG_NULL = 0,    // Nothing.
+  TAG_FALSE,       // Nothing.
+  TAG_TRUE,        // Nothing.
+  TAG_INTEGER,     // The integer, zigzag-encoded, as a varint.
+  TAG_DOUBLE,      // The 8 bytes of the double, little-endian.
+  TAG_STRING,      // The length as a varint, then the bytes.
+  TAG_BINARY,      // The length as a varint, then the bytes.
+  TAG_DICTIONARY,  // The size as a varint, then each key and its value.
+  TAG_LIST         // The size as a varint, then the values.
+};
+
+// Varints are little-endian base 128: each byte holds 7 bits of the number,
+// and has its top bit set unless it is the last one.
+//
+// Keys are numbered in the order they are written. A key is a varint holding
+// either twice its length, followed by the bytes of the key, or twice the
+// number of an identical key written before it, plus one.
+
+class Writer {
+ public:
+  Writer(std::string* output, bool intern_keys)
+      : output_(output),
+        intern_keys_(intern_keys) {
+  }
+
+  void WriteValue(const base::Value& value) {
+    switch (value.GetType()) {
+      case base::Value::TYPE_NULL:
+        output_->push_back(TAG_NULL);
+        break;
+      case base::Value::TYPE_BOOLEAN: {
+        bool boolean_value = false;
+        value.GetAsBoolean(&boolean_value);
+        output_->push_back(boolean_value ? TAG_TRUE : TAG_FALSE);
+        break;
+      }
+      case base::Value::TYPE_INTEGER: {
+        int integer_value = 0;
+        value.GetAsInteger(&integer_value);
+        output_->push_back(TAG_INTEGER);
+        uint32 bits = static_cast<uint32>(integer_value);
+        WriteVarint((bits << 1) ^ (integer_value < 0 ? 0xFFFFFFFF : 0));
+        break;
+      }
+      case base::Value::TYPE_DOUBLE: {
+        double double_value = 0;
+        value.GetAsDouble(&double_value);
+        uint64 bits = base::ByteSwapToLE64(bit_cast<uint64>(double_value));
+        output_->push_back(TAG_DOUBLE);
+        output_->append(reinterpret_cast<const char*>(&bits), sizeof(bits));
+        break;
+      }
+      case base::Value::TYPE_STRING: {
+        const base::StringValue* string_value = NULL;
+        value.GetAsString(&string_value);
+        output_->push_back(TAG_STRING);
+        WriteBytes(string_value->GetString());
+        break;
+      }
+      case base::Value::TYPE_BINARY: {
+        const base::BinaryValue* binary_value =
+            static_cast<const base::BinaryValue*>(&value);
+        output_->push_back(TAG_BINARY);
+        WriteBytes(StringPiece(binary_value->GetBuffer(),
+                               binary_value->GetSize()));
+        break;
+      }
+      case base::Value::TYPE_DICTIONARY: {
+        const base::DictionaryValue* dictionary = NULL;
+        value.GetAsDictionary(&dictionary);
+        output_->push_back(TAG_DICTIONARY);
+        WriteVarint(dictionary->size());
+        for (base::DictionaryValue::Iterator it(*dictionary); !it.IsAtEnd();
+             it.Advance()) {
+          WriteKey(it.key());
+          WriteValue(it.value());
+        }
+        break;
+      }
+      case base::Value::TYPE_LIST: {
+        const base::ListValue* list = NULL;
+        value.GetAsList(&list);
+        output_->push_back(TAG_LIST);
+        WriteVarint(list->GetSize());
+        for (base::ListValue::const_iterator it = list->begin();
+             it != list->end(); ++it) {
+          WriteValue(**it);
+        }
+        break;
+      }
+    }
+  }
+
+ private:
+  void WriteVarint(uint64 value) {
+    while (value >= 0x80) {
+      output_->push_back(static_cast<char>(value | 0x80));
+      value >>= 7;
+    }
+    output_->push_back(static_cast<char>(value));
+  }
+
+  void WriteBytes(const StringPiece& bytes) {
+    WriteVarint(bytes.size());
+    output_->append(bytes.data(), bytes.size());
+  }
+
+  void WriteKey(const std::string& key) {
+    if (intern_keys_) {
+      // The keys point into the Value being serialized, which outlives this.
+      std::pair<KeyMap::iterator, bool> inserted =
+          keys_.insert(std::make_pair(StringPiece(key), keys_.size()));
+      if (!inserted.second) {
+        WriteVarint(inserted.first->second * 2 + 1);
+        return;
+      }
+    }
+    WriteVarint(static_cast<uint64>(key.size()) * 2);
+    output_->append(key);
+  }
+
+  typedef base::hash_map<StringPiece, size_t> KeyMap;
+
+  std::string* output_;
+  bool intern_keys_;
+  // The number of each distinct key written so far, if |intern_keys_|.
+  KeyMap keys_;
+
+  DISALLOW_COPY_AND_ASSIGN(Writer);
+};
+
+class Reader {
+ public:
+  explicit Reader(const StringPiece& input)
+      : pos_(input.data()),
+        end_(input.data() + input.size()),
+        error_(BinaryValueSerializer::BINARY_NO_ERROR) {
+  }
+
+  // Returns the value at the current position, or NULL on error.
+  base::Value* ReadValue(int depth) {
+    if (pos_ == end_)
+      return Fail(BinaryValueSerializer::BINARY_TRUNCATED);
+
+    switch (*pos_++) {
+      case TAG_NULL:
+        return base::Value::CreateNullValue();
+      case TAG_FALSE:
+        return new base::FundamentalValue(false);
+      case TAG_TRUE:
+        return new base::FundamentalValue(true);
+      case TAG_INTEGER: {
+        uint64 bits = 0;
+        if (!ReadVarint(&bits))
+          return NULL;
+        if (bits > 0xFFFFFFFF)
+          return Fail(BinaryValueSerializer::BINARY_MALFORMED_DATA);
+        uint32 zigzag = static_cast<uint32>(bits);
+        return new base::FundamentalValue(
+            static_cast<int>((zigzag >> 1) ^ (0 - (zigzag & 1))));
+      }
+      case TAG_DOUBLE: {
+        uint64 bits = 0;
+        if (static_cast<size_t>(end_ - pos_) < sizeof(bits))
+          return Fail(BinaryValueSerializer::BINARY_TRUNCATED);
+        memcpy(&bits, pos_, sizeof(bits));
+        pos_ += sizeof(bits);
+        return new base::FundamentalValue(
+            bit_cast<double>(base::ByteSwapToLE64(bits)));
+      }
+      case TAG_STRING: {
+        StringPiece bytes;
+        if (!ReadBytes(&bytes))
+          return NULL;
+        // Like JSONReader, reject strings which aren't UTF-8, as StringValue
+        // requires them to be.
+        std::string string = bytes.as_string();
+        if (!base::IsStringUTF8(string))
+          return Fail(BinaryValueSerializer::BINARY_MALFORMED_DATA);
+        return new base::StringValue(string);
+      }
+      case TAG_BINARY: {
+        StringPiece bytes;
+        if (!ReadBytes(&bytes))
+          return NULL;
+        return base::BinaryValue::CreateWithCopiedBuffer(bytes.data(),
+                                                         bytes.size());
+      }
+      case TAG_DICTIONARY: {
+        uint64 size = 0;
+        if (!ReadVarint(&size))
+          return NULL;
+        if (depth + 1 >= kStackMaxDepth)
+          return Fail(BinaryValueSerializer::BINARY_TOO_MUCH_NESTING);
+        scoped_ptr<base::DictionaryValue> dictionary(
+            new base::DictionaryValue);
+        for (uint64 i = 0; i < size; ++i) {
+          StringPiece key;
+          if (!ReadKey(&key))
+            return NULL;
+          base::Value* child = ReadValue(depth + 1);
+          if (!child)
+            return NULL;
+          dictionary->SetWithoutPathExpansion(key.as_string(), child);
+        }
+        return dictionary.release();
+      }
+      case TAG_LIST: {
+        uint64 size = 0;
+        if (!ReadVarint(&size))
+          return NULL;
+        if (depth + 1 >= kStackMaxDepth)
+          return Fail(BinaryValueSerializer::BINARY_TOO_MUCH_NESTING);
+        scoped_ptr<base::ListValue> list(new base::ListValue);
+        for (uint64 i = 0; i < size; ++i) {
+          base::Value* child = ReadValue(depth + 1);
+          if (!child)
+            return NULL;
+          list->Append(child);
+        }
+        return list.release();
+      }
+      default:
+        return Fail(BinaryValueSerializer::BINARY_MALFORMED_DATA);
+    }
+  }
+
+  bool AtEnd() const { return pos_ == end_; }
+
+  int error() const { return error_; }
+
+ private:
+  base::Value* Fail(int error) {
+    error_ = error;
+    return NULL;
+  }
+
+  bool ReadVarint(uint64* value) {
+    uint64 result = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+      if (pos_ == end_) {
+        Fail(BinaryValueSerializer::BINARY_TRUNCATED);
+        return false;
+      }
+      uint8 byte = static_cast<uint8>(*pos_++);
+      result |= static_cast<uint64>(byte & 0x7F) << shift;
+      if (!(byte & 0x80)) {
+        *value = result;
+        return true;
+      }
+    }
+    Fail(BinaryValueSerializer::BINARY_MALFORMED_DATA);
+    return false;
+  }
+
+  bool ReadBytes(StringPiece* bytes) {
+    uint64 size = 0;
+    if (!ReadVarint(&size))
+      return false;
+    if (size > static_cast<uint64>(end_ - pos_)) {
+      Fail(BinaryValueSerializer::BINARY_TRUNCATED);
+      return false;
+    }
+    bytes->set(pos_, static_cast<size_t>(size));
+    pos_ += size;
+    return true;
+  }
+
+  bool ReadKey(StringPiece* key) {
+    uint64 header = 0;
+    if (!ReadVarint(&header))
+      return false;
+    if (header & 1) {
+      uint64 number = header >> 1;
+      if (number >= keys_.size()) {
+        Fail(BinaryValueSerializer::BINARY_MALFORMED_DATA);
+        return false;
+      }
+      *key = keys_[static_cast<size_t>(number)];
+      return true;
+    }
+    uint64 size = header >> 1;
+    if (size > static_cast<uint64>(end_ - pos_)) {
+      Fail(BinaryValueSerializer::BINARY_TRUNCATED);
+      return false;
+    }
+    key->set(pos_, static_cast<size_t>(size));
+    pos_ += size;
+    // Keys referred to by number were checked when they were first read.
+    if (!base::IsStringUTF8(key->as_string())) {
+      Fail(BinaryValueSerializer::BINARY_MALFORMED_DATA);
+      return false;
+    }
+    keys_.push_back(*key);
+    return true;
+  }
+
+  const char* pos_;
+  const char* end_;
+  int error_;
+  // The keys read so far, in order, pointing into the input.
+  std::vector<StringPiece> keys_;
+
+  DISALLOW_COPY_AND_ASSIGN(Reader);
+};
+
+}  // namespace
+
+const char* BinaryValueSerializer::kBadHeader = "Not a binary Value.";
+const char* BinaryValueSerializer::kTruncated = "Unexpected end of data.";
+const char* BinaryValueSerializer::kMalformedData = "Malformed data.";
+const char* BinaryValueSerializer::kTooMuchNesting = "Too much nesting.";
+const char* BinaryValueSerializer::kUnexpectedDataAfterRoot =
+    "Unexpected data after root element.";
+
+BinaryValueSerializer::BinaryValueSerializer(std::string* output)
+    : output_(output),
+      intern_keys_(true) {
+}
+
+BinaryValueSerializer::BinaryValueSerializer(const StringPiece& input)
+    : output_(NULL),
+      input_(input),
+      intern_keys_(true) {
+}
+
+BinaryValueSerializer::~BinaryValueSerializer() {
+}
+
+// static
+bool BinaryValueSerializer::HasBinaryHeader(const StringPiece& data) {
+  return data.starts_with(StringPiece(kHeader, kHeaderSize));
+}
+
+// static
+const char* BinaryValueSerializer::GetErrorMessageForCode(int error_code) {
+  switch (error_code) {
+    case BINARY_NO_ERROR:
+      return "";
+    case BINARY_BAD_HEADER:
+      return kBadHeader;
+    case BINARY_TRUNCATED:
+      return kTruncated;
+    case BINARY_MALFORMED_DATA:
+      return kMalformedData;
+    case BINARY_TOO_MUCH_NESTING:
+      return kTooMuchNesting;
+    case BINARY_UNEXPECTED_DATA_AFTER_ROOT:
+      return kUnexpectedDataAfterRoot;
+    default:
+      NOTREACHED();
+      return "";
+  }
+}
+
+bool BinaryValueSerializer::Serialize(const base::Value& root) {
+  if (!output_)
+    return false;
+
+  output_->assign(kHeader, kHeaderSize);
+  Writer writer(output_, intern_keys_);
+  writer.WriteValue(root);
+  return true;
+}
+
+base::Value* BinaryValueSerializer::Deserialize(int* error_code,
+                                                std::string* error_message) {
+  scoped_ptr<base::Value> root;
+  int error = BINARY_BAD_HEADER;
+  if (HasBinaryHeader(input_)) {
+    Reader reader(input_.substr(kHeaderSize));
+    root.reset(reader.ReadValue(0));
+    error = reader.error();
+    if (root && !reader.AtEnd()) {
+      root.reset();
+      error = BINARY_UNEXPECTED_DATA_AFTER_ROOT;
+    }
+  }
+
+  if (!root) {
+    if (error_code)
+      *error_code = error;
+    if (error_message)
+      *error_message = GetErrorMessageForCode(error);
+    return NULL;
+  }
+  return root.release();
+}
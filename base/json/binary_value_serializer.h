@@ -0,0 +1,84 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef BASE_JSON_BINARY_VALUE_SERIALIZER_H_
+#define BASE_JSON_BINARY_VALUE_SERIALIZER_H_
+
+#include <string>
+
+#include "base/base_export.h"
+#include "base/basictypes.h"
+#include "base/strings/string_piece.h"
+#include "base/values.h"
+
+// Serializes Values to, and deserializes them from, a compact binary format
+// which is much cheaper to read than JSON: there is nothing to unescape or
+// validate, integers are varints, doubles are stored as their bits, and
+// strings are length-prefixed. Dictionary keys are interned by default, so a
+// key which appears many times (e.g. in a list of dictionaries) is stored
+// once. The format starts with a header which HasBinaryHeader() recognizes,
+// and which can't start a JSON text.
+//
+// Deserialization reads the input in place, so it costs nothing more than
+// building the Values when the input is a memory-mapped file.
+class BASE_EXPORT BinaryValueSerializer : public base::ValueSerializer {
+ public:
+  // This enum is designed to safely overlap with JSONReader::JsonParseError
+  // and JSONFileValueSerializer::JsonFileError.
+  enum BinaryValueError {
+    BINARY_NO_ERROR = 0,
+    BINARY_BAD_HEADER = 2000,
+    BINARY_TRUNCATED,
+    BINARY_MALFORMED_DATA,
+    BINARY_TOO_MUCH_NESTING,
+    BINARY_UNEXPECTED_DATA_AFTER_ROOT
+  };
+
+  // Error messages matching the error codes above.
+  static const char* kBadHeader;
+  static const char* kTruncated;
+  static const char* kMalformedData;
+  static const char* kTooMuchNesting;
+  static const char* kUnexpectedDataAfterRoot;
+
+  // |output| is the destination of the serialization. The caller retains
+  // ownership of it.
+  explicit BinaryValueSerializer(std::string* output);
+
+  // This version deserializes |input|, which must outlive the serializer.
+  explicit BinaryValueSerializer(const base::StringPiece& input);
+
+  virtual ~BinaryValueSerializer();
+
+  // Returns whether |data| starts with the header of this format.
+  static bool HasBinaryHeader(const base::StringPiece& data);
+
+  // Replaces the output passed to the constructor with the serialization of
+  // |root|. Fails only if the serializer was constructed for deserialization.
+  virtual bool Serialize(const base::Value& root) override;
+
+  // Deserializes the input passed to the constructor. Returns NULL if it is
+  // malformed, in which case |error_code| (a BinaryValueError) and
+  // |error_message| are set if non-NULL. The caller takes ownership of the
+  // returned value.
+  virtual base::Value* Deserialize(int* error_code,
+                                   std::string* error_message) override;
+
+  // Converts an error code into an error message. |error_code| is assumed to
+  // be a BinaryValueError.
+  static const char* GetErrorMessageForCode(int error_code);
+
+  // Whether repeated dictionary keys are written once and then referred to.
+  // Defaults to true. Deserialization handles both.
+  void set_intern_keys(bool new_value) { intern_keys_ = new_value; }
+
+ private:
+  std::string* output_;
+  base::StringPiece input_;
+  bool intern_keys_;
+
+  DISALLOW_COPY_AND_ASSIGN(BinaryValueSerializer);
+};
+
+#endif  // BASE_JSON_BINARY_VALUE_SERIALIZER_H_
@@ -0,0 +1,92 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <string.h>
+
+#include <string>
+
+#include "base/json/binary_value_serializer.h"
+#include "base/json/json_reader.h"
+#include "base/json/json_writer.h"
+#include "base/memory/scoped_ptr.h"
+#include "base/strings/stringprintf.h"
+#include "base/time/time.h"
+#include "base/values.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "testing/perf/perf_test.h"
+
+namespace base {
+
+namespace {
+
+const int kNumRecords = 100000;
+
+// Returns a list of records like those in local state files.
+scoped_ptr<Value> BuildRoot() {
+  scoped_ptr<ListValue> root(new ListValue);
+  for (int i = 0; i < kNumRecords; ++i) {
+    DictionaryValue* record = new DictionaryValue;
+    record->SetInteger("id", i);
+    record->SetString("name", StringPrintf("record %d", i));
+    record->SetDouble("score", i % 100 + 0.25);
+    record->SetBoolean("active", i % 2 != 0);
+    ListValue* tags = new ListValue;
+    tags->AppendString("alpha");
+    tags->AppendString("beta");
+    record->Set("tags", tags);
+    record->SetInteger("position.x", i);
+    record->SetInteger("position.y", -i);
+    root->Append(record);
+  }
+  return root.PassAs<Value>();
+}
+
+void PrintTime(const std::string& trace, TimeDelta elapsed) {
+  perf_test::PrintResult("binary_value_serializer", "", trace,
+                         elapsed.InMillisecondsF(), "ms", true);
+}
+
+}  // namespace
+
+// Compares writing and reading back a tree as JSON and in the binary format,
+// with a memcpy of the binary output as the lower bound.
+TEST(BinaryValueSerializerPerfTest, JSONVersusBinary) {
+  scoped_ptr<Value> root = BuildRoot();
+
+  TimeTicks start = TimeTicks::HighResNow();
+  std::string json;
+  JSONWriter::Write(root.get(), &json);
+  TimeTicks written = TimeTicks::HighResNow();
+  scoped_ptr<Value> json_root(JSONReader::Read(json));
+  TimeTicks read = TimeTicks::HighResNow();
+  ASSERT_TRUE(json_root);
+  EXPECT_TRUE(root->Equals(json_root.get()));
+  PrintTime("json_write", written - start);
+  PrintTime("json_read", read - written);
+  perf_test::PrintResult("binary_value_serializer", "", "json_size",
+                         json.size(), "bytes", true);
+
+  start = TimeTicks::HighResNow();
+  std::string binary;
+  BinaryValueSerializer writer(&binary);
+  ASSERT_TRUE(writer.Serialize(*root));
+  written = TimeTicks::HighResNow();
+  BinaryValueSerializer reader(binary);
+  scoped_ptr<Value> binary_root(reader.Deserialize(NULL, NULL));
+  read = TimeTicks::HighResNow();
+  ASSERT_TRUE(binary_root);
+  EXPECT_TRUE(root->Equals(binary_root.get()));
+  PrintTime("binary_write", written - start);
+  PrintTime("binary_read", read - written);
+  perf_test::PrintResult("binary_value_serializer", "", "binary_size",
+                         binary.size(), "bytes", true);
+
+  scoped_ptr<char[]> copy(new char[binary.size()]);
+  start = TimeTicks::HighResNow();
+  memcpy(copy.get(), binary.data(), binary.size());
+  PrintTime("memcpy", TimeTicks::HighResNow() - start);
+  EXPECT_EQ(0, memcmp(copy.get(), binary.data(), binary.size()));
+}
+
+}  // namespace base
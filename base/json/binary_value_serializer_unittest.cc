@@ -0,0 +1,170 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/json/binary_value_serializer.h"
+
+#include <limits>
+#include <string>
+
+#include "base/files/file_path.h"
+#include "base/files/file_util.h"
+#include "base/files/memory_mapped_file.h"
+#include "base/files/scoped_temp_dir.h"
+#include "base/memory/scoped_ptr.h"
+#include "base/strings/string_number_conversions.h"
+#include "base/values.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace base {
+
+namespace {
+
+// Returns a tree with every type of value, and keys which repeat.
+scoped_ptr<DictionaryValue> BuildTree() {
+  scoped_ptr<DictionaryValue> root(new DictionaryValue);
+  root->Set("null", Value::CreateNullValue());
+  root->SetBoolean("true", true);
+  root->SetBoolean("false", false);
+  root->SetInteger("zero", 0);
+  root->SetInteger("negative", -1);
+  root->SetInteger("min", std::numeric_limits<int>::min());
+  root->SetInteger("max", std::numeric_limits<int>::max());
+  root->SetDouble("double", 0.1);
+  root->SetDouble("large", 1.7976931348623157e308);
+  root->SetString("string", "\xE2\x82\xAC with a \" quote");
+  root->SetString("nul", std::string("a\0b", 3));
+  root->SetString("", "empty key");
+  const char kBinary[] = { 0, 1, 2, '\xFF' };
+  root->Set("binary",
+            BinaryValue::CreateWithCopiedBuffer(kBinary, sizeof(kBinary)));
+  ListValue* items = new ListValue;
+  for (int i = 0; i < 100; ++i) {
+    DictionaryValue* item = new DictionaryValue;
+    item->SetInteger("id", i);
+    item->SetString("name", "item " + IntToString(i));
+    item->Set("children", new ListValue);
+    items->Append(item);
+  }
+  root->Set("items", items);
+  root->Set("nested.empty", new DictionaryValue);
+  return root.Pass();
+}
+
+std::string Serialize(const Value& value, bool intern_keys) {
+  std::string output;
+  BinaryValueSerializer serializer(&output);
+  serializer.set_intern_keys(intern_keys);
+  EXPECT_TRUE(serializer.Serialize(value));
+  return output;
+}
+
+// Deserializes |input|, which must fail with |expected_error|.
+void ExpectError(const std::string& input, int expected_error) {
+  BinaryValueSerializer serializer(input);
+  int error_code = 0;
+  std::string error_message;
+  scoped_ptr<Value> value(serializer.Deserialize(&error_code, &error_message));
+  EXPECT_FALSE(value);
+  EXPECT_EQ(expected_error, error_code);
+  EXPECT_EQ(BinaryValueSerializer::GetErrorMessageForCode(expected_error),
+            error_message);
+}
+
+}  // namespace
+
+TEST(BinaryValueSerializerTest, RoundTrip) {
+  scoped_ptr<DictionaryValue> root = BuildTree();
+  std::string interned = Serialize(*root, true);
+  std::string plain = Serialize(*root, false);
+  EXPECT_LT(interned.size(), plain.size());
+
+  const std::string* const kOutputs[] = { &interned, &plain };
+  for (size_t i = 0; i < arraysize(kOutputs); ++i) {
+    EXPECT_TRUE(BinaryValueSerializer::HasBinaryHeader(*kOutputs[i]));
+    BinaryValueSerializer serializer(*kOutputs[i]);
+    scoped_ptr<Value> value(serializer.Deserialize(NULL, NULL));
+    ASSERT_TRUE(value);
+    EXPECT_TRUE(root->Equals(value.get()));
+  }
+
+  // Scalar roots work too.
+  FundamentalValue integer(-42);
+  std::string output = Serialize(integer, true);
+  BinaryValueSerializer serializer(output);
+  scoped_ptr<Value> value(serializer.Deserialize(NULL, NULL));
+  ASSERT_TRUE(value);
+  EXPECT_TRUE(integer.Equals(value.get()));
+}
+
+TEST(BinaryValueSerializerTest, Header) {
+  EXPECT_FALSE(BinaryValueSerializer::HasBinaryHeader(""));
+  EXPECT_FALSE(BinaryValueSerializer::HasBinaryHeader("{}"));
+  EXPECT_FALSE(BinaryValueSerializer::HasBinaryHeader("\xEF\xBB\xBF{}"));
+
+  // A deserializing serializer can't serialize.
+  std::string input;
+  BinaryValueSerializer serializer(input);
+  EXPECT_FALSE(serializer.Serialize(FundamentalValue(1)));
+}
+
+TEST(BinaryValueSerializerTest, Errors) {
+  ExpectError("", BinaryValueSerializer::BINARY_BAD_HEADER);
+  ExpectError("{\"a\": 1}", BinaryValueSerializer::BINARY_BAD_HEADER);
+
+  // Every strict prefix of a valid input is truncated.
+  std::string valid = Serialize(*BuildTree(), true);
+  const size_t kHeaderSize = Serialize(FundamentalValue(true), true).size() - 1;
+  for (size_t i = kHeaderSize; i < valid.size(); ++i) {
+    ASSERT_NO_FATAL_FAILURE(ExpectError(
+        valid.substr(0, i), BinaryValueSerializer::BINARY_TRUNCATED));
+  }
+  ExpectError(valid + '\0',
+              BinaryValueSerializer::BINARY_UNEXPECTED_DATA_AFTER_ROOT);
+
+  std::string header = valid.substr(0, kHeaderSize);
+  // Unknown tag.
+  ExpectError(header + '\x7F', BinaryValueSerializer::BINARY_MALFORMED_DATA);
+  // Integer out of range.
+  ExpectError(header + "\x03\xFF\xFF\xFF\xFF\x7F",
+              BinaryValueSerializer::BINARY_MALFORMED_DATA);
+  // Varint longer than 64 bits.
+  ExpectError(header + "\x05" + std::string(10, '\xFF') + '\x01',
+              BinaryValueSerializer::BINARY_MALFORMED_DATA);
+  // A dictionary of one entry whose key refers to a key not written yet.
+  ExpectError(header + "\x07\x01\x01",
+              BinaryValueSerializer::BINARY_MALFORMED_DATA);
+  // A string which isn't UTF-8.
+  ExpectError(header + "\x05\x02\xC0\x80",
+              BinaryValueSerializer::BINARY_MALFORMED_DATA);
+  // A dictionary of one entry whose key isn't UTF-8.
+  ExpectError(header + "\x07\x01\x04\xFF\xFE",
+              BinaryValueSerializer::BINARY_MALFORMED_DATA);
+
+  // Lists nested too deeply.
+  std::string nested = header;
+  for (int i = 0; i < 200; ++i)
+    nested += "\x08\x01";
+  nested += '\x00';
+  ExpectError(nested, BinaryValueSerializer::BINARY_TOO_MUCH_NESTING);
+}
+
+TEST(BinaryValueSerializerTest, MemoryMappedFile) {
+  ScopedTempDir temp_dir;
+  ASSERT_TRUE(temp_dir.CreateUniqueTempDir());
+  FilePath path = temp_dir.path().AppendASCII("values.bin");
+  scoped_ptr<DictionaryValue> root = BuildTree();
+  std::string output = Serialize(*root, true);
+  int size = static_cast<int>(output.size());
+  ASSERT_EQ(size, WriteFile(path, output.data(), size));
+
+  MemoryMappedFile file;
+  ASSERT_TRUE(file.Initialize(path));
+  BinaryValueSerializer serializer(
+      StringPiece(reinterpret_cast<const char*>(file.data()), file.length()));
+  scoped_ptr<Value> value(serializer.Deserialize(NULL, NULL));
+  ASSERT_TRUE(value);
+  EXPECT_TRUE(root->Equals(value.get()));
+}
+
+}  // namespace base
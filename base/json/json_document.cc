@@ -0,0 +1,612 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/json/json_document.h"
+
+#include <string.h>
+
+#include <algorithm>
+
+#include "base/json/json_sax_reader.h"
+#include "base/logging.h"
+
+namespace base {
+
+namespace internal {
+
+// A value of a JSONDocument. Nodes and members are plain data, so that the
+// document can copy them around and free them without running destructors.
+struct JSONNode {
+  Value::Type type;
+
+  // The length of a string, or the number of children of a list or
+  // dictionary.
+  size_t size;
+
+  union {
+    bool boolean_value;
+    int integer_value;
+    double double_value;
+    const char* string_value;
+    const JSONNode* items;
+    const JSONMember* members;
+  };
+};
+
+struct JSONMember {
+  const char* key;
+  size_t key_length;
+  JSONNode value;
+};
+
+}  // namespace internal
+
+namespace {
+
+using internal::JSONMember;
+using internal::JSONNode;
+
+// The document's blocks start small, for small documents, and double in size
+// up to kMaxBlockSize.
+const size_t kMinBlockSize = 4 * 1024;
+const size_t kMaxBlockSize = 1024 * 1024;
+
+const size_t kAlignment = ALIGNOF(JSONMember);
+
+StringPiece KeyOf(const JSONMember& member) {
+  return StringPiece(member.key, member.key_length);
+}
+
+bool MemberKeyLess(const JSONMember& left, const JSONMember& right) {
+  return KeyOf(left) < KeyOf(right);
+}
+
+bool MemberKeyLessThanKey(const JSONMember& member, const StringPiece& key) {
+  return KeyOf(member) < key;
+}
+
+Value* CreateValue(const JSONNode& node) {
+  switch (node.type) {
+    case Value::TYPE_NULL:
+      return Value::CreateNullValue();
+    case Value::TYPE_BOOLEAN:
+      return new FundamentalValue(node.boolean_value);
+    case Value::TYPE_INTEGER:
+      return new FundamentalValue(node.integer_value);
+    case Value::TYPE_DOUBLE:
+      return new FundamentalValue(node.double_value);
+    case Value::TYPE_STRING:
+      return new StringValue(std::string(node.string_value, node.size));
+    case Value::TYPE_DICTIONARY: {
+      DictionaryValue* dictionary = new DictionaryValue;
+      for (size_t i = 0; i < node.size; ++i) {
+        const JSONMember& member = node.members[i];
+        dictionary->SetWithoutPathExpansion(
+            std::string(member.key, member.key_length),
+            CreateValue(member.value));
+      }
+      return dictionary;
+    }
+    case Value::TYPE_LIST: {
+      ListValue* list = new ListValue;
+      for (size_t i = 0; i < node.size; ++i)
+        list->Append(CreateValue(node.items[i]));
+      return list;
+    }
+    default:
+      NOTREACHED();
+      return NULL;
+  }
+}
+
+}  // namespace
+
+namespace internal {
+
+// Builds a JSONDocument from the events of a JSONSaxReader, which parses the
+// input with the grammar and the limits of JSONReader.
+class JSONDocumentBuilder : public JSONSaxHandler {
+ public:
+  explicit JSONDocumentBuilder(JSONDocument* document);
+  virtual ~JSONDocumentBuilder();
+
+  // JSONSaxHandler:
+  virtual bool OnStartObject() override;
+  virtual bool OnEndObject() override;
+  virtual bool OnStartArray() override;
+  virtual bool OnEndArray() override;
+  virtual bool OnKey(const StringPiece& key) override;
+  virtual bool OnString(const StringPiece& value) override;
+  virtual bool OnInteger(int value) override;
+  virtual bool OnDouble(double value) override;
+  virtual bool OnBoolean(bool value) override;
+  virtual bool OnNull() override;
+
+ private:
+  // A list or dictionary being parsed.
+  struct Container {
+    bool is_dictionary;
+
+    // The index of its first child in |items_| or |members_|.
+    size_t first_child;
+
+    // Its key, when it is the value of a member.
+    StringPiece key;
+  };
+
+  void StartContainer(bool is_dictionary);
+
+  // Adds |node| to the innermost container, or makes it the root.
+  void AddNode(const JSONNode& node);
+
+  // Returns a copy of |string| which lives as long as the document.
+  StringPiece StoreString(const StringPiece& string);
+
+  JSONDocument* document_;
+
+  std::vector<Container> containers_;
+
+  // The key of the next member of the innermost dictionary.
+  StringPiece key_;
+
+  // The children of the containers being parsed, which are moved to the
+  // document when the container ends.
+  std::vector<JSONNode> items_;
+  std::vector<JSONMember> members_;
+
+  DISALLOW_COPY_AND_ASSIGN(JSONDocumentBuilder);
+};
+
+JSONDocumentBuilder::JSONDocumentBuilder(JSONDocument* document)
+    : document_(document) {
+}
+
+JSONDocumentBuilder::~JSONDocumentBuilder() {
+}
+
+bool JSONDocumentBuilder::OnStartObject() {
+  StartContainer(true);
+  return true;
+}
+
+bool JSONDocumentBuilder::OnEndObject() {
+  const Container container = containers_.back();
+  containers_.pop_back();
+
+  // Sort the keys, keeping only the last value of repeated keys as
+  // DictionaryValue::SetWithoutPathExpansion() would.
+  std::vector<JSONMember>::iterator first =
+      members_.begin() + container.first_child;
+  std::stable_sort(first, members_.end(), &MemberKeyLess);
+  std::vector<JSONMember>::iterator last = first;
+  for (std::vector<JSONMember>::iterator it = first; it != members_.end();
+       ++it) {
+    if (it + 1 != members_.end() && KeyOf(*it) == KeyOf(*(it + 1)))
+      continue;
+    *last++ = *it;
+  }
+
+  JSONNode node;
+  node.type = Value::TYPE_DICTIONARY;
+  node.size = last - first;
+  JSONMember* members = static_cast<JSONMember*>(
+      document_->Allocate(node.size * sizeof(JSONMember)));
+  std::copy(first, last, members);
+  node.members = members;
+  members_.resize(container.first_child);
+
+  key_ = container.key;
+  AddNode(node);
+  return true;
+}
+
+bool JSONDocumentBuilder::OnStartArray() {
+  StartContainer(false);
+  return true;
+}
+
+bool JSONDocumentBuilder::OnEndArray() {
+  const Container container = containers_.back();
+  containers_.pop_back();
+
+  JSONNode node;
+  node.type = Value::TYPE_LIST;
+  node.size = items_.size() - container.first_child;
+  JSONNode* items = static_cast<JSONNode*>(
+      document_->Allocate(node.size * sizeof(JSONNode)));
+  std::copy(items_.begin() + container.first_child, items_.end(), items);
+  node.items = items;
+  items_.resize(container.first_child);
+
+  key_ = container.key;
+  AddNode(node);
+  return true;
+}
+
+bool JSONDocumentBuilder::OnKey(const StringPiece& key) {
+  key_ = StoreString(key);
+  return true;
+}
+
+bool JSONDocumentBuilder::OnString(const StringPiece& value) {
+  StringPiece piece = StoreString(value);
+  JSONNode node;
+  node.type = Value::TYPE_STRING;
+  node.size = piece.size();
+  node.string_value = piece.data();
+  AddNode(node);
+  return true;
+}
+
+bool JSONDocumentBuilder::OnInteger(int value) {
+  JSONNode node;
+  node.type = Value::TYPE_INTEGER;
+  node.integer_value = value;
+  AddNode(node);
+  return true;
+}
+
+bool JSONDocumentBuilder::OnDouble(double value) {
+  JSONNode node;
+  node.type = Value::TYPE_DOUBLE;
+  node.double_value = value;
+  AddNode(node);
+  return true;
+}
+
+bool JSONDocumentBuilder::OnBoolean(bool value) {
+  JSONNode node;
+  node.type = Value::TYPE_BOOLEAN;
+  node.boolean_value = value;
+  AddNode(node);
+  return true;
+}
+
+bool JSONDocumentBuilder::OnNull() {
+  JSONNode node;
+  node.type = Value::TYPE_NULL;
+  AddNode(node);
+  return true;
+}
+
+void JSONDocumentBuilder::StartContainer(bool is_dictionary) {
+  Container container;
+  container.is_dictionary = is_dictionary;
+  container.first_child = is_dictionary ? members_.size() : items_.size();
+  container.key = key_;
+  containers_.push_back(container);
+}
+
+void JSONDocumentBuilder::AddNode(const JSONNode& node) {
+  if (containers_.empty()) {
+    JSONNode* root =
+        static_cast<JSONNode*>(document_->Allocate(sizeof(JSONNode)));
+    *root = node;
+    document_->root_ = root;
+  } else if (containers_.back().is_dictionary) {
+    JSONMember member;
+    member.key = key_.data();
+    member.key_length = key_.size();
+    member.value = node;
+    members_.push_back(member);
+  } else {
+    items_.push_back(node);
+  }
+}
+
+StringPiece JSONDocumentBuilder::StoreString(const StringPiece& string) {
+  char* copy = static_cast<char*>(document_->Allocate(string.size()));
+  memcpy(copy, string.data(), string.size());
+  return StringPiece(copy, string.size());
+}
+
+}  // namespace internal
+
+// JSONValueRef ////////////////////////////////////////////////////////////////
+
+JSONValueRef::JSONValueRef() : node_(NULL) {
+}
+
+JSONValueRef::JSONValueRef(const JSONNode* node) : node_(node) {
+}
+
+Value::Type JSONValueRef::GetType() const {
+  return node_ ? node_->type : Value::TYPE_NULL;
+}
+
+bool JSONValueRef::GetAsBoolean(bool* out_value) const {
+  if (!IsType(Value::TYPE_BOOLEAN))
+    return false;
+  if (out_value)
+    *out_value = node_->boolean_value;
+  return true;
+}
+
+bool JSONValueRef::GetAsInteger(int* out_value) const {
+  if (!IsType(Value::TYPE_INTEGER))
+    return false;
+  if (out_value)
+    *out_value = node_->integer_value;
+  return true;
+}
+
+bool JSONValueRef::GetAsDouble(double* out_value) const {
+  if (IsType(Value::TYPE_DOUBLE)) {
+    if (out_value)
+      *out_value = node_->double_value;
+    return true;
+  }
+  if (IsType(Value::TYPE_INTEGER)) {
+    if (out_value)
+      *out_value = node_->integer_value;
+    return true;
+  }
+  return false;
+}
+
+bool JSONValueRef::GetAsString(std::string* out_value) const {
+  if (!IsType(Value::TYPE_STRING))
+    return false;
+  if (out_value)
+    out_value->assign(node_->string_value, node_->size);
+  return true;
+}
+
+bool JSONValueRef::GetAsString(StringPiece* out_value) const {
+  if (!IsType(Value::TYPE_STRING))
+    return false;
+  if (out_value)
+    out_value->set(node_->string_value, node_->size);
+  return true;
+}
+
+bool JSONValueRef::GetAsDictionary(JSONDictionaryRef* out_value) const {
+  if (!IsType(Value::TYPE_DICTIONARY))
+    return false;
+  if (out_value)
+    *out_value = JSONDictionaryRef(node_->members, node_->size);
+  return true;
+}
+
+bool JSONValueRef::GetAsList(JSONListRef* out_value) const {
+  if (!IsType(Value::TYPE_LIST))
+    return false;
+  if (out_value)
+    *out_value = JSONListRef(node_->items, node_->size);
+  return true;
+}
+
+scoped_ptr<Value> JSONValueRef::ToValue() const {
+  if (!node_)
+    return scoped_ptr<Value>();
+  return scoped_ptr<Value>(CreateValue(*node_));
+}
+
+// JSONDictionaryRef ///////////////////////////////////////////////////////////
+
+JSONDictionaryRef::JSONDictionaryRef() : members_(NULL), size_(0) {
+}
+
+JSONDictionaryRef::JSONDictionaryRef(const JSONMember* members, size_t size)
+    : members_(members),
+      size_(size) {
+}
+
+bool JSONDictionaryRef::HasKey(const StringPiece& key) const {
+  return GetWithoutPathExpansion(key, NULL);
+}
+
+bool JSONDictionaryRef::Get(const StringPiece& path,
+                            JSONValueRef* out_value) const {
+  JSONDictionaryRef current_dictionary = *this;
+  StringPiece current_path = path;
+  for (size_t delimiter_position = current_path.find('.');
+       delimiter_position != StringPiece::npos;
+       delimiter_position = current_path.find('.')) {
+    JSONValueRef child;
+    if (!current_dictionary.GetWithoutPathExpansion(
+            current_path.substr(0, delimiter_position), &child) ||
+        !child.GetAsDictionary(&current_dictionary)) {
+      return false;
+    }
+    current_path = current_path.substr(delimiter_position + 1);
+  }
+  return current_dictionary.GetWithoutPathExpansion(current_path, out_value);
+}
+
+bool JSONDictionaryRef::GetBoolean(const StringPiece& path,
+                                   bool* out_value) const {
+  JSONValueRef value;
+  return Get(path, &value) && value.GetAsBoolean(out_value);
+}
+
+bool JSONDictionaryRef::GetInteger(const StringPiece& path,
+                                   int* out_value) const {
+  JSONValueRef value;
+  return Get(path, &value) && value.GetAsInteger(out_value);
+}
+
+bool JSONDictionaryRef::GetDouble(const StringPiece& path,
+                                  double* out_value) const {
+  JSONValueRef value;
+  return Get(path, &value) && value.GetAsDouble(out_value);
+}
+
+bool JSONDictionaryRef::GetString(const StringPiece& path,
+                                  std::string* out_value) const {
+  JSONValueRef value;
+  return Get(path, &value) && value.GetAsString(out_value);
+}
+
+bool JSONDictionaryRef::GetString(const StringPiece& path,
+                                  StringPiece* out_value) const {
+  JSONValueRef value;
+  return Get(path, &value) && value.GetAsString(out_value);
+}
+
+bool JSONDictionaryRef::GetDictionary(const StringPiece& path,
+                                      JSONDictionaryRef* out_value) const {
+  JSONValueRef value;
+  return Get(path, &value) && value.GetAsDictionary(out_value);
+}
+
+bool JSONDictionaryRef::GetList(const StringPiece& path,
+                                JSONListRef* out_value) const {
+  JSONValueRef value;
+  return Get(path, &value) && value.GetAsList(out_value);
+}
+
+bool JSONDictionaryRef::GetWithoutPathExpansion(
+    const StringPiece& key,
+    JSONValueRef* out_value) const {
+  const JSONMember* end = members_ + size_;
+  const JSONMember* member =
+      std::lower_bound(members_, end, key, &MemberKeyLessThanKey);
+  if (member == end || KeyOf(*member) != key)
+    return false;
+  if (out_value)
+    *out_value = JSONValueRef(&member->value);
+  return true;
+}
+
+scoped_ptr<DictionaryValue> JSONDictionaryRef::ToValue() const {
+  scoped_ptr<DictionaryValue> dictionary(new DictionaryValue);
+  for (size_t i = 0; i < size_; ++i) {
+    dictionary->SetWithoutPathExpansion(KeyOf(members_[i]).as_string(),
+                                        CreateValue(members_[i].value));
+  }
+  return dictionary.Pass();
+}
+
+JSONDictionaryRef::Iterator::Iterator(const JSONDictionaryRef& target)
+    : members_(target.members_),
+      size_(target.size_),
+      index_(0) {
+}
+
+StringPiece JSONDictionaryRef::Iterator::key() const {
+  DCHECK(!IsAtEnd());
+  return KeyOf(members_[index_]);
+}
+
+JSONValueRef JSONDictionaryRef::Iterator::value() const {
+  DCHECK(!IsAtEnd());
+  return JSONValueRef(&members_[index_].value);
+}
+
+// JSONListRef /////////////////////////////////////////////////////////////////
+
+JSONListRef::JSONListRef() : items_(NULL), size_(0) {
+}
+
+JSONListRef::JSONListRef(const JSONNode* items, size_t size)
+    : items_(items),
+      size_(size) {
+}
+
+bool JSONListRef::Get(size_t index, JSONValueRef* out_value) const {
+  if (index >= size_)
+    return false;
+  if (out_value)
+    *out_value = JSONValueRef(&items_[index]);
+  return true;
+}
+
+bool JSONListRef::GetBoolean(size_t index, bool* out_value) const {
+  JSONValueRef value;
+  return Get(index, &value) && value.GetAsBoolean(out_value);
+}
+
+bool JSONListRef::GetInteger(size_t index, int* out_value) const {
+  JSONValueRef value;
+  return Get(index, &value) && value.GetAsInteger(out_value);
+}
+
+bool JSONListRef::GetDouble(size_t index, double* out_value) const {
+  JSONValueRef value;
+  return Get(index, &value) && value.GetAsDouble(out_value);
+}
+
+bool JSONListRef::GetString(size_t index, std::string* out_value) const {
+  JSONValueRef value;
+  return Get(index, &value) && value.GetAsString(out_value);
+}
+
+bool JSONListRef::GetString(size_t index, StringPiece* out_value) const {
+  JSONValueRef value;
+  return Get(index, &value) && value.GetAsString(out_value);
+}
+
+bool JSONListRef::GetDictionary(size_t index,
+                                JSONDictionaryRef* out_value) const {
+  JSONValueRef value;
+  return Get(index, &value) && value.GetAsDictionary(out_value);
+}
+
+bool JSONListRef::GetList(size_t index, JSONListRef* out_value) const {
+  JSONValueRef value;
+  return Get(index, &value) && value.GetAsList(out_value);
+}
+
+scoped_ptr<ListValue> JSONListRef::ToValue() const {
+  scoped_ptr<ListValue> list(new ListValue);
+  for (size_t i = 0; i < size_; ++i)
+    list->Append(CreateValue(items_[i]));
+  return list.Pass();
+}
+
+// JSONDocument ////////////////////////////////////////////////////////////////
+
+JSONDocument::JSONDocument()
+    : next_(NULL),
+      remaining_(0),
+      next_block_size_(kMinBlockSize),
+      root_(NULL) {
+}
+
+JSONDocument::~JSONDocument() {
+  for (size_t i = 0; i < blocks_.size(); ++i)
+    delete[] blocks_[i];
+}
+
+// static
+scoped_ptr<JSONDocument> JSONDocument::Parse(const StringPiece& json,
+                                             int options,
+                                             int* error_code_out,
+                                             std::string* error_msg_out) {
+  scoped_ptr<JSONDocument> document(new JSONDocument);
+  internal::JSONDocumentBuilder builder(document.get());
+  JSONSaxReader reader(&builder, options);
+  if (reader.ParseComplete(json))
+    return document.Pass();
+
+  if (error_code_out)
+    *error_code_out = reader.error_code();
+  if (error_msg_out)
+    *error_msg_out = reader.GetErrorMessage();
+  return scoped_ptr<JSONDocument>();
+}
+
+void* JSONDocument::Allocate(size_t size) {
+  size = (size + kAlignment - 1) & ~(kAlignment - 1);
+  if (size > remaining_) {
+    if (size > next_block_size_ / 4) {
+      // Large arrays get a block of their own, which keeps the current block
+      // for the next allocations.
+      char* block = new char[size];
+      blocks_.push_back(block);
+      return block;
+    }
+    next_ = new char[next_block_size_];
+    blocks_.push_back(next_);
+    remaining_ = next_block_size_;
+    next_block_size_ = std::min(2 * next_block_size_, kMaxBlockSize);
+  }
+  void* result = next_;
+  next_ += size;
+  remaining_ -= size;
+  return result;
+}
+
+}  // namespace base
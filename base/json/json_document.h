@@ -0,0 +1,221 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+//
+// A read-only representation of a parsed JSON document, made by
+// JSONReader::ReadDocument(). Where JSONReader::Read() allocates every Value,
+// string and map node of the tree separately, a JSONDocument keeps all of its
+// values in a few large blocks: the items of a list and the members of a
+// dictionary are contiguous, dictionary keys are sorted and looked up by
+// binary search, and strings and keys are copied to the same blocks.
+// Destroying a document only frees those blocks.
+//
+// The values are accessed through JSONValueRef, JSONDictionaryRef and
+// JSONListRef, which are small copyable references with the accessors of
+// Value, DictionaryValue and ListValue. They, and the StringPieces they
+// return, are only valid as long as the document. ToValue() converts any part
+// of the document to a mutable Value tree when one is needed.
+//
+// Example:
+//   scoped_ptr<base::JSONDocument> document(
+//       base::JSONReader::ReadDocument(json, base::JSON_PARSE_RFC, NULL,
+//                                      NULL));
+//   base::JSONDictionaryRef root;
+//   std::string name;
+//   if (document && document->root().GetAsDictionary(&root) &&
+//       root.GetString("profile.name", &name)) {
+//     ...
+//   }
+
+#ifndef BASE_JSON_JSON_DOCUMENT_H_
+#define BASE_JSON_JSON_DOCUMENT_H_
+
+#include <string>
+#include <vector>
+
+#include "base/base_export.h"
+#include "base/basictypes.h"
+#include "base/memory/scoped_ptr.h"
+#include "base/strings/string_piece.h"
+#include "base/values.h"
+
+namespace base {
+
+class JSONDictionaryRef;
+class JSONListRef;
+class JSONReader;
+
+namespace internal {
+class JSONDocumentBuilder;
+struct JSONMember;
+struct JSONNode;
+}
+
+// A reference to a value of a JSONDocument. A default-constructed reference
+// refers to no value, and is only useful as an output parameter.
+class BASE_EXPORT JSONValueRef {
+ public:
+  JSONValueRef();
+
+  // Returns TYPE_NULL for a reference to no value. JSON values are never
+  // TYPE_BINARY.
+  Value::Type GetType() const;
+  bool IsType(Value::Type type) const { return GetType() == type; }
+
+  // As with Value, these return true and set |out_value| if the value has
+  // the given type, and return false otherwise. Integers can be read as
+  // doubles.
+  bool GetAsBoolean(bool* out_value) const;
+  bool GetAsInteger(int* out_value) const;
+  bool GetAsDouble(double* out_value) const;
+  bool GetAsString(std::string* out_value) const;
+  bool GetAsString(StringPiece* out_value) const;
+  bool GetAsDictionary(JSONDictionaryRef* out_value) const;
+  bool GetAsList(JSONListRef* out_value) const;
+
+  // Copies the value, and all of its children, to a new Value.
+  scoped_ptr<Value> ToValue() const;
+
+ private:
+  friend class JSONDictionaryRef;
+  friend class JSONDocument;
+  friend class JSONListRef;
+
+  explicit JSONValueRef(const internal::JSONNode* node);
+
+  const internal::JSONNode* node_;
+};
+
+// A reference to a dictionary of a JSONDocument. Iteration is in the order of
+// the keys, as for DictionaryValue. When a key is repeated in the input, the
+// last value is kept, as JSONReader::Read() does.
+class BASE_EXPORT JSONDictionaryRef {
+ public:
+  JSONDictionaryRef();
+
+  bool HasKey(const StringPiece& key) const;
+  size_t size() const { return size_; }
+  bool empty() const { return size_ == 0; }
+
+  // Gets the value at |path|, which has the form "<key>" or
+  // "<key>.<key>.[...]" where "." indexes into the next dictionary down, as
+  // for DictionaryValue::Get(). Returns false if the path can't be resolved.
+  // |out_value| is optional and only set if non-NULL.
+  bool Get(const StringPiece& path, JSONValueRef* out_value) const;
+
+  // Convenience forms of Get(), which also return false if the value doesn't
+  // have the requested type.
+  bool GetBoolean(const StringPiece& path, bool* out_value) const;
+  bool GetInteger(const StringPiece& path, int* out_value) const;
+  bool GetDouble(const StringPiece& path, double* out_value) const;
+  bool GetString(const StringPiece& path, std::string* out_value) const;
+  bool GetString(const StringPiece& path, StringPiece* out_value) const;
+  bool GetDictionary(const StringPiece& path,
+                     JSONDictionaryRef* out_value) const;
+  bool GetList(const StringPiece& path, JSONListRef* out_value) const;
+
+  // Like Get(), but without special treatment of '.'.
+  bool GetWithoutPathExpansion(const StringPiece& key,
+                               JSONValueRef* out_value) const;
+
+  // Copies the dictionary, and all of its children, to a new DictionaryValue.
+  scoped_ptr<DictionaryValue> ToValue() const;
+
+  class BASE_EXPORT Iterator {
+   public:
+    explicit Iterator(const JSONDictionaryRef& target);
+
+    bool IsAtEnd() const { return index_ == size_; }
+    void Advance() { ++index_; }
+
+    StringPiece key() const;
+    JSONValueRef value() const;
+
+   private:
+    const internal::JSONMember* members_;
+    size_t size_;
+    size_t index_;
+  };
+
+ private:
+  friend class JSONValueRef;
+
+  JSONDictionaryRef(const internal::JSONMember* members, size_t size);
+
+  const internal::JSONMember* members_;
+  size_t size_;
+};
+
+// A reference to a list of a JSONDocument.
+class BASE_EXPORT JSONListRef {
+ public:
+  JSONListRef();
+
+  size_t GetSize() const { return size_; }
+  bool empty() const { return size_ == 0; }
+
+  // Gets the value at |index|, as for ListValue::Get(). Returns false if
+  // |index| is out of range. |out_value| is optional and only set if
+  // non-NULL.
+  bool Get(size_t index, JSONValueRef* out_value) const;
+
+  // Convenience forms of Get(), which also return false if the value doesn't
+  // have the requested type.
+  bool GetBoolean(size_t index, bool* out_value) const;
+  bool GetInteger(size_t index, int* out_value) const;
+  bool GetDouble(size_t index, double* out_value) const;
+  bool GetString(size_t index, std::string* out_value) const;
+  bool GetString(size_t index, StringPiece* out_value) const;
+  bool GetDictionary(size_t index, JSONDictionaryRef* out_value) const;
+  bool GetList(size_t index, JSONListRef* out_value) const;
+
+  // Copies the list, and all of its children, to a new ListValue.
+  scoped_ptr<ListValue> ToValue() const;
+
+ private:
+  friend class JSONValueRef;
+
+  JSONListRef(const internal::JSONNode* items, size_t size);
+
+  const internal::JSONNode* items_;
+  size_t size_;
+};
+
+// Owns the values of a parsed document.
+class BASE_EXPORT JSONDocument {
+ public:
+  ~JSONDocument();
+
+  JSONValueRef root() const { return JSONValueRef(root_); }
+
+ private:
+  friend class JSONReader;
+  friend class internal::JSONDocumentBuilder;
+
+  JSONDocument();
+
+  // Parses |json| with |options|, as for JSONReader::ReadDocument().
+  static scoped_ptr<JSONDocument> Parse(const StringPiece& json,
+                                        int options,
+                                        int* error_code_out,
+                                        std::string* error_msg_out);
+
+  // Returns |size| bytes, aligned for any value, which live as long as the
+  // document.
+  void* Allocate(size_t size);
+
+  // The blocks of memory with the values, the unused part of the current one
+  // and the size of the next one.
+  std::vector<char*> blocks_;
+  char* next_;
+  size_t remaining_;
+  size_t next_block_size_;
+
+  const internal::JSONNode* root_;
+
+  DISALLOW_COPY_AND_ASSIGN(JSONDocument);
+};
+
+}  // namespace base
+
+#endif  // BASE_JSON_JSON_DOCUMENT_H_
@@ -0,0 +1,94 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <string>
+
+#include "base/json/json_document.h"
+#include "base/json/json_reader.h"
+#include "base/memory/scoped_ptr.h"
+#include "base/strings/stringprintf.h"
+#include "base/time/time.h"
+#include "base/values.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "testing/perf/perf_test.h"
+
+namespace base {
+
+namespace {
+
+const int kNumRecords = 100000;
+
+std::string BuildDocument() {
+  std::string json = "[";
+  for (int i = 0; i < kNumRecords; ++i) {
+    if (i)
+      json += ",";
+    StringAppendF(&json,
+                  "{\"id\": %d, \"name\": \"record %d\", \"score\": %d.25, "
+                  "\"active\": %s, \"tags\": [\"alpha\", \"beta\"], "
+                  "\"position\": {\"x\": %d, \"y\": -%d}}",
+                  i, i, i % 100, i % 2 ? "true" : "false", i, i);
+  }
+  json += "]";
+  return json;
+}
+
+void PrintTime(const std::string& trace, TimeDelta elapsed) {
+  perf_test::PrintResult("json_document", "", trace,
+                         elapsed.InMillisecondsF(), "ms", true);
+}
+
+}  // namespace
+
+// Parses a document, reads a field of every record, then destroys it.
+TEST(JSONDocumentPerfTest, DocumentVersusValue) {
+  const std::string json = BuildDocument();
+  const int64 expected_sum =
+      static_cast<int64>(kNumRecords) * (kNumRecords - 1) / 2;
+
+  TimeTicks start = TimeTicks::HighResNow();
+  scoped_ptr<Value> root(JSONReader::Read(json));
+  TimeTicks parsed = TimeTicks::HighResNow();
+  ListValue* list = NULL;
+  ASSERT_TRUE(root && root->GetAsList(&list));
+  int64 sum = 0;
+  for (size_t i = 0; i < list->GetSize(); ++i) {
+    DictionaryValue* record = NULL;
+    int id = 0;
+    ASSERT_TRUE(list->GetDictionary(i, &record));
+    ASSERT_TRUE(record->GetInteger("id", &id));
+    sum += id;
+  }
+  TimeTicks read = TimeTicks::HighResNow();
+  root.reset();
+  TimeTicks destroyed = TimeTicks::HighResNow();
+  EXPECT_EQ(expected_sum, sum);
+  PrintTime("value_parse", parsed - start);
+  PrintTime("value_lookup", read - parsed);
+  PrintTime("value_destroy", destroyed - read);
+
+  start = TimeTicks::HighResNow();
+  scoped_ptr<JSONDocument> document(
+      JSONReader::ReadDocument(json, JSON_PARSE_RFC, NULL, NULL));
+  parsed = TimeTicks::HighResNow();
+  JSONListRef records;
+  ASSERT_TRUE(document && document->root().GetAsList(&records));
+  sum = 0;
+  for (size_t i = 0; i < records.GetSize(); ++i) {
+    JSONDictionaryRef record;
+    int id = 0;
+    ASSERT_TRUE(records.GetDictionary(i, &record));
+    ASSERT_TRUE(record.GetInteger("id", &id));
+    sum += id;
+  }
+  read = TimeTicks::HighResNow();
+  document.reset();
+  destroyed = TimeTicks::HighResNow();
+  EXPECT_EQ(expected_sum, sum);
+  PrintTime("document_parse", parsed - start);
+  PrintTime("document_lookup", read - parsed);
+  PrintTime("document_destroy", destroyed - read);
+}
+
+}  // namespace base
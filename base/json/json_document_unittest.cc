@@ -0,0 +1,221 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/json/json_document.h"
+
+#include <string>
+
+#include "base/json/json_reader.h"
+#include "base/memory/scoped_ptr.h"
+#include "base/strings/string_number_conversions.h"
+#include "base/values.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace base {
+
+TEST(JSONDocumentTest, Accessors) {
+  scoped_ptr<JSONDocument> document(JSONReader::ReadDocument(
+      "{\"name\": \"x\\ty\", \"count\": 3, \"ratio\": 0.5, \"on\": true,"
+      " \"none\": null, \"a.b\": 1, \"a\": {\"b\": 2, \"c\": [1, \"two\"]}}",
+      JSON_PARSE_RFC, NULL, NULL));
+  ASSERT_TRUE(document);
+
+  JSONDictionaryRef root;
+  ASSERT_TRUE(document->root().GetAsDictionary(&root));
+  EXPECT_EQ(7u, root.size());
+  EXPECT_FALSE(root.empty());
+
+  std::string name;
+  EXPECT_TRUE(root.GetString("name", &name));
+  EXPECT_EQ("x\ty", name);
+  int count = 0;
+  EXPECT_TRUE(root.GetInteger("count", &count));
+  EXPECT_EQ(3, count);
+  double ratio = 0;
+  EXPECT_TRUE(root.GetDouble("ratio", &ratio));
+  EXPECT_EQ(0.5, ratio);
+  EXPECT_TRUE(root.GetDouble("count", &ratio));
+  EXPECT_EQ(3, ratio);
+  bool on = false;
+  EXPECT_TRUE(root.GetBoolean("on", &on));
+  EXPECT_TRUE(on);
+  JSONValueRef none;
+  EXPECT_TRUE(root.Get("none", &none));
+  EXPECT_TRUE(none.IsType(Value::TYPE_NULL));
+
+  // Type mismatches and missing keys.
+  EXPECT_FALSE(root.GetInteger("name", &count));
+  EXPECT_FALSE(root.GetString("count", &name));
+  EXPECT_FALSE(root.GetDictionary("count", NULL));
+  EXPECT_FALSE(root.Get("missing", NULL));
+  EXPECT_FALSE(root.HasKey("missing"));
+  EXPECT_TRUE(root.HasKey("a.b"));
+
+  // Paths go down dictionaries, unless expansion is disabled.
+  EXPECT_TRUE(root.GetInteger("a.b", &count));
+  EXPECT_EQ(2, count);
+  JSONValueRef dotted;
+  EXPECT_TRUE(root.GetWithoutPathExpansion("a.b", &dotted));
+  EXPECT_TRUE(dotted.GetAsInteger(&count));
+  EXPECT_EQ(1, count);
+  EXPECT_FALSE(root.Get("a.c.0", NULL));
+
+  JSONListRef list;
+  ASSERT_TRUE(root.GetList("a.c", &list));
+  EXPECT_EQ(2u, list.GetSize());
+  EXPECT_TRUE(list.GetInteger(0, &count));
+  EXPECT_EQ(1, count);
+  StringPiece two;
+  EXPECT_TRUE(list.GetString(1, &two));
+  EXPECT_EQ("two", two);
+  EXPECT_FALSE(list.Get(2, NULL));
+  EXPECT_FALSE(list.GetDictionary(0, NULL));
+}
+
+TEST(JSONDocumentTest, DictionaryKeys) {
+  scoped_ptr<JSONDocument> document(JSONReader::ReadDocument(
+      "{\"c\": 1, \"a\": 2, \"b\\u0041\": 3, \"c\": 4, \"\": 5}",
+      JSON_PARSE_RFC, NULL, NULL));
+  ASSERT_TRUE(document);
+  JSONDictionaryRef root;
+  ASSERT_TRUE(document->root().GetAsDictionary(&root));
+
+  // Keys are iterated in order, and the last value of a repeated key wins,
+  // as with DictionaryValue.
+  std::string keys;
+  for (JSONDictionaryRef::Iterator it(root); !it.IsAtEnd(); it.Advance()) {
+    int value = 0;
+    EXPECT_TRUE(it.value().GetAsInteger(&value));
+    keys += "(" + it.key().as_string() + ":" + IntToString(value) + ")";
+  }
+  EXPECT_EQ("(:5)(a:2)(bA:3)(c:4)", keys);
+  EXPECT_EQ(4u, root.size());
+}
+
+TEST(JSONDocumentTest, LargeDocument) {
+  // Enough values for the document to need several blocks, including one of
+  // its own for the list.
+  std::string json = "{";
+  for (int i = 0; i < 5000; ++i) {
+    if (i)
+      json += ",";
+    json += "\"key" + IntToString(i) + "\": [" + IntToString(i) + ", \"v\"]";
+  }
+  json += ", \"list\": [";
+  for (int i = 0; i < 5000; ++i)
+    json += IntToString(i) + ",";
+  json += "0]}";
+
+  scoped_ptr<JSONDocument> document(
+      JSONReader::ReadDocument(json, JSON_PARSE_RFC, NULL, NULL));
+  ASSERT_TRUE(document);
+  JSONDictionaryRef root;
+  ASSERT_TRUE(document->root().GetAsDictionary(&root));
+  EXPECT_EQ(5001u, root.size());
+  for (int i = 0; i < 5000; ++i) {
+    JSONListRef item;
+    int value = -1;
+    ASSERT_TRUE(root.GetList("key" + IntToString(i), &item));
+    EXPECT_TRUE(item.GetInteger(0, &value));
+    EXPECT_EQ(i, value);
+  }
+  JSONListRef list;
+  ASSERT_TRUE(root.GetList("list", &list));
+  EXPECT_EQ(5001u, list.GetSize());
+  int last = -1;
+  EXPECT_TRUE(list.GetInteger(4999, &last));
+  EXPECT_EQ(4999, last);
+}
+
+TEST(JSONDocumentTest, MatchesJSONReader) {
+  const char* const kInputs[] = {
+    "null",
+    "\"str\\u00e9\"",
+    "-1.5e3",
+    "2147483648",
+    "\xEF\xBB\xBF[true, false]",
+    "{\"a\": {\"b\": [[], {}, 1, [2, [3]]]}, \"x\\ny\": \"\\\"\"}",
+    "// Comment.\n{\"a\": /* comment */ 1}  \n",
+  };
+  for (size_t i = 0; i < arraysize(kInputs); ++i) {
+    scoped_ptr<Value> expected(JSONReader::Read(kInputs[i]));
+    ASSERT_TRUE(expected) << kInputs[i];
+    scoped_ptr<JSONDocument> document(
+        JSONReader::ReadDocument(kInputs[i], JSON_PARSE_RFC, NULL, NULL));
+    ASSERT_TRUE(document) << kInputs[i];
+    scoped_ptr<Value> value = document->root().ToValue();
+    EXPECT_TRUE(Value::Equals(expected.get(), value.get())) << kInputs[i];
+  }
+
+  const char* const kInvalidInputs[] = {
+    "",
+    "[1 2]",
+    "[1,2,]",
+    "{\"a\":1,}",
+    "{\"a\" 1}",
+    "{a:1}",
+    "[1] x",
+    "[tru]",
+    "[\"\\q\"]",
+    "[1,\n 2,\r\n  x]",
+    "{\"a\":\n\"unterminated",
+    "[\"\xFF\"]",
+  };
+  for (size_t i = 0; i < arraysize(kInvalidInputs); ++i) {
+    int expected_code = JSONReader::JSON_NO_ERROR;
+    std::string expected_message;
+    EXPECT_FALSE(JSONReader::ReadAndReturnError(
+        kInvalidInputs[i], JSON_PARSE_RFC, &expected_code, &expected_message));
+
+    int error_code = JSONReader::JSON_NO_ERROR;
+    std::string error_message;
+    EXPECT_FALSE(JSONReader::ReadDocument(kInvalidInputs[i], JSON_PARSE_RFC,
+                                          &error_code, &error_message));
+    EXPECT_EQ(expected_code, error_code) << kInvalidInputs[i];
+    EXPECT_EQ(expected_message, error_message) << kInvalidInputs[i];
+  }
+
+  EXPECT_TRUE(JSONReader::ReadDocument("[1, {\"a\": 2,},]",
+                                       JSON_ALLOW_TRAILING_COMMAS, NULL,
+                                       NULL));
+}
+
+TEST(JSONDocumentTest, Nesting) {
+  std::string too_deep(100, '[');
+  too_deep.append(100, ']');
+  int error_code = JSONReader::JSON_NO_ERROR;
+  EXPECT_FALSE(JSONReader::ReadDocument(too_deep, JSON_PARSE_RFC, &error_code,
+                                        NULL));
+  EXPECT_EQ(JSONReader::JSON_TOO_MUCH_NESTING, error_code);
+
+  std::string deep(99, '[');
+  deep.append(99, ']');
+  EXPECT_TRUE(JSONReader::ReadDocument(deep, JSON_PARSE_RFC, NULL, NULL));
+}
+
+TEST(JSONDocumentTest, ToValue) {
+  scoped_ptr<JSONDocument> document(JSONReader::ReadDocument(
+      "{\"list\": [1, \"a\"], \"dict\": {\"k\": null}}", JSON_PARSE_RFC, NULL,
+      NULL));
+  ASSERT_TRUE(document);
+  JSONDictionaryRef root;
+  ASSERT_TRUE(document->root().GetAsDictionary(&root));
+
+  JSONListRef list;
+  ASSERT_TRUE(root.GetList("list", &list));
+  scoped_ptr<ListValue> list_value = list.ToValue();
+  std::string a;
+  EXPECT_TRUE(list_value->GetString(1, &a));
+  EXPECT_EQ("a", a);
+
+  // The copy is independent of the document.
+  scoped_ptr<DictionaryValue> root_value = root.ToValue();
+  document.reset();
+  EXPECT_TRUE(root_value->Get("dict.k", NULL));
+  EXPECT_EQ(2u, root_value->size());
+
+  EXPECT_FALSE(JSONValueRef().ToValue());
+}
+
+}  // namespace base
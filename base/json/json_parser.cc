@@ -15,6 +15,14 @@
 #include "base/strings/utf_string_conversions.h"
 #include "base/third_party/icu/icu_utf.h"
 #include "base/values.h"
+#include "build/build_config.h"
+
+#if defined(ARCH_CPU_X86_FAMILY)
+#include <emmintrin.h>
+#if defined(COMPILER_MSVC)
+#include <intrin.h>
+#endif
+#endif
 
 namespace base {
 namespace internal {
@@ -25,6 +33,66 @@ const int kStackMaxDepth = 100;
 
 const int32 kExtendedASCIIStart = 0x80;
 
+#if defined(ARCH_CPU_X86_FAMILY)
+// Returns the index of the lowest set bit of the non-zero |mask|.
+inline int LowestSetBit(int mask) {
+#if defined(COMPILER_MSVC)
+  unsigned long index;
+  _BitScanForward(&index, mask);
+  return static_cast<int>(index);
+#else
+  return __builtin_ctz(mask);
+#endif
+}
+#endif
+
+// Returns the number of bytes from |pos| which ConsumeStringRaw() can copy
+// verbatim: ASCII characters other than '"' and '\\'. These make up most of
+// the strings in practice, and SSE2 checks them sixteen at a time.
+int CountPlainStringChars(const char* pos, const char* end) {
+  const char* start = pos;
+#if defined(ARCH_CPU_X86_FAMILY)
+  const __m128i quote = _mm_set1_epi8('"');
+  const __m128i backslash = _mm_set1_epi8('\\');
+  for (; end - pos >= 16; pos += 16) {
+    __m128i chars = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pos));
+    // The high bit of each byte is set for non-ASCII characters, and for the
+    // characters which match either of the comparisons.
+    __m128i special = _mm_or_si128(
+        chars, _mm_or_si128(_mm_cmpeq_epi8(chars, quote),
+                            _mm_cmpeq_epi8(chars, backslash)));
+    int mask = _mm_movemask_epi8(special);
+    if (mask)
+      return static_cast<int>(pos - start) + LowestSetBit(mask);
+  }
+#endif
+  while (pos < end && static_cast<uint8>(*pos) < kExtendedASCIIStart &&
+         *pos != '"' && *pos != '\\') {
+    ++pos;
+  }
+  return static_cast<int>(pos - start);
+}
+
+// Returns the number of spaces and tabs from |pos|, which come in long runs in
+// indented documents.
+int CountBlanks(const char* pos, const char* end) {
+  const char* start = pos;
+#if defined(ARCH_CPU_X86_FAMILY)
+  const __m128i space = _mm_set1_epi8(' ');
+  const __m128i tab = _mm_set1_epi8('\t');
+  for (; end - pos >= 16; pos += 16) {
+    __m128i chars = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pos));
+    int mask = ~_mm_movemask_epi8(_mm_or_si128(
+        _mm_cmpeq_epi8(chars, space), _mm_cmpeq_epi8(chars, tab))) & 0xFFFF;
+    if (mask)
+      return static_cast<int>(pos - start) + LowestSetBit(mask);
+  }
+#endif
+  while (pos < end && (*pos == ' ' || *pos == '\t'))
+    ++pos;
+  return static_cast<int>(pos - start);
+}
+
 // This and the class below are used to own the JSON input string for when
 // string tokens are stored as StringPiece instead of std::string. This
 // optimization avoids about 2/3rds of string memory copies. The constructor
@@ -307,6 +375,15 @@ void JSONParser::StringBuilder::Append(const char& c) {
     ++length_;
 }
 
+void JSONParser::StringBuilder::AppendASCII(const char* str, int length) {
+  if (string_) {
+    string_->append(str, length);
+  } else {
+    DCHECK_EQ(pos_ + length_, str);
+    length_ += length;
+  }
+}
+
 void JSONParser::StringBuilder::AppendString(const std::string& str) {
   DCHECK(string_);
   string_->append(str);
@@ -405,10 +482,11 @@ void JSONParser::EatWhitespaceAndComments() {
         // Don't increment line_number_ twice for "\r\n".
         if (!(*pos_ == '\n' && pos_ > start_pos_ && *(pos_ - 1) == '\r'))
           ++line_number_;
-        // Fall through.
+        NextChar();
+        break;
       case ' ':
       case '\t':
-        NextChar();
+        NextNChars(CountBlanks(pos_, end_pos_));
         break;
       case '/':
         if (!EatComment())
@@ -616,6 +694,17 @@ bool JSONParser::ConsumeStringRaw(StringBuilder* out) {
 
   while (CanConsume(1)) {
     pos_ = start_pos_ + index_;  // CBU8_NEXT is postcrement.
+
+    // Take a run of plain characters at once, leaving the parser as if they
+    // had been consumed one by one below.
+    int run_length = CountPlainStringChars(pos_, end_pos_);
+    if (run_length) {
+      string.AppendASCII(pos_, run_length);
+      index_ += run_length;
+      pos_ += run_length - 1;
+      continue;
+    }
+
     CBU8_NEXT(start_pos_, index_, length, next_char);
     if (next_char < 0 || !IsValidCharacter(next_char)) {
       ReportError(JSONReader::JSON_UNSUPPORTED_ENCODING, 1);
@@ -804,6 +893,46 @@ void JSONParser::DecodeUTF8(const int32& point, StringBuilder* dest) {
 }
 
 Value* JSONParser::ConsumeNumber() {
+  StringPiece num_string;
+  if (!ConsumeNumberRaw(&num_string))
+    return NULL;
+
+  // ReadInt is greedy because numbers have no easily detectable sentinel,
+  // so save off where the parser should be on exit (see Consume invariant at
+  // the top of the header), then make sure the next token is one which is
+  // valid.
+  const char* exit_pos = pos_;
+  int exit_index = index_;
+
+  NextChar();
+  switch (GetNextToken()) {
+    case T_OBJECT_END:
+    case T_ARRAY_END:
+    case T_LIST_SEPARATOR:
+    case T_END_OF_INPUT:
+      break;
+    default:
+      ReportError(JSONReader::JSON_SYNTAX_ERROR, 1);
+      return NULL;
+  }
+
+  pos_ = exit_pos;
+  index_ = exit_index;
+
+  int num_int;
+  if (StringToInt(num_string, &num_int))
+    return new FundamentalValue(num_int);
+
+  double num_double;
+  if (base::StringToDouble(num_string.as_string(), &num_double) &&
+      IsFinite(num_double)) {
+    return new FundamentalValue(num_double);
+  }
+
+  return NULL;
+}
+
+bool JSONParser::ConsumeNumberRaw(StringPiece* out) {
   const char* num_start = pos_;
   const int start_index = index_;
   int end_index = start_index;
@@ -813,7 +942,7 @@ Value* JSONParser::ConsumeNumber() {
 
   if (!ReadInt(false)) {
     ReportError(JSONReader::JSON_SYNTAX_ERROR, 1);
-    return NULL;
+    return false;
   }
   end_index = index_;
 
@@ -821,12 +950,12 @@ Value* JSONParser::ConsumeNumber() {
   if (*pos_ == '.') {
     if (!CanConsume(1)) {
       ReportError(JSONReader::JSON_SYNTAX_ERROR, 1);
-      return NULL;
+      return false;
     }
     NextChar();
     if (!ReadInt(true)) {
       ReportError(JSONReader::JSON_SYNTAX_ERROR, 1);
-      return NULL;
+      return false;
     }
     end_index = index_;
   }
@@ -838,45 +967,17 @@ Value* JSONParser::ConsumeNumber() {
       NextChar();
     if (!ReadInt(true)) {
       ReportError(JSONReader::JSON_SYNTAX_ERROR, 1);
-      return NULL;
+      return false;
     }
     end_index = index_;
   }
 
-  // ReadInt is greedy because numbers have no easily detectable sentinel,
-  // so save off where the parser should be on exit (see Consume invariant at
-  // the top of the header), then make sure the next token is one which is
-  // valid.
-  const char* exit_pos = pos_ - 1;
-  int exit_index = index_ - 1;
-
-  switch (GetNextToken()) {
-    case T_OBJECT_END:
-    case T_ARRAY_END:
-    case T_LIST_SEPARATOR:
-    case T_END_OF_INPUT:
-      break;
-    default:
-      ReportError(JSONReader::JSON_SYNTAX_ERROR, 1);
-      return NULL;
-  }
-
-  pos_ = exit_pos;
-  index_ = exit_index;
-
-  StringPiece num_string(num_start, end_index - start_index);
+  // Leave the parser on the last byte of the number.
+  --pos_;
+  --index_;
 
-  int num_int;
-  if (StringToInt(num_string, &num_int))
-    return new FundamentalValue(num_int);
-
-  double num_double;
-  if (base::StringToDouble(num_string.as_string(), &num_double) &&
-      IsFinite(num_double)) {
-    return new FundamentalValue(num_double);
-  }
-
-  return NULL;
+  *out = StringPiece(num_start, end_index - start_index);
+  return true;
 }
 
 bool JSONParser::ReadInt(bool allow_leading_zeros) {
@@ -900,45 +1001,35 @@ bool JSONParser::ReadInt(bool allow_leading_zeros) {
 
 Value* JSONParser::ConsumeLiteral() {
   switch (*pos_) {
-    case 't': {
-      const char* kTrueLiteral = "true";
-      const int kTrueLen = static_cast<int>(strlen(kTrueLiteral));
-      if (!CanConsume(kTrueLen - 1) ||
-          !StringsAreEqual(pos_, kTrueLiteral, kTrueLen)) {
-        ReportError(JSONReader::JSON_SYNTAX_ERROR, 1);
+    case 't':
+      if (!ConsumeLiteralRaw("true"))
         return NULL;
-      }
-      NextNChars(kTrueLen - 1);
       return new FundamentalValue(true);
-    }
-    case 'f': {
-      const char* kFalseLiteral = "false";
-      const int kFalseLen = static_cast<int>(strlen(kFalseLiteral));
-      if (!CanConsume(kFalseLen - 1) ||
-          !StringsAreEqual(pos_, kFalseLiteral, kFalseLen)) {
-        ReportError(JSONReader::JSON_SYNTAX_ERROR, 1);
+    case 'f':
+      if (!ConsumeLiteralRaw("false"))
         return NULL;
-      }
-      NextNChars(kFalseLen - 1);
       return new FundamentalValue(false);
-    }
-    case 'n': {
-      const char* kNullLiteral = "null";
-      const int kNullLen = static_cast<int>(strlen(kNullLiteral));
-      if (!CanConsume(kNullLen - 1) ||
-          !StringsAreEqual(pos_, kNullLiteral, kNullLen)) {
-        ReportError(JSONReader::JSON_SYNTAX_ERROR, 1);
+    case 'n':
+      if (!ConsumeLiteralRaw("null"))
         return NULL;
-      }
-      NextNChars(kNullLen - 1);
       return Value::CreateNullValue();
-    }
     default:
       ReportError(JSONReader::JSON_UNEXPECTED_TOKEN, 1);
       return NULL;
   }
 }
 
+bool JSONParser::ConsumeLiteralRaw(const char* literal) {
+  const int literal_len = static_cast<int>(strlen(literal));
+  if (!CanConsume(literal_len - 1) ||
+      !StringsAreEqual(pos_, literal, literal_len)) {
+    ReportError(JSONReader::JSON_SYNTAX_ERROR, 1);
+    return false;
+  }
+  NextNChars(literal_len - 1);
+  return true;
+}
+
 // static
 bool JSONParser::StringsAreEqual(const char* one, const char* two, size_t len) {
   return strncmp(one, two, len) == 0;
@@ -18,6 +18,7 @@
 #endif
 
 namespace base {
+class JSONSaxReader;
 class Value;
 }
 
@@ -113,6 +114,10 @@ class BASE_EXPORT_PRIVATE JSONParser {
     // AppendString below.
     void Append(const char& c);
 
+    // Appends the |length| ASCII characters at |str|, which must directly
+    // follow the string in the input unless the builder has been converted.
+    void AppendASCII(const char* str, int length);
+
     // Appends a string to the std::string. Must be Convert()ed to use.
     void AppendString(const std::string& str);
 
@@ -202,6 +207,10 @@ class BASE_EXPORT_PRIVATE JSONParser {
   // Assuming that the parser is wound to the start of a valid JSON number,
   // this parses and converts it to either an int or double value.
   Value* ConsumeNumber();
+  // Helper function for ConsumeNumber() that consumes the number and stores
+  // its text in |out|, without checking the token that follows it. Returns
+  // false on failure with error information set.
+  bool ConsumeNumberRaw(StringPiece* out);
   // Helper that reads characters that are ints. Returns true if a number was
   // read and false on error.
   bool ReadInt(bool allow_leading_zeros);
@@ -209,6 +218,10 @@ class BASE_EXPORT_PRIVATE JSONParser {
   // Consumes the literal values of |true|, |false|, and |null|, assuming the
   // parser is wound to the first character of any of those.
   Value* ConsumeLiteral();
+  // Helper function for ConsumeLiteral() that consumes |literal|, assuming the
+  // parser is wound to its first character. Returns false on failure with
+  // error information set.
+  bool ConsumeLiteralRaw(const char* literal);
 
   // Compares two string buffers of a given length.
   static bool StringsAreEqual(const char* left, const char* right, size_t len);
@@ -253,14 +266,18 @@ class BASE_EXPORT_PRIVATE JSONParser {
   int error_line_;
   int error_column_;
 
+  // JSONSaxReader drives the tokenizer directly instead of building Values.
+  friend class base::JSONSaxReader;
   friend class JSONParserTest;
   FRIEND_TEST_ALL_PREFIXES(JSONParserTest, NextChar);
   FRIEND_TEST_ALL_PREFIXES(JSONParserTest, ConsumeDictionary);
   FRIEND_TEST_ALL_PREFIXES(JSONParserTest, ConsumeList);
   FRIEND_TEST_ALL_PREFIXES(JSONParserTest, ConsumeString);
+  FRIEND_TEST_ALL_PREFIXES(JSONParserTest, ConsumeLongStrings);
   FRIEND_TEST_ALL_PREFIXES(JSONParserTest, ConsumeLiterals);
   FRIEND_TEST_ALL_PREFIXES(JSONParserTest, ConsumeNumbers);
   FRIEND_TEST_ALL_PREFIXES(JSONParserTest, ErrorMessages);
+  FRIEND_TEST_ALL_PREFIXES(JSONParserTest, ErrorPositionsAfterRuns);
 
   DISALLOW_COPY_AND_ASSIGN(JSONParser);
 };
@@ -0,0 +1,87 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <string>
+
+#include "base/json/json_reader.h"
+#include "base/json/json_writer.h"
+#include "base/memory/scoped_ptr.h"
+#include "base/strings/stringprintf.h"
+#include "base/time/time.h"
+#include "base/values.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "testing/perf/perf_test.h"
+
+namespace base {
+
+namespace {
+
+const int kNumRecords = 50000;
+const int kNumIterations = 5;
+
+// Builds a list of records with short strings and numbers.
+std::string BuildRecordsDocument() {
+  std::string json = "[";
+  for (int i = 0; i < kNumRecords; ++i) {
+    if (i)
+      json += ",";
+    StringAppendF(&json,
+                  "{\"id\":%d,\"name\":\"record %d\",\"score\":%d.25,"
+                  "\"active\":%s,\"tags\":[\"alpha\",\"beta\"]}",
+                  i, i, i % 100, i % 2 ? "true" : "false");
+  }
+  json += "]";
+  return json;
+}
+
+// Builds a list of records dominated by long strings, a few of them escaped.
+std::string BuildStringsDocument() {
+  const std::string sentence =
+      "The quick brown fox jumps over the lazy dog, again and again. ";
+  std::string json = "[";
+  for (int i = 0; i < kNumRecords / 10; ++i) {
+    if (i)
+      json += ",";
+    json += "{\"url\":\"https://www.example.com/path/to/page";
+    json += StringPrintf("%d", i);
+    json += "?query=value\",\"text\":\"";
+    for (int j = 0; j < 8; ++j)
+      json += sentence;
+    json += "\\n\\\"quoted\\\"\"}";
+  }
+  json += "]";
+  return json;
+}
+
+void MeasureReadThroughput(const std::string& trace, const std::string& json) {
+  TimeTicks start = TimeTicks::HighResNow();
+  for (int i = 0; i < kNumIterations; ++i) {
+    scoped_ptr<Value> root(JSONReader::Read(json));
+    ASSERT_TRUE(root);
+  }
+  TimeDelta elapsed = TimeTicks::HighResNow() - start;
+  perf_test::PrintResult(
+      "json_parse", "", trace,
+      json.size() * kNumIterations / elapsed.InSecondsF() / (1024 * 1024),
+      "MB/s", true);
+}
+
+}  // namespace
+
+TEST(JSONParserPerfTest, Throughput) {
+  const std::string records = BuildRecordsDocument();
+  MeasureReadThroughput("records", records);
+
+  // The same document, indented as written by JSONWriter::PRETTY_PRINT.
+  scoped_ptr<Value> root(JSONReader::Read(records));
+  ASSERT_TRUE(root);
+  std::string pretty_records;
+  JSONWriter::WriteWithOptions(root.get(), JSONWriter::OPTIONS_PRETTY_PRINT,
+                               &pretty_records);
+  MeasureReadThroughput("pretty_records", pretty_records);
+
+  MeasureReadThroughput("strings", BuildStringsDocument());
+}
+
+}  // namespace base
@@ -55,6 +55,29 @@ TEST_F(JSONParserTest, ConsumeString) {
   EXPECT_EQ("test", str);
 }
 
+TEST_F(JSONParserTest, ConsumeLongStrings) {
+  // Plain characters are scanned in blocks, so end the run at every offset
+  // across a few blocks.
+  for (size_t length = 0; length < 40; ++length) {
+    std::string run(length, 'a');
+    const char* kSuffixes[] = { "", "\\n", "\xC3\xA9", "\\u0041bc" };
+    const char* kExpectedSuffixes[] = { "", "\n", "\xC3\xA9", "Abc" };
+    for (size_t i = 0; i < arraysize(kSuffixes); ++i) {
+      std::string input = "\"" + run + kSuffixes[i] + run + "\",|";
+      scoped_ptr<JSONParser> parser(NewTestParser(input));
+      scoped_ptr<Value> value(parser->ConsumeString());
+      EXPECT_EQ('"', *parser->pos_) << input;
+
+      TestLastThree(parser.get());
+
+      ASSERT_TRUE(value.get()) << input;
+      std::string str;
+      EXPECT_TRUE(value->GetAsString(&str));
+      EXPECT_EQ(run + kExpectedSuffixes[i] + run, str);
+    }
+  }
+}
+
 TEST_F(JSONParserTest, ConsumeList) {
   std::string input("[true, false],|");
   scoped_ptr<JSONParser> parser(NewTestParser(input));
@@ -302,6 +325,41 @@ TEST_F(JSONParserTest, ErrorMessages) {
   EXPECT_EQ(JSONReader::JSON_INVALID_ESCAPE, error_code);
 }
 
+TEST_F(JSONParserTest, ErrorPositionsAfterRuns) {
+  // Errors are reported at the same position whether the characters before
+  // them are consumed one by one or in blocks.
+  for (int length = 0; length < 40; ++length) {
+    std::string run(length, 'a');
+    std::string error_message;
+    int error_code = 0;
+    scoped_ptr<Value> root(JSONReader::ReadAndReturnError(
+        "[\"" + run + "\xFF\"]", JSON_PARSE_RFC, &error_code,
+        &error_message));
+    EXPECT_FALSE(root.get());
+    EXPECT_EQ(JSONParser::FormatErrorMessage(1, length + 4,
+                                             JSONReader::kUnsupportedEncoding),
+              error_message);
+
+    root.reset(JSONReader::ReadAndReturnError(
+        "[\"a" + run, JSON_PARSE_RFC, &error_code, &error_message));
+    EXPECT_FALSE(root.get());
+    EXPECT_EQ(JSONParser::FormatErrorMessage(1, length + 4,
+                                             JSONReader::kSyntaxError),
+              error_message);
+
+    std::string blanks(length, ' ');
+    blanks.append(length / 2, '\t');
+    root.reset(JSONReader::ReadAndReturnError(
+        "[1,\n" + blanks + "x]", JSON_PARSE_RFC, &error_code,
+        &error_message));
+    EXPECT_FALSE(root.get());
+    EXPECT_EQ(JSONParser::FormatErrorMessage(
+                  2, static_cast<int>(blanks.size()) + 2,
+                  JSONReader::kUnexpectedToken),
+              error_message);
+  }
+}
+
 TEST_F(JSONParserTest, Decode4ByteUtf8Char) {
   // This test strings contains a 4 byte unicode character (a smiley!) that the
   // reader should be able to handle (the character is \xf0\x9f\x98\x87).
@@ -0,0 +1,588 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/json/json_path_query.h"
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+#include "base/json/json_sax_reader.h"
+#include "base/logging.h"
+#include "base/strings/string_number_conversions.h"
+#include "base/values.h"
+
+namespace base {
+
+struct JSONPathQuery::Node {
+  typedef std::pair<std::string, Node*> KeyChild;
+  typedef std::pair<size_t, Node*> IndexChild;
+
+  Node() : result(-1) {}
+
+  static bool KeyChildLessThanKey(const KeyChild& child,
+                                  const StringPiece& key) {
+    return StringPiece(child.first) < key;
+  }
+
+  static bool IndexChildLessThanIndex(const IndexChild& child, size_t index) {
+    return child.first < index;
+  }
+
+  // The index of the result of the path which ends here, or -1.
+  int result;
+
+  // The children reached by a key or an index, sorted by key or index.
+  std::vector<KeyChild> keys;
+  std::vector<IndexChild> indices;
+};
+
+namespace {
+
+// A step of a path: a dictionary key, or a list index if |is_index|.
+struct Segment {
+  bool is_index;
+  std::string key;
+  size_t index;
+};
+
+// Splits |path| into |segments|. Returns false if it is malformed.
+bool ParsePath(const StringPiece& path, std::vector<Segment>* segments) {
+  size_t pos = 0;
+  bool after_dot = false;
+  while (pos < path.size()) {
+    Segment segment;
+    if (path[pos] == '[') {
+      if (after_dot)
+        return false;
+      size_t close = path.find(']', pos);
+      if (close == StringPiece::npos)
+        return false;
+      StringPiece digits = path.substr(pos + 1, close - pos - 1);
+      if (digits.empty() ||
+          digits.find_first_not_of("0123456789") != StringPiece::npos ||
+          !StringToSizeT(digits, &segment.index)) {
+        return false;
+      }
+      segment.is_index = true;
+      pos = close + 1;
+    } else {
+      // A key starts the path or follows a '.'.
+      if (pos != 0 && !after_dot)
+        return false;
+      size_t end = path.find_first_of(".[", pos);
+      if (end == StringPiece::npos)
+        end = path.size();
+      if (end == pos)
+        return false;
+      segment.is_index = false;
+      path.substr(pos, end - pos).CopyToString(&segment.key);
+      pos = end;
+    }
+    segments->push_back(segment);
+
+    after_dot = pos < path.size() && path[pos] == '.';
+    if (after_dot)
+      ++pos;
+  }
+  return !after_dot;
+}
+
+// Splits the root dictionary of a document into its members, using the
+// offsets of the tokens of their values in the input.
+class MemberSplitter : public JSONSaxHandler {
+ public:
+  MemberSplitter(const StringPiece& json,
+                 std::vector<JSONPathQuery::Member>* members)
+      : json_(json),
+        members_(members),
+        reader_(NULL),
+        depth_(0),
+        root_is_dictionary_(false),
+        value_begin_(0) {
+  }
+
+  void set_reader(const JSONSaxReader* reader) { reader_ = reader; }
+
+  bool root_is_dictionary() const { return root_is_dictionary_; }
+
+  // JSONSaxHandler:
+  virtual bool OnStartObject() override { return StartContainer(true); }
+  virtual bool OnEndObject() override { return EndContainer(); }
+  virtual bool OnStartArray() override { return StartContainer(false); }
+  virtual bool OnEndArray() override { return EndContainer(); }
+  virtual bool OnKey(const StringPiece& key) override {
+    if (depth_ == 1)
+      key.CopyToString(&key_);
+    return true;
+  }
+  virtual bool OnString(const StringPiece& value) override {
+    return OnScalar();
+  }
+  virtual bool OnInteger(int value) override { return OnScalar(); }
+  virtual bool OnDouble(double value) override { return OnScalar(); }
+  virtual bool OnBoolean(bool value) override { return OnScalar(); }
+  virtual bool OnNull() override { return OnScalar(); }
+
+ private:
+  bool StartContainer(bool is_object) {
+    if (depth_ == 0)
+      root_is_dictionary_ = is_object;
+    else if (depth_ == 1)
+      value_begin_ = reader_->token_begin();
+    ++depth_;
+    return true;
+  }
+
+  bool EndContainer() {
+    --depth_;
+    if (depth_ == 1)
+      AddMember(value_begin_);
+    return true;
+  }
+
+  bool OnScalar() {
+    if (depth_ == 1)
+      AddMember(reader_->token_begin());
+    return true;
+  }
+
+  // Adds the member whose value ends with the current token.
+  void AddMember(size_t value_begin) {
+    if (!root_is_dictionary_)
+      return;
+    members_->push_back(JSONPathQuery::Member(
+        key_, json_.substr(value_begin, reader_->token_end() - value_begin)));
+  }
+
+  const StringPiece json_;
+  std::vector<JSONPathQuery::Member>* members_;
+  const JSONSaxReader* reader_;
+
+  // The number of open containers.
+  int depth_;
+
+  bool root_is_dictionary_;
+
+  // The key of the current member, and the offset of the start of its value
+  // when it is a container.
+  std::string key_;
+  size_t value_begin_;
+
+  DISALLOW_COPY_AND_ASSIGN(MemberSplitter);
+};
+
+}  // namespace
+
+// Follows the trie of a JSONPathQuery along the events of a document. The
+// subtrees which no path leads into are skipped without allocating anything,
+// and Values are only built for the nodes of the trie which end a path.
+class JSONPathQuery::Walker : public JSONSaxHandler {
+ public:
+  Walker(const Node* root, ScopedVector<Value>* results);
+  virtual ~Walker();
+
+  // JSONSaxHandler:
+  virtual bool OnStartObject() override;
+  virtual bool OnEndObject() override;
+  virtual bool OnStartArray() override;
+  virtual bool OnEndArray() override;
+  virtual bool OnKey(const StringPiece& key) override;
+  virtual bool OnString(const StringPiece& value) override;
+  virtual bool OnInteger(int value) override;
+  virtual bool OnDouble(double value) override;
+  virtual bool OnBoolean(bool value) override;
+  virtual bool OnNull() override;
+
+ private:
+  // A list or dictionary which a path leads into.
+  struct Frame {
+    const Node* node;
+    bool is_list;
+
+    // For a list, the index of the next item, and the next child of |node|,
+    // since the children are visited in order along with the items.
+    size_t index;
+    std::vector<Node::IndexChild>::const_iterator next_child;
+  };
+
+  // Returns the node of the trie for the value which starts, or NULL if no
+  // path leads to it.
+  const Node* NextNode();
+
+  bool StartContainer(bool is_object);
+  bool EndContainer();
+
+  // Returns true if the scalar which starts is part of a selected value, in
+  // which case it must be passed to AddScalar().
+  bool WantsScalar();
+  void AddScalar(Value* value);
+
+  // Adds |value| to the value being built.
+  void AddValue(Value* value);
+
+  // Sets the results of |build_node_| and its descendants once their value
+  // is complete.
+  void FinishValue();
+
+  // Sets the results of the descendants of |node| from the corresponding
+  // children of |value|.
+  void SelectChildren(const Node* node, const Value& value);
+
+  // Resets the results of |node| and its descendants, when a dictionary key
+  // is repeated.
+  void ClearResults(const Node* node);
+
+  void SetResult(int index, Value* value);
+
+  ScopedVector<Value>* results_;
+
+  // The containers being walked, outside of the value being built.
+  std::vector<Frame> frames_;
+
+  // The node of the next value at the root or in a dictionary.
+  const Node* next_node_;
+
+  // The number of open containers in the subtree being skipped.
+  int skip_depth_;
+
+  // The value being built for |build_node_|, and its open containers.
+  scoped_ptr<Value> build_root_;
+  const Node* build_node_;
+  std::vector<Value*> build_stack_;
+
+  // The key of the next member of the dictionary being built.
+  std::string build_key_;
+
+  DISALLOW_COPY_AND_ASSIGN(Walker);
+};
+
+JSONPathQuery::Walker::Walker(const Node* root, ScopedVector<Value>* results)
+    : results_(results),
+      next_node_(root),
+      skip_depth_(0),
+      build_node_(NULL) {
+}
+
+JSONPathQuery::Walker::~Walker() {
+}
+
+bool JSONPathQuery::Walker::OnStartObject() {
+  return StartContainer(true);
+}
+
+bool JSONPathQuery::Walker::OnEndObject() {
+  return EndContainer();
+}
+
+bool JSONPathQuery::Walker::OnStartArray() {
+  return StartContainer(false);
+}
+
+bool JSONPathQuery::Walker::OnEndArray() {
+  return EndContainer();
+}
+
+bool JSONPathQuery::Walker::OnKey(const StringPiece& key) {
+  if (!build_stack_.empty()) {
+    key.CopyToString(&build_key_);
+    return true;
+  }
+  if (skip_depth_ > 0)
+    return true;
+
+  const Node* node = frames_.back().node;
+  std::vector<Node::KeyChild>::const_iterator it =
+      std::lower_bound(node->keys.begin(), node->keys.end(), key,
+                       &Node::KeyChildLessThanKey);
+  next_node_ = NULL;
+  if (it != node->keys.end() && it->first == key) {
+    next_node_ = it->second;
+    ClearResults(next_node_);
+  }
+  return true;
+}
+
+bool JSONPathQuery::Walker::OnString(const StringPiece& value) {
+  if (WantsScalar())
+    AddScalar(new StringValue(value.as_string()));
+  return true;
+}
+
+bool JSONPathQuery::Walker::OnInteger(int value) {
+  if (WantsScalar())
+    AddScalar(new FundamentalValue(value));
+  return true;
+}
+
+bool JSONPathQuery::Walker::OnDouble(double value) {
+  if (WantsScalar())
+    AddScalar(new FundamentalValue(value));
+  return true;
+}
+
+bool JSONPathQuery::Walker::OnBoolean(bool value) {
+  if (WantsScalar())
+    AddScalar(new FundamentalValue(value));
+  return true;
+}
+
+bool JSONPathQuery::Walker::OnNull() {
+  if (WantsScalar())
+    AddScalar(Value::CreateNullValue());
+  return true;
+}
+
+const JSONPathQuery::Node* JSONPathQuery::Walker::NextNode() {
+  if (frames_.empty() || !frames_.back().is_list) {
+    const Node* node = next_node_;
+    next_node_ = NULL;
+    return node;
+  }
+
+  Frame& frame = frames_.back();
+  const Node* node = NULL;
+  if (frame.next_child != frame.node->indices.end() &&
+      frame.next_child->first == frame.index) {
+    node = frame.next_child->second;
+    ++frame.next_child;
+  }
+  ++frame.index;
+  return node;
+}
+
+bool JSONPathQuery::Walker::StartContainer(bool is_object) {
+  if (build_stack_.empty()) {
+    if (skip_depth_ > 0) {
+      ++skip_depth_;
+      return true;
+    }
+
+    const Node* node = NextNode();
+    if (!node || node->result < 0) {
+      if (node && !(is_object ? node->keys.empty() : node->indices.empty())) {
+        Frame frame;
+        frame.node = node;
+        frame.is_list = !is_object;
+        frame.index = 0;
+        frame.next_child = node->indices.begin();
+        frames_.push_back(frame);
+      } else {
+        skip_depth_ = 1;
+      }
+      return true;
+    }
+    build_node_ = node;
+  }
+
+  Value* container;
+  if (is_object)
+    container = new DictionaryValue;
+  else
+    container = new ListValue;
+  AddValue(container);
+  build_stack_.push_back(container);
+  return true;
+}
+
+bool JSONPathQuery::Walker::EndContainer() {
+  if (!build_stack_.empty()) {
+    build_stack_.pop_back();
+    if (build_stack_.empty())
+      FinishValue();
+  } else if (skip_depth_ > 0) {
+    --skip_depth_;
+  } else {
+    frames_.pop_back();
+  }
+  return true;
+}
+
+bool JSONPathQuery::Walker::WantsScalar() {
+  if (!build_stack_.empty())
+    return true;
+  if (skip_depth_ > 0)
+    return false;
+
+  const Node* node = NextNode();
+  if (!node || node->result < 0)
+    return false;
+  build_node_ = node;
+  return true;
+}
+
+void JSONPathQuery::Walker::AddScalar(Value* value) {
+  AddValue(value);
+  if (build_stack_.empty())
+    FinishValue();
+}
+
+void JSONPathQuery::Walker::AddValue(Value* value) {
+  if (build_stack_.empty()) {
+    build_root_.reset(value);
+    return;
+  }
+
+  DictionaryValue* dictionary;
+  ListValue* list;
+  if (build_stack_.back()->GetAsDictionary(&dictionary))
+    dictionary->SetWithoutPathExpansion(build_key_, value);
+  else if (build_stack_.back()->GetAsList(&list))
+    list->Append(value);
+  else
+    NOTREACHED();
+}
+
+void JSONPathQuery::Walker::FinishValue() {
+  Value* value = build_root_.release();
+  SelectChildren(build_node_, *value);
+  SetResult(build_node_->result, value);
+}
+
+void JSONPathQuery::Walker::SelectChildren(const Node* node,
+                                           const Value& value) {
+  const DictionaryValue* dictionary;
+  if (!node->keys.empty() && value.GetAsDictionary(&dictionary)) {
+    for (std::vector<Node::KeyChild>::const_iterator it = node->keys.begin();
+         it != node->keys.end(); ++it) {
+      const Value* child;
+      if (!dictionary->GetWithoutPathExpansion(it->first, &child))
+        continue;
+      if (it->second->result >= 0)
+        SetResult(it->second->result, child->DeepCopy());
+      SelectChildren(it->second, *child);
+    }
+  }
+
+  const ListValue* list;
+  if (!node->indices.empty() && value.GetAsList(&list)) {
+    for (std::vector<Node::IndexChild>::const_iterator it =
+             node->indices.begin();
+         it != node->indices.end(); ++it) {
+      const Value* child;
+      if (!list->Get(it->first, &child))
+        break;
+      if (it->second->result >= 0)
+        SetResult(it->second->result, child->DeepCopy());
+      SelectChildren(it->second, *child);
+    }
+  }
+}
+
+void JSONPathQuery::Walker::ClearResults(const Node* node) {
+  if (node->result >= 0)
+    SetResult(node->result, NULL);
+  for (std::vector<Node::KeyChild>::const_iterator it = node->keys.begin();
+       it != node->keys.end(); ++it) {
+    ClearResults(it->second);
+  }
+  for (std::vector<Node::IndexChild>::const_iterator it =
+           node->indices.begin();
+       it != node->indices.end(); ++it) {
+    ClearResults(it->second);
+  }
+}
+
+void JSONPathQuery::Walker::SetResult(int index, Value* value) {
+  delete (*results_)[index];
+  (*results_)[index] = value;
+}
+
+// static
+bool JSONPathQuery::SplitMembers(const StringPiece& json,
+                                 int options,
+                                 std::vector<Member>* members,
+                                 int* error_code_out,
+                                 std::string* error_msg_out) {
+  members->clear();
+  MemberSplitter splitter(json, members);
+  JSONSaxReader reader(&splitter, options);
+  splitter.set_reader(&reader);
+  if (!reader.ParseComplete(json)) {
+    members->clear();
+    if (error_code_out)
+      *error_code_out = reader.error_code();
+    if (error_msg_out)
+      *error_msg_out = reader.GetErrorMessage();
+    return false;
+  }
+
+  if (!splitter.root_is_dictionary()) {
+    if (error_code_out)
+      *error_code_out = JSONReader::JSON_NO_ERROR;
+    if (error_msg_out)
+      error_msg_out->clear();
+    return false;
+  }
+  return true;
+}
+
+JSONPathQuery::JSONPathQuery() : path_count_(0) {
+  nodes_.push_back(new Node);
+}
+
+JSONPathQuery::~JSONPathQuery() {
+}
+
+bool JSONPathQuery::AddPath(const StringPiece& path, size_t* index) {
+  std::vector<Segment> segments;
+  if (!ParsePath(path, &segments))
+    return false;
+
+  Node* node = nodes_[0];
+  for (std::vector<Segment>::const_iterator segment = segments.begin();
+       segment != segments.end(); ++segment) {
+    if (segment->is_index) {
+      std::vector<Node::IndexChild>& children = node->indices;
+      std::vector<Node::IndexChild>::iterator it =
+          std::lower_bound(children.begin(), children.end(), segment->index,
+                           &Node::IndexChildLessThanIndex);
+      if (it == children.end() || it->first != segment->index) {
+        nodes_.push_back(new Node);
+        it = children.insert(it,
+                             Node::IndexChild(segment->index, nodes_.back()));
+      }
+      node = it->second;
+    } else {
+      std::vector<Node::KeyChild>& children = node->keys;
+      std::vector<Node::KeyChild>::iterator it =
+          std::lower_bound(children.begin(), children.end(),
+                           StringPiece(segment->key),
+                           &Node::KeyChildLessThanKey);
+      if (it == children.end() || it->first != segment->key) {
+        nodes_.push_back(new Node);
+        it = children.insert(it, Node::KeyChild(segment->key, nodes_.back()));
+      }
+      node = it->second;
+    }
+  }
+
+  if (node->result < 0)
+    node->result = static_cast<int>(path_count_++);
+  *index = node->result;
+  return true;
+}
+
+bool JSONPathQuery::Execute(const StringPiece& json,
+                            int options,
+                            ScopedVector<Value>* results,
+                            int* error_code_out,
+                            std::string* error_msg_out) const {
+  results->clear();
+  results->resize(path_count_);
+
+  Walker walker(nodes_[0], results);
+  JSONSaxReader reader(&walker, options);
+  if (reader.ParseComplete(json))
+    return true;
+
+  results->clear();
+  if (error_code_out)
+    *error_code_out = reader.error_code();
+  if (error_msg_out)
+    *error_msg_out = reader.GetErrorMessage();
+  return false;
+}
+
+}  // namespace base
@@ -0,0 +1,107 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+//
+// Extracts the values at a few paths of a JSON document without building the
+// rest of it. Where JSONReader::Read() followed by DictionaryValue::Get()
+// allocates a Value for every node of the document, a JSONPathQuery reads the
+// events of a JSONSaxReader over the input, skips the subtrees which no path
+// leads into without allocating anything, and only creates Values for the
+// selected nodes. The whole input is still validated, so a query fails on the
+// same documents, with the same errors, as JSONReader::ReadAndReturnError().
+//
+// A path is a sequence of dictionary keys separated by '.', each of which may
+// be followed by list indices in brackets, like "a.b[3].c". A path may also
+// start with an index, for documents whose root is a list, and the empty path
+// selects the whole document. As with DictionaryValue::Get(), keys can't
+// contain '.'; they can't contain '[' either.
+//
+// Example:
+//   base::JSONPathQuery query;
+//   size_t name_index, id_index;
+//   CHECK(query.AddPath("profile.name", &name_index));
+//   CHECK(query.AddPath("accounts[0].id", &id_index));
+//   ScopedVector<base::Value> results;
+//   std::string name;
+//   if (query.Execute(json, base::JSON_PARSE_RFC, &results, NULL, NULL) &&
+//       results[name_index] && results[name_index]->GetAsString(&name)) {
+//     ...
+//   }
+
+#ifndef BASE_JSON_JSON_PATH_QUERY_H_
+#define BASE_JSON_JSON_PATH_QUERY_H_
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "base/base_export.h"
+#include "base/basictypes.h"
+#include "base/memory/scoped_vector.h"
+#include "base/strings/string_piece.h"
+
+namespace base {
+
+class Value;
+
+class BASE_EXPORT JSONPathQuery {
+ public:
+  // A member of a dictionary: its key, and the unparsed text of its value.
+  typedef std::pair<std::string, StringPiece> Member;
+
+  // Splits |json|, whose root must be a dictionary, into its members without
+  // creating any Value, so that they can be parsed one by one later with
+  // JSONReader::Read(). Sets |members| to the members in document order, with
+  // values which refer to |json|. The whole input is still validated, as by
+  // Execute(). Returns false if |json| is malformed, in which case
+  // |error_code_out| and |error_msg_out| are set if non-NULL, or if its root is
+  // not a dictionary, in which case the error code is
+  // JSONReader::JSON_NO_ERROR.
+  static bool SplitMembers(const StringPiece& json,
+                           int options,
+                           std::vector<Member>* members,
+                           int* error_code_out,
+                           std::string* error_msg_out);
+
+  JSONPathQuery();
+  ~JSONPathQuery();
+
+  // Adds |path| to the query and sets |index| to the position of its result
+  // in the output of Execute(). Adding the same path twice gives the same
+  // index. Returns false, and leaves the query unchanged, if |path| is
+  // malformed.
+  bool AddPath(const StringPiece& path, size_t* index);
+
+  // The number of distinct paths added so far.
+  size_t path_count() const { return path_count_; }
+
+  // Runs the query over |json|, which is parsed with |options| (see
+  // JSONParserOptions). On success, |results| holds path_count() entries,
+  // with the value at each path, or NULL where the document has no value at
+  // that path. When a dictionary key is repeated, the last value is the one
+  // selected, as JSONReader::Read() keeps it. Returns false if |json| is
+  // malformed, in which case |error_code_out| and |error_msg_out| are set if
+  // non-NULL, as for JSONReader::ReadAndReturnError().
+  bool Execute(const StringPiece& json,
+               int options,
+               ScopedVector<Value>* results,
+               int* error_code_out,
+               std::string* error_msg_out) const;
+
+ private:
+  // A node of the trie of paths. Nodes are owned by |nodes_|, the root being
+  // the first one.
+  struct Node;
+
+  // Follows the trie along the events of a JSONSaxReader.
+  class Walker;
+
+  ScopedVector<Node> nodes_;
+  size_t path_count_;
+
+  DISALLOW_COPY_AND_ASSIGN(JSONPathQuery);
+};
+
+}  // namespace base
+
+#endif  // BASE_JSON_JSON_PATH_QUERY_H_
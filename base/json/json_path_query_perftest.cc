@@ -0,0 +1,103 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <string>
+
+#include "base/json/json_path_query.h"
+#include "base/json/json_reader.h"
+#include "base/memory/scoped_ptr.h"
+#include "base/strings/stringprintf.h"
+#include "base/time/time.h"
+#include "base/values.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "testing/perf/perf_test.h"
+
+namespace base {
+
+namespace {
+
+const int kNumRecords = 100000;
+const int kSelectedRecord = kNumRecords / 2;
+
+// Builds a large document of records, with a few small fields around them.
+std::string BuildDocument() {
+  std::string json = "{\"meta\": {\"version\": 3, \"name\": \"records\"}, "
+                     "\"records\": [";
+  for (int i = 0; i < kNumRecords; ++i) {
+    if (i)
+      json += ",";
+    StringAppendF(&json,
+                  "{\"id\": %d, \"name\": \"record %d\", \"score\": %d.25, "
+                  "\"active\": %s, \"parent\": null, "
+                  "\"tags\": [\"alpha\", \"beta\", \"gamma\\t\"], "
+                  "\"position\": {\"x\": %d, \"y\": -%d}}",
+                  i, i, i % 100, i % 2 ? "true" : "false", i, i);
+  }
+  StringAppendF(&json, "], \"summary\": {\"count\": %d}}", kNumRecords);
+  return json;
+}
+
+void PrintTime(const std::string& trace, TimeDelta elapsed) {
+  perf_test::PrintResult("json_path_query", "", trace,
+                         elapsed.InMillisecondsF(), "ms", true);
+}
+
+}  // namespace
+
+// Compares extracting three fields of a large document with a full parse and
+// DictionaryValue::Get(), and with a JSONPathQuery.
+TEST(JSONPathQueryPerfTest, QueryVersusParse) {
+  const std::string json = BuildDocument();
+  const std::string expected_name = StringPrintf("record %d", kSelectedRecord);
+
+  TimeTicks start = TimeTicks::HighResNow();
+  {
+    scoped_ptr<Value> root(JSONReader::Read(json));
+    DictionaryValue* dictionary = NULL;
+    ASSERT_TRUE(root && root->GetAsDictionary(&dictionary));
+    int version = 0;
+    int count = 0;
+    ListValue* records = NULL;
+    DictionaryValue* record = NULL;
+    std::string name;
+    ASSERT_TRUE(dictionary->GetInteger("meta.version", &version));
+    ASSERT_TRUE(dictionary->GetInteger("summary.count", &count));
+    ASSERT_TRUE(dictionary->GetList("records", &records));
+    ASSERT_TRUE(records->GetDictionary(kSelectedRecord, &record));
+    ASSERT_TRUE(record->GetString("name", &name));
+    EXPECT_EQ(3, version);
+    EXPECT_EQ(kNumRecords, count);
+    EXPECT_EQ(expected_name, name);
+  }
+  // The tree is destroyed within the measurement.
+  PrintTime("parse_and_get", TimeTicks::HighResNow() - start);
+
+  start = TimeTicks::HighResNow();
+  JSONPathQuery query;
+  size_t version_index = 0;
+  size_t count_index = 0;
+  size_t name_index = 0;
+  ASSERT_TRUE(query.AddPath("meta.version", &version_index));
+  ASSERT_TRUE(query.AddPath("summary.count", &count_index));
+  ASSERT_TRUE(query.AddPath(
+      StringPrintf("records[%d].name", kSelectedRecord), &name_index));
+  ScopedVector<Value> results;
+  ASSERT_TRUE(query.Execute(json, JSON_PARSE_RFC, &results, NULL, NULL));
+  PrintTime("query", TimeTicks::HighResNow() - start);
+
+  int version = 0;
+  int count = 0;
+  std::string name;
+  ASSERT_TRUE(results[version_index] &&
+              results[version_index]->GetAsInteger(&version));
+  ASSERT_TRUE(results[count_index] &&
+              results[count_index]->GetAsInteger(&count));
+  ASSERT_TRUE(results[name_index] &&
+              results[name_index]->GetAsString(&name));
+  EXPECT_EQ(3, version);
+  EXPECT_EQ(kNumRecords, count);
+  EXPECT_EQ(expected_name, name);
+}
+
+}  // namespace base
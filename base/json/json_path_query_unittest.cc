@@ -0,0 +1,229 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/json/json_path_query.h"
+
+#include <string>
+#include <vector>
+
+#include "base/json/json_reader.h"
+#include "base/memory/scoped_ptr.h"
+#include "base/values.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace base {
+
+namespace {
+
+const char kDocument[] =
+    "{\"name\": \"x\\ty\", \"count\": 3, \"skipped\": [1, 2.5, \"s\", null,"
+    " {\"deep\": [true, false]}], \"a.b\": 1, \"a\": {\"b\": [10, {\"c\": 11},"
+    " 12, {\"c\": \"thirteen\", \"d\": [[1, 2], [3]]}]}}";
+
+// Runs a query for |path| alone over |json|, and returns its result.
+scoped_ptr<Value> QueryOne(const std::string& json, const std::string& path) {
+  JSONPathQuery query;
+  size_t index = 0;
+  EXPECT_TRUE(query.AddPath(path, &index));
+  ScopedVector<Value> results;
+  EXPECT_TRUE(query.Execute(json, JSON_PARSE_RFC, &results, NULL, NULL));
+  if (results.size() != 1u)
+    return scoped_ptr<Value>();
+  scoped_ptr<Value> result(results[0]);
+  results.weak_clear();
+  return result.Pass();
+}
+
+}  // namespace
+
+TEST(JSONPathQueryTest, Paths) {
+  JSONPathQuery query;
+  const char* const kPaths[] = {
+    "name", "count", "a.b[3].c", "a.b[1]", "a.b[3].d[0][1]", "a", "missing",
+    "a.b[7]", "name.x", "a.b.c", "a.b[0].c", ""
+  };
+  size_t indices[arraysize(kPaths)];
+  for (size_t i = 0; i < arraysize(kPaths); ++i) {
+    ASSERT_TRUE(query.AddPath(kPaths[i], &indices[i])) << kPaths[i];
+    EXPECT_EQ(i, indices[i]);
+  }
+  EXPECT_EQ(arraysize(kPaths), query.path_count());
+
+  // Adding a path again gives the same result.
+  size_t index = 0;
+  EXPECT_TRUE(query.AddPath("a.b[3].c", &index));
+  EXPECT_EQ(indices[2], index);
+  EXPECT_EQ(arraysize(kPaths), query.path_count());
+
+  ScopedVector<Value> results;
+  ASSERT_TRUE(query.Execute(kDocument, JSON_PARSE_RFC, &results, NULL, NULL));
+  ASSERT_EQ(arraysize(kPaths), results.size());
+
+  std::string string_value;
+  int int_value = 0;
+  ASSERT_TRUE(results[0]);
+  EXPECT_TRUE(results[0]->GetAsString(&string_value));
+  EXPECT_EQ("x\ty", string_value);
+  ASSERT_TRUE(results[1]);
+  EXPECT_TRUE(results[1]->GetAsInteger(&int_value));
+  EXPECT_EQ(3, int_value);
+  ASSERT_TRUE(results[2]);
+  EXPECT_TRUE(results[2]->GetAsString(&string_value));
+  EXPECT_EQ("thirteen", string_value);
+  ASSERT_TRUE(results[4]);
+  EXPECT_TRUE(results[4]->GetAsInteger(&int_value));
+  EXPECT_EQ(2, int_value);
+
+  // Values are the same as with a full parse, including the containers which
+  // other paths lead into.
+  scoped_ptr<Value> root(JSONReader::Read(kDocument));
+  ASSERT_TRUE(root);
+  DictionaryValue* dictionary = NULL;
+  ASSERT_TRUE(root->GetAsDictionary(&dictionary));
+  ListValue* list = NULL;
+  ASSERT_TRUE(dictionary->GetList("a.b", &list));
+  Value* item = NULL;
+  ASSERT_TRUE(list->Get(1, &item));
+  ASSERT_TRUE(results[3]);
+  EXPECT_TRUE(item->Equals(results[3]));
+  ASSERT_TRUE(dictionary->Get("a", &item));
+  ASSERT_TRUE(results[5]);
+  EXPECT_TRUE(item->Equals(results[5]));
+  ASSERT_TRUE(results[11]);
+  EXPECT_TRUE(root->Equals(results[11]));
+
+  // Paths which don't lead to a value.
+  for (size_t i = 6; i <= 10; ++i)
+    EXPECT_FALSE(results[i]) << kPaths[i];
+}
+
+TEST(JSONPathQueryTest, MalformedPaths) {
+  const char* const kPaths[] = {
+    ".", "a.", ".a", "a..b", "a[", "a[]", "a[x]", "a[-1]", "a[1]b", "a.[1]",
+    "[1", "a[99999999999999999999999]"
+  };
+  JSONPathQuery query;
+  for (size_t i = 0; i < arraysize(kPaths); ++i) {
+    size_t index = 0;
+    EXPECT_FALSE(query.AddPath(kPaths[i], &index)) << kPaths[i];
+  }
+  EXPECT_EQ(0u, query.path_count());
+}
+
+TEST(JSONPathQueryTest, ListRoot) {
+  scoped_ptr<Value> value = QueryOne("[{\"a\": 1}, {\"a\": 2}]", "[1].a");
+  int int_value = 0;
+  ASSERT_TRUE(value);
+  EXPECT_TRUE(value->GetAsInteger(&int_value));
+  EXPECT_EQ(2, int_value);
+
+  value = QueryOne("\"scalar\"", "");
+  std::string string_value;
+  ASSERT_TRUE(value);
+  EXPECT_TRUE(value->GetAsString(&string_value));
+  EXPECT_EQ("scalar", string_value);
+}
+
+TEST(JSONPathQueryTest, RepeatedKeys) {
+  // The last value of a key is selected, as JSONReader keeps it.
+  scoped_ptr<Value> value = QueryOne("{\"a\": 1, \"a\": 2}", "a");
+  int int_value = 0;
+  ASSERT_TRUE(value);
+  EXPECT_TRUE(value->GetAsInteger(&int_value));
+  EXPECT_EQ(2, int_value);
+
+  // Including when the last value doesn't have the path.
+  value = QueryOne("{\"a\": {\"b\": 1}, \"a\": {\"c\": 2}}", "a.b");
+  EXPECT_FALSE(value);
+}
+
+TEST(JSONPathQueryTest, Errors) {
+  JSONPathQuery query;
+  size_t index = 0;
+  ASSERT_TRUE(query.AddPath("a", &index));
+
+  // Malformed input is reported as JSONReader does, including in the parts
+  // which are skipped.
+  const char* const kInputs[] = {
+    "{\"a\": 1, \"b\": [1, 2,]}",
+    "{\"b\": {\"c\" 1}, \"a\": 2}",
+    "{\"a\": 1} 2",
+    "{\"b\": [nul], \"a\": 1}",
+    "{\"b\": \"\\q\", \"a\": 1}",
+  };
+  for (size_t i = 0; i < arraysize(kInputs); ++i) {
+    int expected_code = 0;
+    std::string expected_message;
+    scoped_ptr<Value> root(JSONReader::ReadAndReturnError(
+        kInputs[i], JSON_PARSE_RFC, &expected_code, &expected_message));
+    EXPECT_FALSE(root);
+
+    ScopedVector<Value> results;
+    int error_code = 0;
+    std::string error_message;
+    EXPECT_FALSE(query.Execute(kInputs[i], JSON_PARSE_RFC, &results,
+                               &error_code, &error_message)) << kInputs[i];
+    EXPECT_EQ(expected_code, error_code) << kInputs[i];
+    EXPECT_EQ(expected_message, error_message) << kInputs[i];
+    EXPECT_TRUE(results.empty());
+  }
+
+  // Options are respected.
+  ScopedVector<Value> results;
+  EXPECT_TRUE(query.Execute("{\"b\": [1, 2,], \"a\": 1,}",
+                            JSON_ALLOW_TRAILING_COMMAS, &results, NULL, NULL));
+
+  // So is the nesting limit, whether the nested values are skipped or not.
+  std::string nested = "{\"b\": " + std::string(200, '[') +
+                       std::string(200, ']') + "}";
+  EXPECT_FALSE(query.Execute(nested, JSON_PARSE_RFC, &results, NULL, NULL));
+  nested = "{\"a\": " + std::string(200, '[') + std::string(200, ']') + "}";
+  EXPECT_FALSE(query.Execute(nested, JSON_PARSE_RFC, &results, NULL, NULL));
+}
+
+TEST(JSONPathQueryTest, SplitMembers) {
+  std::vector<JSONPathQuery::Member> members;
+  ASSERT_TRUE(JSONPathQuery::SplitMembers(kDocument, JSON_PARSE_RFC, &members,
+                                          NULL, NULL));
+  scoped_ptr<Value> root(JSONReader::Read(kDocument));
+  DictionaryValue* dictionary = NULL;
+  ASSERT_TRUE(root && root->GetAsDictionary(&dictionary));
+  ASSERT_EQ(dictionary->size(), members.size());
+  EXPECT_EQ("name", members[0].first);
+  EXPECT_EQ("\"x\\ty\"", members[0].second.as_string());
+  EXPECT_EQ("count", members[1].first);
+  EXPECT_EQ("3", members[1].second.as_string());
+  EXPECT_EQ("a.b", members[3].first);
+  for (size_t i = 0; i < members.size(); ++i) {
+    const Value* expected = NULL;
+    ASSERT_TRUE(dictionary->GetWithoutPathExpansion(members[i].first,
+                                                    &expected));
+    scoped_ptr<Value> value(JSONReader::Read(members[i].second));
+    EXPECT_TRUE(Value::Equals(expected, value.get())) << members[i].first;
+  }
+
+  EXPECT_TRUE(JSONPathQuery::SplitMembers(" {} ", JSON_PARSE_RFC, &members,
+                                          NULL, NULL));
+  EXPECT_TRUE(members.empty());
+
+  // Keys are unescaped.
+  ASSERT_TRUE(JSONPathQuery::SplitMembers("{\"\\u0041\": null}",
+                                          JSON_PARSE_RFC, &members, NULL,
+                                          NULL));
+  ASSERT_EQ(1u, members.size());
+  EXPECT_EQ("A", members[0].first);
+  EXPECT_EQ("null", members[0].second.as_string());
+
+  // Malformed input fails as JSONReader does, and other roots with no error.
+  int error_code = 0;
+  EXPECT_FALSE(JSONPathQuery::SplitMembers("{\"a\": [1,]}", JSON_PARSE_RFC,
+                                           &members, &error_code, NULL));
+  EXPECT_EQ(JSONReader::JSON_TRAILING_COMMA, error_code);
+  EXPECT_TRUE(members.empty());
+  EXPECT_FALSE(JSONPathQuery::SplitMembers("[1, 2]", JSON_PARSE_RFC, &members,
+                                           &error_code, NULL));
+  EXPECT_EQ(JSONReader::JSON_NO_ERROR, error_code);
+}
+
+}  // namespace base
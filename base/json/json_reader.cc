@@ -4,6 +4,7 @@
 
 #include "base/json/json_reader.h"
 
+#include "base/json/json_document.h"
 #include "base/json/json_parser.h"
 #include "base/logging.h"
 
@@ -72,6 +73,14 @@ Value* JSONReader::ReadAndReturnError(const StringPiece& json,
   return NULL;
 }
 
+// static
+scoped_ptr<JSONDocument> JSONReader::ReadDocument(const StringPiece& json,
+                                                  int options,
+                                                  int* error_code_out,
+                                                  std::string* error_msg_out) {
+  return JSONDocument::Parse(json, options, error_code_out, error_msg_out);
+}
+
 // static
 std::string JSONReader::ErrorCodeToString(JsonParseError error_code) {
   switch (error_code) {
@@ -37,6 +37,7 @@
 
 namespace base {
 
+class JSONDocument;
 class Value;
 
 namespace internal {
@@ -110,6 +111,16 @@ class BASE_EXPORT JSONReader {
                                    int* error_code_out,
                                    std::string* error_msg_out);
 
+  // Reads and parses |json| into a read-only JSONDocument (see
+  // json_document.h), which is much cheaper to build and destroy than a Value
+  // tree. Accepts the same input and reports errors like
+  // ReadAndReturnError(); JSON_DETACHABLE_CHILDREN has no effect. Returns
+  // NULL if the input is not properly formed.
+  static scoped_ptr<JSONDocument> ReadDocument(const StringPiece& json,
+                                               int options,
+                                               int* error_code_out,
+                                               std::string* error_msg_out);
+
   // Converts a JSON parse error code into a human readable message.
   // Returns an empty string if error_code is JSON_NO_ERROR.
   static std::string ErrorCodeToString(JsonParseError error_code);
@@ -0,0 +1,383 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/json/json_sax_reader.h"
+
+#include <algorithm>
+
+#include "base/float_util.h"
+#include "base/json/json_parser.h"
+#include "base/logging.h"
+#include "base/strings/string_number_conversions.h"
+
+namespace base {
+
+namespace {
+
+// Same nesting limit as JSONParser.
+const int kStackMaxDepth = 100;
+
+// How far from the end of the buffered input the tokenizer may fail on a
+// token which is merely cut by the end of a chunk. The longest lookahead is a
+// surrogate pair escape, "\uXXXX\uXXXX".
+const int kMaxTokenLookahead = 12;
+
+const char kUTF8ByteOrderMark[] = "\xEF\xBB\xBF";
+
+}  // namespace
+
+typedef internal::JSONParser JSONParser;
+
+JSONSaxReader::JSONSaxReader(JSONSaxHandler* handler, int options)
+    : handler_(handler),
+      options_(options),
+      parser_(new JSONParser(options)),
+      consumed_(0),
+      token_index_(0),
+      state_(STATE_VALUE),
+      at_start_(true),
+      failed_(false) {
+  DCHECK(handler_);
+  parser_->line_number_ = 1;
+}
+
+JSONSaxReader::~JSONSaxReader() {
+}
+
+// static
+bool JSONSaxReader::Parse(const StringPiece& json,
+                          JSONSaxHandler* handler,
+                          int options) {
+  JSONSaxReader reader(handler, options);
+  return reader.ParseComplete(json);
+}
+
+bool JSONSaxReader::ParseComplete(const StringPiece& json) {
+  DCHECK(at_start_ && buffer_.empty());
+  size_t consumed;
+  return ParseInput(json, true, &consumed);
+}
+
+bool JSONSaxReader::Feed(const StringPiece& chunk) {
+  DCHECK(!failed_);
+  if (failed_)
+    return false;
+  chunk.AppendToString(&buffer_);
+  return ParseBuffer(false);
+}
+
+bool JSONSaxReader::Finish() {
+  if (failed_)
+    return false;
+  return ParseBuffer(true);
+}
+
+JSONReader::JsonParseError JSONSaxReader::error_code() const {
+  return parser_->error_code();
+}
+
+std::string JSONSaxReader::GetErrorMessage() const {
+  return parser_->GetErrorMessage();
+}
+
+size_t JSONSaxReader::token_begin() const {
+  return consumed_ + token_index_;
+}
+
+size_t JSONSaxReader::token_end() const {
+  // The parser is on the last byte of the token while it is reported.
+  return consumed_ + parser_->index_ + 1;
+}
+
+bool JSONSaxReader::ParseBuffer(bool is_final) {
+  size_t consumed;
+  if (!ParseInput(buffer_, is_final, &consumed))
+    return false;
+  buffer_.erase(0, consumed);
+  return true;
+}
+
+bool JSONSaxReader::ParseInput(const StringPiece& input,
+                               bool is_final,
+                               size_t* consumed) {
+  JSONParser* parser = parser_.get();
+  *consumed = 0;
+  parser->start_pos_ = input.data();
+  parser->pos_ = parser->start_pos_;
+  parser->end_pos_ = parser->start_pos_ + input.size();
+  parser->index_ = 0;
+
+  if (at_start_) {
+    // Skip a UTF-8 byte-order mark, once there is enough input to tell.
+    const size_t kMarkLength = arraysize(kUTF8ByteOrderMark) - 1;
+    size_t length = std::min(input.size(), kMarkLength);
+    if (input.substr(0, length) == StringPiece(kUTF8ByteOrderMark, length)) {
+      if (length < kMarkLength && !is_final)
+        return true;
+      if (length == kMarkLength)
+        parser->NextNChars(kMarkLength);
+    }
+    at_start_ = false;
+  }
+
+  Result result;
+  do {
+    result = ParseNextToken(is_final);
+  } while (result == RESULT_OK);
+
+  if (result == RESULT_ERROR) {
+    failed_ = true;
+    return false;
+  }
+  DCHECK(!is_final || result == RESULT_DONE);
+
+  // The consumed input is dropped by the caller. Columns are counted from
+  // |index_last_line_|, so it moves along with the buffer.
+  *consumed = parser->index_;
+  consumed_ += parser->index_;
+  parser->index_last_line_ -= parser->index_;
+  parser->index_ = 0;
+  parser->start_pos_ = NULL;
+  parser->pos_ = NULL;
+  parser->end_pos_ = NULL;
+  return true;
+}
+
+JSONSaxReader::Result JSONSaxReader::ParseNextToken(bool is_final) {
+  JSONParser* parser = parser_.get();
+  const Checkpoint checkpoint = SaveCheckpoint();
+  JSONParser::Token token = parser->GetNextToken();
+  token_index_ = parser->index_;
+  if (token == JSONParser::T_END_OF_INPUT) {
+    if (!is_final) {
+      // Trailing whitespace and comments are consumed with the next token, so
+      // that a "\r\n" or a comment split across chunks is read in one piece.
+      RestoreCheckpoint(checkpoint);
+      return RESULT_NEED_MORE_INPUT;
+    }
+    if (state_ == STATE_DONE)
+      return RESULT_DONE;
+  }
+
+  switch (state_) {
+    case STATE_VALUE:
+      return ParseValue(token, is_final, checkpoint);
+
+    case STATE_ARRAY_FIRST_VALUE:
+    case STATE_ARRAY_NEXT_VALUE:
+      if (token != JSONParser::T_ARRAY_END)
+        return ParseValue(token, is_final, checkpoint);
+      if (state_ == STATE_ARRAY_NEXT_VALUE &&
+          !(options_ & JSON_ALLOW_TRAILING_COMMAS)) {
+        parser->ReportError(JSONReader::JSON_TRAILING_COMMA, 1);
+        return RESULT_ERROR;
+      }
+      return EndContainer();
+
+    case STATE_OBJECT_FIRST_KEY:
+    case STATE_OBJECT_NEXT_KEY: {
+      if (token == JSONParser::T_OBJECT_END) {
+        if (state_ == STATE_OBJECT_NEXT_KEY &&
+            !(options_ & JSON_ALLOW_TRAILING_COMMAS)) {
+          parser->ReportError(JSONReader::JSON_TRAILING_COMMA, 1);
+          return RESULT_ERROR;
+        }
+        return EndContainer();
+      }
+      if (token != JSONParser::T_STRING) {
+        parser->ReportError(JSONReader::JSON_UNQUOTED_DICTIONARY_KEY, 1);
+        return RESULT_ERROR;
+      }
+
+      JSONParser::StringBuilder key;
+      if (!parser->ConsumeStringRaw(&key))
+        return TokenFailed(is_final, checkpoint);
+      Result result = HandlerResult(handler_->OnKey(
+          key.CanBeStringPiece() ? key.AsStringPiece()
+                                 : StringPiece(key.AsString())));
+      parser->NextChar();
+      state_ = STATE_PAIR_SEPARATOR;
+      return result;
+    }
+
+    case STATE_PAIR_SEPARATOR:
+      if (token != JSONParser::T_OBJECT_PAIR_SEPARATOR) {
+        parser->ReportError(JSONReader::JSON_SYNTAX_ERROR, 1);
+        return RESULT_ERROR;
+      }
+      parser->NextChar();
+      state_ = STATE_VALUE;
+      return RESULT_OK;
+
+    case STATE_SEPARATOR_OR_END: {
+      bool in_object = containers_.back();
+      if (token == JSONParser::T_LIST_SEPARATOR) {
+        parser->NextChar();
+        state_ = in_object ? STATE_OBJECT_NEXT_KEY : STATE_ARRAY_NEXT_VALUE;
+        return RESULT_OK;
+      }
+      if (token == (in_object ? JSONParser::T_OBJECT_END
+                              : JSONParser::T_ARRAY_END)) {
+        return EndContainer();
+      }
+      parser->ReportError(JSONReader::JSON_SYNTAX_ERROR, in_object ? 0 : 1);
+      return RESULT_ERROR;
+    }
+
+    case STATE_DONE:
+      parser->ReportError(JSONReader::JSON_UNEXPECTED_DATA_AFTER_ROOT, 1);
+      return RESULT_ERROR;
+  }
+
+  NOTREACHED();
+  return RESULT_ERROR;
+}
+
+JSONSaxReader::Result JSONSaxReader::ParseValue(int token,
+                                                bool is_final,
+                                                const Checkpoint& checkpoint) {
+  JSONParser* parser = parser_.get();
+  switch (token) {
+    case JSONParser::T_OBJECT_BEGIN:
+    case JSONParser::T_ARRAY_BEGIN: {
+      if (static_cast<int>(containers_.size()) + 1 >= kStackMaxDepth) {
+        parser->ReportError(JSONReader::JSON_TOO_MUCH_NESTING, 1);
+        return RESULT_ERROR;
+      }
+      bool is_object = token == JSONParser::T_OBJECT_BEGIN;
+      containers_.push_back(is_object);
+      Result result = HandlerResult(is_object ? handler_->OnStartObject()
+                                              : handler_->OnStartArray());
+      parser->NextChar();
+      state_ = is_object ? STATE_OBJECT_FIRST_KEY : STATE_ARRAY_FIRST_VALUE;
+      return result;
+    }
+
+    case JSONParser::T_STRING: {
+      JSONParser::StringBuilder value;
+      if (!parser->ConsumeStringRaw(&value))
+        return TokenFailed(is_final, checkpoint);
+      Result result = HandlerResult(handler_->OnString(
+          value.CanBeStringPiece() ? value.AsStringPiece()
+                                   : StringPiece(value.AsString())));
+      return result == RESULT_OK ? EndValue() : result;
+    }
+
+    case JSONParser::T_NUMBER: {
+      StringPiece num_string;
+      if (!parser->ConsumeNumberRaw(&num_string))
+        return TokenFailed(is_final, checkpoint);
+
+      // Like JSONParser::ConsumeNumber(), make sure the number is followed by
+      // a token which is valid after it. This also tells whether the number
+      // may continue in the next chunk.
+      const Checkpoint number_end = SaveCheckpoint();
+      parser->NextChar();
+      switch (parser->GetNextToken()) {
+        case JSONParser::T_END_OF_INPUT:
+          if (!is_final) {
+            RestoreCheckpoint(checkpoint);
+            return RESULT_NEED_MORE_INPUT;
+          }
+          break;
+        case JSONParser::T_OBJECT_END:
+        case JSONParser::T_ARRAY_END:
+        case JSONParser::T_LIST_SEPARATOR:
+          break;
+        default:
+          parser->ReportError(JSONReader::JSON_SYNTAX_ERROR, 1);
+          return RESULT_ERROR;
+      }
+      RestoreCheckpoint(number_end);
+
+      bool accepted;
+      int num_int;
+      double num_double;
+      if (StringToInt(num_string, &num_int)) {
+        accepted = handler_->OnInteger(num_int);
+      } else if (StringToDouble(num_string.as_string(), &num_double) &&
+                 IsFinite(num_double)) {
+        accepted = handler_->OnDouble(num_double);
+      } else {
+        parser->ReportError(JSONReader::JSON_SYNTAX_ERROR, 1);
+        return RESULT_ERROR;
+      }
+      Result result = HandlerResult(accepted);
+      return result == RESULT_OK ? EndValue() : result;
+    }
+
+    case JSONParser::T_BOOL_TRUE:
+    case JSONParser::T_BOOL_FALSE:
+    case JSONParser::T_NULL: {
+      const char* literal = "null";
+      if (token == JSONParser::T_BOOL_TRUE)
+        literal = "true";
+      else if (token == JSONParser::T_BOOL_FALSE)
+        literal = "false";
+      if (!parser->ConsumeLiteralRaw(literal))
+        return TokenFailed(is_final, checkpoint);
+      Result result = HandlerResult(
+          token == JSONParser::T_NULL
+              ? handler_->OnNull()
+              : handler_->OnBoolean(token == JSONParser::T_BOOL_TRUE));
+      return result == RESULT_OK ? EndValue() : result;
+    }
+
+    default:
+      parser->ReportError(JSONReader::JSON_UNEXPECTED_TOKEN, 1);
+      return RESULT_ERROR;
+  }
+}
+
+JSONSaxReader::Result JSONSaxReader::EndContainer() {
+  bool is_object = containers_.back();
+  containers_.pop_back();
+  Result result = HandlerResult(is_object ? handler_->OnEndObject()
+                                          : handler_->OnEndArray());
+  return result == RESULT_OK ? EndValue() : result;
+}
+
+JSONSaxReader::Result JSONSaxReader::EndValue() {
+  parser_->NextChar();
+  state_ = containers_.empty() ? STATE_DONE : STATE_SEPARATOR_OR_END;
+  return RESULT_OK;
+}
+
+JSONSaxReader::Result JSONSaxReader::TokenFailed(
+    bool is_final,
+    const Checkpoint& checkpoint) {
+  JSONParser* parser = parser_.get();
+  if (is_final || parser->end_pos_ - parser->pos_ > kMaxTokenLookahead)
+    return RESULT_ERROR;
+
+  // The token is retried from its start with the next chunk, which reports
+  // the error again if it really is malformed.
+  RestoreCheckpoint(checkpoint);
+  parser->error_code_ = JSONReader::JSON_NO_ERROR;
+  parser->error_line_ = 0;
+  parser->error_column_ = 0;
+  return RESULT_NEED_MORE_INPUT;
+}
+
+JSONSaxReader::Checkpoint JSONSaxReader::SaveCheckpoint() const {
+  Checkpoint checkpoint;
+  checkpoint.pos = parser_->pos_;
+  checkpoint.index = parser_->index_;
+  checkpoint.line_number = parser_->line_number_;
+  checkpoint.index_last_line = parser_->index_last_line_;
+  return checkpoint;
+}
+
+void JSONSaxReader::RestoreCheckpoint(const Checkpoint& checkpoint) {
+  parser_->pos_ = checkpoint.pos;
+  parser_->index_ = checkpoint.index;
+  parser_->line_number_ = checkpoint.line_number;
+  parser_->index_last_line_ = checkpoint.index_last_line;
+}
+
+JSONSaxReader::Result JSONSaxReader::HandlerResult(bool accepted) {
+  return accepted ? RESULT_OK : RESULT_ERROR;
+}
+
+}  // namespace base
@@ -0,0 +1,206 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+//
+// An event-driven ("SAX") JSON reader. Instead of building a Value tree like
+// JSONReader, it reports the structure of the document to a JSONSaxHandler
+// as it is tokenized, so that callers which only need a few fields don't pay
+// for allocating and destroying the whole tree.
+//
+// The input can be fed incrementally: JSONSaxReader only buffers the bytes of
+// the token being read when a chunk ends, so a document of any size is
+// processed in memory bounded by the chunk size and the longest token.
+//
+// Parsing follows the same grammar, options, limits and error codes as
+// JSONReader (see json_reader.h), and error line and column numbers are
+// relative to the start of the whole document.
+//
+// Example:
+//   class TitleFinder : public base::JSONSaxHandler { ... };
+//   TitleFinder finder;
+//   base::JSONSaxReader reader(&finder, base::JSON_PARSE_RFC);
+//   while (ReadChunk(&chunk)) {
+//     if (!reader.Feed(chunk))
+//       break;
+//   }
+//   if (!reader.Finish())
+//     LOG(ERROR) << reader.GetErrorMessage();
+
+#ifndef BASE_JSON_JSON_SAX_READER_H_
+#define BASE_JSON_JSON_SAX_READER_H_
+
+#include <string>
+#include <vector>
+
+#include "base/base_export.h"
+#include "base/basictypes.h"
+#include "base/json/json_reader.h"
+#include "base/memory/scoped_ptr.h"
+#include "base/strings/string_piece.h"
+
+namespace base {
+
+namespace internal {
+class JSONParser;
+}
+
+// Receives the events of a JSONSaxReader. The StringPiece arguments are only
+// valid for the duration of the call. Returning false from any method stops
+// parsing; the reader then fails without setting an error code.
+class BASE_EXPORT JSONSaxHandler {
+ public:
+  virtual ~JSONSaxHandler() {}
+
+  virtual bool OnStartObject() = 0;
+  virtual bool OnEndObject() = 0;
+  virtual bool OnStartArray() = 0;
+  virtual bool OnEndArray() = 0;
+
+  // Called for every key of an object, before the events of its value.
+  virtual bool OnKey(const StringPiece& key) = 0;
+
+  // Scalars. As with JSONReader, numbers which fit in an int are reported as
+  // integers, and other numbers as doubles.
+  virtual bool OnString(const StringPiece& value) = 0;
+  virtual bool OnInteger(int value) = 0;
+  virtual bool OnDouble(double value) = 0;
+  virtual bool OnBoolean(bool value) = 0;
+  virtual bool OnNull() = 0;
+};
+
+class BASE_EXPORT JSONSaxReader {
+ public:
+  // |handler| must outlive the reader. |options| are JSONParserOptions;
+  // JSON_DETACHABLE_CHILDREN has no effect since no Value is built.
+  JSONSaxReader(JSONSaxHandler* handler, int options);
+  ~JSONSaxReader();
+
+  // Parses the complete document |json|, reporting its events to |handler|.
+  // Returns false if the document is malformed or the handler stopped
+  // parsing.
+  static bool Parse(const StringPiece& json,
+                    JSONSaxHandler* handler,
+                    int options);
+
+  // Same as Parse(), on a reader which has not been fed yet, for handlers
+  // which need token_begin() and token_end(). |json| is not copied.
+  bool ParseComplete(const StringPiece& json);
+
+  // Parses the next |chunk| of the document. Events are reported for all the
+  // tokens which are complete; the rest is buffered until the next call.
+  // Returns false if the input is malformed or the handler stopped parsing,
+  // after which the reader must not be fed anymore.
+  bool Feed(const StringPiece& chunk);
+
+  // Signals the end of the document and parses the buffered input. Returns
+  // false if the document is malformed or incomplete, or if the handler
+  // stopped parsing.
+  bool Finish();
+
+  // Returns the error code if parsing failed, JSON_NO_ERROR otherwise.
+  JSONReader::JsonParseError error_code() const;
+
+  // Converts the error code to a human-readable string, including line and
+  // column numbers if appropriate.
+  std::string GetErrorMessage() const;
+
+  // During a call to the handler, the offsets in the whole input of the first
+  // byte of the token being reported and of the byte following it. The token
+  // is the key for OnKey(), the bracket for the container events, and the
+  // value for the scalar events.
+  size_t token_begin() const;
+  size_t token_end() const;
+
+ private:
+  // Where the reader is in the grammar, i.e. what the next token may be.
+  enum State {
+    STATE_VALUE,              // The root value, or the value after a ':'.
+    STATE_ARRAY_FIRST_VALUE,  // After '['.
+    STATE_ARRAY_NEXT_VALUE,   // After ',' in an array.
+    STATE_OBJECT_FIRST_KEY,   // After '{'.
+    STATE_OBJECT_NEXT_KEY,    // After ',' in an object.
+    STATE_PAIR_SEPARATOR,     // After a key.
+    STATE_SEPARATOR_OR_END,   // After a value in an array or object.
+    STATE_DONE,               // After the root value.
+  };
+
+  enum Result {
+    RESULT_OK,
+    RESULT_NEED_MORE_INPUT,
+    RESULT_DONE,
+    RESULT_ERROR,
+  };
+
+  // The position of the parser before a token, to rewind to when the token
+  // is cut by the end of the buffered input.
+  struct Checkpoint {
+    const char* pos;
+    int index;
+    int line_number;
+    int index_last_line;
+  };
+
+  // Parses as many tokens of |buffer_| as possible, then drops the consumed
+  // bytes from it. |is_final| is true if no more input will follow.
+  bool ParseBuffer(bool is_final);
+
+  // Parses as many tokens of |input| as possible, and sets |consumed| to the
+  // number of bytes which won't be needed anymore.
+  bool ParseInput(const StringPiece& input, bool is_final, size_t* consumed);
+
+  // Parses the next token. On success, the parser is left on the first byte
+  // following the token.
+  Result ParseNextToken(bool is_final);
+
+  // Parses the token starting a value.
+  Result ParseValue(int token, bool is_final, const Checkpoint& checkpoint);
+
+  // Reports the end of the innermost array or object.
+  Result EndContainer();
+
+  // Moves the parser past the current token and updates |state_| after a
+  // complete value.
+  Result EndValue();
+
+  // Called when a token could not be consumed. Returns RESULT_NEED_MORE_INPUT
+  // and rewinds the parser to |checkpoint| if the token may continue in the
+  // next chunk, RESULT_ERROR otherwise.
+  Result TokenFailed(bool is_final, const Checkpoint& checkpoint);
+
+  Checkpoint SaveCheckpoint() const;
+  void RestoreCheckpoint(const Checkpoint& checkpoint);
+
+  // Returns RESULT_OK if the handler accepted the event.
+  Result HandlerResult(bool accepted);
+
+  JSONSaxHandler* handler_;
+  int options_;
+
+  // Provides the tokenizer and the error reporting.
+  scoped_ptr<internal::JSONParser> parser_;
+
+  // The input which has not been consumed yet.
+  std::string buffer_;
+
+  // The number of bytes of the input which have been consumed and dropped
+  // before the current buffer, and the index in the current buffer of the
+  // token being parsed.
+  size_t consumed_;
+  int token_index_;
+
+  State state_;
+
+  // One entry per open container: true for objects, false for arrays.
+  std::vector<bool> containers_;
+
+  // Whether a byte-order mark may still start the input.
+  bool at_start_;
+
+  bool failed_;
+
+  DISALLOW_COPY_AND_ASSIGN(JSONSaxReader);
+};
+
+}  // namespace base
+
+#endif  // BASE_JSON_JSON_SAX_READER_H_
@@ -0,0 +1,133 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <string>
+
+#include "base/json/json_reader.h"
+#include "base/json/json_sax_reader.h"
+#include "base/memory/scoped_ptr.h"
+#include "base/strings/stringprintf.h"
+#include "base/time/time.h"
+#include "base/values.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "testing/perf/perf_test.h"
+
+namespace base {
+
+namespace {
+
+const int kNumRecords = 100000;
+const size_t kChunkSize = 64 * 1024;
+
+// Builds a list of records, each with a few fields of every type.
+std::string BuildDocument() {
+  std::string json = "[";
+  for (int i = 0; i < kNumRecords; ++i) {
+    if (i)
+      json += ",";
+    StringAppendF(&json,
+                  "{\"id\": %d, \"name\": \"record %d\", \"score\": %d.25, "
+                  "\"active\": %s, \"parent\": null, "
+                  "\"tags\": [\"alpha\", \"beta\", \"gamma\\t\"], "
+                  "\"position\": {\"x\": %d, \"y\": -%d}}",
+                  i, i, i % 100, i % 2 ? "true" : "false", i, i);
+  }
+  json += "]";
+  return json;
+}
+
+// Sums the "id" fields of the records, the way a caller which only needs one
+// field would use the SAX interface.
+class IdSummer : public JSONSaxHandler {
+ public:
+  IdSummer() : depth_(0), in_id_(false), sum_(0) {}
+
+  int64 sum() const { return sum_; }
+
+  // JSONSaxHandler implementation:
+  virtual bool OnStartObject() override {
+    ++depth_;
+    return true;
+  }
+  virtual bool OnEndObject() override {
+    --depth_;
+    return true;
+  }
+  virtual bool OnStartArray() override { return true; }
+  virtual bool OnEndArray() override { return true; }
+  virtual bool OnKey(const StringPiece& key) override {
+    in_id_ = depth_ == 1 && key == "id";
+    return true;
+  }
+  virtual bool OnString(const StringPiece& value) override { return true; }
+  virtual bool OnInteger(int value) override {
+    if (in_id_)
+      sum_ += value;
+    return true;
+  }
+  virtual bool OnDouble(double value) override { return true; }
+  virtual bool OnBoolean(bool value) override { return true; }
+  virtual bool OnNull() override { return true; }
+
+ private:
+  int depth_;
+  bool in_id_;
+  int64 sum_;
+
+  DISALLOW_COPY_AND_ASSIGN(IdSummer);
+};
+
+void PrintThroughput(const std::string& trace,
+                     size_t bytes,
+                     TimeDelta elapsed) {
+  perf_test::PrintResult("json_read", "", trace,
+                         bytes / elapsed.InSecondsF() / (1024 * 1024), "MB/s",
+                         true);
+}
+
+TEST(JSONSaxReaderPerfTest, SaxVersusDom) {
+  const std::string json = BuildDocument();
+  const int64 expected_sum =
+      static_cast<int64>(kNumRecords) * (kNumRecords - 1) / 2;
+
+  // DOM: build the tree, then look the field up in every record.
+  TimeTicks start = TimeTicks::HighResNow();
+  {
+    scoped_ptr<Value> root(JSONReader::Read(json));
+    ListValue* list = NULL;
+    ASSERT_TRUE(root && root->GetAsList(&list));
+    int64 sum = 0;
+    for (size_t i = 0; i < list->GetSize(); ++i) {
+      DictionaryValue* record = NULL;
+      int id = 0;
+      ASSERT_TRUE(list->GetDictionary(i, &record));
+      ASSERT_TRUE(record->GetInteger("id", &id));
+      sum += id;
+    }
+    EXPECT_EQ(expected_sum, sum);
+  }
+  // The tree is destroyed within the measurement.
+  PrintThroughput("dom", json.size(), TimeTicks::HighResNow() - start);
+
+  // SAX, with the whole document at once.
+  start = TimeTicks::HighResNow();
+  IdSummer summer;
+  ASSERT_TRUE(JSONSaxReader::Parse(json, &summer, JSON_PARSE_RFC));
+  PrintThroughput("sax", json.size(), TimeTicks::HighResNow() - start);
+  EXPECT_EQ(expected_sum, summer.sum());
+
+  // SAX, fed in chunks as when streaming from a file.
+  start = TimeTicks::HighResNow();
+  IdSummer chunked_summer;
+  JSONSaxReader reader(&chunked_summer, JSON_PARSE_RFC);
+  for (size_t i = 0; i < json.size(); i += kChunkSize)
+    ASSERT_TRUE(reader.Feed(StringPiece(json).substr(i, kChunkSize)));
+  ASSERT_TRUE(reader.Finish());
+  PrintThroughput("sax_chunked", json.size(), TimeTicks::HighResNow() - start);
+  EXPECT_EQ(expected_sum, chunked_summer.sum());
+}
+
+}  // namespace
+
+}  // namespace base
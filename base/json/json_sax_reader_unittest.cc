@@ -0,0 +1,279 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/json/json_sax_reader.h"
+
+#include <string>
+
+#include "base/json/json_reader.h"
+#include "base/memory/scoped_ptr.h"
+#include "base/strings/string_number_conversions.h"
+#include "base/values.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace base {
+
+namespace {
+
+// Records the events as a compact string, e.g. {K(a)[I(1)S(b)]}.
+class EventRecorder : public JSONSaxHandler {
+ public:
+  EventRecorder() {}
+
+  // Makes OnKey() stop parsing when it sees |key|.
+  void set_stop_key(const std::string& key) { stop_key_ = key; }
+
+  const std::string& events() const { return events_; }
+
+  // JSONSaxHandler implementation:
+  virtual bool OnStartObject() override {
+    events_ += "{";
+    return true;
+  }
+  virtual bool OnEndObject() override {
+    events_ += "}";
+    return true;
+  }
+  virtual bool OnStartArray() override {
+    events_ += "[";
+    return true;
+  }
+  virtual bool OnEndArray() override {
+    events_ += "]";
+    return true;
+  }
+  virtual bool OnKey(const StringPiece& key) override {
+    events_ += "K(" + key.as_string() + ")";
+    return key != stop_key_;
+  }
+  virtual bool OnString(const StringPiece& value) override {
+    events_ += "S(" + value.as_string() + ")";
+    return true;
+  }
+  virtual bool OnInteger(int value) override {
+    events_ += "I(" + IntToString(value) + ")";
+    return true;
+  }
+  virtual bool OnDouble(double value) override {
+    events_ += "D(" + DoubleToString(value) + ")";
+    return true;
+  }
+  virtual bool OnBoolean(bool value) override {
+    events_ += value ? "T" : "F";
+    return true;
+  }
+  virtual bool OnNull() override {
+    events_ += "N";
+    return true;
+  }
+
+ private:
+  std::string events_;
+  std::string stop_key_;
+
+  DISALLOW_COPY_AND_ASSIGN(EventRecorder);
+};
+
+// Records the text of the token of each event, from the offsets given by the
+// reader, separated by spaces.
+class TokenRecorder : public JSONSaxHandler {
+ public:
+  explicit TokenRecorder(const std::string& json) : json_(json), reader_(NULL) {
+  }
+
+  void set_reader(const JSONSaxReader* reader) { reader_ = reader; }
+
+  const std::string& tokens() const { return tokens_; }
+
+  // JSONSaxHandler implementation:
+  virtual bool OnStartObject() override { return Record(); }
+  virtual bool OnEndObject() override { return Record(); }
+  virtual bool OnStartArray() override { return Record(); }
+  virtual bool OnEndArray() override { return Record(); }
+  virtual bool OnKey(const StringPiece& key) override { return Record(); }
+  virtual bool OnString(const StringPiece& value) override { return Record(); }
+  virtual bool OnInteger(int value) override { return Record(); }
+  virtual bool OnDouble(double value) override { return Record(); }
+  virtual bool OnBoolean(bool value) override { return Record(); }
+  virtual bool OnNull() override { return Record(); }
+
+ private:
+  bool Record() {
+    if (!tokens_.empty())
+      tokens_ += " ";
+    tokens_ += json_.substr(reader_->token_begin(),
+                            reader_->token_end() - reader_->token_begin());
+    return true;
+  }
+
+  const std::string json_;
+  const JSONSaxReader* reader_;
+  std::string tokens_;
+
+  DISALLOW_COPY_AND_ASSIGN(TokenRecorder);
+};
+
+// Feeds |json| to a reader in chunks of |chunk_size| bytes. Returns whether
+// parsing succeeded, and the events and error message.
+bool ParseInChunks(const std::string& json,
+                   size_t chunk_size,
+                   std::string* events,
+                   std::string* error_message) {
+  EventRecorder recorder;
+  JSONSaxReader reader(&recorder, JSON_PARSE_RFC);
+  bool success = true;
+  for (size_t i = 0; i < json.size() && success; i += chunk_size)
+    success = reader.Feed(StringPiece(json).substr(i, chunk_size));
+  if (success)
+    success = reader.Finish();
+  *events = recorder.events();
+  *error_message = reader.GetErrorMessage();
+  return success;
+}
+
+}  // namespace
+
+TEST(JSONSaxReaderTest, Events) {
+  EventRecorder recorder;
+  EXPECT_TRUE(JSONSaxReader::Parse(
+      "{\"a\": [1, -2.5, true, false, null, \"x\\ty\"], \"b\": {}, \"c\": []}",
+      &recorder, JSON_PARSE_RFC));
+  EXPECT_EQ("{K(a)[I(1)D(-2.5)TFNS(x\ty)]K(b){}K(c)[]}", recorder.events());
+
+  EventRecorder scalar_recorder;
+  EXPECT_TRUE(JSONSaxReader::Parse("  \"\\u00e9\" ", &scalar_recorder,
+                                   JSON_PARSE_RFC));
+  EXPECT_EQ("S(\xC3\xA9)", scalar_recorder.events());
+}
+
+TEST(JSONSaxReaderTest, IncrementalInput) {
+  const std::string json =
+      "\xEF\xBB\xBF{\n"
+      "  // Comment.\n"
+      "  \"key\\u0041\": [12345, 1.5e10, \"\xC3\xA9\\uD83D\\uDE00\"],\r\n"
+      "  /* Block\n   comment. */ \"literals\": [true, false, null]\n"
+      "}\n";
+  EventRecorder recorder;
+  ASSERT_TRUE(JSONSaxReader::Parse(json, &recorder, JSON_PARSE_RFC));
+  EXPECT_EQ("{K(keyA)[I(12345)D(1.5e+10)S(\xC3\xA9\xF0\x9F\x98\x80)]"
+            "K(literals)[TFN]}",
+            recorder.events());
+
+  // Any split of the input gives the same events.
+  for (size_t chunk_size = 1; chunk_size < 8; ++chunk_size) {
+    std::string events;
+    std::string error_message;
+    EXPECT_TRUE(ParseInChunks(json, chunk_size, &events, &error_message))
+        << chunk_size;
+    EXPECT_EQ(recorder.events(), events) << chunk_size;
+  }
+}
+
+TEST(JSONSaxReaderTest, ErrorsMatchJSONReader) {
+  const char* const kInvalidInputs[] = {
+    "",
+    "[",
+    "[1 2]",
+    "[1,2,]",
+    "{\"a\":1,}",
+    "{\"a\" 1}",
+    "{a:1}",
+    "[1] x",
+    "[tru]",
+    "[\"\\q\"]",
+    "[1,\n 2,\r\n  x]",
+    "{\"a\":\n\"unterminated",
+  };
+  for (size_t i = 0; i < arraysize(kInvalidInputs); ++i) {
+    const std::string json = kInvalidInputs[i];
+    int error_code = JSONReader::JSON_NO_ERROR;
+    std::string error_message;
+    scoped_ptr<Value> value(JSONReader::ReadAndReturnError(
+        json, JSON_PARSE_RFC, &error_code, &error_message));
+    ASSERT_FALSE(value) << json;
+
+    EventRecorder recorder;
+    JSONSaxReader reader(&recorder, JSON_PARSE_RFC);
+    EXPECT_FALSE(reader.Feed(json) && reader.Finish()) << json;
+    EXPECT_EQ(error_code, reader.error_code()) << json;
+    EXPECT_EQ(error_message, reader.GetErrorMessage()) << json;
+
+    // Errors are reported at the same position when the input is split.
+    std::string events;
+    std::string chunked_error_message;
+    EXPECT_FALSE(ParseInChunks(json, 1, &events, &chunked_error_message));
+    EXPECT_EQ(recorder.events(), events) << json;
+    EXPECT_EQ(error_message, chunked_error_message) << json;
+  }
+}
+
+TEST(JSONSaxReaderTest, TrailingCommas) {
+  EventRecorder recorder;
+  EXPECT_TRUE(JSONSaxReader::Parse("{\"a\": [1, 2,],}", &recorder,
+                                   JSON_ALLOW_TRAILING_COMMAS));
+  EXPECT_EQ("{K(a)[I(1)I(2)]}", recorder.events());
+}
+
+TEST(JSONSaxReaderTest, Nesting) {
+  std::string too_deep(100, '[');
+  too_deep.append(100, ']');
+  EventRecorder recorder;
+  JSONSaxReader reader(&recorder, JSON_PARSE_RFC);
+  EXPECT_FALSE(reader.Feed(too_deep));
+  EXPECT_EQ(JSONReader::JSON_TOO_MUCH_NESTING, reader.error_code());
+
+  std::string deep(99, '[');
+  deep.append(99, ']');
+  EventRecorder deep_recorder;
+  EXPECT_TRUE(JSONSaxReader::Parse(deep, &deep_recorder, JSON_PARSE_RFC));
+  EXPECT_EQ(deep, deep_recorder.events());
+}
+
+TEST(JSONSaxReaderTest, HandlerStopsParsing) {
+  EventRecorder recorder;
+  recorder.set_stop_key("stop");
+  JSONSaxReader reader(&recorder, JSON_PARSE_RFC);
+  EXPECT_FALSE(reader.Feed("{\"a\": 1, \"stop\": 2, \"b\": 3}"));
+  EXPECT_EQ("{K(a)I(1)K(stop)", recorder.events());
+  EXPECT_EQ(JSONReader::JSON_NO_ERROR, reader.error_code());
+  EXPECT_FALSE(reader.Finish());
+}
+
+TEST(JSONSaxReaderTest, IncompleteDocument) {
+  EventRecorder recorder;
+  JSONSaxReader reader(&recorder, JSON_PARSE_RFC);
+  EXPECT_TRUE(reader.Feed("{\"a\": [1, 2"));
+  // The last number may still continue, so it is not reported yet.
+  EXPECT_EQ("{K(a)[I(1)", recorder.events());
+  EXPECT_FALSE(reader.Finish());
+  EXPECT_EQ("{K(a)[I(1)I(2)", recorder.events());
+  EXPECT_EQ(JSONReader::JSON_SYNTAX_ERROR, reader.error_code());
+}
+
+TEST(JSONSaxReaderTest, TokenOffsets) {
+  const std::string json =
+      "\xEF\xBB\xBF{\"a\\n\": [1.5e3, true, null],\n"
+      "  /* Comment. */ \"b\": {\"c\": \"d\"}}";
+  const std::string kExpected =
+      "{ \"a\\n\" [ 1.5e3 true null ] \"b\" { \"c\" \"d\" } }";
+
+  TokenRecorder recorder(json);
+  JSONSaxReader reader(&recorder, JSON_PARSE_RFC);
+  recorder.set_reader(&reader);
+  EXPECT_TRUE(reader.ParseComplete(json));
+  EXPECT_EQ(kExpected, recorder.tokens());
+
+  // The offsets are relative to the whole input when it is fed in chunks.
+  for (size_t chunk_size = 1; chunk_size < 8; ++chunk_size) {
+    TokenRecorder chunk_recorder(json);
+    JSONSaxReader chunk_reader(&chunk_recorder, JSON_PARSE_RFC);
+    chunk_recorder.set_reader(&chunk_reader);
+    for (size_t i = 0; i < json.size(); i += chunk_size)
+      ASSERT_TRUE(chunk_reader.Feed(StringPiece(json).substr(i, chunk_size)));
+    EXPECT_TRUE(chunk_reader.Finish());
+    EXPECT_EQ(kExpected, chunk_recorder.tokens()) << chunk_size;
+  }
+}
+
+}  // namespace base
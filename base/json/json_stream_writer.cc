@@ -0,0 +1,337 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/json/json_stream_writer.h"
+
+#include <cmath>
+
+#include "base/json/json_writer.h"
+#include "base/json/string_escape.h"
+#include "base/lazy_instance.h"
+#include "base/logging.h"
+#include "base/strings/string_number_conversions.h"
+
+namespace base {
+
+namespace {
+
+#if defined(OS_WIN)
+const char kPrettyPrintLineEnding[] = "\r\n";
+#else
+const char kPrettyPrintLineEnding[] = "\n";
+#endif
+
+// Iterated by the frames of lists, which don't use their dictionary iterator.
+LazyInstance<DictionaryValue>::Leaky g_empty_dictionary =
+    LAZY_INSTANCE_INITIALIZER;
+
+}  // namespace
+
+JSONStreamWriter::Frame::Frame(const ListValue* list, size_t depth)
+    : list(list),
+      list_it(list->begin()),
+      dictionary_it(g_empty_dictionary.Get()),
+      depth(depth),
+      first_value_has_been_output(false) {
+}
+
+JSONStreamWriter::Frame::Frame(const DictionaryValue* dictionary,
+                               size_t depth)
+    : list(NULL),
+      dictionary_it(*dictionary),
+      depth(depth),
+      first_value_has_been_output(false) {
+}
+
+JSONStreamWriter::FileSink::FileSink(File* file) : file_(file) {
+  DCHECK(file_);
+}
+
+JSONStreamWriter::FileSink::FileSink(PlatformFile file)
+    : owned_file_(new File(file)),
+      file_(owned_file_.get()) {
+}
+
+JSONStreamWriter::FileSink::~FileSink() {
+  if (owned_file_)
+    owned_file_->TakePlatformFile();
+}
+
+bool JSONStreamWriter::FileSink::Write(const char* data, size_t size) {
+  int int_size = static_cast<int>(size);
+  return file_->WriteAtCurrentPos(data, int_size) == int_size;
+}
+
+JSONStreamWriter::ChunkedMemorySink::ChunkedMemorySink() : size_(0) {
+}
+
+JSONStreamWriter::ChunkedMemorySink::~ChunkedMemorySink() {
+}
+
+bool JSONStreamWriter::ChunkedMemorySink::Write(const char* data,
+                                                size_t size) {
+  std::string chunk(data, size);
+  chunks_.push_back(RefCountedString::TakeString(&chunk));
+  size_ += size;
+  return true;
+}
+
+// static
+const size_t JSONStreamWriter::kBufferSize = 16 * 1024;
+
+JSONStreamWriter::JSONStreamWriter(const Value* root, int options, Sink* sink)
+    : root_(root),
+      omit_binary_values_(
+          (options & JSONWriter::OPTIONS_OMIT_BINARY_VALUES) != 0),
+      omit_double_type_preservation_(
+          (options & JSONWriter::OPTIONS_OMIT_DOUBLE_TYPE_PRESERVATION) != 0),
+      pretty_print_((options & JSONWriter::OPTIONS_PRETTY_PRINT) != 0),
+      sink_(sink),
+      output_(&buffer_),
+      started_(false),
+      done_(false),
+      has_binary_value_(false),
+      sink_failed_(false),
+      bytes_written_(0) {
+  DCHECK(root_);
+  DCHECK(sink_);
+  // Leave room for the value which crosses the limit.
+  buffer_.reserve(2 * kBufferSize);
+}
+
+JSONStreamWriter::JSONStreamWriter(const Value* root,
+                                   int options,
+                                   std::string* output)
+    : root_(root),
+      omit_binary_values_(
+          (options & JSONWriter::OPTIONS_OMIT_BINARY_VALUES) != 0),
+      omit_double_type_preservation_(
+          (options & JSONWriter::OPTIONS_OMIT_DOUBLE_TYPE_PRESERVATION) != 0),
+      pretty_print_((options & JSONWriter::OPTIONS_PRETTY_PRINT) != 0),
+      sink_(NULL),
+      output_(output),
+      started_(false),
+      done_(false),
+      has_binary_value_(false),
+      sink_failed_(false),
+      bytes_written_(0) {
+  DCHECK(root_);
+  DCHECK(output_);
+}
+
+JSONStreamWriter::~JSONStreamWriter() {
+}
+
+bool JSONStreamWriter::Write() {
+  while (!WriteSome(kBufferSize)) {
+  }
+  return succeeded();
+}
+
+bool JSONStreamWriter::WriteSome(size_t max_bytes) {
+  const int64 start = bytes_written_ + output_->size();
+  while (!done_ &&
+         static_cast<uint64>(bytes_written_ + output_->size() - start) <
+             max_bytes) {
+    if (!started_) {
+      started_ = true;
+      WriteValue(root_, 0U);
+    } else {
+      WriteNext();
+    }
+
+    if (frames_.empty()) {
+      if (pretty_print_)
+        output_->append(kPrettyPrintLineEnding);
+      done_ = true;
+    } else if (buffer_.size() >= kBufferSize) {
+      Flush();
+    }
+  }
+  Flush();
+  return done_;
+}
+
+void JSONStreamWriter::WriteValue(const Value* node, size_t depth) {
+  switch (node->GetType()) {
+    case Value::TYPE_NULL: {
+      output_->append("null");
+      return;
+    }
+
+    case Value::TYPE_BOOLEAN: {
+      bool value;
+      bool result = node->GetAsBoolean(&value);
+      DCHECK(result);
+      output_->append(value ? "true" : "false");
+      return;
+    }
+
+    case Value::TYPE_INTEGER: {
+      int value;
+      bool result = node->GetAsInteger(&value);
+      DCHECK(result);
+      output_->append(IntToString(value));
+      return;
+    }
+
+    case Value::TYPE_DOUBLE: {
+      double value;
+      bool result = node->GetAsDouble(&value);
+      DCHECK(result);
+      if (omit_double_type_preservation_ &&
+          value <= kint64max &&
+          value >= kint64min &&
+          std::floor(value) == value) {
+        output_->append(Int64ToString(static_cast<int64>(value)));
+        return;
+      }
+      std::string real = DoubleToString(value);
+      // Ensure that the number has a .0 if there's no decimal or 'e'.  This
+      // makes sure that when we read the JSON back, it's interpreted as a
+      // real rather than an int.
+      if (real.find('.') == std::string::npos &&
+          real.find('e') == std::string::npos &&
+          real.find('E') == std::string::npos) {
+        real.append(".0");
+      }
+      // The JSON spec requires that non-integer values in the range (-1,1)
+      // have a zero before the decimal point - ".52" is not valid, "0.52" is.
+      if (real[0] == '.') {
+        real.insert(static_cast<size_t>(0), static_cast<size_t>(1), '0');
+      } else if (real.length() > 1 && real[0] == '-' && real[1] == '.') {
+        // "-.1" bad "-0.1" good
+        real.insert(static_cast<size_t>(1), static_cast<size_t>(1), '0');
+      }
+      output_->append(real);
+      return;
+    }
+
+    case Value::TYPE_STRING: {
+      std::string value;
+      bool result = node->GetAsString(&value);
+      DCHECK(result);
+      EscapeJSONString(value, true, output_);
+      return;
+    }
+
+    case Value::TYPE_LIST: {
+      output_->push_back('[');
+      if (pretty_print_)
+        output_->push_back(' ');
+
+      const ListValue* list = NULL;
+      bool result = node->GetAsList(&list);
+      DCHECK(result);
+      frames_.push_back(Frame(list, depth));
+      return;
+    }
+
+    case Value::TYPE_DICTIONARY: {
+      output_->push_back('{');
+      if (pretty_print_)
+        output_->append(kPrettyPrintLineEnding);
+
+      const DictionaryValue* dict = NULL;
+      bool result = node->GetAsDictionary(&dict);
+      DCHECK(result);
+      frames_.push_back(Frame(dict, depth));
+      return;
+    }
+
+    case Value::TYPE_BINARY:
+      // Successful only if we're allowed to omit it.
+      DLOG_IF(ERROR, !omit_binary_values_) << "Cannot serialize binary value.";
+      if (!omit_binary_values_)
+        has_binary_value_ = true;
+      return;
+  }
+  NOTREACHED();
+}
+
+void JSONStreamWriter::WriteNext() {
+  Frame* frame = &frames_.back();
+
+  if (frame->list) {
+    while (frame->list_it != frame->list->end() && omit_binary_values_ &&
+           (*frame->list_it)->GetType() == Value::TYPE_BINARY) {
+      ++frame->list_it;
+    }
+
+    if (frame->list_it == frame->list->end()) {
+      if (pretty_print_)
+        output_->push_back(' ');
+      output_->push_back(']');
+      frames_.pop_back();
+      return;
+    }
+
+    if (frame->first_value_has_been_output) {
+      output_->push_back(',');
+      if (pretty_print_)
+        output_->push_back(' ');
+    }
+    frame->first_value_has_been_output = true;
+
+    const Value* value = *frame->list_it;
+    ++frame->list_it;
+    WriteValue(value, frame->depth);
+    return;
+  }
+
+  DictionaryValue::Iterator* it = &frame->dictionary_it;
+  while (!it->IsAtEnd() && omit_binary_values_ &&
+         it->value().GetType() == Value::TYPE_BINARY) {
+    it->Advance();
+  }
+
+  if (it->IsAtEnd()) {
+    if (pretty_print_) {
+      output_->append(kPrettyPrintLineEnding);
+      IndentLine(frame->depth);
+    }
+    output_->push_back('}');
+    frames_.pop_back();
+    return;
+  }
+
+  if (frame->first_value_has_been_output) {
+    output_->push_back(',');
+    if (pretty_print_)
+      output_->append(kPrettyPrintLineEnding);
+  }
+  frame->first_value_has_been_output = true;
+
+  if (pretty_print_)
+    IndentLine(frame->depth + 1U);
+
+  EscapeJSONString(it->key(), true, output_);
+  output_->push_back(':');
+  if (pretty_print_)
+    output_->push_back(' ');
+
+  const Value* value = &it->value();
+  it->Advance();
+  WriteValue(value, frame->depth + 1U);
+}
+
+void JSONStreamWriter::IndentLine(size_t depth) {
+  output_->append(depth * 3U, ' ');
+}
+
+void JSONStreamWriter::Flush() {
+  if (!sink_ || buffer_.empty() || sink_failed_)
+    return;
+
+  if (!sink_->Write(buffer_.data(), buffer_.size())) {
+    DLOG(ERROR) << "Failed to write JSON";
+    sink_failed_ = true;
+    done_ = true;
+  } else {
+    bytes_written_ += buffer_.size();
+  }
+  buffer_.clear();
+}
+
+}  // namespace base
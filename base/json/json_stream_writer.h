@@ -0,0 +1,188 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+//
+// JSONStreamWriter serializes a Value tree like JSONWriter, with the same
+// options and output, but hands the output to a Sink through a small buffer
+// instead of building it in one string. Serializing a large tree to a file
+// therefore needs memory for the buffer only.
+//
+// Writing can also be done in slices with WriteSome(), e.g. one slice per
+// task, so that a very large tree doesn't block a thread for long. The tree
+// must not be modified until the writer is done.
+//
+// Example:
+//   base::File file(path, base::File::FLAG_CREATE_ALWAYS |
+//                         base::File::FLAG_WRITE);
+//   base::JSONStreamWriter::FileSink sink(&file);
+//   base::JSONStreamWriter writer(
+//       &root, base::JSONWriter::OPTIONS_PRETTY_PRINT, &sink);
+//   if (!writer.Write())
+//     LOG(ERROR) << "Failed to write " << path.value();
+
+#ifndef BASE_JSON_JSON_STREAM_WRITER_H_
+#define BASE_JSON_JSON_STREAM_WRITER_H_
+
+#include <string>
+#include <vector>
+
+#include "base/base_export.h"
+#include "base/basictypes.h"
+#include "base/files/file.h"
+#include "base/memory/ref_counted.h"
+#include "base/memory/ref_counted_memory.h"
+#include "base/memory/scoped_ptr.h"
+#include "base/values.h"
+
+namespace base {
+
+class JSONWriter;
+
+class BASE_EXPORT JSONStreamWriter {
+ public:
+  // Receives the output of a JSONStreamWriter.
+  class BASE_EXPORT Sink {
+   public:
+    virtual ~Sink() {}
+
+    // Consumes the next |size| bytes of output. Returning false stops the
+    // writer, which then fails.
+    virtual bool Write(const char* data, size_t size) = 0;
+  };
+
+  // Writes the output to a file, at its current position.
+  class BASE_EXPORT FileSink : public Sink {
+   public:
+    // |file| must outlive the sink.
+    explicit FileSink(File* file);
+
+    // Writes to the already opened |file| descriptor or handle, which is not
+    // closed by the sink.
+    explicit FileSink(PlatformFile file);
+
+    virtual ~FileSink();
+
+    // Sink implementation:
+    virtual bool Write(const char* data, size_t size) override;
+
+   private:
+    scoped_ptr<File> owned_file_;
+    File* file_;
+
+    DISALLOW_COPY_AND_ASSIGN(FileSink);
+  };
+
+  // Keeps the output in memory as a list of chunks of about kBufferSize
+  // bytes, which avoids one large allocation, e.g. for sending it over IPC.
+  class BASE_EXPORT ChunkedMemorySink : public Sink {
+   public:
+    ChunkedMemorySink();
+    virtual ~ChunkedMemorySink();
+
+    const std::vector<scoped_refptr<RefCountedMemory> >& chunks() const {
+      return chunks_;
+    }
+
+    // Returns the total size of the chunks.
+    size_t size() const { return size_; }
+
+    // Sink implementation:
+    virtual bool Write(const char* data, size_t size) override;
+
+   private:
+    std::vector<scoped_refptr<RefCountedMemory> > chunks_;
+    size_t size_;
+
+    DISALLOW_COPY_AND_ASSIGN(ChunkedMemorySink);
+  };
+
+  // Size of the output buffer. Output is handed to the sink whenever the
+  // buffer is this full; a string longer than this is handed over at once.
+  static const size_t kBufferSize;
+
+  // |root| must stay alive and unmodified until the writer is done, and
+  // |sink| must outlive the writer. |options| are JSONWriter::Options.
+  JSONStreamWriter(const Value* root, int options, Sink* sink);
+  ~JSONStreamWriter();
+
+  // Writes the whole tree. Returns false if the tree contains a binary value
+  // and OPTIONS_OMIT_BINARY_VALUES is not set, as JSONWriter does, or if the
+  // sink failed.
+  bool Write();
+
+  // Writes the tree until at least |max_bytes| more bytes of output have been
+  // produced, then hands the buffered output to the sink. Returns true when
+  // the writer is done, i.e. when the whole tree has been written or the sink
+  // failed; succeeded() tells them apart.
+  bool WriteSome(size_t max_bytes);
+
+  // Returns false if the writer has failed so far. Once the writer is done,
+  // this is the result Write() would have returned.
+  bool succeeded() const { return !has_binary_value_ && !sink_failed_; }
+
+  // Returns the number of bytes handed to the sink so far.
+  int64 bytes_written() const { return bytes_written_; }
+
+ private:
+  friend class JSONWriter;
+
+  // A list or dictionary being written, and the position of the next child.
+  struct Frame {
+    Frame(const ListValue* list, size_t depth);
+    Frame(const DictionaryValue* dictionary, size_t depth);
+
+    // NULL for dictionaries.
+    const ListValue* list;
+    ListValue::const_iterator list_it;
+    // Unused for lists.
+    DictionaryValue::Iterator dictionary_it;
+
+    size_t depth;
+    bool first_value_has_been_output;
+  };
+
+  // Writes to |*output| directly, without a sink. Used by JSONWriter.
+  JSONStreamWriter(const Value* root, int options, std::string* output);
+
+  // Writes |node| if it is a scalar, or opens it and pushes a frame if it is
+  // a list or dictionary. |depth| is the indentation level of dictionary
+  // keys, which lists do not increase.
+  void WriteValue(const Value* node, size_t depth);
+
+  // Writes the next child of the top frame, or closes the frame.
+  void WriteNext();
+
+  // Appends the indentation for |depth| to the output.
+  void IndentLine(size_t depth);
+
+  // Hands the buffered output to the sink, if any.
+  void Flush();
+
+  const Value* root_;
+  bool omit_binary_values_;
+  bool omit_double_type_preservation_;
+  bool pretty_print_;
+
+  Sink* sink_;
+  std::string buffer_;
+
+  // Where the output is appended: |buffer_|, or the string given by
+  // JSONWriter.
+  std::string* output_;
+
+  // The frames are kept by value, so that writing a container doesn't
+  // allocate.
+  std::vector<Frame> frames_;
+  bool started_;
+  bool done_;
+
+  bool has_binary_value_;
+  bool sink_failed_;
+  int64 bytes_written_;
+
+  DISALLOW_COPY_AND_ASSIGN(JSONStreamWriter);
+};
+
+}  // namespace base
+
+#endif  // BASE_JSON_JSON_STREAM_WRITER_H_
@@ -0,0 +1,93 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <string>
+
+#include "base/json/json_stream_writer.h"
+#include "base/json/json_writer.h"
+#include "base/memory/scoped_ptr.h"
+#include "base/strings/string_number_conversions.h"
+#include "base/time/time.h"
+#include "base/values.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "testing/perf/perf_test.h"
+
+namespace base {
+
+namespace {
+
+const int kNumRecords = 100000;
+
+scoped_ptr<ListValue> BuildTree() {
+  scoped_ptr<ListValue> root(new ListValue);
+  for (int i = 0; i < kNumRecords; ++i) {
+    DictionaryValue* record = new DictionaryValue;
+    record->SetInteger("id", i);
+    record->SetString("name", "record " + IntToString(i));
+    record->SetDouble("score", i % 100 + 0.25);
+    record->SetBoolean("active", i % 2 != 0);
+    ListValue* tags = new ListValue;
+    tags->AppendString("alpha");
+    tags->AppendString("beta");
+    record->Set("tags", tags);
+    root->Append(record);
+  }
+  return root.Pass();
+}
+
+// Counts the output and remembers the largest piece it is handed, without
+// keeping anything.
+class CountingSink : public JSONStreamWriter::Sink {
+ public:
+  CountingSink() : size_(0), largest_write_(0) {}
+
+  virtual bool Write(const char* data, size_t size) override {
+    size_ += size;
+    if (size > largest_write_)
+      largest_write_ = size;
+    return true;
+  }
+
+  size_t size() const { return size_; }
+  size_t largest_write() const { return largest_write_; }
+
+ private:
+  size_t size_;
+  size_t largest_write_;
+};
+
+void PrintThroughput(const std::string& trace, size_t bytes,
+                     TimeDelta elapsed) {
+  perf_test::PrintResult("json_stream_writer", "", trace,
+                         bytes / elapsed.InSecondsF() / (1024 * 1024),
+                         "MB/s", true);
+}
+
+}  // namespace
+
+// Compares writing a large tree to a string, which is then handed on, with
+// streaming it through the writer's buffer.
+TEST(JSONStreamWriterPerfTest, StringVersusStream) {
+  scoped_ptr<ListValue> root = BuildTree();
+
+  TimeTicks start = TimeTicks::HighResNow();
+  std::string json;
+  EXPECT_TRUE(JSONWriter::Write(root.get(), &json));
+  TimeDelta string_time = TimeTicks::HighResNow() - start;
+
+  start = TimeTicks::HighResNow();
+  CountingSink sink;
+  EXPECT_TRUE(JSONStreamWriter(root.get(), 0, &sink).Write());
+  TimeDelta stream_time = TimeTicks::HighResNow() - start;
+  EXPECT_EQ(json.size(), sink.size());
+
+  PrintThroughput("string", json.size(), string_time);
+  PrintThroughput("stream", sink.size(), stream_time);
+  perf_test::PrintResult("json_stream_writer", "", "string_peak_buffer",
+                         json.capacity() / 1024, "KB", true);
+  perf_test::PrintResult("json_stream_writer", "", "stream_peak_buffer",
+                         sink.largest_write() / 1024, "KB", true);
+}
+
+}  // namespace base
@@ -0,0 +1,206 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/json/json_stream_writer.h"
+
+#include <string>
+
+#include "base/files/file.h"
+#include "base/files/file_path.h"
+#include "base/files/file_util.h"
+#include "base/files/scoped_temp_dir.h"
+#include "base/json/json_reader.h"
+#include "base/json/json_writer.h"
+#include "base/memory/scoped_ptr.h"
+#include "base/strings/string_number_conversions.h"
+#include "base/values.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace base {
+
+namespace {
+
+// Returns a tree whose JSON is several times larger than the buffer, with
+// nested lists and dictionaries, empty containers and a long string.
+scoped_ptr<DictionaryValue> BuildTree() {
+  scoped_ptr<DictionaryValue> root(new DictionaryValue);
+  for (int i = 0; i < 500; ++i) {
+    DictionaryValue* item = new DictionaryValue;
+    item->SetInteger("id", i);
+    item->SetString("name", "item \"" + IntToString(i) + "\"");
+    item->SetDouble("ratio", i / 4.0);
+    item->SetBoolean("odd", i % 2 != 0);
+    ListValue* list = new ListValue;
+    list->AppendInteger(i);
+    list->Append(new ListValue);
+    list->Append(new DictionaryValue);
+    list->Append(Value::CreateNullValue());
+    item->Set("list", list);
+    root->Set("item" + IntToString(i), item);
+  }
+  root->SetString("long", std::string(3 * JSONStreamWriter::kBufferSize, 'x'));
+  return root.Pass();
+}
+
+std::string Concatenate(const JSONStreamWriter::ChunkedMemorySink& sink) {
+  std::string output;
+  for (size_t i = 0; i < sink.chunks().size(); ++i) {
+    output.append(sink.chunks()[i]->front_as<char>(),
+                  sink.chunks()[i]->size());
+  }
+  EXPECT_EQ(sink.size(), output.size());
+  return output;
+}
+
+// Accepts |limit| bytes, then fails.
+class LimitedSink : public JSONStreamWriter::Sink {
+ public:
+  explicit LimitedSink(size_t limit) : limit_(limit) {}
+
+  virtual bool Write(const char* data, size_t size) override {
+    if (output_.size() + size > limit_)
+      return false;
+    output_.append(data, size);
+    return true;
+  }
+
+  const std::string& output() const { return output_; }
+
+ private:
+  size_t limit_;
+  std::string output_;
+};
+
+}  // namespace
+
+TEST(JSONStreamWriterTest, MatchesJSONWriter) {
+  scoped_ptr<DictionaryValue> root = BuildTree();
+  const int kOptions[] = {
+    0,
+    JSONWriter::OPTIONS_PRETTY_PRINT,
+    JSONWriter::OPTIONS_OMIT_DOUBLE_TYPE_PRESERVATION,
+  };
+  for (size_t i = 0; i < arraysize(kOptions); ++i) {
+    std::string expected;
+    EXPECT_TRUE(JSONWriter::WriteWithOptions(root.get(), kOptions[i],
+                                             &expected));
+
+    JSONStreamWriter::ChunkedMemorySink sink;
+    JSONStreamWriter writer(root.get(), kOptions[i], &sink);
+    EXPECT_TRUE(writer.Write());
+    EXPECT_TRUE(writer.succeeded());
+    EXPECT_EQ(expected, Concatenate(sink));
+    EXPECT_EQ(static_cast<int64>(expected.size()), writer.bytes_written());
+    EXPECT_LT(2u, sink.chunks().size());
+  }
+
+  // Scalars and empty containers.
+  const char* const kInputs[] = { "0", "\"\"", "[]", "{}", "[[],{}]" };
+  for (size_t i = 0; i < arraysize(kInputs); ++i) {
+    scoped_ptr<Value> value(JSONReader::Read(kInputs[i]));
+    ASSERT_TRUE(value);
+    std::string expected;
+    EXPECT_TRUE(JSONWriter::Write(value.get(), &expected));
+    JSONStreamWriter::ChunkedMemorySink sink;
+    EXPECT_TRUE(JSONStreamWriter(value.get(), 0, &sink).Write());
+    EXPECT_EQ(expected, Concatenate(sink));
+  }
+}
+
+TEST(JSONStreamWriterTest, WriteSome) {
+  scoped_ptr<DictionaryValue> root = BuildTree();
+  std::string expected;
+  EXPECT_TRUE(JSONWriter::WriteWithOptions(
+      root.get(), JSONWriter::OPTIONS_PRETTY_PRINT, &expected));
+
+  // Every slice hands at least the requested size to the sink, except the
+  // last one.
+  JSONStreamWriter::ChunkedMemorySink sink;
+  JSONStreamWriter writer(root.get(), JSONWriter::OPTIONS_PRETTY_PRINT, &sink);
+  int slices = 0;
+  int64 previous = 0;
+  while (!writer.WriteSome(100)) {
+    EXPECT_LE(previous + 100, writer.bytes_written());
+    previous = writer.bytes_written();
+    ++slices;
+  }
+  EXPECT_TRUE(writer.succeeded());
+  EXPECT_LT(100, slices);
+  EXPECT_EQ(expected, Concatenate(sink));
+
+  // Once done, further calls write nothing.
+  EXPECT_TRUE(writer.WriteSome(100));
+  EXPECT_EQ(static_cast<int64>(expected.size()), writer.bytes_written());
+}
+
+TEST(JSONStreamWriterTest, BinaryValues) {
+  DictionaryValue root;
+  root.SetInteger("a", 1);
+  root.Set("binary", BinaryValue::CreateWithCopiedBuffer("asdf", 4));
+  ListValue* list = new ListValue;
+  list->Append(BinaryValue::CreateWithCopiedBuffer("asdf", 4));
+  list->AppendInteger(2);
+  root.Set("list", list);
+
+  JSONStreamWriter::ChunkedMemorySink failed_sink;
+  JSONStreamWriter failed_writer(&root, 0, &failed_sink);
+  EXPECT_FALSE(failed_writer.Write());
+  EXPECT_FALSE(failed_writer.succeeded());
+
+  std::string expected;
+  EXPECT_TRUE(JSONWriter::WriteWithOptions(
+      &root, JSONWriter::OPTIONS_OMIT_BINARY_VALUES, &expected));
+  EXPECT_EQ("{\"a\":1,\"list\":[2]}", expected);
+  JSONStreamWriter::ChunkedMemorySink sink;
+  JSONStreamWriter writer(&root, JSONWriter::OPTIONS_OMIT_BINARY_VALUES,
+                          &sink);
+  EXPECT_TRUE(writer.Write());
+  EXPECT_EQ(expected, Concatenate(sink));
+}
+
+TEST(JSONStreamWriterTest, SinkFailure) {
+  scoped_ptr<DictionaryValue> root = BuildTree();
+  LimitedSink sink(JSONStreamWriter::kBufferSize * 2);
+  JSONStreamWriter writer(root.get(), 0, &sink);
+  EXPECT_FALSE(writer.Write());
+  EXPECT_FALSE(writer.succeeded());
+  EXPECT_EQ(static_cast<int64>(sink.output().size()), writer.bytes_written());
+  EXPECT_LT(0, writer.bytes_written());
+
+  // The writer stops at the first failure.
+  EXPECT_TRUE(writer.WriteSome(100));
+  EXPECT_EQ(static_cast<int64>(sink.output().size()), writer.bytes_written());
+}
+
+TEST(JSONStreamWriterTest, FileSink) {
+  ScopedTempDir temp_dir;
+  ASSERT_TRUE(temp_dir.CreateUniqueTempDir());
+  FilePath path = temp_dir.path().Append(FILE_PATH_LITERAL("test.json"));
+  scoped_ptr<DictionaryValue> root = BuildTree();
+
+  {
+    File file(path, File::FLAG_CREATE_ALWAYS | File::FLAG_WRITE);
+    ASSERT_TRUE(file.IsValid());
+    JSONStreamWriter::FileSink sink(&file);
+    EXPECT_TRUE(JSONStreamWriter(root.get(), 0, &sink).Write());
+  }
+
+  std::string expected;
+  EXPECT_TRUE(JSONWriter::Write(root.get(), &expected));
+  std::string contents;
+  EXPECT_TRUE(ReadFileToString(path, &contents));
+  EXPECT_EQ(expected, contents);
+
+  // A sink on a platform file leaves it open.
+  File file(path, File::FLAG_OPEN | File::FLAG_APPEND);
+  ASSERT_TRUE(file.IsValid());
+  {
+    JSONStreamWriter::FileSink sink(file.GetPlatformFile());
+    EXPECT_TRUE(JSONStreamWriter(root.get(), 0, &sink).Write());
+  }
+  EXPECT_TRUE(file.IsValid());
+  EXPECT_EQ(2 * static_cast<int64>(expected.size()), file.GetLength());
+}
+
+}  // namespace base
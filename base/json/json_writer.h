@@ -14,6 +14,8 @@ namespace base {
 
 class Value;
 
+// Serializes Value trees to JSON strings. To write to a file or another sink
+// without building the whole output in memory, see JSONStreamWriter.
 class BASE_EXPORT JSONWriter {
  public:
   enum Options {
@@ -46,23 +48,7 @@ class BASE_EXPORT JSONWriter {
                                std::string* json);
 
  private:
-  JSONWriter(int options, std::string* json);
-
-  // Called recursively to build the JSON string. When completed,
-  // |json_string_| will contain the JSON.
-  bool BuildJSONString(const Value* const node, size_t depth);
-
-  // Adds space to json_string_ for the indent level.
-  void IndentLine(size_t depth);
-
-  bool omit_binary_values_;
-  bool omit_double_type_preservation_;
-  bool pretty_print_;
-
-  // Where we write JSON data as we generate it.
-  std::string* json_string_;
-
-  DISALLOW_COPY_AND_ASSIGN(JSONWriter);
+  DISALLOW_IMPLICIT_CONSTRUCTORS(JSONWriter);
 };
 
 }  // namespace base
@@ -0,0 +1,166 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/json/ndjson_reader.h"
+
+#include <vector>
+
+#include "base/bind.h"
+#include "base/files/file.h"
+#include "base/files/file_path.h"
+#include "base/json/json_reader.h"
+#include "base/location.h"
+#include "base/logging.h"
+#include "base/memory/scoped_vector.h"
+#include "base/strings/string_piece.h"
+#include "base/strings/string_util.h"
+#include "base/threading/sequenced_worker_pool.h"
+#include "base/values.h"
+
+namespace base {
+
+struct NDJSONReader::Chunk {
+  Chunk() : done(false), line_count(0), error_line(0) {}
+
+  // The lines to parse, ending with a '\n' except for the last chunk.
+  StringPiece data;
+
+  // Set once the chunk has been parsed. Guarded by NDJSONReader::lock_; the
+  // other fields belong to the task until then.
+  bool done;
+
+  ScopedVector<Value> records;
+  int line_count;
+
+  // The 1-based number, within the chunk, of the line which failed to parse,
+  // or 0. The lines after it aren't parsed.
+  int error_line;
+  std::string error_message;
+};
+
+const size_t NDJSONReader::kDefaultChunkSize = 256 * 1024;
+const size_t NDJSONReader::kDefaultMaxPendingChunks = 16;
+
+NDJSONReader::NDJSONReader(SequencedWorkerPool* pool, int options)
+    : pool_(pool),
+      options_(options),
+      chunk_size_(kDefaultChunkSize),
+      max_pending_chunks_(kDefaultMaxPendingChunks),
+      initialized_(false),
+      chunk_done_(&lock_),
+      error_line_(0) {
+}
+
+NDJSONReader::~NDJSONReader() {
+}
+
+bool NDJSONReader::Initialize(const FilePath& path) {
+  File file(path, File::FLAG_OPEN | File::FLAG_READ);
+  if (!file.IsValid())
+    return false;
+  // An empty file can't be mapped, and has no records anyway.
+  initialized_ = file.GetLength() == 0 || file_.Initialize(file.Pass());
+  return initialized_;
+}
+
+bool NDJSONReader::Read(const RecordCallback& callback) {
+  DCHECK(initialized_);
+  DCHECK_GT(chunk_size_, 0u);
+  DCHECK_GT(max_pending_chunks_, 0u);
+  error_line_ = 0;
+  error_message_.clear();
+
+  StringPiece input;
+  if (file_.IsValid())
+    input.set(reinterpret_cast<const char*>(file_.data()), file_.length());
+  size_t offset = 0;
+  int line_base = 0;
+  bool stopped = false;
+  bool succeeded = true;
+
+  // The chunks which have been handed to the pool, in the order of the file.
+  // Every one of them is waited for, even after stopping, since their tasks
+  // refer to the reader and to the mapped file.
+  ScopedVector<Chunk> pending;
+  for (;;) {
+    while (!stopped && pending.size() < max_pending_chunks_ &&
+           offset < input.size()) {
+      size_t end = input.size();
+      if (input.size() - offset > chunk_size_) {
+        end = input.find('\n', offset + chunk_size_ - 1);
+        end = end == StringPiece::npos ? input.size() : end + 1;
+      }
+      Chunk* chunk = new Chunk;
+      chunk->data = input.substr(offset, end - offset);
+      offset = end;
+      pending.push_back(chunk);
+      if (!pool_->PostWorkerTaskWithShutdownBehavior(
+              FROM_HERE,
+              Bind(&NDJSONReader::ParseChunk, Unretained(this), chunk),
+              SequencedWorkerPool::BLOCK_SHUTDOWN)) {
+        ParseChunk(chunk);
+      }
+    }
+    if (pending.empty())
+      break;
+
+    Chunk* chunk = pending.front();
+    {
+      AutoLock auto_lock(lock_);
+      while (!chunk->done)
+        chunk_done_.Wait();
+    }
+
+    // The records are handed over one by one, and those which aren't are
+    // deleted along with the chunk.
+    std::vector<Value*> records;
+    chunk->records.release(&records);
+    for (size_t i = 0; i < records.size(); ++i) {
+      scoped_ptr<Value> record(records[i]);
+      if (!stopped && !callback.Run(record.Pass()))
+        stopped = true;
+    }
+    if (!stopped && chunk->error_line) {
+      error_line_ = line_base + chunk->error_line;
+      error_message_ = chunk->error_message;
+      stopped = true;
+      succeeded = false;
+    }
+    line_base += chunk->line_count;
+    pending.erase(pending.begin());
+  }
+  return succeeded;
+}
+
+void NDJSONReader::ParseChunk(Chunk* chunk) {
+  const StringPiece data = chunk->data;
+  size_t pos = 0;
+  while (pos < data.size()) {
+    size_t end = data.find('\n', pos);
+    if (end == StringPiece::npos)
+      end = data.size();
+    StringPiece line = data.substr(pos, end - pos);
+    pos = end + 1;
+    ++chunk->line_count;
+    if (ContainsOnlyChars(line, kWhitespaceASCII))
+      continue;
+
+    int error_code = 0;
+    std::string error_message;
+    Value* record = JSONReader::ReadAndReturnError(line, options_, &error_code,
+                                                   &error_message);
+    if (!record) {
+      chunk->error_line = chunk->line_count;
+      chunk->error_message = error_message;
+      break;
+    }
+    chunk->records.push_back(record);
+  }
+
+  AutoLock auto_lock(lock_);
+  chunk->done = true;
+  chunk_done_.Broadcast();
+}
+
+}  // namespace base
@@ -0,0 +1,109 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+//
+// Reads newline-delimited JSON, a file with one JSON text per line, using the
+// threads of a SequencedWorkerPool to parse it. The file is memory-mapped and
+// split into chunks of whole lines, which are parsed in parallel while the
+// records of the earlier chunks are handed to the caller, in the order of the
+// file. At most a fixed number of chunks are in flight at once, which bounds
+// the memory used by the parsed records waiting to be handed over.
+//
+// Example:
+//   base::NDJSONReader reader(pool, base::JSON_PARSE_RFC);
+//   if (!reader.Initialize(path) ||
+//       !reader.Read(base::Bind(&Ingest, base::Unretained(this)))) {
+//     LOG(ERROR) << "line " << reader.error_line() << ": "
+//                << reader.error_message();
+//   }
+
+#ifndef BASE_JSON_NDJSON_READER_H_
+#define BASE_JSON_NDJSON_READER_H_
+
+#include <string>
+
+#include "base/base_export.h"
+#include "base/basictypes.h"
+#include "base/callback.h"
+#include "base/files/memory_mapped_file.h"
+#include "base/memory/ref_counted.h"
+#include "base/memory/scoped_ptr.h"
+#include "base/synchronization/condition_variable.h"
+#include "base/synchronization/lock.h"
+
+namespace base {
+
+class FilePath;
+class SequencedWorkerPool;
+class Value;
+
+class BASE_EXPORT NDJSONReader {
+ public:
+  // Receives the records in order. Returns false to stop reading.
+  typedef Callback<bool(scoped_ptr<Value> record)> RecordCallback;
+
+  // The default size of the chunks parsed by each task.
+  static const size_t kDefaultChunkSize;
+
+  // The default number of chunks being parsed or waiting to be handed over.
+  static const size_t kDefaultMaxPendingChunks;
+
+  // Parses lines with |options| (see JSONParserOptions) on |pool|.
+  NDJSONReader(SequencedWorkerPool* pool, int options);
+  ~NDJSONReader();
+
+  // Maps the file at |path|. Returns false if it can't be opened or mapped.
+  // Must succeed before Read() is called.
+  bool Initialize(const FilePath& path);
+
+  // Parses every line of the file and runs |callback| with each record, in
+  // order, on the calling thread. Blocks until the file has been read, or
+  // |callback| has returned false. Lines which only contain whitespace are
+  // skipped. Returns false if a line isn't valid JSON, in which case the
+  // records of the lines before it have been handed over, and error_line()
+  // and error_message() tell what is wrong. Stopping from |callback| isn't an
+  // error.
+  bool Read(const RecordCallback& callback);
+
+  // The number of bytes of whole lines parsed by each task. Chunks are larger
+  // when a line is.
+  void set_chunk_size(size_t chunk_size) { chunk_size_ = chunk_size; }
+
+  // The number of chunks which may be parsed, or parsed and waiting to be
+  // handed over, at once. At least 1.
+  void set_max_pending_chunks(size_t max_pending_chunks) {
+    max_pending_chunks_ = max_pending_chunks;
+  }
+
+  // The 1-based number of the line Read() failed on, and the error of
+  // JSONReader for it.
+  int error_line() const { return error_line_; }
+  const std::string& error_message() const { return error_message_; }
+
+ private:
+  struct Chunk;
+
+  // Parses the lines of |chunk| on a worker thread, or on the calling thread
+  // if the pool has been shut down.
+  void ParseChunk(Chunk* chunk);
+
+  scoped_refptr<SequencedWorkerPool> pool_;
+  const int options_;
+  size_t chunk_size_;
+  size_t max_pending_chunks_;
+  MemoryMappedFile file_;
+  bool initialized_;
+
+  // Guards Chunk::done, and is signaled whenever a chunk is done.
+  Lock lock_;
+  ConditionVariable chunk_done_;
+
+  int error_line_;
+  std::string error_message_;
+
+  DISALLOW_COPY_AND_ASSIGN(NDJSONReader);
+};
+
+}  // namespace base
+
+#endif  // BASE_JSON_NDJSON_READER_H_
@@ -0,0 +1,95 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <string>
+
+#include "base/bind.h"
+#include "base/files/file_path.h"
+#include "base/files/file_util.h"
+#include "base/files/scoped_temp_dir.h"
+#include "base/json/json_reader.h"
+#include "base/json/ndjson_reader.h"
+#include "base/memory/scoped_ptr.h"
+#include "base/message_loop/message_loop.h"
+#include "base/strings/string_number_conversions.h"
+#include "base/strings/stringprintf.h"
+#include "base/test/sequenced_worker_pool_owner.h"
+#include "base/time/time.h"
+#include "base/values.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "testing/perf/perf_test.h"
+
+namespace base {
+
+namespace {
+
+const int kNumRecords = 200000;
+
+// Counts the records, as a stand-in for ingesting them.
+bool CountRecord(int* count, scoped_ptr<Value> record) {
+  ++*count;
+  return true;
+}
+
+void PrintRate(const std::string& trace, TimeDelta elapsed) {
+  perf_test::PrintResult("ndjson_reader", "", trace,
+                         kNumRecords / elapsed.InSecondsF(), "records/s",
+                         true);
+}
+
+}  // namespace
+
+// Compares parsing a file line by line on one thread with NDJSONReader, for
+// pools of increasing numbers of threads.
+TEST(NDJSONReaderPerfTest, RecordsPerSecond) {
+  ScopedTempDir temp_dir;
+  ASSERT_TRUE(temp_dir.CreateUniqueTempDir());
+  FilePath path = temp_dir.path().AppendASCII("records.ndjson");
+  std::string contents;
+  for (int i = 0; i < kNumRecords; ++i) {
+    StringAppendF(&contents,
+                  "{\"id\": %d, \"name\": \"record %d\", \"score\": %d.25, "
+                  "\"active\": %s, \"tags\": [\"alpha\", \"beta\"], "
+                  "\"position\": {\"x\": %d, \"y\": -%d}}\n",
+                  i, i, i % 100, i % 2 ? "true" : "false", i, i);
+  }
+  ASSERT_EQ(static_cast<int>(contents.size()),
+            WriteFile(path, contents.data(), contents.size()));
+
+  // Split the lines and read them one by one, as without NDJSONReader.
+  TimeTicks start = TimeTicks::HighResNow();
+  {
+    std::string file_contents;
+    ASSERT_TRUE(ReadFileToString(path, &file_contents));
+    int count = 0;
+    size_t pos = 0;
+    while (pos < file_contents.size()) {
+      size_t end = file_contents.find('\n', pos);
+      scoped_ptr<Value> record(JSONReader::Read(
+          StringPiece(file_contents).substr(pos, end - pos)));
+      ASSERT_TRUE(record);
+      CountRecord(&count, record.Pass());
+      pos = end + 1;
+    }
+    EXPECT_EQ(kNumRecords, count);
+  }
+  PrintRate("serial", TimeTicks::HighResNow() - start);
+
+  MessageLoop message_loop;  // Needed by SequencedWorkerPool.
+  const size_t kThreadCounts[] = { 1, 2, 4, 8 };
+  for (size_t i = 0; i < arraysize(kThreadCounts); ++i) {
+    SequencedWorkerPoolOwner pool_owner(kThreadCounts[i], "NDJSONReader");
+    start = TimeTicks::HighResNow();
+    NDJSONReader reader(pool_owner.pool().get(), JSON_PARSE_RFC);
+    ASSERT_TRUE(reader.Initialize(path));
+    int count = 0;
+    EXPECT_TRUE(reader.Read(Bind(&CountRecord, &count)));
+    PrintRate("threads_" + SizeTToString(kThreadCounts[i]),
+              TimeTicks::HighResNow() - start);
+    EXPECT_EQ(kNumRecords, count);
+    pool_owner.pool()->Shutdown();
+  }
+}
+
+}  // namespace base
@@ -0,0 +1,176 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/json/ndjson_reader.h"
+
+#include <string>
+#include <vector>
+
+#include "base/bind.h"
+#include "base/files/file_path.h"
+#include "base/files/file_util.h"
+#include "base/files/scoped_temp_dir.h"
+#include "base/json/json_reader.h"
+#include "base/memory/scoped_ptr.h"
+#include "base/message_loop/message_loop.h"
+#include "base/strings/stringprintf.h"
+#include "base/test/sequenced_worker_pool_owner.h"
+#include "base/values.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace base {
+
+namespace {
+
+const int kNumRecords = 1000;
+
+// Collects the "id" of each record, stopping after |limit| records.
+class IdCollector {
+ public:
+  explicit IdCollector(size_t limit) : limit_(limit) {}
+
+  bool OnRecord(scoped_ptr<Value> record) {
+    DictionaryValue* dictionary = NULL;
+    int id = -1;
+    EXPECT_TRUE(record->GetAsDictionary(&dictionary));
+    EXPECT_TRUE(dictionary && dictionary->GetInteger("id", &id));
+    ids_.push_back(id);
+    return ids_.size() < limit_;
+  }
+
+  const std::vector<int>& ids() const { return ids_; }
+
+ private:
+  const size_t limit_;
+  std::vector<int> ids_;
+
+  DISALLOW_COPY_AND_ASSIGN(IdCollector);
+};
+
+class NDJSONReaderTest : public testing::Test {
+ protected:
+  NDJSONReaderTest() : pool_owner_(3, "NDJSONReaderTest") {}
+
+  virtual void SetUp() override {
+    ASSERT_TRUE(temp_dir_.CreateUniqueTempDir());
+    path_ = temp_dir_.path().AppendASCII("records.ndjson");
+  }
+
+  virtual void TearDown() override {
+    pool_owner_.pool()->Shutdown();
+  }
+
+  // Writes kNumRecords records, with blank lines and "\r\n" line ends mixed
+  // in. Returns the line number of record |bad_record|, which is malformed,
+  // if it is less than kNumRecords.
+  int WriteRecords(int bad_record) {
+    std::string contents;
+    int line = 0;
+    int bad_line = 0;
+    for (int i = 0; i < kNumRecords; ++i) {
+      if (i % 7 == 0) {
+        contents += "  \n";
+        ++line;
+      }
+      ++line;
+      if (i == bad_record) {
+        bad_line = line;
+        contents += "{\"id\": ,}\n";
+        continue;
+      }
+      StringAppendF(&contents, "{\"id\": %d, \"name\": \"record %d\"}%s", i,
+                    i, i % 3 ? "\n" : "\r\n");
+    }
+    EXPECT_EQ(static_cast<int>(contents.size()),
+              WriteFile(path_, contents.data(), contents.size()));
+    return bad_line;
+  }
+
+  MessageLoop message_loop_;  // Needed by SequencedWorkerPool.
+  SequencedWorkerPoolOwner pool_owner_;
+  ScopedTempDir temp_dir_;
+  FilePath path_;
+};
+
+}  // namespace
+
+TEST_F(NDJSONReaderTest, RecordsInOrder) {
+  WriteRecords(kNumRecords);
+
+  // Chunks of a few lines, of which few are in flight, and one chunk for the
+  // whole file.
+  const size_t kChunkSizes[] = { 100, NDJSONReader::kDefaultChunkSize };
+  for (size_t i = 0; i < arraysize(kChunkSizes); ++i) {
+    NDJSONReader reader(pool_owner_.pool().get(), JSON_PARSE_RFC);
+    reader.set_chunk_size(kChunkSizes[i]);
+    reader.set_max_pending_chunks(2);
+    ASSERT_TRUE(reader.Initialize(path_));
+    IdCollector collector(kNumRecords + 1);
+    EXPECT_TRUE(reader.Read(
+        Bind(&IdCollector::OnRecord, Unretained(&collector))));
+    ASSERT_EQ(static_cast<size_t>(kNumRecords), collector.ids().size());
+    for (int id = 0; id < kNumRecords; ++id)
+      EXPECT_EQ(id, collector.ids()[id]);
+  }
+}
+
+TEST_F(NDJSONReaderTest, MalformedRecord) {
+  const int kBadRecord = 600;
+  int bad_line = WriteRecords(kBadRecord);
+
+  NDJSONReader reader(pool_owner_.pool().get(), JSON_PARSE_RFC);
+  reader.set_chunk_size(100);
+  ASSERT_TRUE(reader.Initialize(path_));
+  IdCollector collector(kNumRecords + 1);
+  EXPECT_FALSE(reader.Read(
+      Bind(&IdCollector::OnRecord, Unretained(&collector))));
+  EXPECT_EQ(static_cast<size_t>(kBadRecord), collector.ids().size());
+  EXPECT_EQ(bad_line, reader.error_line());
+
+  std::string expected_message;
+  scoped_ptr<Value> value(JSONReader::ReadAndReturnError(
+      "{\"id\": ,}", JSON_PARSE_RFC, NULL, &expected_message));
+  EXPECT_FALSE(value);
+  EXPECT_EQ(expected_message, reader.error_message());
+}
+
+TEST_F(NDJSONReaderTest, StopFromCallback) {
+  WriteRecords(kNumRecords);
+
+  NDJSONReader reader(pool_owner_.pool().get(), JSON_PARSE_RFC);
+  reader.set_chunk_size(100);
+  ASSERT_TRUE(reader.Initialize(path_));
+  IdCollector collector(10);
+  EXPECT_TRUE(reader.Read(
+      Bind(&IdCollector::OnRecord, Unretained(&collector))));
+  EXPECT_EQ(10u, collector.ids().size());
+}
+
+TEST_F(NDJSONReaderTest, EmptyAndMissingFiles) {
+  NDJSONReader reader(pool_owner_.pool().get(), JSON_PARSE_RFC);
+  EXPECT_FALSE(reader.Initialize(path_));
+
+  ASSERT_EQ(0, WriteFile(path_, "", 0));
+  ASSERT_TRUE(reader.Initialize(path_));
+  IdCollector collector(1);
+  EXPECT_TRUE(reader.Read(
+      Bind(&IdCollector::OnRecord, Unretained(&collector))));
+  EXPECT_TRUE(collector.ids().empty());
+}
+
+TEST_F(NDJSONReaderTest, PoolShutDown) {
+  WriteRecords(kNumRecords);
+  pool_owner_.pool()->Shutdown();
+
+  // The chunks are parsed on the calling thread.
+  NDJSONReader reader(pool_owner_.pool().get(), JSON_PARSE_RFC);
+  reader.set_chunk_size(100);
+  ASSERT_TRUE(reader.Initialize(path_));
+  IdCollector collector(kNumRecords + 1);
+  EXPECT_TRUE(reader.Read(
+      Bind(&IdCollector::OnRecord, Unretained(&collector))));
+  EXPECT_EQ(static_cast<size_t>(kNumRecords), collector.ids().size());
+}
+
+}  // namespace base
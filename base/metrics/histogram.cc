@@ -271,6 +271,10 @@ scoped_ptr<HistogramSamples> Histogram::SnapshotSamples() const {
   return SnapshotSampleVector().Pass();
 }
 
+scoped_ptr<HistogramSamples> Histogram::SnapshotDelta() {
+  return samples_->ExtractDelta().Pass();
+}
+
 void Histogram::AddSamples(const HistogramSamples& samples) {
   samples_->Add(samples);
 }
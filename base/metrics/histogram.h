@@ -389,6 +389,7 @@ class BASE_EXPORT Histogram : public HistogramBase {
       size_t expected_bucket_count) const override;
   virtual void Add(Sample value) override;
   virtual scoped_ptr<HistogramSamples> SnapshotSamples() const override;
+  virtual scoped_ptr<HistogramSamples> SnapshotDelta() override;
   virtual void AddSamples(const HistogramSamples& samples) override;
   virtual bool AddSamplesFromPickle(PickleIterator* iter) override;
   virtual void WriteHTMLGraph(std::string* output) const override;
@@ -418,6 +419,11 @@ class BASE_EXPORT Histogram : public HistogramBase {
   // be a name (or string description) given to the bucket.
   virtual const std::string GetAsciiBucketRange(size_t it) const;
 
+  // Implementation of SnapshotSamples function. This is also what the ASCII,
+  // HTML and JSON output is built from, so derived classes can override it to
+  // present a different view of their samples.
+  virtual scoped_ptr<SampleVector> SnapshotSampleVector() const;
+
  private:
   // Allow tests to corrupt our innards for testing purposes.
   FRIEND_TEST_ALL_PREFIXES(HistogramTest, BoundsTest);
@@ -433,9 +439,6 @@ class BASE_EXPORT Histogram : public HistogramBase {
       PickleIterator* iter);
   static HistogramBase* DeserializeInfoImpl(PickleIterator* iter);
 
-  // Implementation of SnapshotSamples function.
-  scoped_ptr<SampleVector> SnapshotSampleVector() const;
-
   //----------------------------------------------------------------------------
   // Helpers for emitting Ascii graphic.  Each method appends data to output.
 
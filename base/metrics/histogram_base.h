@@ -136,6 +136,12 @@ class BASE_EXPORT HistogramBase {
   // Override with atomic/locked snapshot if needed.
   virtual scoped_ptr<HistogramSamples> SnapshotSamples() const = 0;
 
+  // Snapshot the samples recorded since the previous call to SnapshotDelta()
+  // and mark them as logged, so the histogram itself tracks what has already
+  // been reported. Returns NULL if nothing was recorded in between. There can
+  // only be one consumer of deltas per histogram.
+  virtual scoped_ptr<HistogramSamples> SnapshotDelta() = 0;
+
   // The following methods provide graphical histogram displays.
   virtual void WriteHTMLGraph(std::string* output) const = 0;
   virtual void WriteAscii(std::string* output) const = 0;
@@ -5,7 +5,10 @@
 #include "base/metrics/histogram_delta_serialization.h"
 
 #include "base/logging.h"
+#include "base/metrics/bucket_ranges.h"
+#include "base/metrics/histogram.h"
 #include "base/metrics/histogram_base.h"
+#include "base/metrics/histogram_samples.h"
 #include "base/metrics/histogram_snapshot_manager.h"
 #include "base/numerics/safe_conversions.h"
 #include "base/pickle.h"
@@ -13,8 +16,184 @@
 
 namespace base {
 
+// The compact format is:
+//
+//   message     := version:uint8 record*
+//   record      := id:varint [description] sum:svarint
+//                  redundant_count:svarint entry_count:varint entry*
+//   description := length:varint SerializeInfo() Pickle
+//   entry       := key_delta:svarint count:svarint
+//
+// Ids are assigned in order of first appearance on the connection, and the
+// description is only present when the id is the next unassigned one. The key
+// of an entry is its bucket index, or its sample for sparse histograms, and is
+// encoded as the difference with the key of the previous entry (or 0). Keys
+// are strictly increasing. A varint is an unsigned LEB128 integer and an
+// svarint a zigzag-encoded varint.
+
+// static
+const uint8 HistogramDeltaSerialization::kCompactFormatVersion = 1;
+
 namespace {
 
+typedef HistogramBase::Count Count;
+typedef HistogramBase::Sample Sample;
+
+void AppendVarint(uint64 value, std::string* output) {
+  while (value >= 0x80) {
+    output->push_back(static_cast<char>((value & 0x7F) | 0x80));
+    value >>= 7;
+  }
+  output->push_back(static_cast<char>(value));
+}
+
+void AppendSignedVarint(int64 value, std::string* output) {
+  AppendVarint((static_cast<uint64>(value) << 1) ^
+                   static_cast<uint64>(value >> 63),
+               output);
+}
+
+// Reads the integers of a compact message. All methods return false when
+// running past the end of the message or reading a malformed integer.
+class CompactReader {
+ public:
+  explicit CompactReader(const std::string& data)
+      : data_(data),
+        position_(0) {}
+
+  bool Done() const { return position_ == data_.size(); }
+
+  bool ReadByte(uint8* value) {
+    if (position_ == data_.size())
+      return false;
+    *value = static_cast<uint8>(data_[position_++]);
+    return true;
+  }
+
+  bool ReadVarint(uint64* value) {
+    *value = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+      uint8 byte;
+      if (!ReadByte(&byte))
+        return false;
+      *value |= static_cast<uint64>(byte & 0x7F) << shift;
+      if (!(byte & 0x80))
+        return true;
+    }
+    return false;
+  }
+
+  bool ReadSignedVarint(int64* value) {
+    uint64 encoded;
+    if (!ReadVarint(&encoded))
+      return false;
+    *value = static_cast<int64>(encoded >> 1) ^
+             -static_cast<int64>(encoded & 1);
+    return true;
+  }
+
+  bool ReadBytes(uint64 length, std::string* bytes) {
+    if (length > data_.size() - position_)
+      return false;
+    bytes->assign(data_, position_, static_cast<size_t>(length));
+    position_ += static_cast<size_t>(length);
+    return true;
+  }
+
+ private:
+  const std::string& data_;
+  size_t position_;
+
+  DISALLOW_COPY_AND_ASSIGN(CompactReader);
+};
+
+// The samples of one compact record, in the form expected by
+// HistogramBase::AddSamples().
+class DecodedSamples : public HistogramSamples {
+ public:
+  struct Entry {
+    Sample min;
+    Sample max;
+    Count count;
+  };
+
+  DecodedSamples(int64 sum, Count redundant_count) {
+    IncreaseSum(sum);
+    IncreaseRedundantCount(redundant_count);
+  }
+  virtual ~DecodedSamples() {}
+
+  void Append(Sample min, Sample max, Count count) {
+    Entry entry = { min, max, count };
+    entries_.push_back(entry);
+  }
+
+  // HistogramSamples implementation:
+  virtual void Accumulate(Sample value, Count count) override {
+    NOTREACHED();
+  }
+  virtual Count GetCount(Sample value) const override {
+    for (size_t i = 0; i < entries_.size(); ++i) {
+      if (entries_[i].min <= value && value < entries_[i].max)
+        return entries_[i].count;
+    }
+    return 0;
+  }
+  virtual Count TotalCount() const override {
+    Count total = 0;
+    for (size_t i = 0; i < entries_.size(); ++i)
+      total += entries_[i].count;
+    return total;
+  }
+  virtual scoped_ptr<SampleCountIterator> Iterator() const override;
+
+ protected:
+  virtual bool AddSubtractImpl(SampleCountIterator* iter,
+                               Operator op) override {
+    NOTREACHED();
+    return false;
+  }
+
+ private:
+  std::vector<Entry> entries_;
+
+  DISALLOW_COPY_AND_ASSIGN(DecodedSamples);
+};
+
+class DecodedSamplesIterator : public SampleCountIterator {
+ public:
+  explicit DecodedSamplesIterator(
+      const std::vector<DecodedSamples::Entry>& entries)
+      : entries_(entries),
+        index_(0) {}
+  virtual ~DecodedSamplesIterator() {}
+
+  // SampleCountIterator implementation:
+  virtual bool Done() const override { return index_ == entries_.size(); }
+  virtual void Next() override {
+    DCHECK(!Done());
+    ++index_;
+  }
+  virtual void Get(Sample* min, Sample* max, Count* count) const override {
+    DCHECK(!Done());
+    if (min)
+      *min = entries_[index_].min;
+    if (max)
+      *max = entries_[index_].max;
+    if (count)
+      *count = entries_[index_].count;
+  }
+
+ private:
+  const std::vector<DecodedSamples::Entry>& entries_;
+  size_t index_;
+};
+
+scoped_ptr<SampleCountIterator> DecodedSamples::Iterator() const {
+  return scoped_ptr<SampleCountIterator>(
+      new DecodedSamplesIterator(entries_));
+}
+
 // Create or find existing histogram and add the samples from pickle.
 // Silently returns when seeing any data problem in the pickle.
 void DeserializeHistogramAndAddSamples(PickleIterator* iter) {
@@ -35,7 +214,8 @@ void DeserializeHistogramAndAddSamples(PickleIterator* iter) {
 HistogramDeltaSerialization::HistogramDeltaSerialization(
     const std::string& caller_name)
     : histogram_snapshot_manager_(this),
-      serialized_deltas_(NULL) {
+      serialized_deltas_(NULL),
+      compact_deltas_(NULL) {
   inconsistencies_histogram_ =
       LinearHistogram::FactoryGet(
           "Histogram.Inconsistencies" + caller_name, 1,
@@ -49,11 +229,6 @@ HistogramDeltaSerialization::HistogramDeltaSerialization(
           HistogramBase::NEVER_EXCEEDED_VALUE,
           HistogramBase::NEVER_EXCEEDED_VALUE + 1,
           HistogramBase::kUmaTargetedHistogramFlag);
-
-  inconsistent_snapshot_histogram_ =
-      Histogram::FactoryGet(
-          "Histogram.InconsistentSnapshot" + caller_name, 1, 1000000, 50,
-          HistogramBase::kUmaTargetedHistogramFlag);
 }
 
 HistogramDeltaSerialization::~HistogramDeltaSerialization() {
@@ -70,6 +245,19 @@ void HistogramDeltaSerialization::PrepareAndSerializeDeltas(
   serialized_deltas_ = NULL;
 }
 
+void HistogramDeltaSerialization::PrepareAndSerializeCompactDeltas(
+    std::string* serialized_deltas) {
+  serialized_deltas->assign(1, static_cast<char>(kCompactFormatVersion));
+  compact_deltas_ = serialized_deltas;
+  histogram_snapshot_manager_.PrepareDeltas(
+      Histogram::kIPCSerializationSourceFlag, Histogram::kNoFlags);
+  compact_deltas_ = NULL;
+
+  // Don't send a message without any record.
+  if (serialized_deltas->size() == 1)
+    serialized_deltas->clear();
+}
+
 // static
 void HistogramDeltaSerialization::DeserializeAndAddSamples(
     const std::vector<std::string>& serialized_deltas) {
@@ -86,6 +274,11 @@ void HistogramDeltaSerialization::RecordDelta(
     const HistogramSamples& snapshot) {
   DCHECK_NE(0, snapshot.TotalCount());
 
+  if (compact_deltas_) {
+    RecordCompactDelta(histogram, snapshot);
+    return;
+  }
+
   Pickle pickle;
   histogram.SerializeInfo(&pickle);
   snapshot.Serialize(&pickle);
@@ -93,6 +286,53 @@ void HistogramDeltaSerialization::RecordDelta(
       std::string(static_cast<const char*>(pickle.data()), pickle.size()));
 }
 
+void HistogramDeltaSerialization::RecordCompactDelta(
+    const HistogramBase& histogram,
+    const HistogramSamples& snapshot) {
+  std::map<const HistogramBase*, uint32>::const_iterator found =
+      compact_ids_.find(&histogram);
+  if (found != compact_ids_.end()) {
+    AppendVarint(found->second, compact_deltas_);
+  } else {
+    uint32 id = static_cast<uint32>(compact_ids_.size());
+    compact_ids_[&histogram] = id;
+    AppendVarint(id, compact_deltas_);
+
+    Pickle pickle;
+    histogram.SerializeInfo(&pickle);
+    AppendVarint(pickle.size(), compact_deltas_);
+    compact_deltas_->append(static_cast<const char*>(pickle.data()),
+                            pickle.size());
+  }
+
+  AppendSignedVarint(snapshot.sum(), compact_deltas_);
+  AppendSignedVarint(snapshot.redundant_count(), compact_deltas_);
+
+  bool is_sparse = histogram.GetHistogramType() == SPARSE_HISTOGRAM;
+  std::string entries;
+  uint64 entry_count = 0;
+  int64 previous_key = 0;
+  for (scoped_ptr<SampleCountIterator> it = snapshot.Iterator(); !it->Done();
+       it->Next()) {
+    Sample min;
+    Count count;
+    it->Get(&min, NULL, &count);
+    int64 key = min;
+    if (!is_sparse) {
+      size_t index = 0;
+      bool has_index = it->GetBucketIndex(&index);
+      DCHECK(has_index);
+      key = static_cast<int64>(index);
+    }
+    AppendSignedVarint(key - previous_key, &entries);
+    AppendSignedVarint(count, &entries);
+    previous_key = key;
+    ++entry_count;
+  }
+  AppendVarint(entry_count, compact_deltas_);
+  compact_deltas_->append(entries);
+}
+
 void HistogramDeltaSerialization::InconsistencyDetected(
     HistogramBase::Inconsistency problem) {
   inconsistencies_histogram_->Add(problem);
@@ -103,9 +343,99 @@ void HistogramDeltaSerialization::UniqueInconsistencyDetected(
   inconsistencies_unique_histogram_->Add(problem);
 }
 
-void HistogramDeltaSerialization::InconsistencyDetectedInLoggedCount(
-    int amount) {
-  inconsistent_snapshot_histogram_->Add(std::abs(amount));
+HistogramDeltaDeserializer::HistogramDeltaDeserializer() {
+}
+
+HistogramDeltaDeserializer::~HistogramDeltaDeserializer() {
+}
+
+bool HistogramDeltaDeserializer::DeserializeAndAddSamples(
+    const std::string& serialized_deltas) {
+  if (serialized_deltas.empty())
+    return true;
+
+  CompactReader reader(serialized_deltas);
+  uint8 version;
+  if (!reader.ReadByte(&version) ||
+      version != HistogramDeltaSerialization::kCompactFormatVersion) {
+    return false;
+  }
+
+  while (!reader.Done()) {
+    uint64 id;
+    if (!reader.ReadVarint(&id) || id > histograms_.size())
+      return false;
+    if (id == histograms_.size()) {
+      uint64 length;
+      std::string description;
+      if (!reader.ReadVarint(&length) ||
+          !reader.ReadBytes(length, &description)) {
+        return false;
+      }
+      Pickle pickle(description.data(), checked_cast<int>(description.size()));
+      PickleIterator iter(pickle);
+      histograms_.push_back(DeserializeHistogramInfo(&iter));
+    }
+    HistogramBase* histogram = histograms_[static_cast<size_t>(id)];
+
+    int64 sum;
+    int64 redundant_count;
+    uint64 entry_count;
+    if (!reader.ReadSignedVarint(&sum) ||
+        !reader.ReadSignedVarint(&redundant_count) ||
+        !IsValueInRangeForNumericType<Count>(redundant_count) ||
+        !reader.ReadVarint(&entry_count)) {
+      return false;
+    }
+
+    const BucketRanges* ranges = NULL;
+    if (histogram && histogram->GetHistogramType() != SPARSE_HISTOGRAM)
+      ranges = static_cast<Histogram*>(histogram)->bucket_ranges();
+
+    DecodedSamples samples(sum, static_cast<Count>(redundant_count));
+    int64 key = 0;
+    for (uint64 i = 0; i < entry_count; ++i) {
+      int64 key_delta;
+      int64 count;
+      // Keys are Samples, or bucket indices, so consecutive keys are up to
+      // 2^32 - 1 apart, e.g. from kint32min to kint32max.
+      if (!reader.ReadSignedVarint(&key_delta) ||
+          key_delta > static_cast<int64>(kuint32max) ||
+          key_delta < -static_cast<int64>(kuint32max) ||
+          (i > 0 && key_delta <= 0) ||
+          !reader.ReadSignedVarint(&count) ||
+          !IsValueInRangeForNumericType<Count>(count)) {
+        return false;
+      }
+      key += key_delta;
+      if (!IsValueInRangeForNumericType<Sample>(key))
+        return false;
+      if (!histogram)
+        continue;
+
+      if (ranges) {
+        if (key < 0 || key >= static_cast<int64>(ranges->bucket_count()))
+          return false;
+        size_t index = static_cast<size_t>(key);
+        samples.Append(ranges->range(index), ranges->range(index + 1),
+                       static_cast<Count>(count));
+      } else {
+        samples.Append(static_cast<Sample>(key),
+                       static_cast<Sample>(key + 1),
+                       static_cast<Count>(count));
+      }
+    }
+
+    if (!histogram)
+      continue;
+    if (histogram->flags() & HistogramBase::kIPCSerializationSourceFlag) {
+      DVLOG(1) << "Single process mode, histogram observed and not copied: "
+               << histogram->histogram_name();
+      continue;
+    }
+    histogram->AddSamples(samples);
+  }
+  return true;
 }
 
 }  // namespace base
@@ -5,6 +5,7 @@
 #ifndef BASE_METRICS_HISTOGRAM_DELTA_SERIALIZATION_H_
 #define BASE_METRICS_HISTOGRAM_DELTA_SERIALIZATION_H_
 
+#include <map>
 #include <string>
 #include <vector>
 
@@ -19,8 +20,25 @@ namespace base {
 class HistogramBase;
 
 // Serializes and restores histograms deltas.
+//
+// Two wire formats are supported:
+// - The Pickle format: PrepareAndSerializeDeltas() produces one Pickle per
+//   histogram with its full description and fixed-width bucket counts. It is
+//   stateless and read by the static DeserializeAndAddSamples().
+// - The compact format: PrepareAndSerializeCompactDeltas() produces a single
+//   versioned message per call. Histogram descriptions (name, flags, ranges)
+//   are only sent the first time a histogram is seen on the connection and
+//   later referred to by a small id; bucket indices are delta-encoded and all
+//   integers are varints. It must be read, in order, by a single
+//   HistogramDeltaDeserializer per connection.
+//
+// The Pickle format remains the fallback for receivers which don't understand
+// kCompactFormatVersion.
 class BASE_EXPORT HistogramDeltaSerialization : public HistogramFlattener {
  public:
+  // Version byte leading every message in the compact format.
+  static const uint8 kCompactFormatVersion;
+
   // |caller_name| is string used in histograms for counting inconsistencies.
   explicit HistogramDeltaSerialization(const std::string& caller_name);
   virtual ~HistogramDeltaSerialization();
@@ -31,6 +49,11 @@ class BASE_EXPORT HistogramDeltaSerialization : public HistogramFlattener {
   // will compute the deltas relative to this one.
   void PrepareAndSerializeDeltas(std::vector<std::string>* serialized_deltas);
 
+  // Same as above, but stores the deltas in the compact format into
+  // |serialized_deltas|, which is left empty if there are no deltas. The
+  // message depends on all previous compact messages from this object.
+  void PrepareAndSerializeCompactDeltas(std::string* serialized_deltas);
+
   // Deserialize deltas and add samples to corresponding histograms, creating
   // them if necessary. Silently ignores errors in |serialized_deltas|.
   static void DeserializeAndAddSamples(
@@ -44,22 +67,51 @@ class BASE_EXPORT HistogramDeltaSerialization : public HistogramFlattener {
       HistogramBase::Inconsistency problem) override;
   virtual void UniqueInconsistencyDetected(
       HistogramBase::Inconsistency problem) override;
-  virtual void InconsistencyDetectedInLoggedCount(int amount) override;
+
+  // Appends |snapshot| to |compact_deltas_|.
+  void RecordCompactDelta(const HistogramBase& histogram,
+                          const HistogramSamples& snapshot);
 
   // Calculates deltas in histogram counters.
   HistogramSnapshotManager histogram_snapshot_manager_;
 
-  // Output buffer for serialized deltas.
+  // Output buffer for serialized deltas, in the Pickle or the compact format.
+  // At most one of them is non-NULL.
   std::vector<std::string>* serialized_deltas_;
+  std::string* compact_deltas_;
+
+  // Ids of the histograms already described in the compact format.
+  std::map<const HistogramBase*, uint32> compact_ids_;
 
   // Histograms to count inconsistencies in snapshots.
   HistogramBase* inconsistencies_histogram_;
   HistogramBase* inconsistencies_unique_histogram_;
-  HistogramBase* inconsistent_snapshot_histogram_;
 
   DISALLOW_COPY_AND_ASSIGN(HistogramDeltaSerialization);
 };
 
+// Restores histogram deltas serialized in the compact format. Keeps track of
+// the histograms described by earlier messages, so there must be one instance
+// per HistogramDeltaSerialization sending to it.
+class BASE_EXPORT HistogramDeltaDeserializer {
+ public:
+  HistogramDeltaDeserializer();
+  ~HistogramDeltaDeserializer();
+
+  // Deserializes |serialized_deltas| and adds the samples to the
+  // corresponding histograms, creating them if necessary. Returns false if
+  // the message is malformed or of an unknown version, in which case the
+  // remaining deltas of the message are dropped.
+  bool DeserializeAndAddSamples(const std::string& serialized_deltas);
+
+ private:
+  // Histograms by compact id. NULL for histograms which couldn't be created
+  // locally; their samples are skipped.
+  std::vector<HistogramBase*> histograms_;
+
+  DISALLOW_COPY_AND_ASSIGN(HistogramDeltaDeserializer);
+};
+
 }  // namespace base
 
 #endif  // BASE_METRICS_HISTOGRAM_DELTA_SERIALIZATION_H_
@@ -0,0 +1,103 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <string>
+#include <vector>
+
+#include "base/metrics/histogram.h"
+#include "base/metrics/histogram_delta_serialization.h"
+#include "base/metrics/sparse_histogram.h"
+#include "base/metrics/statistics_recorder.h"
+#include "base/strings/stringprintf.h"
+#include "base/time/time.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "testing/perf/perf_test.h"
+
+namespace base {
+
+namespace {
+
+const int kNumHistograms = 1000;
+const int kNumRuns = 20;
+
+// Compares the size and CPU cost of shipping the same deltas in the Pickle
+// and the compact format, the way a child process would on every metrics
+// upload.
+class HistogramDeltaSerializationPerfTest : public testing::Test {
+ public:
+  virtual void SetUp() {
+    StatisticsRecorder::Initialize();
+    for (int i = 0; i < kNumHistograms; ++i) {
+      std::string name = StringPrintf("PerfTest.Deltas.Histogram%d", i);
+      if (i % 10 == 0) {
+        histograms_.push_back(
+            SparseHistogram::FactoryGet(name, HistogramBase::kNoFlags));
+      } else {
+        histograms_.push_back(Histogram::FactoryGet(
+            name, 1, 100000, 50, HistogramBase::kNoFlags));
+      }
+    }
+  }
+
+  // Adds a few samples to every histogram, so that each upload has deltas.
+  void AddSamples(int run) {
+    for (size_t i = 0; i < histograms_.size(); ++i) {
+      for (int sample = 1 + run; sample < 100000; sample *= 3)
+        histograms_[i]->Add(sample);
+    }
+  }
+
+ protected:
+  std::vector<HistogramBase*> histograms_;
+};
+
+TEST_F(HistogramDeltaSerializationPerfTest, PickleVersusCompact) {
+  HistogramDeltaSerialization pickle_serializer("PerfTestPickle");
+  HistogramDeltaSerialization compact_serializer("PerfTestCompact");
+  HistogramDeltaDeserializer deserializer;
+
+  size_t pickle_bytes = 0;
+  size_t compact_bytes = 0;
+  TimeDelta pickle_time;
+  TimeDelta compact_time;
+  TimeDelta compact_deserialize_time;
+  for (int run = 0; run < kNumRuns; ++run) {
+    AddSamples(run);
+    std::vector<std::string> pickle_deltas;
+    TimeTicks start = TimeTicks::HighResNow();
+    pickle_serializer.PrepareAndSerializeDeltas(&pickle_deltas);
+    pickle_time += TimeTicks::HighResNow() - start;
+    for (size_t i = 0; i < pickle_deltas.size(); ++i)
+      pickle_bytes += pickle_deltas[i].size();
+
+    AddSamples(run);
+    std::string compact_deltas;
+    start = TimeTicks::HighResNow();
+    compact_serializer.PrepareAndSerializeCompactDeltas(&compact_deltas);
+    compact_time += TimeTicks::HighResNow() - start;
+    compact_bytes += compact_deltas.size();
+
+    // The histograms are local, so only the decoding is measured here.
+    start = TimeTicks::HighResNow();
+    EXPECT_TRUE(deserializer.DeserializeAndAddSamples(compact_deltas));
+    compact_deserialize_time += TimeTicks::HighResNow() - start;
+  }
+
+  perf_test::PrintResult("delta_bytes", "", "pickle",
+                         pickle_bytes / kNumRuns, "bytes", true);
+  perf_test::PrintResult("delta_bytes", "", "compact",
+                         compact_bytes / kNumRuns, "bytes", true);
+  perf_test::PrintResult("serialize_time", "", "pickle",
+                         pickle_time.InMillisecondsF() / kNumRuns, "ms", true);
+  perf_test::PrintResult("serialize_time", "", "compact",
+                         compact_time.InMillisecondsF() / kNumRuns, "ms",
+                         true);
+  perf_test::PrintResult("deserialize_time", "", "compact",
+                         compact_deserialize_time.InMillisecondsF() / kNumRuns,
+                         "ms", true);
+}
+
+}  // namespace
+
+}  // namespace base
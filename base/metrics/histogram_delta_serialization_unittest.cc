@@ -8,6 +8,7 @@
 
 #include "base/metrics/histogram.h"
 #include "base/metrics/histogram_base.h"
+#include "base/metrics/sparse_histogram.h"
 #include "base/metrics/statistics_recorder.h"
 #include "testing/gtest/include/gtest/gtest.h"
 
@@ -51,4 +52,126 @@ TEST(HistogramDeltaSerializationTest, DeserializeHistogramAndAddSamples) {
   EXPECT_EQ(2, snapshot2->GetCount(1000));
 }
 
+TEST(HistogramDeltaSerializationTest, DeserializeCompactDeltas) {
+  StatisticsRecorder statistic_recorder;
+  HistogramDeltaSerialization serializer("HistogramDeltaSerializationTest");
+  HistogramDeltaDeserializer deserializer;
+  std::string deltas;
+  // Nothing was changed yet.
+  serializer.PrepareAndSerializeCompactDeltas(&deltas);
+  EXPECT_TRUE(deltas.empty());
+  EXPECT_TRUE(deserializer.DeserializeAndAddSamples(deltas));
+
+  HistogramBase* histogram = Histogram::FactoryGet(
+      "TestHistogram", 1, 1000, 10, HistogramBase::kNoFlags);
+  HistogramBase* sparse_histogram =
+      SparseHistogram::FactoryGet("TestSparseHistogram",
+                                  HistogramBase::kNoFlags);
+  histogram->Add(1);
+  histogram->Add(10);
+  histogram->Add(1000);
+  sparse_histogram->Add(-5);
+  sparse_histogram->Add(100);
+
+  serializer.PrepareAndSerializeCompactDeltas(&deltas);
+  ASSERT_FALSE(deltas.empty());
+  EXPECT_EQ(HistogramDeltaSerialization::kCompactFormatVersion,
+            static_cast<uint8>(deltas[0]));
+
+  // The histograms have kIPCSerializationSourceFlag. So samples will be
+  // ignored.
+  EXPECT_TRUE(deserializer.DeserializeAndAddSamples(deltas));
+  EXPECT_EQ(3, histogram->SnapshotSamples()->TotalCount());
+  EXPECT_EQ(2, sparse_histogram->SnapshotSamples()->TotalCount());
+
+  // The histograms are only described in the first message, so send a second
+  // one which refers to them by id.
+  histogram->Add(10);
+  histogram->Add(100);
+  sparse_histogram->Add(100);
+
+  std::string first_deltas = deltas;
+  serializer.PrepareAndSerializeCompactDeltas(&deltas);
+  ASSERT_FALSE(deltas.empty());
+  EXPECT_LT(deltas.size(), first_deltas.size());
+
+  // Clear kIPCSerializationSourceFlag to emulate multi-process usage.
+  histogram->ClearFlags(HistogramBase::kIPCSerializationSourceFlag);
+  sparse_histogram->ClearFlags(HistogramBase::kIPCSerializationSourceFlag);
+  EXPECT_TRUE(deserializer.DeserializeAndAddSamples(deltas));
+
+  scoped_ptr<HistogramSamples> snapshot(histogram->SnapshotSamples());
+  EXPECT_EQ(1, snapshot->GetCount(1));
+  EXPECT_EQ(3, snapshot->GetCount(10));
+  EXPECT_EQ(2, snapshot->GetCount(100));
+  EXPECT_EQ(1, snapshot->GetCount(1000));
+  EXPECT_EQ(1231, snapshot->sum());
+
+  scoped_ptr<HistogramSamples> sparse_snapshot(
+      sparse_histogram->SnapshotSamples());
+  EXPECT_EQ(1, sparse_snapshot->GetCount(-5));
+  EXPECT_EQ(3, sparse_snapshot->GetCount(100));
+}
+
+// Sparse keys span the whole range of samples, so consecutive keys can be
+// further apart than any sample.
+TEST(HistogramDeltaSerializationTest, DeserializeExtremeSparseKeys) {
+  StatisticsRecorder statistic_recorder;
+  HistogramDeltaSerialization serializer("HistogramDeltaSerializationTest");
+  HistogramDeltaDeserializer deserializer;
+
+  HistogramBase* sparse_histogram =
+      SparseHistogram::FactoryGet("TestSparseHistogram",
+                                  HistogramBase::kNoFlags);
+  sparse_histogram->Add(kint32min);
+  sparse_histogram->Add(-1);
+  sparse_histogram->Add(kint32max);
+
+  std::string deltas;
+  serializer.PrepareAndSerializeCompactDeltas(&deltas);
+  ASSERT_FALSE(deltas.empty());
+
+  // Clear kIPCSerializationSourceFlag to emulate multi-process usage.
+  sparse_histogram->ClearFlags(HistogramBase::kIPCSerializationSourceFlag);
+  EXPECT_TRUE(deserializer.DeserializeAndAddSamples(deltas));
+
+  scoped_ptr<HistogramSamples> snapshot(sparse_histogram->SnapshotSamples());
+  EXPECT_EQ(6, snapshot->TotalCount());
+  EXPECT_EQ(2, snapshot->GetCount(kint32min));
+  EXPECT_EQ(2, snapshot->GetCount(-1));
+  EXPECT_EQ(2, snapshot->GetCount(kint32max));
+}
+
+TEST(HistogramDeltaSerializationTest, DeserializeMalformedCompactDeltas) {
+  StatisticsRecorder statistic_recorder;
+  HistogramDeltaSerialization serializer("HistogramDeltaSerializationTest");
+
+  HistogramBase* histogram = Histogram::FactoryGet(
+      "TestHistogram", 1, 1000, 10, HistogramBase::kNoFlags);
+  histogram->Add(10);
+  std::string deltas;
+  serializer.PrepareAndSerializeCompactDeltas(&deltas);
+  ASSERT_FALSE(deltas.empty());
+
+  // Unknown version.
+  std::string bad_version = deltas;
+  bad_version[0] = static_cast<char>(
+      HistogramDeltaSerialization::kCompactFormatVersion + 1);
+  HistogramDeltaDeserializer deserializer1;
+  EXPECT_FALSE(deserializer1.DeserializeAndAddSamples(bad_version));
+
+  // Truncated message.
+  HistogramDeltaDeserializer deserializer2;
+  EXPECT_FALSE(deserializer2.DeserializeAndAddSamples(
+      deltas.substr(0, deltas.size() - 1)));
+
+  // Reference to a histogram which was never described.
+  std::string unknown_id;
+  unknown_id.push_back(
+      static_cast<char>(HistogramDeltaSerialization::kCompactFormatVersion));
+  unknown_id.push_back(5);
+  HistogramDeltaDeserializer deserializer3;
+  EXPECT_FALSE(deserializer3.DeserializeAndAddSamples(unknown_id));
+}
+
 }  // namespace base
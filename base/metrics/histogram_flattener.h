@@ -33,10 +33,9 @@ class BASE_EXPORT HistogramFlattener {
   virtual void UniqueInconsistencyDetected(
       HistogramBase::Inconsistency problem) = 0;
 
-  // Will be called when the total logged sample count of a histogram
-  // differs from the sum of logged sample count in all the buckets.  The
-  // argument |amount| is the non-zero discrepancy.
-  virtual void InconsistencyDetectedInLoggedCount(int amount) = 0;
+  // Deprecated: HistogramSnapshotManager no longer compares logged counts, so
+  // this is never called. Kept so that existing implementations still build.
+  virtual void InconsistencyDetectedInLoggedCount(int amount) {}
 
  protected:
   HistogramFlattener() {}
@@ -8,10 +8,6 @@
 #include "base/metrics/histogram_flattener.h"
 #include "base/metrics/histogram_samples.h"
 #include "base/metrics/statistics_recorder.h"
-#include "base/stl_util.h"
-
-using std::map;
-using std::string;
 
 namespace base {
 
@@ -22,7 +18,6 @@ HistogramSnapshotManager::HistogramSnapshotManager(
 }
 
 HistogramSnapshotManager::~HistogramSnapshotManager() {
-  STLDeleteValues(&logged_samples_);
 }
 
 void HistogramSnapshotManager::PrepareDeltas(
@@ -35,18 +30,21 @@ void HistogramSnapshotManager::PrepareDeltas(
        ++it) {
     (*it)->SetFlags(flag_to_set);
     if (((*it)->flags() & required_flags) == required_flags)
-      PrepareDelta(**it);
+      PrepareDelta(*it);
   }
 }
 
-void HistogramSnapshotManager::PrepareDelta(const HistogramBase& histogram) {
+void HistogramSnapshotManager::PrepareDelta(HistogramBase* histogram) {
   DCHECK(histogram_flattener_);
 
-  // Get up-to-date snapshot of sample stats.
-  scoped_ptr<HistogramSamples> snapshot(histogram.SnapshotSamples());
-  const std::string& histogram_name = histogram.histogram_name();
+  // Get the samples recorded since the last delta. Histograms that were not
+  // touched in between return NULL without copying anything.
+  scoped_ptr<HistogramSamples> delta(histogram->SnapshotDelta());
+  if (!delta)
+    return;
+  const std::string& histogram_name = histogram->histogram_name();
 
-  int corruption = histogram.FindCorruption(*snapshot);
+  int corruption = histogram->FindCorruption(*delta);
 
   // Crash if we detect that our histograms have been overwritten.  This may be
   // a fair distance from the memory smasher, but we hope to correlate these
@@ -77,40 +75,8 @@ void HistogramSnapshotManager::PrepareDelta(const HistogramBase& histogram) {
     return;
   }
 
-  HistogramSamples* to_log;
-  map<string, HistogramSamples*>::iterator it =
-      logged_samples_.find(histogram_name);
-  if (it == logged_samples_.end()) {
-    to_log = snapshot.release();
-
-    // This histogram has not been logged before, add a new entry.
-    logged_samples_[histogram_name] = to_log;
-  } else {
-    HistogramSamples* already_logged = it->second;
-    InspectLoggedSamplesInconsistency(*snapshot, already_logged);
-    snapshot->Subtract(*already_logged);
-    already_logged->Add(*snapshot);
-    to_log = snapshot.get();
-  }
-
-  if (to_log->TotalCount() > 0)
-    histogram_flattener_->RecordDelta(histogram, *to_log);
-}
-
-void HistogramSnapshotManager::InspectLoggedSamplesInconsistency(
-      const HistogramSamples& new_snapshot,
-      HistogramSamples* logged_samples) {
-  HistogramBase::Count discrepancy =
-      logged_samples->TotalCount() - logged_samples->redundant_count();
-  if (!discrepancy)
-    return;
-
-  histogram_flattener_->InconsistencyDetectedInLoggedCount(discrepancy);
-  if (discrepancy > Histogram::kCommonRaceBasedCountMismatch) {
-    // Fix logged_samples.
-    logged_samples->Subtract(*logged_samples);
-    logged_samples->Add(new_snapshot);
-  }
+  if (delta->TotalCount() > 0)
+    histogram_flattener_->RecordDelta(*histogram, *delta);
 }
 
 }  // namespace base
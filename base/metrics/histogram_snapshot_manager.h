@@ -23,6 +23,11 @@ class HistogramFlattener;
 // corruption, this class also validates as much rendundancy as it can before
 // calling for the marginal change (a.k.a., delta) in a histogram to be
 // recorded.
+//
+// Each histogram keeps track of what has already been logged (see
+// HistogramBase::SnapshotDelta()), so histograms that were not touched since
+// the previous call cost no allocation or copying. As a consequence, only one
+// HistogramSnapshotManager per process should prepare deltas.
 class BASE_EXPORT HistogramSnapshotManager {
  public:
   explicit HistogramSnapshotManager(HistogramFlattener* histogram_flattener);
@@ -38,17 +43,8 @@ class BASE_EXPORT HistogramSnapshotManager {
                      HistogramBase::Flags required_flags);
 
  private:
-  // Snapshot this histogram, and record the delta.
-  void PrepareDelta(const HistogramBase& histogram);
-
-  // Try to detect and fix count inconsistency of logged samples.
-  void InspectLoggedSamplesInconsistency(
-      const HistogramSamples& new_snapshot,
-      HistogramSamples* logged_samples);
-
-  // For histograms, track what we've already recorded (as a sample for
-  // each histogram) so that we can record only the delta with the next log.
-  std::map<std::string, HistogramSamples*> logged_samples_;
+  // Snapshot the changes to this histogram, and record the delta.
+  void PrepareDelta(HistogramBase* histogram);
 
   // List of histograms found to be corrupt, and their problems.
   std::map<std::string, int> inconsistencies_;
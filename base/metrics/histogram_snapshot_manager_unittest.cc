@@ -21,6 +21,7 @@ class HistogramFlattenerDeltaRecorder : public HistogramFlattener {
   virtual void RecordDelta(const HistogramBase& histogram,
                            const HistogramSamples& snapshot) override {
     recorded_delta_histogram_names_.push_back(histogram.histogram_name());
+    recorded_delta_counts_.push_back(snapshot.TotalCount());
   }
 
   virtual void InconsistencyDetected(
@@ -33,16 +34,17 @@ class HistogramFlattenerDeltaRecorder : public HistogramFlattener {
     ASSERT_TRUE(false);
   }
 
-  virtual void InconsistencyDetectedInLoggedCount(int amount) override {
-    ASSERT_TRUE(false);
-  }
-
   std::vector<std::string> GetRecordedDeltaHistogramNames() {
     return recorded_delta_histogram_names_;
   }
 
+  std::vector<HistogramBase::Count> GetRecordedDeltaCounts() {
+    return recorded_delta_counts_;
+  }
+
  private:
   std::vector<std::string> recorded_delta_histogram_names_;
+  std::vector<HistogramBase::Count> recorded_delta_counts_;
 
   DISALLOW_COPY_AND_ASSIGN(HistogramFlattenerDeltaRecorder);
 };
@@ -103,4 +105,31 @@ TEST_F(HistogramSnapshotManagerTest,
   EXPECT_EQ("UmaStabilityHistogram", histograms[0]);
 }
 
+TEST_F(HistogramSnapshotManagerTest, PrepareDeltasOnlyRecordsChanges) {
+  UMA_HISTOGRAM_ENUMERATION("UmaHistogram", 1, 2);
+  UMA_HISTOGRAM_ENUMERATION("UmaHistogram", 1, 2);
+  UMA_STABILITY_HISTOGRAM_ENUMERATION("UmaStabilityHistogram", 1, 2);
+
+  histogram_snapshot_manager_.PrepareDeltas(HistogramBase::kNoFlags,
+                                            HistogramBase::kNoFlags);
+  // Nothing was recorded in between, so there are no new deltas.
+  histogram_snapshot_manager_.PrepareDeltas(HistogramBase::kNoFlags,
+                                            HistogramBase::kNoFlags);
+  UMA_HISTOGRAM_ENUMERATION("UmaHistogram", 0, 2);
+  histogram_snapshot_manager_.PrepareDeltas(HistogramBase::kNoFlags,
+                                            HistogramBase::kNoFlags);
+
+  const std::vector<std::string>& histograms =
+      histogram_flattener_delta_recorder_.GetRecordedDeltaHistogramNames();
+  const std::vector<HistogramBase::Count>& counts =
+      histogram_flattener_delta_recorder_.GetRecordedDeltaCounts();
+  ASSERT_EQ(3U, histograms.size());
+  EXPECT_EQ("UmaHistogram", histograms[0]);
+  EXPECT_EQ(2, counts[0]);
+  EXPECT_EQ("UmaStabilityHistogram", histograms[1]);
+  EXPECT_EQ(1, counts[1]);
+  EXPECT_EQ("UmaHistogram", histograms[2]);
+  EXPECT_EQ(1, counts[2]);
+}
+
 }  // namespace base
@@ -0,0 +1,196 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/metrics/metrics_text_exporter.h"
+
+#include "base/logging.h"
+#include "base/metrics/bucket_ranges.h"
+#include "base/metrics/histogram.h"
+#include "base/metrics/histogram_base.h"
+#include "base/metrics/histogram_samples.h"
+#include "base/metrics/statistics_recorder.h"
+#include "base/metrics/stats_table.h"
+#include "base/strings/string_number_conversions.h"
+
+namespace base {
+
+namespace {
+
+// Room left in the buffer before appending a line. Metric names are only
+// bounded by the histogram names, so an overlong line may still grow the
+// buffer, once.
+const size_t kLineReserve = 512;
+
+bool IsMetricNameChar(char c) {
+  return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') ||
+         (c >= '0' && c <= '9') || c == '_' || c == ':';
+}
+
+}  // namespace
+
+// static
+const size_t MetricsTextExporter::kBufferSize = 16 * 1024;
+
+MetricsTextExporter::MetricsTextExporter(File* file)
+    : file_(file),
+      bytes_written_(0),
+      failed_(false) {
+  DCHECK(file_);
+  buffer_.reserve(kBufferSize);
+}
+
+MetricsTextExporter::MetricsTextExporter(PlatformFile file)
+    : owned_file_(new File(file)),
+      file_(owned_file_.get()),
+      bytes_written_(0),
+      failed_(false) {
+  buffer_.reserve(kBufferSize);
+}
+
+MetricsTextExporter::~MetricsTextExporter() {
+  Flush();
+  if (owned_file_)
+    owned_file_->TakePlatformFile();
+}
+
+void MetricsTextExporter::WriteHistograms(const std::string& query) {
+  // Only copy the pointers under StatisticsRecorder's lock. Histograms are
+  // never deleted, so they can be formatted afterwards without it.
+  StatisticsRecorder::Histograms snapshot;
+  StatisticsRecorder::GetSnapshot(query, &snapshot);
+  for (StatisticsRecorder::Histograms::const_iterator it = snapshot.begin();
+       it != snapshot.end();
+       ++it) {
+    WriteHistogram(**it);
+  }
+}
+
+void MetricsTextExporter::WriteHistogram(const HistogramBase& histogram) {
+  scoped_ptr<HistogramSamples> samples = histogram.SnapshotSamples();
+  const std::string& name = GetMetricName(histogram.histogram_name());
+
+  MaybeFlush();
+  buffer_.append("# TYPE ");
+  buffer_.append(name);
+  buffer_.append(" histogram\n");
+
+  // Buckets are cumulative. The overflow bucket, if any, only shows up in the
+  // +Inf bucket.
+  int64 cumulative_count = 0;
+  scoped_ptr<SampleCountIterator> it = samples->Iterator();
+  if (histogram.GetHistogramType() != SPARSE_HISTOGRAM) {
+    // Every bucket is written, even if it is empty, so that the histogram has
+    // the same series in every export. The iterator skips empty buckets.
+    const BucketRanges* ranges =
+        static_cast<const Histogram&>(histogram).bucket_ranges();
+    for (size_t index = 0; index < ranges->bucket_count(); ++index) {
+      size_t sample_index = 0;
+      if (!it->Done() && it->GetBucketIndex(&sample_index) &&
+          sample_index == index) {
+        HistogramBase::Count count;
+        it->Get(NULL, NULL, &count);
+        cumulative_count += count;
+        it->Next();
+      }
+      HistogramBase::Sample max = ranges->range(index + 1);
+      if (max == HistogramBase::kSampleType_MAX)
+        continue;
+      AppendSample(name, "_bucket",
+                   "{le=\"" + IntToString(max - 1) + "\"}",
+                   cumulative_count);
+    }
+  } else {
+    // Sparse histograms have no fixed buckets, but a sample which was
+    // recorded keeps its bucket in later exports.
+    for (; !it->Done(); it->Next()) {
+      HistogramBase::Sample min;
+      HistogramBase::Sample max;
+      HistogramBase::Count count;
+      it->Get(&min, &max, &count);
+      cumulative_count += count;
+      if (max == HistogramBase::kSampleType_MAX)
+        continue;
+      AppendSample(name, "_bucket",
+                   "{le=\"" + IntToString(max - 1) + "\"}",
+                   cumulative_count);
+    }
+  }
+  AppendSample(name, "_bucket", "{le=\"+Inf\"}", cumulative_count);
+  AppendSample(name, "_sum", std::string(), samples->sum());
+  AppendSample(name, "_count", std::string(), cumulative_count);
+}
+
+void MetricsTextExporter::WriteStatsTable(const StatsTable& table) {
+  int max_counters = table.GetMaxCounters();
+  for (int index = 1; index <= max_counters; ++index) {
+    const char* row_name = table.GetRowName(index);
+    if (!row_name || !*row_name)
+      continue;
+    const std::string& name = GetMetricName(row_name);
+    MaybeFlush();
+    buffer_.append("# TYPE ");
+    buffer_.append(name);
+    buffer_.append(" counter\n");
+    AppendSample(name, "", std::string(), table.GetRowValue(index));
+  }
+}
+
+bool MetricsTextExporter::Flush() {
+  if (buffer_.empty() || failed_)
+    return !failed_;
+
+  int size = static_cast<int>(buffer_.size());
+  int written = file_->WriteAtCurrentPos(buffer_.data(), size);
+  if (written != size) {
+    DLOG(ERROR) << "Failed to write metrics";
+    failed_ = true;
+  } else {
+    bytes_written_ += written;
+  }
+  buffer_.clear();
+  return !failed_;
+}
+
+const std::string& MetricsTextExporter::GetMetricName(
+    const std::string& name) {
+  std::map<std::string, std::string>::const_iterator found =
+      metric_names_.find(name);
+  if (found != metric_names_.end())
+    return found->second;
+
+  std::string metric_name;
+  if (name.empty() || (name[0] >= '0' && name[0] <= '9'))
+    metric_name.push_back('_');
+  for (std::string::const_iterator it = name.begin(); it != name.end(); ++it)
+    metric_name.push_back(IsMetricNameChar(*it) ? *it : '_');
+
+  // Another name may have been sanitized to the same metric name already.
+  if (used_metric_names_.count(metric_name)) {
+    std::string base_name = metric_name;
+    for (int suffix = 2; used_metric_names_.count(metric_name); ++suffix)
+      metric_name = base_name + "_" + IntToString(suffix);
+  }
+  used_metric_names_.insert(metric_name);
+  return metric_names_[name] = metric_name;
+}
+
+void MetricsTextExporter::AppendSample(const std::string& metric_name,
+                                       const char* suffix,
+                                       const std::string& labels,
+                                       int64 value) {
+  MaybeFlush();
+  buffer_.append(metric_name);
+  buffer_.append(suffix);
+  buffer_.append(labels);
+  buffer_.push_back(' ');
+  buffer_.append(Int64ToString(value));
+  buffer_.push_back('\n');
+}
+
+void MetricsTextExporter::MaybeFlush() {
+  if (buffer_.size() + kLineReserve > kBufferSize)
+    Flush();
+}
+
+}  // namespace base
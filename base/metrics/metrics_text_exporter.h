@@ -0,0 +1,113 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+// MetricsTextExporter streams the registered histograms and StatsTable
+// counters of a live process to a file in the Prometheus text exposition
+// format (version 0.0.4):
+//
+//   # TYPE Net_ConnectTime histogram
+//   Net_ConnectTime_bucket{le="9"} 3
+//   Net_ConnectTime_bucket{le="+Inf"} 4
+//   Net_ConnectTime_sum 1234
+//   Net_ConnectTime_count 4
+//
+// Unlike StatisticsRecorder::WriteGraph(), the output is never built in one
+// string: it goes through a small fixed-size buffer that is flushed to the
+// file as it fills up, and only one histogram snapshot is alive at a time.
+// StatisticsRecorder's lock is only held while the list of histograms is
+// copied, not while they are formatted.
+//
+// Metric names are the histogram and counter names with every character
+// outside [a-zA-Z0-9_:] replaced by '_'. When two names map to the same metric
+// name, the one exported later gets a suffix, e.g. "A.b" and "A-b" become
+// A_b and A_b_2. Histogram buckets are exported with the inclusive upper bound
+// of their integer samples. Every bucket of a histogram is exported, even when
+// it is empty, so the same series appear in every export. Sparse histograms
+// have no fixed buckets, and export one bucket per recorded sample.
+
+#ifndef BASE_METRICS_METRICS_TEXT_EXPORTER_H_
+#define BASE_METRICS_METRICS_TEXT_EXPORTER_H_
+
+#include <map>
+#include <set>
+#include <string>
+
+#include "base/base_export.h"
+#include "base/basictypes.h"
+#include "base/files/file.h"
+#include "base/memory/scoped_ptr.h"
+
+namespace base {
+
+class HistogramBase;
+class StatsTable;
+
+class BASE_EXPORT MetricsTextExporter {
+ public:
+  // Size of the output buffer. Output is flushed whenever it is this full.
+  static const size_t kBufferSize;
+
+  // Writes to |file| at its current position. |file| must outlive the
+  // exporter.
+  explicit MetricsTextExporter(File* file);
+
+  // Writes to the already opened |file| descriptor or handle, which is not
+  // closed by the exporter.
+  explicit MetricsTextExporter(PlatformFile file);
+
+  // Flushes any buffered output.
+  ~MetricsTextExporter();
+
+  // Writes every registered histogram which has |query| as a substring of its
+  // name (an empty |query| will process all registered histograms).
+  void WriteHistograms(const std::string& query);
+
+  // Writes a single histogram.
+  void WriteHistogram(const HistogramBase& histogram);
+
+  // Writes every counter and timer of |table| as a counter.
+  void WriteStatsTable(const StatsTable& table);
+
+  // Writes the buffered output to the file. Returns false if this or any
+  // previous write failed.
+  bool Flush();
+
+  // Returns the number of bytes handed to the file so far.
+  int64 bytes_written() const { return bytes_written_; }
+
+ private:
+  // Returns the metric name of the histogram or counter |name|: |name| with
+  // the characters that are not allowed in metric names replaced, and made
+  // unique among the metric names of the exporter.
+  const std::string& GetMetricName(const std::string& name);
+
+  // Appends a sample line: |metric_name||suffix||labels| |value|.
+  void AppendSample(const std::string& metric_name,
+                    const char* suffix,
+                    const std::string& labels,
+                    int64 value);
+
+  // Flushes the buffer if it is close to full.
+  void MaybeFlush();
+
+  // Owns |file_| when constructed from a PlatformFile. The platform file is
+  // released rather than closed on destruction.
+  scoped_ptr<File> owned_file_;
+  File* file_;
+
+  // The metric names given so far, by histogram or counter name, and the set
+  // of them.
+  std::map<std::string, std::string> metric_names_;
+  std::set<std::string> used_metric_names_;
+
+  std::string buffer_;
+  int64 bytes_written_;
+  bool failed_;
+
+  DISALLOW_COPY_AND_ASSIGN(MetricsTextExporter);
+};
+
+}  // namespace base
+
+#endif  // BASE_METRICS_METRICS_TEXT_EXPORTER_H_
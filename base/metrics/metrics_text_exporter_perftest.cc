@@ -0,0 +1,61 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <string>
+
+#include "base/files/file.h"
+#include "base/files/file_path.h"
+#include "base/files/scoped_temp_dir.h"
+#include "base/metrics/histogram.h"
+#include "base/metrics/metrics_text_exporter.h"
+#include "base/metrics/statistics_recorder.h"
+#include "base/strings/stringprintf.h"
+#include "base/time/time.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "testing/perf/perf_test.h"
+
+namespace base {
+
+namespace {
+
+const int kNumHistograms = 10000;
+const int kNumRuns = 10;
+
+TEST(MetricsTextExporterPerfTest, WriteHistograms) {
+  StatisticsRecorder::Initialize();
+  for (int i = 0; i < kNumHistograms; ++i) {
+    HistogramBase* histogram = Histogram::FactoryGet(
+        StringPrintf("PerfTest.Exporter.Histogram%d", i), 1, 10000, 50,
+        HistogramBase::kNoFlags);
+    for (int sample = 1; sample < 10000; sample += 97 + i % 13)
+      histogram->Add(sample);
+  }
+
+  ScopedTempDir temp_dir;
+  ASSERT_TRUE(temp_dir.CreateUniqueTempDir());
+  FilePath path = temp_dir.path().AppendASCII("metrics.txt");
+
+  int64 bytes_written = 0;
+  TimeTicks start = TimeTicks::HighResNow();
+  for (int run = 0; run < kNumRuns; ++run) {
+    File file(path, File::FLAG_CREATE_ALWAYS | File::FLAG_WRITE);
+    ASSERT_TRUE(file.IsValid());
+    MetricsTextExporter exporter(&file);
+    exporter.WriteHistograms("PerfTest.Exporter.");
+    ASSERT_TRUE(exporter.Flush());
+    bytes_written += exporter.bytes_written();
+  }
+  double elapsed_seconds = (TimeTicks::HighResNow() - start).InSecondsF();
+
+  perf_test::PrintResult("histograms_exported", "", "text",
+                         kNumHistograms * kNumRuns / elapsed_seconds,
+                         "histograms/s", true);
+  perf_test::PrintResult("bytes_exported", "", "text",
+                         bytes_written / elapsed_seconds / (1024 * 1024),
+                         "MB/s", true);
+}
+
+}  // namespace
+
+}  // namespace base
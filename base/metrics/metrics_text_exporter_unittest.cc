@@ -0,0 +1,179 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/metrics/metrics_text_exporter.h"
+
+#include <string>
+
+#include "base/files/file.h"
+#include "base/files/file_path.h"
+#include "base/files/file_util.h"
+#include "base/files/scoped_temp_dir.h"
+#include "base/metrics/histogram.h"
+#include "base/metrics/statistics_recorder.h"
+#include "base/metrics/stats_table.h"
+#include "base/strings/stringprintf.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace base {
+
+class MetricsTextExporterTest : public testing::Test {
+ protected:
+  virtual void SetUp() {
+    // Each test will have a clean state (no Histogram / BucketRanges
+    // registered).
+    statistics_recorder_ = new StatisticsRecorder();
+    ASSERT_TRUE(temp_dir_.CreateUniqueTempDir());
+    path_ = temp_dir_.path().AppendASCII("metrics.txt");
+  }
+
+  virtual void TearDown() {
+    delete statistics_recorder_;
+    statistics_recorder_ = NULL;
+  }
+
+  std::string ReadOutput() {
+    std::string output;
+    EXPECT_TRUE(ReadFileToString(path_, &output));
+    return output;
+  }
+
+  StatisticsRecorder* statistics_recorder_;
+  ScopedTempDir temp_dir_;
+  FilePath path_;
+};
+
+TEST_F(MetricsTextExporterTest, WriteHistogram) {
+  // Buckets: [0, 1), [1, 2), [2, 3), [3, 4), [4, 5), [5, INT_MAX).
+  HistogramBase* histogram = LinearHistogram::FactoryGet(
+      "Test.Linear", 1, 5, 6, HistogramBase::kNoFlags);
+  histogram->Add(0);
+  histogram->Add(2);
+  histogram->Add(2);
+  histogram->Add(10);
+
+  File file(path_, File::FLAG_CREATE_ALWAYS | File::FLAG_WRITE);
+  ASSERT_TRUE(file.IsValid());
+  {
+    MetricsTextExporter exporter(&file);
+    exporter.WriteHistograms(std::string());
+    EXPECT_TRUE(exporter.Flush());
+  }
+  file.Close();
+
+  EXPECT_EQ("# TYPE Test_Linear histogram\n"
+            "Test_Linear_bucket{le=\"0\"} 1\n"
+            "Test_Linear_bucket{le=\"1\"} 1\n"
+            "Test_Linear_bucket{le=\"2\"} 3\n"
+            "Test_Linear_bucket{le=\"3\"} 3\n"
+            "Test_Linear_bucket{le=\"4\"} 3\n"
+            "Test_Linear_bucket{le=\"+Inf\"} 4\n"
+            "Test_Linear_sum 14\n"
+            "Test_Linear_count 4\n",
+            ReadOutput());
+}
+
+TEST_F(MetricsTextExporterTest, EmptyHistogramAndNameSanitizing) {
+  LinearHistogram::FactoryGet("1st.Name-x", 1, 5, 6, HistogramBase::kNoFlags);
+
+  File file(path_, File::FLAG_CREATE_ALWAYS | File::FLAG_WRITE);
+  ASSERT_TRUE(file.IsValid());
+  {
+    MetricsTextExporter exporter(file.GetPlatformFile());
+    exporter.WriteHistograms(std::string());
+  }
+  // The exporter released the platform file rather than closing it.
+  EXPECT_TRUE(file.IsValid());
+  file.Close();
+
+  EXPECT_EQ("# TYPE _1st_Name_x histogram\n"
+            "_1st_Name_x_bucket{le=\"0\"} 0\n"
+            "_1st_Name_x_bucket{le=\"1\"} 0\n"
+            "_1st_Name_x_bucket{le=\"2\"} 0\n"
+            "_1st_Name_x_bucket{le=\"3\"} 0\n"
+            "_1st_Name_x_bucket{le=\"4\"} 0\n"
+            "_1st_Name_x_bucket{le=\"+Inf\"} 0\n"
+            "_1st_Name_x_sum 0\n"
+            "_1st_Name_x_count 0\n",
+            ReadOutput());
+}
+
+TEST_F(MetricsTextExporterTest, NameCollisions) {
+  HistogramBase* dotted = LinearHistogram::FactoryGet(
+      "Test.Name", 1, 2, 3, HistogramBase::kNoFlags);
+  HistogramBase* dashed = LinearHistogram::FactoryGet(
+      "Test-Name", 1, 2, 3, HistogramBase::kNoFlags);
+
+  File file(path_, File::FLAG_CREATE_ALWAYS | File::FLAG_WRITE);
+  ASSERT_TRUE(file.IsValid());
+  {
+    MetricsTextExporter exporter(&file);
+    exporter.WriteHistogram(*dotted);
+    exporter.WriteHistogram(*dashed);
+    // A histogram keeps its metric name when it is written again.
+    exporter.WriteHistogram(*dotted);
+  }
+  file.Close();
+
+  std::string output = ReadOutput();
+  const char kDotted[] = "# TYPE Test_Name histogram\n";
+  const char kDashed[] = "# TYPE Test_Name_2 histogram\n";
+  size_t first = output.find(kDotted);
+  ASSERT_NE(std::string::npos, first);
+  size_t second = output.find(kDashed);
+  ASSERT_NE(std::string::npos, second);
+  EXPECT_LT(first, second);
+  EXPECT_NE(std::string::npos, output.find(kDotted, second));
+  EXPECT_NE(std::string::npos, output.find("Test_Name_2_count 0\n"));
+}
+
+TEST_F(MetricsTextExporterTest, WriteStatsTable) {
+  StatsTable table(StatsTable::TableIdentifier(), 1, 5);
+  int slot_id = table.RegisterThread("main");
+  ASSERT_NE(0, slot_id);
+  int counter_id = table.FindCounter("c:Test.Counter");
+  ASSERT_NE(0, counter_id);
+  *table.GetLocation(counter_id, slot_id) = 7;
+
+  File file(path_, File::FLAG_CREATE_ALWAYS | File::FLAG_WRITE);
+  ASSERT_TRUE(file.IsValid());
+  {
+    MetricsTextExporter exporter(&file);
+    exporter.WriteStatsTable(table);
+  }
+  file.Close();
+
+  EXPECT_EQ("# TYPE c:Test_Counter counter\n"
+            "c:Test_Counter 7\n",
+            ReadOutput());
+}
+
+TEST_F(MetricsTextExporterTest, OutputLargerThanBuffer) {
+  for (int i = 0; i < 500; ++i) {
+    HistogramBase* histogram = Histogram::FactoryGet(
+        StringPrintf("Test.Histogram%d", i), 1, 1000, 50,
+        HistogramBase::kNoFlags);
+    for (int sample = 1; sample < 1000; sample += 7)
+      histogram->Add(sample);
+  }
+
+  File file(path_, File::FLAG_CREATE_ALWAYS | File::FLAG_WRITE);
+  ASSERT_TRUE(file.IsValid());
+  int64 bytes_written = 0;
+  {
+    MetricsTextExporter exporter(&file);
+    exporter.WriteHistograms("Test.");
+    EXPECT_TRUE(exporter.Flush());
+    bytes_written = exporter.bytes_written();
+  }
+  file.Close();
+
+  std::string output = ReadOutput();
+  EXPECT_LT(MetricsTextExporter::kBufferSize, output.size());
+  EXPECT_EQ(static_cast<int64>(output.size()), bytes_written);
+  EXPECT_NE(std::string::npos,
+            output.find("Test_Histogram499_count 143\n"));
+}
+
+}  // namespace base
@@ -0,0 +1,160 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/metrics/rolling_histogram.h"
+
+#include <algorithm>
+
+#include "base/logging.h"
+#include "base/metrics/bucket_ranges.h"
+#include "base/metrics/sample_vector.h"
+#include "base/metrics/statistics_recorder.h"
+#include "base/time/default_tick_clock.h"
+#include "base/time/tick_clock.h"
+
+namespace base {
+
+typedef HistogramBase::Count Count;
+typedef HistogramBase::Sample Sample;
+
+// static
+const size_t RollingHistogram::kSlabCount = 10u;
+
+// static
+HistogramBase* RollingHistogram::FactoryGet(const std::string& name,
+                                            Sample minimum,
+                                            Sample maximum,
+                                            size_t bucket_count,
+                                            TimeDelta window,
+                                            int32 flags) {
+  bool valid_arguments =
+      InspectConstructionArguments(name, &minimum, &maximum, &bucket_count);
+  DCHECK(valid_arguments);
+  DCHECK_GE(window.InMicroseconds(), static_cast<int64>(kSlabCount));
+
+  HistogramBase* histogram = StatisticsRecorder::FindHistogram(name);
+  if (!histogram) {
+    // To avoid racy destruction at shutdown, the following will be leaked.
+    BucketRanges* ranges = new BucketRanges(bucket_count + 1);
+    InitializeBucketRanges(minimum, maximum, ranges);
+    const BucketRanges* registered_ranges =
+        StatisticsRecorder::RegisterOrDeleteDuplicateRanges(ranges);
+
+    RollingHistogram* tentative_histogram =
+        new RollingHistogram(name, minimum, maximum, registered_ranges, window);
+
+    tentative_histogram->SetFlags(flags);
+    histogram =
+        StatisticsRecorder::RegisterOrDeleteDuplicate(tentative_histogram);
+  }
+
+  DCHECK_EQ(HISTOGRAM, histogram->GetHistogramType());
+  if (!histogram->HasConstructionArguments(minimum, maximum, bucket_count)) {
+    DLOG(ERROR) << "Histogram " << name << " has bad construction arguments";
+    return NULL;
+  }
+  return histogram;
+}
+
+// static
+HistogramBase* RollingHistogram::FactoryTimeGet(const std::string& name,
+                                                TimeDelta minimum,
+                                                TimeDelta maximum,
+                                                size_t bucket_count,
+                                                TimeDelta window,
+                                                int32 flags) {
+  return FactoryGet(name, static_cast<Sample>(minimum.InMilliseconds()),
+                    static_cast<Sample>(maximum.InMilliseconds()), bucket_count,
+                    window, flags);
+}
+
+RollingHistogram::RollingHistogram(const std::string& name,
+                                   Sample minimum,
+                                   Sample maximum,
+                                   const BucketRanges* ranges,
+                                   TimeDelta window)
+    : Histogram(name, minimum, maximum, ranges),
+      slab_duration_(TimeDelta::FromMicroseconds(
+          std::max(window.InMicroseconds() / static_cast<int64>(kSlabCount),
+                   static_cast<int64>(1)))),
+      tick_clock_(new DefaultTickClock()),
+      slab_intervals_(kSlabCount, -1) {
+  origin_ = tick_clock_->NowTicks();
+  for (size_t i = 0; i < kSlabCount; ++i)
+    slabs_.push_back(new SampleVector(ranges));
+}
+
+RollingHistogram::~RollingHistogram() {
+}
+
+void RollingHistogram::SetTickClockForTesting(
+    scoped_ptr<TickClock> tick_clock) {
+  AutoLock auto_lock(lock_);
+  tick_clock_ = tick_clock.Pass();
+  origin_ = tick_clock_->NowTicks();
+  for (size_t i = 0; i < kSlabCount; ++i)
+    slab_intervals_[i] = -1;
+}
+
+void RollingHistogram::Add(Sample value) {
+  Histogram::Add(value);
+
+  // Same clamping as Histogram::Add().
+  if (value > kSampleType_MAX - 1)
+    value = kSampleType_MAX - 1;
+  if (value < 0)
+    value = 0;
+
+  AutoLock auto_lock(lock_);
+  GetSlab(CurrentInterval())->Accumulate(value, 1);
+}
+
+void RollingHistogram::AddSamples(const HistogramSamples& samples) {
+  Histogram::AddSamples(samples);
+
+  AutoLock auto_lock(lock_);
+  GetSlab(CurrentInterval())->Add(samples);
+}
+
+bool RollingHistogram::AddSamplesFromPickle(PickleIterator* iter) {
+  // The pickle can only be read once, so decode it before adding the samples
+  // to both the lifetime counts and the current slab.
+  SampleVector samples(bucket_ranges());
+  if (!samples.AddFromPickle(iter))
+    return false;
+  AddSamples(samples);
+  return true;
+}
+
+scoped_ptr<SampleVector> RollingHistogram::SnapshotSampleVector() const {
+  scoped_ptr<SampleVector> samples(new SampleVector(bucket_ranges()));
+
+  AutoLock auto_lock(lock_);
+  int64 oldest_interval =
+      CurrentInterval() - static_cast<int64>(kSlabCount) + 1;
+  for (size_t i = 0; i < kSlabCount; ++i) {
+    if (slab_intervals_[i] >= oldest_interval)
+      samples->Add(*slabs_[i]);
+  }
+  return samples.Pass();
+}
+
+int64 RollingHistogram::CurrentInterval() const {
+  lock_.AssertAcquired();
+  return (tick_clock_->NowTicks() - origin_) / slab_duration_;
+}
+
+SampleVector* RollingHistogram::GetSlab(int64 interval) {
+  lock_.AssertAcquired();
+  size_t index = static_cast<size_t>(interval % kSlabCount);
+  if (slab_intervals_[index] != interval) {
+    // The slab holds samples from kSlabCount or more intervals ago; recycle it.
+    delete slabs_[index];
+    slabs_[index] = new SampleVector(bucket_ranges());
+    slab_intervals_[index] = interval;
+  }
+  return slabs_[index];
+}
+
+}  // namespace base
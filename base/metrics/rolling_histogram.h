@@ -0,0 +1,107 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+// RollingHistogram is a Histogram whose displayed samples only cover a recent
+// time window (for example the last 10 seconds), which makes it possible to
+// read live percentiles without diffing snapshots externally.
+//
+// The window is split into kSlabCount slabs of equal duration. Each slab is a
+// SampleVector sharing the histogram's BucketRanges, tagged with the interval
+// it belongs to, so no per-sample timestamps are kept. When a sample lands in
+// a new interval, the oldest slab is recycled for it. SnapshotSamples() (and
+// therefore WriteAscii(), WriteHTMLGraph() and WriteJSON()) sums the slabs
+// that are still inside the window. The window hence covers between
+// (kSlabCount - 1) and kSlabCount slab durations.
+//
+// The lifetime samples are still accumulated as for any Histogram, and are
+// what SnapshotDelta() reports, so a RollingHistogram is uploaded and shipped
+// across processes exactly like a regular HISTOGRAM.
+
+#ifndef BASE_METRICS_ROLLING_HISTOGRAM_H_
+#define BASE_METRICS_ROLLING_HISTOGRAM_H_
+
+#include <string>
+#include <vector>
+
+#include "base/base_export.h"
+#include "base/basictypes.h"
+#include "base/memory/scoped_ptr.h"
+#include "base/memory/scoped_vector.h"
+#include "base/metrics/histogram.h"
+#include "base/synchronization/lock.h"
+#include "base/time/time.h"
+
+namespace base {
+
+class TickClock;
+
+class BASE_EXPORT RollingHistogram : public Histogram {
+ public:
+  // Number of slabs the window is split into.
+  static const size_t kSlabCount;
+
+  // Same arguments as Histogram::FactoryGet(), plus the |window| the
+  // snapshots should cover.
+  static HistogramBase* FactoryGet(const std::string& name,
+                                   Sample minimum,
+                                   Sample maximum,
+                                   size_t bucket_count,
+                                   TimeDelta window,
+                                   int32 flags);
+  static HistogramBase* FactoryTimeGet(const std::string& name,
+                                       TimeDelta minimum,
+                                       TimeDelta maximum,
+                                       size_t bucket_count,
+                                       TimeDelta window,
+                                       int32 flags);
+
+  virtual ~RollingHistogram();
+
+  TimeDelta window() const { return slab_duration_ * kSlabCount; }
+
+  // Replaces the clock used to assign samples to slabs. Takes ownership.
+  void SetTickClockForTesting(scoped_ptr<TickClock> tick_clock);
+
+  // Histogram implementation:
+  virtual void Add(Sample value) override;
+  virtual void AddSamples(const HistogramSamples& samples) override;
+  virtual bool AddSamplesFromPickle(PickleIterator* iter) override;
+
+ protected:
+  RollingHistogram(const std::string& name,
+                   Sample minimum,
+                   Sample maximum,
+                   const BucketRanges* ranges,
+                   TimeDelta window);
+
+  // Returns the samples within the window rather than the lifetime samples.
+  virtual scoped_ptr<SampleVector> SnapshotSampleVector() const override;
+
+ private:
+  // Returns the index of the slab interval containing the current time.
+  // |lock_| must be held.
+  int64 CurrentInterval() const;
+
+  // Returns the slab for |interval|, recycling the oldest one if needed.
+  // |lock_| must be held.
+  SampleVector* GetSlab(int64 interval);
+
+  TimeDelta slab_duration_;
+  TimeTicks origin_;
+  scoped_ptr<TickClock> tick_clock_;
+
+  // Protects |slabs_| and |slab_intervals_|.
+  mutable Lock lock_;
+
+  // |slabs_[i]| holds the samples of interval |slab_intervals_[i]|, where
+  // i == interval % kSlabCount.
+  ScopedVector<SampleVector> slabs_;
+  std::vector<int64> slab_intervals_;
+
+  DISALLOW_COPY_AND_ASSIGN(RollingHistogram);
+};
+
+}  // namespace base
+
+#endif  // BASE_METRICS_ROLLING_HISTOGRAM_H_
@@ -0,0 +1,117 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/metrics/rolling_histogram.h"
+
+#include <string>
+
+#include "base/memory/scoped_ptr.h"
+#include "base/metrics/histogram_samples.h"
+#include "base/metrics/statistics_recorder.h"
+#include "base/test/simple_test_tick_clock.h"
+#include "base/time/time.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace base {
+
+class RollingHistogramTest : public testing::Test {
+ protected:
+  virtual void SetUp() {
+    // Each test will have a clean state (no Histogram / BucketRanges
+    // registered).
+    statistics_recorder_ = new StatisticsRecorder();
+  }
+
+  virtual void TearDown() {
+    delete statistics_recorder_;
+    statistics_recorder_ = NULL;
+  }
+
+  // Creates a histogram with a 10 second window, i.e. 1 second slabs, driven
+  // by |clock_|.
+  RollingHistogram* CreateHistogram(const std::string& name) {
+    RollingHistogram* histogram = static_cast<RollingHistogram*>(
+        RollingHistogram::FactoryGet(name, 1, 1000, 10,
+                                     TimeDelta::FromSeconds(10),
+                                     HistogramBase::kNoFlags));
+    clock_ = new SimpleTestTickClock();
+    histogram->SetTickClockForTesting(scoped_ptr<TickClock>(clock_));
+    return histogram;
+  }
+
+  StatisticsRecorder* statistics_recorder_;
+  SimpleTestTickClock* clock_;  // Owned by the histogram.
+};
+
+TEST_F(RollingHistogramTest, BasicTest) {
+  RollingHistogram* histogram = CreateHistogram("Rolling");
+  EXPECT_EQ(TimeDelta::FromSeconds(10), histogram->window());
+  EXPECT_EQ(HISTOGRAM, histogram->GetHistogramType());
+
+  // The same histogram is returned for the same name.
+  EXPECT_EQ(histogram,
+            RollingHistogram::FactoryGet("Rolling", 1, 1000, 10,
+                                         TimeDelta::FromSeconds(10),
+                                         HistogramBase::kNoFlags));
+
+  histogram->Add(5);
+  histogram->Add(500);
+  scoped_ptr<HistogramSamples> snapshot(histogram->SnapshotSamples());
+  EXPECT_EQ(2, snapshot->TotalCount());
+  EXPECT_EQ(1, snapshot->GetCount(5));
+  EXPECT_EQ(1, snapshot->GetCount(500));
+}
+
+TEST_F(RollingHistogramTest, WindowExpiresOldSamples) {
+  RollingHistogram* histogram = CreateHistogram("Rolling");
+
+  histogram->Add(5);
+  clock_->Advance(TimeDelta::FromMilliseconds(5500));
+  histogram->Add(500);
+  histogram->Add(500);
+
+  scoped_ptr<HistogramSamples> snapshot(histogram->SnapshotSamples());
+  EXPECT_EQ(3, snapshot->TotalCount());
+
+  // The first sample falls out of the window once its slab is ten slabs old.
+  clock_->Advance(TimeDelta::FromMilliseconds(4000));
+  snapshot = histogram->SnapshotSamples();
+  EXPECT_EQ(3, snapshot->TotalCount());
+  clock_->Advance(TimeDelta::FromMilliseconds(1000));
+  snapshot = histogram->SnapshotSamples();
+  EXPECT_EQ(2, snapshot->TotalCount());
+  EXPECT_EQ(0, snapshot->GetCount(5));
+  EXPECT_EQ(2, snapshot->GetCount(500));
+
+  // A slab is recycled for new samples once it has expired.
+  clock_->Advance(TimeDelta::FromSeconds(10));
+  histogram->Add(5);
+  snapshot = histogram->SnapshotSamples();
+  EXPECT_EQ(1, snapshot->TotalCount());
+  EXPECT_EQ(1, snapshot->GetCount(5));
+
+  // The ASCII output only shows the window.
+  std::string ascii;
+  histogram->WriteAscii(&ascii);
+  EXPECT_NE(std::string::npos, ascii.find("recorded 1 samples"));
+
+  // Deltas still report the lifetime samples.
+  scoped_ptr<HistogramSamples> delta(histogram->SnapshotDelta());
+  ASSERT_TRUE(delta);
+  EXPECT_EQ(4, delta->TotalCount());
+}
+
+TEST_F(RollingHistogramTest, AddSamples) {
+  RollingHistogram* histogram = CreateHistogram("Rolling");
+  histogram->Add(5);
+  scoped_ptr<HistogramSamples> samples(histogram->SnapshotSamples());
+
+  clock_->Advance(TimeDelta::FromSeconds(20));
+  histogram->AddSamples(*samples);
+  scoped_ptr<HistogramSamples> snapshot(histogram->SnapshotSamples());
+  EXPECT_EQ(1, snapshot->TotalCount());
+  EXPECT_EQ(1, snapshot->GetCount(5));
+}
+
+}  // namespace base
@@ -4,6 +4,8 @@
 
 #include "base/metrics/sample_vector.h"
 
+#include <algorithm>
+
 #include "base/logging.h"
 #include "base/metrics/bucket_ranges.h"
 
@@ -16,6 +18,11 @@ typedef HistogramBase::Sample Sample;
 
 SampleVector::SampleVector(const BucketRanges* bucket_ranges)
     : counts_(bucket_ranges->bucket_count()),
+      dirty_groups_(
+          (bucket_ranges->bucket_count() + kBucketsPerDirtyGroup - 1) /
+          kBucketsPerDirtyGroup),
+      logged_sum_(0),
+      logged_redundant_count_(0),
       bucket_ranges_(bucket_ranges) {
   CHECK_GE(bucket_ranges_->bucket_count(), 1u);
 }
@@ -26,6 +33,7 @@ void SampleVector::Accumulate(Sample value, Count count) {
   size_t bucket_index = GetBucketIndex(value);
   subtle::NoBarrier_Store(&counts_[bucket_index],
       subtle::NoBarrier_Load(&counts_[bucket_index]) + count);
+  MarkBucketDirty(bucket_index);
   IncreaseSum(count * value);
   IncreaseRedundantCount(count);
 }
@@ -48,6 +56,47 @@ Count SampleVector::GetCountAtIndex(size_t bucket_index) const {
   return subtle::NoBarrier_Load(&counts_[bucket_index]);
 }
 
+scoped_ptr<SampleVector> SampleVector::ExtractDelta() {
+  if (logged_counts_.empty())
+    logged_counts_.resize(counts_.size());
+
+  scoped_ptr<SampleVector> delta;
+  for (size_t group = 0; group < dirty_groups_.size(); ++group) {
+    if (!subtle::NoBarrier_Load(&dirty_groups_[group]))
+      continue;
+    // Clear the flag before reading the counts, so that a concurrent
+    // Accumulate() either lands in this delta or marks the group again.
+    subtle::NoBarrier_AtomicExchange(&dirty_groups_[group], 0);
+    subtle::MemoryBarrier();
+
+    size_t begin = group * kBucketsPerDirtyGroup;
+    size_t end = std::min(begin + kBucketsPerDirtyGroup, counts_.size());
+    for (size_t i = begin; i < end; ++i) {
+      Count current = subtle::NoBarrier_Load(&counts_[i]);
+      Count change = current - logged_counts_[i];
+      if (!change)
+        continue;
+      if (!delta)
+        delta.reset(new SampleVector(bucket_ranges_));
+      subtle::NoBarrier_Store(&delta->counts_[i], change);
+      logged_counts_[i] = current;
+    }
+  }
+
+  int64 sum_change = sum() - logged_sum_;
+  Count redundant_count_change = redundant_count() - logged_redundant_count_;
+  if (!delta && !sum_change && !redundant_count_change)
+    return delta.Pass();
+
+  if (!delta)
+    delta.reset(new SampleVector(bucket_ranges_));
+  delta->IncreaseSum(sum_change);
+  delta->IncreaseRedundantCount(redundant_count_change);
+  logged_sum_ += sum_change;
+  logged_redundant_count_ += redundant_count_change;
+  return delta.Pass();
+}
+
 scoped_ptr<SampleCountIterator> SampleVector::Iterator() const {
   return scoped_ptr<SampleCountIterator>(
       new SampleVectorIterator(&counts_, bucket_ranges_));
@@ -70,6 +119,7 @@ bool SampleVector::AddSubtractImpl(SampleCountIterator* iter,
           subtle::NoBarrier_Load(&counts_[index]);
       subtle::NoBarrier_Store(&counts_[index],
           old_counts + ((op ==  HistogramSamples::ADD) ? count : -count));
+      MarkBucketDirty(index);
       iter->Next();
     } else if (min > bucket_ranges_->range(index)) {
       // Sample is larger than current bucket range. Try next.
@@ -111,6 +161,14 @@ size_t SampleVector::GetBucketIndex(Sample value) const {
   return mid;
 }
 
+void SampleVector::MarkBucketDirty(size_t bucket_index) {
+  HistogramBase::AtomicCount* dirty =
+      &dirty_groups_[bucket_index / kBucketsPerDirtyGroup];
+  // Avoid writing to the shared cache line when the group is already marked.
+  if (!subtle::NoBarrier_Load(dirty))
+    subtle::NoBarrier_Store(dirty, 1);
+}
+
 SampleVectorIterator::SampleVectorIterator(const vector<Count>* counts,
                                            const BucketRanges* bucket_ranges)
     : counts_(counts),
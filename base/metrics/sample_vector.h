@@ -36,6 +36,13 @@ class BASE_EXPORT_PRIVATE SampleVector : public HistogramSamples {
   // Get count of a specific bucket.
   HistogramBase::Count GetCountAtIndex(size_t bucket_index) const;
 
+  // Extracts the samples accumulated since the previous call and marks them as
+  // logged. Only bucket groups that changed since that call are visited, so
+  // the cost is proportional to recent activity rather than to the number of
+  // buckets. Returns NULL if nothing was accumulated in between. Must not be
+  // called concurrently with itself.
+  scoped_ptr<SampleVector> ExtractDelta();
+
  protected:
   virtual bool AddSubtractImpl(
       SampleCountIterator* iter,
@@ -46,8 +53,25 @@ class BASE_EXPORT_PRIVATE SampleVector : public HistogramSamples {
  private:
   FRIEND_TEST_ALL_PREFIXES(HistogramTest, CorruptSampleCounts);
 
+  // Number of consecutive buckets sharing one dirty flag. 16 counts fill a
+  // typical 64-byte cache line.
+  static const size_t kBucketsPerDirtyGroup = 16;
+
+  // Flags the group holding |bucket_index| as changed since the last delta.
+  void MarkBucketDirty(size_t bucket_index);
+
   std::vector<HistogramBase::AtomicCount> counts_;
 
+  // One flag per group of kBucketsPerDirtyGroup buckets. Set whenever a count
+  // in the group changes and cleared by ExtractDelta().
+  std::vector<HistogramBase::AtomicCount> dirty_groups_;
+
+  // The counts, sum and redundant count already handed out by ExtractDelta().
+  // |logged_counts_| is only allocated on the first call.
+  std::vector<HistogramBase::Count> logged_counts_;
+  int64 logged_sum_;
+  HistogramBase::Count logged_redundant_count_;
+
   // Shares the same BucketRanges with Histogram object.
   const BucketRanges* const bucket_ranges_;
 
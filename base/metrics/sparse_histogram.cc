@@ -60,6 +60,39 @@ scoped_ptr<HistogramSamples> SparseHistogram::SnapshotSamples() const {
   return snapshot.Pass();
 }
 
+scoped_ptr<HistogramSamples> SparseHistogram::SnapshotDelta() {
+  // Both maps are sorted by value, so they are walked in order together,
+  // without lookups.
+  scoped_ptr<SampleMap> delta;
+
+  base::AutoLock auto_lock(lock_);
+  scoped_ptr<SampleCountIterator> logged = logged_samples_.Iterator();
+  for (scoped_ptr<SampleCountIterator> it = samples_.Iterator(); !it->Done();
+       it->Next()) {
+    Sample value;
+    Count count;
+    it->Get(&value, NULL, &count);
+    Count change = count;
+    for (; !logged->Done(); logged->Next()) {
+      Sample logged_value;
+      Count logged_count;
+      logged->Get(&logged_value, NULL, &logged_count);
+      if (logged_value > value)
+        break;
+      if (logged_value == value)
+        change -= logged_count;
+    }
+    if (!change)
+      continue;
+    if (!delta)
+      delta.reset(new SampleMap());
+    delta->Accumulate(value, change);
+  }
+  if (delta)
+    logged_samples_.Add(*delta);
+  return delta.Pass();
+}
+
 void SparseHistogram::AddSamples(const HistogramSamples& samples) {
   base::AutoLock auto_lock(lock_);
   samples_.Add(samples);
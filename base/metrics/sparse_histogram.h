@@ -46,6 +46,7 @@ class BASE_EXPORT_PRIVATE SparseHistogram : public HistogramBase {
   virtual void AddSamples(const HistogramSamples& samples) override;
   virtual bool AddSamplesFromPickle(PickleIterator* iter) override;
   virtual scoped_ptr<HistogramSamples> SnapshotSamples() const override;
+  virtual scoped_ptr<HistogramSamples> SnapshotDelta() override;
   virtual void WriteHTMLGraph(std::string* output) const override;
   virtual void WriteAscii(std::string* output) const override;
 
@@ -78,11 +79,15 @@ class BASE_EXPORT_PRIVATE SparseHistogram : public HistogramBase {
   // For constuctor calling.
   friend class SparseHistogramTest;
 
-  // Protects access to |samples_|.
+  // Protects access to |samples_| and |logged_samples_|.
   mutable base::Lock lock_;
 
   SampleMap samples_;
 
+  // Samples already handed out by SnapshotDelta(). Only touched when a delta
+  // is taken, so that recording a sample stays as cheap as without deltas.
+  SampleMap logged_samples_;
+
   DISALLOW_COPY_AND_ASSIGN(SparseHistogram);
 };
 
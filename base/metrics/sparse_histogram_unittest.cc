@@ -63,6 +63,54 @@ TEST_F(SparseHistogramTest, BasicTest) {
   EXPECT_EQ(1, snapshot2->GetCount(101));
 }
 
+TEST_F(SparseHistogramTest, SnapshotDelta) {
+  scoped_ptr<SparseHistogram> histogram(NewSparseHistogram("Sparse"));
+  EXPECT_FALSE(histogram->SnapshotDelta());
+
+  histogram->Add(100);
+  histogram->Add(100);
+  scoped_ptr<HistogramSamples> delta1(histogram->SnapshotDelta());
+  ASSERT_TRUE(delta1);
+  EXPECT_EQ(2, delta1->TotalCount());
+  EXPECT_EQ(2, delta1->GetCount(100));
+  EXPECT_FALSE(histogram->SnapshotDelta());
+
+  histogram->Add(100);
+  histogram->Add(101);
+  scoped_ptr<HistogramSamples> delta2(histogram->SnapshotDelta());
+  ASSERT_TRUE(delta2);
+  EXPECT_EQ(2, delta2->TotalCount());
+  EXPECT_EQ(1, delta2->GetCount(100));
+  EXPECT_EQ(1, delta2->GetCount(101));
+  EXPECT_EQ(201, delta2->sum());
+
+  // Merged samples are part of the next delta too.
+  SampleMap merged;
+  merged.Accumulate(102, 3);
+  histogram->AddSamples(merged);
+  scoped_ptr<HistogramSamples> delta3(histogram->SnapshotDelta());
+  ASSERT_TRUE(delta3);
+  EXPECT_EQ(3, delta3->TotalCount());
+  EXPECT_EQ(3, delta3->GetCount(102));
+  EXPECT_EQ(0, delta3->GetCount(100));
+
+  // New values sorted before and between logged ones.
+  histogram->Add(99);
+  histogram->Add(101);
+  histogram->Add(103);
+  scoped_ptr<HistogramSamples> delta4(histogram->SnapshotDelta());
+  ASSERT_TRUE(delta4);
+  EXPECT_EQ(3, delta4->TotalCount());
+  EXPECT_EQ(1, delta4->GetCount(99));
+  EXPECT_EQ(1, delta4->GetCount(101));
+  EXPECT_EQ(1, delta4->GetCount(103));
+  EXPECT_EQ(0, delta4->GetCount(102));
+
+  // The full snapshot is unaffected by delta tracking.
+  scoped_ptr<HistogramSamples> snapshot(histogram->SnapshotSamples());
+  EXPECT_EQ(10, snapshot->TotalCount());
+}
+
 TEST_F(SparseHistogramTest, MacroBasicTest) {
   UMA_HISTOGRAM_SPARSE_SLOWLY("Sparse", 100);
   UMA_HISTOGRAM_SPARSE_SLOWLY("Sparse", 200);
@@ -4,6 +4,15 @@
 
 #include "base/metrics/stats_table.h"
 
+#if defined(OS_POSIX)
+#include <errno.h>
+#include <signal.h>
+#elif defined(OS_WIN)
+#include <windows.h>
+#endif
+
+#include "base/atomicops.h"
+#include "base/hash.h"
 #include "base/logging.h"
 #include "base/memory/scoped_ptr.h"
 #include "base/memory/shared_memory.h"
@@ -20,6 +29,7 @@ namespace base {
 //
 // +-------------------------------------------+
 // | Version | Size | MaxCounters | MaxThreads |
+// | NumCounters                               |
 // +-------------------------------------------+
 // | Thread names table                        |
 // +-------------------------------------------+
@@ -29,11 +39,37 @@ namespace base {
 // +-------------------------------------------+
 // | Counter names table                       |
 // +-------------------------------------------+
-// | Data                                      |
+// | Counter hash table                        |
 // +-------------------------------------------+
+// | Data segment 1                            |
+// +-------------------------------------------+
+// | ...                                       |
+// +-------------------------------------------+
+// | Data segment N                            |
+// +-------------------------------------------+
+//
+// The data is logically a grid, where the columns are the thread_ids and the
+// rows are the counter_ids.  Physically, the rows are grouped in segments of
+// kCountersPerSegment rows.  Within a segment, each thread has its own
+// contiguous run of kCountersPerSegment values, aligned to a cache line, so
+// threads updating the same counter never write to the same cache line.
+// The number of segments is fixed when the table is created: a table is
+// shared between processes as a single shared memory segment, so it cannot
+// be extended with segments mapped later.  Instead, the rows of a table are
+// only zeroed, and so their pages only committed, as counters are added: a
+// table reserves address space for |max_counters| counters up front, but its
+// memory grows with the counters actually used.
 //
-// The data layout is a grid, where the columns are the thread_ids and the
-// rows are the counter_ids.
+// The counter hash table is an open-addressed table of counter ids, indexed
+// by the hash of the counter name and probed linearly.  A slot is 0 when it
+// is empty.  To add a counter, a thread reserves an empty slot with a
+// compare-and-swap, storing the negated id of its process, allocates a row by
+// atomically incrementing NumCounters, writes the name of the row, and then
+// publishes its id in the slot.  Lookups which reach a reserved slot wait for
+// its id, so two threads adding the same counter never both allocate a row
+// for it.  A process which dies while adding a counter never publishes it, so
+// waiting lookups eventually check whether the reserving process still runs,
+// and free its slot if it doesn't.
 //
 // If the first character of the thread_name is '\0', then that column is
 // empty.
@@ -48,17 +84,10 @@ namespace base {
 // required.
 //
 // At the shared-memory level, we have a lock.  This lock protects the
-// shared-memory table only, and is used when we create new counters (e.g.
-// use rows) or when we register new threads (e.g. use columns).  Reading
-// data from the table does not require any locking at the shared memory
-// level.
-//
-// Each process which accesses the table will create a StatsTable object.
-// The StatsTable maintains a hash table of the existing counters in the
-// table for faster lookup.  Since the hash table is process specific,
-// each process maintains its own cache.  We avoid complexity here by never
-// de-allocating from the hash table.  (Counters are dynamically added,
-// but not dynamically removed).
+// thread tables only, and is used when we register new threads (e.g. use
+// columns).  Creating and finding counters (e.g. using rows) doesn't take
+// it, and reading data from the table does not require any locking either.
+// Counters are dynamically added, but not dynamically removed.
 
 // In order for external viewers to be able to read our shared memory,
 // we all need to use the same size ints.
@@ -68,11 +97,23 @@ namespace {
 
 // An internal version in case we ever change the format of this
 // file, and so that we can identify our table.
-const int kTableVersion = 0x13131313;
+const int kTableVersion = 0x13131314;
+
+// How many times a lookup yields while waiting for a reserved slot of the
+// counter hash table before it checks whether the reserving process died.
+const int kReservedSlotYields = 100;
 
 // The name for un-named counters and threads in the table.
 const char kUnknownName[] = "<unknown>";
 
+// The alignment of the data segments, so that no two threads share a cache
+// line.
+const int kCacheLineSize = 64;
+
+COMPILE_ASSERT(StatsTable::kCountersPerSegment * sizeof(int) %
+                   kCacheLineSize == 0,
+               segment_runs_must_fill_cache_lines);
+
 // Calculates delta to align an offset to the size of an int
 inline int AlignOffset(int offset) {
   return (sizeof(int) - (offset % sizeof(int))) % sizeof(int);
@@ -82,6 +123,42 @@ inline int AlignedSize(int size) {
   return size + AlignOffset(size);
 }
 
+// Calculates delta to align an offset to a cache line.
+inline int AlignOffsetToCacheLine(int offset) {
+  return (kCacheLineSize - (offset % kCacheLineSize)) % kCacheLineSize;
+}
+
+// Returns the number of slots in the counter hash table.  This is a power of
+// two at least twice as large as |max_counters| so that probe sequences stay
+// short.
+inline int CounterHashCapacity(int max_counters) {
+  int capacity = 1;
+  while (capacity < 2 * max_counters)
+    capacity *= 2;
+  return capacity;
+}
+
+// Returns the number of data segments needed for |max_counters|.
+inline int SegmentCount(int max_counters) {
+  return (max_counters + StatsTable::kCountersPerSegment - 1) /
+      StatsTable::kCountersPerSegment;
+}
+
+// Returns whether the process |pid|, which reserved a slot of the counter
+// hash table, may still publish it.
+bool IsProcessRunning(ProcessId pid) {
+#if defined(OS_POSIX)
+  return kill(pid, 0) == 0 || errno != ESRCH;
+#elif defined(OS_WIN)
+  HANDLE process = OpenProcess(SYNCHRONIZE, FALSE, pid);
+  if (!process)
+    return GetLastError() != ERROR_INVALID_PARAMETER;
+  bool running = WaitForSingleObject(process, 0) == WAIT_TIMEOUT;
+  CloseHandle(process);
+  return running;
+#endif
+}
+
 }  // namespace
 
 // The StatsTable::Internal maintains convenience pointers into the
@@ -95,8 +172,16 @@ class StatsTable::Internal {
     int size;
     int max_counters;
     int max_threads;
+    // The number of counter rows handed out so far.  Can exceed
+    // |max_counters| once the table is full.
+    subtle::Atomic32 num_counters;
   };
 
+  // Returns the offset of the first data segment, and the total size, of a
+  // table holding |max_threads| and |max_counters|.
+  static int ComputeDataOffset(int max_threads, int max_counters);
+  static int ComputeSize(int max_threads, int max_counters);
+
   // Construct a new Internal based on expected size parameters, or
   // return NULL on failure.
   static Internal* New(const StatsTable::TableIdentifier& table,
@@ -112,6 +197,12 @@ class StatsTable::Internal {
   int size() const { return table_header_->size; }
   int max_counters() const { return table_header_->max_counters; }
   int max_threads() const { return table_header_->max_threads; }
+  subtle::Atomic32* num_counters() const {
+    return &table_header_->num_counters;
+  }
+  int counter_hash_capacity() const {
+    return CounterHashCapacity(max_counters());
+  }
 
   // Accessors for our tables
   char* thread_name(int slot_id) const {
@@ -128,8 +219,15 @@ class StatsTable::Internal {
     return &counter_names_table_[
       (counter_id-1) * (StatsTable::kMaxCounterNameLength)];
   }
-  int* row(int counter_id) const {
-    return &data_table_[(counter_id-1) * max_threads()];
+  subtle::Atomic32* counter_hash_slot(uint32 index) const {
+    return &counter_hash_table_[index];
+  }
+  int* location(int counter_id, int slot_id) const {
+    int segment = (counter_id-1) / StatsTable::kCountersPerSegment;
+    int offset = (counter_id-1) % StatsTable::kCountersPerSegment;
+    return &data_table_[
+      ((segment * max_threads()) + (slot_id-1)) *
+          StatsTable::kCountersPerSegment + offset];
   }
 
  private:
@@ -141,6 +239,7 @@ class StatsTable::Internal {
         thread_tid_table_(NULL),
         thread_pid_table_(NULL),
         counter_names_table_(NULL),
+        counter_hash_table_(NULL),
         data_table_(NULL) {
   }
 
@@ -163,11 +262,31 @@ class StatsTable::Internal {
   PlatformThreadId* thread_tid_table_;
   int* thread_pid_table_;
   char* counter_names_table_;
+  subtle::Atomic32* counter_hash_table_;
   int* data_table_;
 
   DISALLOW_COPY_AND_ASSIGN(Internal);
 };
 
+// static
+int StatsTable::Internal::ComputeDataOffset(int max_threads,
+                                            int max_counters) {
+  int offset = AlignedSize(sizeof(TableHeader));
+  offset += AlignedSize(max_threads * sizeof(char) * kMaxThreadNameLength);
+  offset += AlignedSize(max_threads * sizeof(int));
+  offset += AlignedSize(max_threads * sizeof(int));
+  offset += AlignedSize(max_counters * sizeof(char) * kMaxCounterNameLength);
+  offset += CounterHashCapacity(max_counters) * sizeof(subtle::Atomic32);
+  return offset + AlignOffsetToCacheLine(offset);
+}
+
+// static
+int StatsTable::Internal::ComputeSize(int max_threads, int max_counters) {
+  return ComputeDataOffset(max_threads, max_counters) +
+      SegmentCount(max_counters) * max_threads * kCountersPerSegment *
+      sizeof(int);
+}
+
 // static
 StatsTable::Internal* StatsTable::Internal::New(
     const StatsTable::TableIdentifier& table,
@@ -227,8 +346,10 @@ SharedMemory* StatsTable::Internal::CreateSharedMemory(
 void StatsTable::Internal::InitializeTable(void* memory, int size,
                                            int max_counters,
                                            int max_threads) {
-  // Zero everything.
-  memset(memory, 0, size);
+  // A named table can be left half-initialized by a process which crashed,
+  // so zero the tables, even if the version is 0.  The rows of the data
+  // segments are zeroed as counters are added.
+  memset(memory, 0, ComputeDataOffset(max_threads, max_counters));
 
   // Initialize the header.
   TableHeader* header = static_cast<TableHeader*>(memory);
@@ -267,8 +388,13 @@ void StatsTable::Internal::ComputeMappedPointers(void* memory) {
             max_counters() * StatsTable::kMaxCounterNameLength;
   offset += AlignOffset(offset);
 
+  counter_hash_table_ = reinterpret_cast<subtle::Atomic32*>(data + offset);
+  offset += sizeof(subtle::Atomic32) * counter_hash_capacity();
+  offset += AlignOffsetToCacheLine(offset);
+
   data_table_ = reinterpret_cast<int*>(data + offset);
-  offset += sizeof(int) * max_threads() * max_counters();
+  offset += sizeof(int) * SegmentCount(max_counters()) * max_threads() *
+            StatsTable::kCountersPerSegment;
 
   DCHECK_EQ(offset, size());
 }
@@ -292,13 +418,7 @@ StatsTable::StatsTable(const TableIdentifier& table,
                        int max_counters)
     : internal_(NULL),
       tls_index_(SlotReturnFunction) {
-  int table_size =
-    AlignedSize(sizeof(Internal::TableHeader)) +
-    AlignedSize((max_counters * sizeof(char) * kMaxCounterNameLength)) +
-    AlignedSize((max_threads * sizeof(char) * kMaxThreadNameLength)) +
-    AlignedSize(max_threads * sizeof(int)) +
-    AlignedSize(max_threads * sizeof(int)) +
-    AlignedSize((sizeof(int) * (max_counters * max_threads)));
+  int table_size = Internal::ComputeSize(max_threads, max_counters);
 
   internal_ = Internal::New(table, table_size, max_threads, max_counters);
 
@@ -394,19 +514,55 @@ int StatsTable::FindCounter(const std::string& name) {
   if (!internal_)
     return 0;
 
-  // Create a scope for our auto-lock.
-  {
-    AutoLock scoped_lock(counters_lock_);
+  // Counters are stored and hashed by their truncated name.
+  std::string counter_name =
+      name.empty() ? kUnknownName : name.substr(0, kMaxCounterNameLength - 1);
+
+  uint32 mask = internal_->counter_hash_capacity() - 1;
+  uint32 index = Hash(counter_name) & mask;
+  int reservation = -static_cast<int>(GetCurrentProcId());
+  for (uint32 probe = 0; probe <= mask; probe++) {
+    subtle::Atomic32* slot = internal_->counter_hash_slot(index);
+    int counter_id = subtle::Acquire_Load(slot);
+    int yields = 0;
+    while (counter_id <= 0) {
+      if (counter_id < 0) {
+        // Another thread or process is adding a counter in this slot; wait
+        // until it is published, then check whether it is ours.  Free the
+        // slot if the reserving process died.
+        if (++yields % kReservedSlotYields == 0 &&
+            !IsProcessRunning(static_cast<ProcessId>(-counter_id))) {
+          subtle::NoBarrier_CompareAndSwap(slot, counter_id, 0);
+        } else {
+          PlatformThread::YieldCurrentThread();
+        }
+        counter_id = subtle::Acquire_Load(slot);
+        continue;
+      }
+
+      // The counter does not exist.  Reserve the slot before allocating the
+      // row, so that a row is only allocated by the thread which publishes
+      // it.
+      counter_id = subtle::Acquire_CompareAndSwap(slot, 0, reservation);
+      if (counter_id)
+        continue;
+      int new_counter_id = AddCounter(counter_name);
+      // Publishes the new row, or releases the slot if the table is full.
+      subtle::Release_Store(slot, new_counter_id);
+      return new_counter_id;
+    }
 
-    // Attempt to find the counter.
-    CountersMap::const_iterator iter;
-    iter = counters_.find(name);
-    if (iter != counters_.end())
-      return iter->second;
+    if (!strncmp(internal_->counter_name(counter_id), counter_name.c_str(),
+                 kMaxCounterNameLength)) {
+      return counter_id;
+    }
+    index = (index + 1) & mask;
   }
 
-  // Counter does not exist, so add it.
-  return AddCounter(name);
+  // The hash table has twice as many slots as there are rows, so it is never
+  // full.
+  NOTREACHED();
+  return 0;
 }
 
 int* StatsTable::GetLocation(int counter_id, int slot_id) const {
@@ -415,8 +571,7 @@ int* StatsTable::GetLocation(int counter_id, int slot_id) const {
   if (slot_id > internal_->max_threads())
     return NULL;
 
-  int* row = internal_->row(counter_id);
-  return &(row[slot_id-1]);
+  return internal_->location(counter_id, slot_id);
 }
 
 const char* StatsTable::GetRowName(int index) const {
@@ -435,10 +590,9 @@ int StatsTable::GetRowValue(int index, int pid) const {
     return 0;
 
   int rv = 0;
-  int* row = internal_->row(index);
   for (int slot_id = 1; slot_id <= internal_->max_threads(); slot_id++) {
     if (pid == 0 || *internal_->thread_pid(slot_id) == pid)
-      rv += row[slot_id-1];
+      rv += *internal_->location(index, slot_id);
   }
   return rv;
 }
@@ -543,55 +697,27 @@ int StatsTable::FindEmptyThread() const {
   return index;
 }
 
-int StatsTable::FindCounterOrEmptyRow(const std::string& name) const {
-  // Note: the API returns slots numbered from 1..N, although
-  // internally, the array is 0..N-1.  This is so that we can return
-  // zero as "not found".
-  //
-  // There isn't much reason for this other than to be consistent
-  // with the way we track columns for thread slots.  (See comments
-  // in FindEmptyThread for why it is done this way).
-  if (!internal_)
-    return 0;
-
-  int free_slot = 0;
-  for (int index = 1; index <= internal_->max_counters(); index++) {
-    char* row_name = internal_->counter_name(index);
-    if (!*row_name && !free_slot)
-      free_slot = index;  // save that we found a free slot
-    else if (!strncmp(row_name, name.c_str(), kMaxCounterNameLength))
-      return index;
-  }
-  return free_slot;
-}
-
 int StatsTable::AddCounter(const std::string& name) {
   if (!internal_)
     return 0;
 
-  int counter_id = 0;
-  {
-    // To add a counter to the shared memory, we need the
-    // shared memory lock.
-    SharedMemoryAutoLockDeprecated lock(internal_->shared_memory());
-
-    // We have space, so create a new counter.
-    counter_id = FindCounterOrEmptyRow(name);
-    if (!counter_id)
-      return 0;
+  // Don't keep counting once the table is full.
+  if (subtle::NoBarrier_Load(internal_->num_counters()) >=
+      internal_->max_counters())
+    return 0;
 
-    std::string counter_name = name;
-    if (name.empty())
-      counter_name = kUnknownName;
-    strlcpy(internal_->counter_name(counter_id), counter_name.c_str(),
-            kMaxCounterNameLength);
-  }
+  int counter_id =
+      subtle::NoBarrier_AtomicIncrement(internal_->num_counters(), 1);
+  if (counter_id > internal_->max_counters())
+    return 0;
 
-  // now add to our in-memory cache
-  {
-    AutoLock lock(counters_lock_);
-    counters_[name] = counter_id;
-  }
+  // InitializeTable() leaves the data segments alone, so that their pages
+  // are only committed as rows are used, and a reused named table may still
+  // hold old data.
+  for (int slot_id = 1; slot_id <= internal_->max_threads(); slot_id++)
+    *internal_->location(counter_id, slot_id) = 0;
+  strlcpy(internal_->counter_name(counter_id), name.c_str(),
+          kMaxCounterNameLength);
   return counter_id;
 }
 
@@ -14,7 +14,13 @@
 // To achieve this, StatsTable creates a shared memory segment to store
 // the data for the counters.  Upon creation, it has a specific size
 // which governs the maximum number of counters and concurrent
-// threads/processes which can use it.
+// threads/processes which can use it.  Counter data is laid out in segments
+// of kCountersPerSegment counters, whose memory is only committed as counters
+// are added, so a large maximum mostly costs address space.
+//
+// Counters are looked up by name through a hash table stored in the shared
+// memory, without locking, and each thread writes to its own cache lines, so
+// counter lookups and updates only contend while a counter is being added.
 //
 
 #ifndef BASE_METRICS_STATS_TABLE_H_
@@ -24,9 +30,7 @@
 
 #include "base/base_export.h"
 #include "base/basictypes.h"
-#include "base/containers/hash_tables.h"
 #include "base/memory/shared_memory.h"
-#include "base/synchronization/lock.h"
 #include "base/threading/thread_local_storage.h"
 #include "build/build_config.h"
 
@@ -105,7 +109,8 @@ class BASE_EXPORT StatsTable {
   // Returns an id for the counter which can be used to call GetLocation().
   // If the counter does not exist, attempts to create a row for the new
   // counter.  If there is no space in the table for the new counter,
-  // returns 0.
+  // returns 0.  This never takes a lock, and is safe to call concurrently
+  // from any thread or process sharing the table.
   int FindCounter(const std::string& name);
 
   // TODO(mbelshe): implement RemoveCounter.
@@ -151,6 +156,10 @@ class BASE_EXPORT StatsTable {
   // null terminator, as stored in the shared memory.
   static const int kMaxCounterNameLength = 64;
 
+  // The number of counters per data segment.  Each thread owns a contiguous,
+  // cache line aligned run of this many values in every segment.
+  static const int kCountersPerSegment = 256;
+
   // Convenience function to lookup a counter location for a
   // counter by name for the calling thread.  Will register
   // the thread if it is not already registered.
@@ -159,7 +168,6 @@ class BASE_EXPORT StatsTable {
  private:
   class Internal;
   struct TLSData;
-  typedef hash_map<std::string, int> CountersMap;
 
   // Returns the space occupied by a thread in the table.  Generally used
   // if a thread terminates but the process continues.  This function
@@ -180,19 +188,13 @@ class BASE_EXPORT StatsTable {
   // calling this function.
   int FindEmptyThread() const;
 
-  // Locates a counter in the table or finds an empty row.  Returns a
-  // number > 0 on success, or 0 on failure.  The caller must hold the
-  // shared_memory_lock when calling this function.
-  int FindCounterOrEmptyRow(const std::string& name) const;
-
-  // Internal function to add a counter to the StatsTable.  Assumes that
-  // the counter does not already exist in the table.
+  // Allocates a new row for a counter and writes its |name|, which must
+  // already be truncated to kMaxCounterNameLength-1 characters.  The row is
+  // not reachable through FindCounter() until it is published in the hash
+  // table.
   //
-  // name is a unique identifier for this counter, and will be truncated
-  // to kMaxCounterNameLength-1 characters.
-  //
-  // On success, returns the counter_id for the newly added counter.
-  // On failure, returns 0.
+  // On success, returns the counter_id for the new row.
+  // On failure (the table is full), returns 0.
   int AddCounter(const std::string& name);
 
   // Get the TLS data for the calling thread.  Returns NULL if none is
@@ -200,16 +202,6 @@ class BASE_EXPORT StatsTable {
   TLSData* GetTLSData() const;
 
   Internal* internal_;
-
-  // The counters_lock_ protects the counters_ hash table.
-  base::Lock counters_lock_;
-
-  // The counters_ hash map is an in-memory hash of the counters.
-  // It is used for quick lookup of counters, but is cannot be used
-  // as a substitute for what is in the shared memory.  Even though
-  // we don't have a counter in our hash table, another process may
-  // have created it.
-  CountersMap counters_;
   ThreadLocalStorage::Slot tls_index_;
 
   DISALLOW_COPY_AND_ASSIGN(StatsTable);
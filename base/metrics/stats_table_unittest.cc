@@ -2,6 +2,8 @@
 // Use of this source code is governed by a BSD-style license that can be
 // found in the LICENSE file.
 
+#include <vector>
+
 #include "base/memory/shared_memory.h"
 #include "base/metrics/stats_counters.h"
 #include "base/metrics/stats_table.h"
@@ -50,6 +52,96 @@ TEST_F(StatsTableTest, VerifySlots) {
   EXPECT_EQ(counter_id, 0);
 }
 
+// Verify that counters spanning several data segments get distinct,
+// stable ids, and that threads write to separate cache lines.
+TEST_F(StatsTableTest, CountersAcrossSegments) {
+  const int kMaxThreads = 2;
+  const int kMaxCounter = 2 * StatsTable::kCountersPerSegment + 10;
+  StatsTable table(StatsTable::TableIdentifier(), kMaxThreads, kMaxCounter);
+
+  int slot_id = table.RegisterThread("mainThread");
+  EXPECT_NE(slot_id, 0);
+
+  std::vector<int> counter_ids;
+  for (int index = 0; index < kMaxCounter; index++) {
+    std::string counter_name = base::StringPrintf("counter.ctr%d", index);
+    int counter_id = table.FindCounter(counter_name);
+    ASSERT_GT(counter_id, 0);
+    EXPECT_STREQ(counter_name.c_str(), table.GetRowName(counter_id));
+    counter_ids.push_back(counter_id);
+    *table.GetLocation(counter_id, slot_id) = index;
+  }
+
+  for (int index = 0; index < kMaxCounter; index++) {
+    std::string counter_name = base::StringPrintf("counter.ctr%d", index);
+    EXPECT_EQ(counter_ids[index], table.FindCounter(counter_name));
+    EXPECT_EQ(index, table.GetCounterValue(counter_name));
+  }
+
+  // The same counter lives on different cache lines for different threads.
+  char* slot1 = reinterpret_cast<char*>(table.GetLocation(counter_ids[0], 1));
+  char* slot2 = reinterpret_cast<char*>(table.GetLocation(counter_ids[0], 2));
+  EXPECT_LE(64, slot2 - slot1);
+
+  // Names longer than the maximum are truncated consistently.
+  std::string long_name(2 * StatsTable::kMaxCounterNameLength, 'x');
+  StatsTable long_table(StatsTable::TableIdentifier(), kMaxThreads, 1);
+  int long_id = long_table.FindCounter(long_name);
+  EXPECT_GT(long_id, 0);
+  EXPECT_EQ(long_id, long_table.FindCounter(long_name));
+}
+
+// Finds the same counters as other threads, in the same order.
+class FindCounterThread : public SimpleThread {
+ public:
+  FindCounterThread(StatsTable* table, int num_counters)
+      : SimpleThread("FindCounterThread"),
+        table_(table),
+        num_counters_(num_counters),
+        failures_(0) {}
+
+  virtual void Run() override {
+    for (int index = 0; index < num_counters_; index++) {
+      if (!table_->FindCounter(base::StringPrintf("counter.ctr%d", index)))
+        failures_++;
+    }
+  }
+
+  int failures() const { return failures_; }
+
+ private:
+  StatsTable* table_;
+  int num_counters_;
+  int failures_;
+};
+
+// Verify that threads racing to add the same counters don't use up rows, so
+// a table can hold exactly as many counters as it was created for.
+TEST_F(StatsTableTest, ConcurrentFindCounter) {
+  const int kMaxThreads = 8;
+  const int kMaxCounter = 200;
+  StatsTable table(StatsTable::TableIdentifier(), kMaxThreads, kMaxCounter);
+
+  FindCounterThread* threads[kMaxThreads];
+  for (int index = 0; index < kMaxThreads; index++) {
+    threads[index] = new FindCounterThread(&table, kMaxCounter);
+    threads[index]->Start();
+  }
+  for (int index = 0; index < kMaxThreads; index++) {
+    threads[index]->Join();
+    EXPECT_EQ(0, threads[index]->failures());
+    delete threads[index];
+  }
+
+  for (int index = 0; index < kMaxCounter; index++) {
+    std::string counter_name = base::StringPrintf("counter.ctr%d", index);
+    int counter_id = table.FindCounter(counter_name);
+    ASSERT_GT(counter_id, 0);
+    EXPECT_STREQ(counter_name.c_str(), table.GetRowName(counter_id));
+  }
+  EXPECT_EQ(0, table.FindCounter("counter.extra"));
+}
+
 // CounterZero will continually be set to 0.
 const std::string kCounterZero = "CounterZero";
 // Counter1313 will continually be set to 1313.
@@ -4,6 +4,8 @@
 
 #include "base/prefs/default_pref_store.h"
 #include "base/logging.h"
+#include "base/prefs/mapped_default_pref_store.h"
+#include "base/prefs/pref_key.h"
 
 using base::Value;
 
@@ -11,7 +13,14 @@ DefaultPrefStore::DefaultPrefStore() {}
 
 bool DefaultPrefStore::GetValue(const std::string& key,
                                 const Value** result) const {
-  return prefs_.GetValue(key, result);
+  return prefs_.GetValue(key, result) ||
+         (image_.get() && image_->GetValue(key, result));
+}
+
+bool DefaultPrefStore::GetValueForKey(PrefKey key,
+                                      const Value** result) const {
+  return prefs_.GetValue(key, result) ||
+         (image_.get() && image_->GetValue(key.name(), result));
 }
 
 void DefaultPrefStore::AddObserver(PrefStore::Observer* observer) {
@@ -29,7 +38,8 @@ bool DefaultPrefStore::HasObservers() const {
 void DefaultPrefStore::SetDefaultValue(const std::string& key,
                                        scoped_ptr<Value> value) {
   DCHECK(!GetValue(key, NULL));
-  prefs_.SetValue(key, value.release());
+  // Registered prefs are the only ones whose names are interned.
+  prefs_.SetValue(PrefKey::Intern(key), value.release());
 }
 
 void DefaultPrefStore::ReplaceDefaultValue(const std::string& key,
@@ -50,4 +60,10 @@ DefaultPrefStore::const_iterator DefaultPrefStore::end() const {
   return prefs_.end();
 }
 
+void DefaultPrefStore::SetImage(
+    const scoped_refptr<MappedDefaultPrefStore>& image) {
+  DCHECK(!image_.get());
+  image_ = image;
+}
+
 DefaultPrefStore::~DefaultPrefStore() {}
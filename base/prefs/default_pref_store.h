@@ -7,12 +7,15 @@
 
 #include <string>
 
+#include "base/memory/ref_counted.h"
 #include "base/observer_list.h"
 #include "base/prefs/base_prefs_export.h"
 #include "base/prefs/pref_store.h"
 #include "base/prefs/pref_value_map.h"
 #include "base/values.h"
 
+class MappedDefaultPrefStore;
+
 // Used within a PrefRegistry to keep track of default preference values.
 class BASE_PREFS_EXPORT DefaultPrefStore : public PrefStore {
  public:
@@ -23,12 +26,15 @@ class BASE_PREFS_EXPORT DefaultPrefStore : public PrefStore {
   // PrefStore implementation:
   virtual bool GetValue(const std::string& key,
                         const base::Value** result) const override;
+  virtual bool GetValueForKey(PrefKey key,
+                              const base::Value** result) const override;
   virtual void AddObserver(PrefStore::Observer* observer) override;
   virtual void RemoveObserver(PrefStore::Observer* observer) override;
   virtual bool HasObservers() const override;
 
-  // Sets a |value| for |key|. Should only be called if a value has not been
-  // set yet; otherwise call ReplaceDefaultValue().
+  // Sets a |value| for |key|, and interns |key|, as the pref is registered.
+  // Should only be called if a value has not been set yet; otherwise call
+  // ReplaceDefaultValue().
   void SetDefaultValue(const std::string& key, scoped_ptr<base::Value> value);
 
   // Replaces the the value for |key| with a new value. Should only be called
@@ -36,14 +42,23 @@ class BASE_PREFS_EXPORT DefaultPrefStore : public PrefStore {
   void ReplaceDefaultValue(const std::string& key,
                            scoped_ptr<base::Value> value);
 
+  // Iterates over the values which were set, without those of the image.
   const_iterator begin() const;
   const_iterator end() const;
 
+  // Sets a precompiled image of defaults, whose values are returned for the
+  // keys which have no value set. The names of its prefs aren't interned, so
+  // that only the prefs which are used are. Should only be called once.
+  void SetImage(const scoped_refptr<MappedDefaultPrefStore>& image);
+  const MappedDefaultPrefStore* image() const { return image_.get(); }
+
  private:
   virtual ~DefaultPrefStore();
 
   PrefValueMap prefs_;
 
+  scoped_refptr<MappedDefaultPrefStore> image_;
+
   ObserverList<PrefStore::Observer, true> observers_;
 
   DISALLOW_COPY_AND_ASSIGN(DefaultPrefStore);
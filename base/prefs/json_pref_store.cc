@@ -5,18 +5,30 @@
 #include "base/prefs/json_pref_store.h"
 
 #include <algorithm>
+#include <map>
+#include <vector>
 
 #include "base/bind.h"
 #include "base/callback.h"
+#include "base/critical_closure.h"
+#include "base/files/file.h"
 #include "base/files/file_path.h"
 #include "base/files/file_util.h"
+#include "base/files/memory_mapped_file.h"
+#include "base/json/binary_value_serializer.h"
 #include "base/json/json_file_value_serializer.h"
+#include "base/json/json_path_query.h"
+#include "base/json/json_reader.h"
 #include "base/json/json_string_value_serializer.h"
 #include "base/memory/ref_counted.h"
+#include "base/memory/ref_counted_memory.h"
+#include "base/memory/scoped_vector.h"
 #include "base/metrics/histogram.h"
 #include "base/prefs/pref_filter.h"
 #include "base/sequenced_task_runner.h"
+#include "base/strings/string_piece.h"
 #include "base/strings/string_util.h"
+#include "base/synchronization/lock.h"
 #include "base/task_runner_util.h"
 #include "base/threading/sequenced_worker_pool.h"
 #include "base/values.h"
@@ -31,10 +43,65 @@ struct JsonPrefStore::ReadResult {
   PrefReadError error;
   bool no_dir;
 
+  // When the file was read lazily, |value| is empty, and these are its
+  // contents and their split into top-level prefs.
+  scoped_refptr<base::RefCountedString> lazy_data;
+  std::vector<base::JSONPathQuery::Member> lazy_members;
+
  private:
   DISALLOW_COPY_AND_ASSIGN(ReadResult);
 };
 
+// The top-level prefs of a file read lazily, by key, and the contents of the
+// file their text is in.
+struct JsonPrefStore::LazyPrefs
+    : public base::RefCountedThreadSafe<JsonPrefStore::LazyPrefs> {
+  LazyPrefs() {}
+
+  std::map<std::string, base::StringPiece> values;
+  scoped_refptr<base::RefCountedString> data;
+
+ private:
+  friend class base::RefCountedThreadSafe<JsonPrefStore::LazyPrefs>;
+
+  ~LazyPrefs() {}
+
+  DISALLOW_COPY_AND_ASSIGN(LazyPrefs);
+};
+
+// A copy of the prefs of a store, which its writes bring up to date and
+// serialize on the file task runner, so that only the prefs which changed
+// since the previous write are copied on the thread of the store. This costs
+// a second copy of the prefs in memory, for as long as the store writes.
+struct JsonPrefStore::WriteMirror
+    : public base::RefCountedThreadSafe<JsonPrefStore::WriteMirror> {
+  WriteMirror() {}
+
+  // Only used on the file task runner, where the writes run in order.
+  base::DictionaryValue prefs;
+
+  // Protects the changes below, which the store hands over to the next write.
+  base::Lock lock;
+
+  // A copy of all the prefs, which replaces |prefs|, with the lazy prefs to
+  // add to it which are not in |modified_lazy_prefs|. NULL if |prefs| are
+  // only updated.
+  scoped_ptr<base::DictionaryValue> copy;
+  scoped_refptr<JsonPrefStore::LazyPrefs> lazy_prefs;
+  std::set<std::string> modified_lazy_prefs;
+
+  // Batches of records in the format of the journal, applied in order, after
+  // |copy|.
+  ScopedVector<base::ListValue> batches;
+
+ private:
+  friend class base::RefCountedThreadSafe<JsonPrefStore::WriteMirror>;
+
+  ~WriteMirror() {}
+
+  DISALLOW_COPY_AND_ASSIGN(WriteMirror);
+};
+
 JsonPrefStore::ReadResult::ReadResult()
     : error(PersistentPrefStore::PREF_READ_ERROR_NONE), no_dir(false) {
 }
@@ -46,6 +113,298 @@ namespace {
 
 // Some extensions we'll tack on to copies of the Preferences files.
 const base::FilePath::CharType kBadExtension[] = FILE_PATH_LITERAL("bad");
+const base::FilePath::CharType kJournalExtension[] =
+    FILE_PATH_LITERAL("journal");
+
+// The journal is folded into the file once it is larger than the file by this
+// factor, and larger than kMinJournalSizeToCompact.
+const int64 kJournalCompactionRatio = 1;
+const int64 kMinJournalSizeToCompact = 64 * 1024;
+
+base::FilePath GetJournalPath(const base::FilePath& path) {
+  return path.AddExtension(kJournalExtension);
+}
+
+// Reads the prefs file at |path|, in either format. Files in the binary format
+// are decoded straight from a mapping. Anything else, including files which
+// can't be mapped, is read as JSON.
+base::Value* ReadPrefsFile(const base::FilePath& path,
+                           int* error_code,
+                           std::string* error_msg) {
+  base::MemoryMappedFile mapped_file;
+  base::StringPiece mapped_data;
+  if (mapped_file.Initialize(path)) {
+    mapped_data.set(reinterpret_cast<const char*>(mapped_file.data()),
+                    mapped_file.length());
+  }
+  if (BinaryValueSerializer::HasBinaryHeader(mapped_data)) {
+    BinaryValueSerializer serializer(mapped_data);
+    return serializer.Deserialize(error_code, error_msg);
+  }
+  JSONFileValueSerializer serializer(path);
+  return serializer.Deserialize(error_code, error_msg);
+}
+
+bool SerializePrefs(const base::DictionaryValue& prefs,
+                    JsonPrefStore::FileFormat file_format,
+                    std::string* output) {
+  if (file_format == JsonPrefStore::FILE_FORMAT_BINARY) {
+    BinaryValueSerializer serializer(output);
+    return serializer.Serialize(prefs);
+  }
+  JSONStringValueSerializer serializer(output);
+  serializer.set_pretty_print(true);
+  return serializer.Serialize(prefs);
+}
+
+// Returns whether |batch|, a line of the journal, is a list of records of the
+// form ["key", value] for a pref which was set, or ["key"] for one which was
+// removed.
+bool IsValidJournalBatch(const base::ListValue& batch) {
+  for (size_t i = 0; i < batch.GetSize(); ++i) {
+    const base::ListValue* record = NULL;
+    std::string key;
+    if (!batch.GetList(i, &record) || record->GetSize() < 1 ||
+        record->GetSize() > 2 || !record->GetString(0, &key)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Returns a batch of the journal with the current values in |prefs| of the
+// keys which changed, so that a key which changed several times since the
+// last batch is written once.
+base::ListValue* MakeJournalBatch(const base::DictionaryValue& prefs,
+                                  const std::set<std::string>& changed_keys) {
+  // Setting a key replaces its parents which aren't dictionaries, and removing
+  // it removes those which are left empty. The record is then for the first
+  // parent which isn't a dictionary anymore, as replaying the change of the
+  // key alone wouldn't replace or remove it.
+  std::set<std::string> keys;
+  for (std::set<std::string>::const_iterator it = changed_keys.begin();
+       it != changed_keys.end(); ++it) {
+    size_t dot = it->find('.');
+    const base::DictionaryValue* parent = NULL;
+    while (dot != std::string::npos &&
+           prefs.GetDictionary(it->substr(0, dot), &parent)) {
+      dot = it->find('.', dot + 1);
+    }
+    keys.insert(it->substr(0, dot));
+  }
+
+  base::ListValue* batch = new base::ListValue;
+  for (std::set<std::string>::const_iterator it = keys.begin();
+       it != keys.end(); ++it) {
+    base::ListValue* record = new base::ListValue;
+    record->AppendString(*it);
+    const base::Value* value = NULL;
+    if (prefs.Get(*it, &value))
+      record->Append(value->DeepCopy());
+    batch->Append(record);
+  }
+  return batch;
+}
+
+// Applies the records of |batch|, a valid batch of the journal, to |prefs|.
+// The values are moved out of |batch|.
+void ApplyJournalBatch(base::ListValue* batch, base::DictionaryValue* prefs) {
+  for (size_t i = 0; i < batch->GetSize(); ++i) {
+    base::ListValue* record = NULL;
+    std::string key;
+    batch->GetList(i, &record);
+    record->GetString(0, &key);
+    scoped_ptr<base::Value> pref_value;
+    if (record->Remove(1, &pref_value))
+      prefs->Set(key, pref_value.release());
+    else
+      prefs->RemovePath(key, NULL);
+  }
+}
+
+// Applies the batches of the journal at |journal_path| to |prefs|, in order.
+// A crash while appending a batch may leave an incomplete line at the end of
+// the journal, so the first line which lacks its '\n' or isn't a valid batch
+// ends the replay. Returns the number of batches applied, and sets
+// |valid_length| to the length of their lines.
+int ReplayJournal(const base::FilePath& journal_path,
+                  base::DictionaryValue* prefs,
+                  int64* valid_length) {
+  *valid_length = 0;
+  std::string journal;
+  if (!base::ReadFileToString(journal_path, &journal))
+    return 0;
+
+  int batch_count = 0;
+  size_t pos = 0;
+  for (;;) {
+    size_t end = journal.find('\n', pos);
+    if (end == std::string::npos)
+      break;
+    // The values are moved out of the batch, so they must not refer to it.
+    scoped_ptr<base::Value> value(base::JSONReader::Read(
+        base::StringPiece(journal).substr(pos, end - pos),
+        base::JSON_DETACHABLE_CHILDREN));
+    base::ListValue* batch = NULL;
+    if (!value || !value->GetAsList(&batch) || !IsValidJournalBatch(*batch))
+      break;
+
+    ApplyJournalBatch(batch, prefs);
+    ++batch_count;
+    pos = end + 1;
+  }
+  *valid_length = pos;
+  return batch_count;
+}
+
+// Brings |mirror| up to date with the changes handed to it by the store at
+// |path|, and serializes it into |output|. Runs on the file task runner.
+bool SerializeMirror(const scoped_refptr<JsonPrefStore::WriteMirror>& mirror,
+                     JsonPrefStore::FileFormat file_format,
+                     const base::FilePath& path,
+                     std::string* output) {
+  scoped_ptr<base::DictionaryValue> copy;
+  scoped_refptr<JsonPrefStore::LazyPrefs> lazy_prefs;
+  std::set<std::string> modified_lazy_prefs;
+  ScopedVector<base::ListValue> batches;
+  {
+    base::AutoLock auto_lock(mirror->lock);
+    copy = mirror->copy.Pass();
+    lazy_prefs.swap(mirror->lazy_prefs);
+    modified_lazy_prefs.swap(mirror->modified_lazy_prefs);
+    batches.swap(mirror->batches);
+  }
+
+  base::DictionaryValue* prefs = &mirror->prefs;
+  if (copy) {
+    prefs->Swap(copy.get());
+    if (lazy_prefs.get()) {
+      for (std::map<std::string, base::StringPiece>::const_iterator it =
+               lazy_prefs->values.begin();
+           it != lazy_prefs->values.end(); ++it) {
+        if (modified_lazy_prefs.count(it->first))
+          continue;
+        base::Value* value = base::JSONReader::Read(it->second);
+        DCHECK(value);
+        if (value)
+          prefs->SetWithoutPathExpansion(it->first, value);
+      }
+    }
+  }
+  for (size_t i = 0; i < batches.size(); ++i)
+    ApplyJournalBatch(batches[i], prefs);
+
+  if (!SerializePrefs(*prefs, file_format, output))
+    return false;
+
+  std::string spaceless_basename;
+  base::ReplaceChars(path.BaseName().MaybeAsASCII(), " ", "_",
+                     &spaceless_basename);
+
+  // The histogram below is an expansion of the UMA_HISTOGRAM_COUNTS_10000
+  // macro adapted to allow for a dynamically suffixed histogram name.
+  // Note: The factory creates and owns the histogram.
+  base::HistogramBase* histogram =
+      base::LinearHistogram::FactoryGet(
+          "Settings.JsonDataSizeKilobytes." + spaceless_basename,
+          1,
+          10000,
+          50,
+          base::HistogramBase::kUmaTargetedHistogramFlag);
+  histogram->Add(static_cast<int>(output->size()) / 1024);
+  return true;
+}
+
+// Folds the journal into the prefs file at |path|, and deletes it. A crash
+// before the journal is deleted leaves batches which are already part of the
+// file, and applying them again changes nothing.
+bool CompactJournal(const base::FilePath& path,
+                    JsonPrefStore::FileFormat file_format) {
+  int error_code = 0;
+  std::string error_msg;
+  scoped_ptr<base::Value> value(ReadPrefsFile(path, &error_code, &error_msg));
+  if (!value) {
+    if (error_code != JSONFileValueSerializer::JSON_NO_SUCH_FILE)
+      return false;
+    value.reset(new base::DictionaryValue);
+  }
+  base::DictionaryValue* prefs = NULL;
+  if (!value->GetAsDictionary(&prefs))
+    return false;
+
+  base::FilePath journal_path = GetJournalPath(path);
+  int64 valid_length = 0;
+  ReplayJournal(journal_path, prefs, &valid_length);
+  std::string data;
+  return SerializePrefs(*prefs, file_format, &data) &&
+         base::ImportantFileWriter::WriteFileAtomically(path, data) &&
+         base::DeleteFile(journal_path, false);
+}
+
+// Appends |batch|, a line, to the journal of the prefs file at |path|, and
+// flushes it. Then folds the journal into the file if it has grown large
+// enough, which is done here so that it is ordered with the other writes.
+bool AppendToJournal(const base::FilePath& path,
+                     JsonPrefStore::FileFormat file_format,
+                     const std::string& batch) {
+  base::File journal(GetJournalPath(path),
+                     base::File::FLAG_OPEN_ALWAYS | base::File::FLAG_APPEND);
+  if (!journal.IsValid())
+    return false;
+  int64 journal_length = journal.GetLength();
+  if (journal_length < 0)
+    return false;
+  int size = static_cast<int>(batch.size());
+  if (journal.WriteAtCurrentPos(batch.data(), size) != size ||
+      !journal.Flush()) {
+    // Don't leave a partial line, which would hide the batches after it.
+    journal.SetLength(journal_length);
+    return false;
+  }
+  journal_length += size;
+  journal.Close();
+
+  int64 file_size = 0;
+  if (!base::GetFileSize(path, &file_size))
+    file_size = 0;
+  if (journal_length > std::max(kMinJournalSizeToCompact,
+                                file_size * kJournalCompactionRatio)) {
+    // The journal stays valid if this fails, and is folded on the next read.
+    CompactJournal(path, file_format);
+  }
+  return true;
+}
+
+// Reads the JSON file at |path| lazily into |read_result|: it is only split
+// into top-level prefs, which are parsed when they are first used. Returns
+// false if the file should be read in full instead: if it can't be read, or is
+// malformed, so that the error is handled as usual, or if it is in the binary
+// format, which is cheap to decode.
+bool ReadPrefsFileLazily(const base::FilePath& path,
+                         JsonPrefStore::ReadResult* read_result) {
+  std::string data;
+  if (!base::ReadFileToString(path, &data) ||
+      BinaryValueSerializer::HasBinaryHeader(data)) {
+    return false;
+  }
+
+  scoped_refptr<base::RefCountedString> lazy_data(
+      base::RefCountedString::TakeString(&data));
+  std::vector<base::JSONPathQuery::Member> members;
+  if (!base::JSONPathQuery::SplitMembers(lazy_data->data(),
+                                         base::JSON_PARSE_RFC,
+                                         &members,
+                                         NULL,
+                                         NULL)) {
+    return false;
+  }
+
+  read_result->value.reset(new base::DictionaryValue);
+  read_result->error = PersistentPrefStore::PREF_READ_ERROR_NONE;
+  read_result->lazy_data = lazy_data;
+  read_result->lazy_members.swap(members);
+  return true;
+}
 
 PersistentPrefStore::PrefReadError HandleReadErrors(
     const base::Value* value,
@@ -91,9 +450,14 @@ PersistentPrefStore::PrefReadError HandleReadErrors(
   return PersistentPrefStore::PREF_READ_ERROR_NONE;
 }
 
+// Reads the prefs file, and folds the journal into it. No journal is left once
+// the read succeeds, so that its batches can't override the full writes which
+// follow.
 scoped_ptr<JsonPrefStore::ReadResult> ReadPrefsFromDisk(
     const base::FilePath& path,
-    const base::FilePath& alternate_path) {
+    const base::FilePath& alternate_path,
+    JsonPrefStore::FileFormat file_format,
+    bool lazy_loading_enabled) {
   if (!base::PathExists(path) && !alternate_path.empty() &&
       base::PathExists(alternate_path)) {
     base::Move(alternate_path, path);
@@ -103,10 +467,56 @@ scoped_ptr<JsonPrefStore::ReadResult> ReadPrefsFromDisk(
   std::string error_msg;
   scoped_ptr<JsonPrefStore::ReadResult> read_result(
       new JsonPrefStore::ReadResult);
-  JSONFileValueSerializer serializer(path);
-  read_result->value.reset(serializer.Deserialize(&error_code, &error_msg));
+
+  // The journal is folded into the prefs, which must be parsed for that.
+  const base::FilePath journal_path = GetJournalPath(path);
+  if (lazy_loading_enabled && !base::PathExists(journal_path) &&
+      ReadPrefsFileLazily(path, read_result.get())) {
+    return read_result.Pass();
+  }
+
+  read_result->value.reset(ReadPrefsFile(path, &error_code, &error_msg));
   read_result->error =
       HandleReadErrors(read_result->value.get(), path, error_code, error_msg);
+
+  if (base::PathExists(journal_path)) {
+    switch (read_result->error) {
+      case PersistentPrefStore::PREF_READ_ERROR_NONE:
+      case PersistentPrefStore::PREF_READ_ERROR_NO_FILE: {
+        scoped_ptr<base::DictionaryValue> prefs(
+            read_result->value ? static_cast<base::DictionaryValue*>(
+                                     read_result->value.release())
+                               : new base::DictionaryValue);
+        int64 valid_length = 0;
+        bool delete_journal = true;
+        if (ReplayJournal(journal_path, prefs.get(), &valid_length) > 0) {
+          read_result->error = PersistentPrefStore::PREF_READ_ERROR_NONE;
+          std::string data;
+          if (!SerializePrefs(*prefs, file_format, &data) ||
+              !base::ImportantFileWriter::WriteFileAtomically(path, data)) {
+            // Keep the batches, without any incomplete line after them.
+            base::File journal(journal_path,
+                               base::File::FLAG_OPEN | base::File::FLAG_WRITE);
+            journal.SetLength(valid_length);
+            delete_journal = false;
+          }
+        }
+        if (read_result->error == PersistentPrefStore::PREF_READ_ERROR_NONE)
+          read_result->value.reset(prefs.release());
+        if (delete_journal)
+          base::DeleteFile(journal_path, false);
+        break;
+      }
+      case PersistentPrefStore::PREF_READ_ERROR_JSON_PARSE:
+      case PersistentPrefStore::PREF_READ_ERROR_JSON_REPEAT:
+        // The batches only make sense on top of the file which was moved
+        // aside.
+        base::DeleteFile(journal_path, false);
+        break;
+      default:
+        break;
+    }
+  }
   read_result->no_dir = !base::PathExists(path.DirName());
   return read_result.Pass();
 }
@@ -132,7 +542,12 @@ JsonPrefStore::JsonPrefStore(
       sequenced_task_runner_(sequenced_task_runner),
       prefs_(new base::DictionaryValue()),
       read_only_(false),
+      file_format_(FILE_FORMAT_JSON),
       writer_(filename, sequenced_task_runner),
+      journal_enabled_(false),
+      lazy_loading_enabled_(false),
+      write_mirror_(new WriteMirror),
+      write_mirror_needs_copy_(true),
       pref_filter_(pref_filter.Pass()),
       initialized_(false),
       filtering_in_progress_(false),
@@ -149,7 +564,12 @@ JsonPrefStore::JsonPrefStore(
       sequenced_task_runner_(sequenced_task_runner),
       prefs_(new base::DictionaryValue()),
       read_only_(false),
+      file_format_(FILE_FORMAT_JSON),
       writer_(filename, sequenced_task_runner),
+      journal_enabled_(false),
+      lazy_loading_enabled_(false),
+      write_mirror_(new WriteMirror),
+      write_mirror_needs_copy_(true),
       pref_filter_(pref_filter.Pass()),
       initialized_(false),
       filtering_in_progress_(false),
@@ -160,8 +580,9 @@ bool JsonPrefStore::GetValue(const std::string& key,
                              const base::Value** result) const {
   DCHECK(CalledOnValidThread());
 
-  base::Value* tmp = NULL;
-  if (!prefs_->Get(key, &tmp))
+  const base::DictionaryValue* lazy_prefs = GetLoadedLazyPrefs(key);
+  const base::Value* tmp = NULL;
+  if (!(lazy_prefs ? lazy_prefs : prefs_.get())->Get(key, &tmp))
     return false;
 
   if (result)
@@ -197,6 +618,7 @@ bool JsonPrefStore::GetMutableValue(const std::string& key,
                                     base::Value** result) {
   DCHECK(CalledOnValidThread());
 
+  LoadLazyPrefForUpdate(key);
   return prefs_->Get(key, result);
 }
 
@@ -205,7 +627,8 @@ void JsonPrefStore::SetValue(const std::string& key, base::Value* value) {
 
   DCHECK(value);
   scoped_ptr<base::Value> new_value(value);
-  base::Value* old_value = NULL;
+  LoadLazyPrefForUpdate(key);
+  const base::Value* old_value = NULL;
   prefs_->Get(key, &old_value);
   if (!old_value || !value->Equals(old_value)) {
     prefs_->Set(key, new_value.release());
@@ -219,18 +642,19 @@ void JsonPrefStore::SetValueSilently(const std::string& key,
 
   DCHECK(value);
   scoped_ptr<base::Value> new_value(value);
-  base::Value* old_value = NULL;
+  LoadLazyPrefForUpdate(key);
+  const base::Value* old_value = NULL;
   prefs_->Get(key, &old_value);
   if (!old_value || !value->Equals(old_value)) {
     prefs_->Set(key, new_value.release());
-    if (!read_only_)
-      writer_.ScheduleWrite(this);
+    ScheduleWrite(key);
   }
 }
 
 void JsonPrefStore::RemoveValue(const std::string& key) {
   DCHECK(CalledOnValidThread());
 
+  LoadLazyPrefForUpdate(key);
   if (prefs_->RemovePath(key, NULL))
     ReportValueChanged(key);
 }
@@ -238,9 +662,9 @@ void JsonPrefStore::RemoveValue(const std::string& key) {
 void JsonPrefStore::RemoveValueSilently(const std::string& key) {
   DCHECK(CalledOnValidThread());
 
+  LoadLazyPrefForUpdate(key);
   prefs_->RemovePath(key, NULL);
-  if (!read_only_)
-    writer_.ScheduleWrite(this);
+  ScheduleWrite(key);
 }
 
 bool JsonPrefStore::ReadOnly() const {
@@ -265,7 +689,8 @@ PersistentPrefStore::PrefReadError JsonPrefStore::ReadPrefs() {
     return PREF_READ_ERROR_FILE_NOT_SPECIFIED;
   }
 
-  OnFileRead(ReadPrefsFromDisk(path_, alternate_path_));
+  OnFileRead(ReadPrefsFromDisk(path_, alternate_path_, file_format_,
+                               lazy_loading_enabled_));
   return filtering_in_progress_ ? PREF_READ_ERROR_ASYNCHRONOUS_TASK_INCOMPLETE
                                 : read_error_;
 }
@@ -286,7 +711,8 @@ void JsonPrefStore::ReadPrefsAsync(ReadErrorDelegate* error_delegate) {
   base::PostTaskAndReplyWithResult(
       sequenced_task_runner_.get(),
       FROM_HERE,
-      base::Bind(&ReadPrefsFromDisk, path_, alternate_path_),
+      base::Bind(&ReadPrefsFromDisk, path_, alternate_path_, file_format_,
+                 lazy_loading_enabled_),
       base::Bind(&JsonPrefStore::OnFileRead, AsWeakPtr()));
 }
 
@@ -295,6 +721,11 @@ void JsonPrefStore::CommitPendingWrite() {
 
   if (writer_.HasPendingWrite() && !read_only_)
     writer_.DoScheduledWrite();
+
+  if (journal_timer_.IsRunning() && !read_only_) {
+    journal_timer_.Stop();
+    WriteJournalBatch();
+  }
 }
 
 void JsonPrefStore::ReportValueChanged(const std::string& key) {
@@ -305,17 +736,155 @@ void JsonPrefStore::ReportValueChanged(const std::string& key) {
 
   FOR_EACH_OBSERVER(PrefStore::Observer, observers_, OnPrefValueChanged(key));
 
-  if (!read_only_)
-    writer_.ScheduleWrite(this);
+  ScheduleWrite(key);
 }
 
 void JsonPrefStore::RegisterOnNextSuccessfulWriteCallback(
     const base::Closure& on_next_successful_write) {
   DCHECK(CalledOnValidThread());
 
+  if (journal_enabled_) {
+    DCHECK(on_next_successful_journal_write_.is_null());
+    on_next_successful_journal_write_ = on_next_successful_write;
+    return;
+  }
   writer_.RegisterOnNextSuccessfulWriteCallback(on_next_successful_write);
 }
 
+void JsonPrefStore::set_journal_enabled(bool journal_enabled) {
+  DCHECK(CalledOnValidThread());
+
+  DCHECK(!initialized_);
+  DCHECK(!journal_enabled || !pref_filter_);
+  journal_enabled_ = journal_enabled;
+}
+
+void JsonPrefStore::set_lazy_loading_enabled(bool lazy_loading_enabled) {
+  DCHECK(CalledOnValidThread());
+
+  DCHECK(!initialized_);
+  DCHECK(!lazy_loading_enabled || !pref_filter_);
+  lazy_loading_enabled_ = lazy_loading_enabled;
+}
+
+void JsonPrefStore::ScheduleWrite(const std::string& key) {
+  DCHECK(CalledOnValidThread());
+
+  if (read_only_)
+    return;
+
+  dirty_keys_.insert(key);
+  if (!journal_enabled_) {
+    writer_.ScheduleWriteWithBackgroundSerializer(this);
+    return;
+  }
+  if (!journal_timer_.IsRunning()) {
+    journal_timer_.Start(FROM_HERE, writer_.commit_interval(), this,
+                         &JsonPrefStore::WriteJournalBatch);
+  }
+}
+
+void JsonPrefStore::WriteJournalBatch() {
+  DCHECK(CalledOnValidThread());
+
+  scoped_ptr<base::ListValue> batch(MakeJournalBatch(*prefs_, dirty_keys_));
+  dirty_keys_.clear();
+  std::string data;
+  JSONStringValueSerializer serializer(&data);
+  if (!serializer.Serialize(*batch)) {
+    DLOG(WARNING) << "failed to serialize journal batch for "
+                  << path_.value().c_str();
+    return;
+  }
+  data.push_back('\n');
+
+  // As in ImportantFileWriter, a reply is only asked for when there is a
+  // callback to run.
+  if (!on_next_successful_journal_write_.is_null()) {
+    base::PostTaskAndReplyWithResult(
+        sequenced_task_runner_.get(),
+        FROM_HERE,
+        base::MakeCriticalClosure(
+            base::Bind(&AppendToJournal, path_, file_format_, data)),
+        base::Bind(&JsonPrefStore::OnJournalBatchWritten, AsWeakPtr()));
+    return;
+  }
+  sequenced_task_runner_->PostTask(
+      FROM_HERE,
+      base::MakeCriticalClosure(base::Bind(
+          base::IgnoreResult(&AppendToJournal), path_, file_format_, data)));
+}
+
+void JsonPrefStore::OnJournalBatchWritten(bool success) {
+  DCHECK(CalledOnValidThread());
+
+  if (success && !on_next_successful_journal_write_.is_null()) {
+    on_next_successful_journal_write_.Run();
+    on_next_successful_journal_write_.Reset();
+  }
+}
+
+const base::DictionaryValue* JsonPrefStore::GetLoadedLazyPrefs(
+    const std::string& key) const {
+  if (!lazy_prefs_.get())
+    return NULL;
+
+  std::string top_level_key = key.substr(0, key.find('.'));
+  if (modified_lazy_prefs_.count(top_level_key))
+    return NULL;
+  std::map<std::string, base::StringPiece>::const_iterator it =
+      lazy_prefs_->values.find(top_level_key);
+  if (it == lazy_prefs_->values.end())
+    return NULL;
+
+  if (!loaded_lazy_prefs_)
+    loaded_lazy_prefs_.reset(new base::DictionaryValue);
+  if (!loaded_lazy_prefs_->HasKey(top_level_key)) {
+    // The whole file was validated when it was split. The parsed value is
+    // detached from its input, as its children may be removed.
+    base::Value* value =
+        base::JSONReader::Read(it->second, base::JSON_DETACHABLE_CHILDREN);
+    DCHECK(value);
+    if (value)
+      loaded_lazy_prefs_->SetWithoutPathExpansion(top_level_key, value);
+  }
+  return loaded_lazy_prefs_.get();
+}
+
+void JsonPrefStore::LoadLazyPrefForUpdate(const std::string& key) {
+  if (!GetLoadedLazyPrefs(key))
+    return;
+
+  // Moving the value rather than copying it keeps pointers to it valid.
+  std::string top_level_key = key.substr(0, key.find('.'));
+  scoped_ptr<base::Value> value;
+  if (loaded_lazy_prefs_->RemoveWithoutPathExpansion(top_level_key, &value))
+    prefs_->SetWithoutPathExpansion(top_level_key, value.release());
+  modified_lazy_prefs_.insert(top_level_key);
+  ReleaseLazyPrefsIfParsed();
+}
+
+void JsonPrefStore::ReleaseLazyPrefsIfParsed() {
+  if (!lazy_prefs_.get())
+    return;
+  size_t loaded = loaded_lazy_prefs_ ? loaded_lazy_prefs_->size() : 0;
+  if (loaded + modified_lazy_prefs_.size() < lazy_prefs_->values.size())
+    return;
+
+  if (loaded_lazy_prefs_) {
+    while (!loaded_lazy_prefs_->empty()) {
+      std::string top_level_key =
+          base::DictionaryValue::Iterator(*loaded_lazy_prefs_).key();
+      scoped_ptr<base::Value> value;
+      loaded_lazy_prefs_->RemoveWithoutPathExpansion(top_level_key, &value);
+      prefs_->SetWithoutPathExpansion(top_level_key, value.release());
+    }
+    loaded_lazy_prefs_.reset();
+  }
+  modified_lazy_prefs_.clear();
+  lazy_prefs_ = NULL;
+}
+
 void JsonPrefStore::OnFileRead(scoped_ptr<ReadResult> read_result) {
   DCHECK(CalledOnValidThread());
 
@@ -340,6 +909,19 @@ void JsonPrefStore::OnFileRead(scoped_ptr<ReadResult> read_result) {
         DCHECK(read_result->value.get());
         unfiltered_prefs.reset(
             static_cast<base::DictionaryValue*>(read_result->value.release()));
+        loaded_lazy_prefs_.reset();
+        modified_lazy_prefs_.clear();
+        lazy_prefs_ = NULL;
+        if (!read_result->lazy_members.empty()) {
+          // Later members override earlier ones with the same key, as in a
+          // full parse.
+          lazy_prefs_ = new LazyPrefs;
+          for (size_t i = 0; i < read_result->lazy_members.size(); ++i) {
+            lazy_prefs_->values[read_result->lazy_members[i].first] =
+                read_result->lazy_members[i].second;
+          }
+          lazy_prefs_->data = read_result->lazy_data;
+        }
         break;
       case PREF_READ_ERROR_NO_FILE:
         // If the file just doesn't exist, maybe this is first run.  In any case
@@ -382,35 +964,43 @@ JsonPrefStore::~JsonPrefStore() {
   CommitPendingWrite();
 }
 
-bool JsonPrefStore::SerializeData(std::string* output) {
+JsonPrefStore::DataProducer JsonPrefStore::GetSerializedDataProducer() {
   DCHECK(CalledOnValidThread());
 
-  if (pref_filter_)
+  if (pref_filter_) {
     pref_filter_->FilterSerializeData(prefs_.get());
-
-  JSONStringValueSerializer serializer(output);
-  serializer.set_pretty_print(true);
-  bool result = serializer.Serialize(*prefs_);
-
-  if (result) {
-    std::string spaceless_basename;
-    base::ReplaceChars(path_.BaseName().MaybeAsASCII(), " ", "_",
-                       &spaceless_basename);
-
-    // The histogram below is an expansion of the UMA_HISTOGRAM_COUNTS_10000
-    // macro adapted to allow for a dynamically suffixed histogram name.
-    // Note: The factory creates and owns the histogram.
-    base::HistogramBase* histogram =
-        base::LinearHistogram::FactoryGet(
-            "Settings.JsonDataSizeKilobytes." + spaceless_basename,
-            1,
-            10000,
-            50,
-            base::HistogramBase::kUmaTargetedHistogramFlag);
-    histogram->Add(static_cast<int>(output->size()) / 1024);
+    // The filter may have changed any pref.
+    write_mirror_needs_copy_ = true;
   }
 
-  return result;
+  // Only the prefs which changed since the previous write are copied here.
+  // The file task runner applies them to its own copy of the prefs, which it
+  // serializes while |prefs_| are modified. All the prefs are copied for the
+  // first write after they are read, and for every write with a filter. The
+  // lazy prefs which weren't modified are then parsed there from their text.
+  ReleaseLazyPrefsIfParsed();
+  scoped_ptr<base::DictionaryValue> copy;
+  scoped_ptr<base::ListValue> batch;
+  if (write_mirror_needs_copy_)
+    copy.reset(prefs_->DeepCopy());
+  else
+    batch.reset(MakeJournalBatch(*prefs_, dirty_keys_));
+  dirty_keys_.clear();
+  write_mirror_needs_copy_ = false;
+
+  {
+    base::AutoLock auto_lock(write_mirror_->lock);
+    if (copy) {
+      // The changes which weren't written yet are part of the copy.
+      write_mirror_->copy = copy.Pass();
+      write_mirror_->lazy_prefs = lazy_prefs_;
+      write_mirror_->modified_lazy_prefs = modified_lazy_prefs_;
+      write_mirror_->batches.clear();
+    } else {
+      write_mirror_->batches.push_back(batch.release());
+    }
+  }
+  return base::Bind(&SerializeMirror, write_mirror_, file_format_, path_);
 }
 
 void JsonPrefStore::FinalizeFileRead(bool initialization_successful,
@@ -428,11 +1018,12 @@ void JsonPrefStore::FinalizeFileRead(bool initialization_successful,
   }
 
   prefs_ = prefs.Pass();
+  write_mirror_needs_copy_ = true;
 
   initialized_ = true;
 
   if (schedule_write && !read_only_)
-    writer_.ScheduleWrite(this);
+    writer_.ScheduleWriteWithBackgroundSerializer(this);
 
   if (error_delegate_ && read_error_ != PREF_READ_ERROR_NONE)
     error_delegate_->OnError(read_error_);
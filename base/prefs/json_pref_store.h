@@ -5,11 +5,12 @@
 #ifndef BASE_PREFS_JSON_PREF_STORE_H_
 #define BASE_PREFS_JSON_PREF_STORE_H_
 
+#include <map>
 #include <set>
 #include <string>
 
 #include "base/basictypes.h"
-#include "base/callback_forward.h"
+#include "base/callback.h"
 #include "base/compiler_specific.h"
 #include "base/files/file_path.h"
 #include "base/files/important_file_writer.h"
@@ -19,13 +20,16 @@
 #include "base/observer_list.h"
 #include "base/prefs/base_prefs_export.h"
 #include "base/prefs/persistent_pref_store.h"
+#include "base/strings/string_piece.h"
 #include "base/threading/non_thread_safe.h"
+#include "base/timer/timer.h"
 
 class PrefFilter;
 
 namespace base {
 class DictionaryValue;
 class FilePath;
+class RefCountedString;
 class SequencedTaskRunner;
 class SequencedWorkerPool;
 class Value;
@@ -34,11 +38,23 @@ class Value;
 // A writable PrefStore implementation that is used for user preferences.
 class BASE_PREFS_EXPORT JsonPrefStore
     : public PersistentPrefStore,
-      public base::ImportantFileWriter::DataSerializer,
+      public base::ImportantFileWriter::BackgroundDataSerializer,
       public base::SupportsWeakPtr<JsonPrefStore>,
       public base::NonThreadSafe {
  public:
+  struct LazyPrefs;
   struct ReadResult;
+  struct WriteMirror;
+
+  // The formats in which the store can write its file. Files in either
+  // format are read.
+  enum FileFormat {
+    // Pretty-printed JSON.
+    FILE_FORMAT_JSON,
+    // The binary format of BinaryValueSerializer, which is smaller and much
+    // faster to read, but not human-readable.
+    FILE_FORMAT_BINARY
+  };
 
   // Returns instance of SequencedTaskRunner which guarantees that file
   // operations on the same file will be executed in sequenced order.
@@ -90,12 +106,33 @@ class BASE_PREFS_EXPORT JsonPrefStore
   virtual void CommitPendingWrite() override;
   virtual void ReportValueChanged(const std::string& key) override;
 
+  // Sets the format of the next writes. Defaults to FILE_FORMAT_JSON.
+  void set_file_format(FileFormat file_format) { file_format_ = file_format; }
+
+  // When enabled, each batch of changes is appended to a journal beside the
+  // file as a record of the prefs which were set or removed, instead of
+  // rewriting the whole file. The journal is folded into the file in the
+  // background once it outgrows it, and when the prefs are read. Must be set
+  // before the prefs are read, and isn't supported with a |pref_filter_|,
+  // which may change any pref when the file is written.
+  void set_journal_enabled(bool journal_enabled);
+
+  // When enabled, reading a JSON file only splits it into its top-level prefs,
+  // without parsing them, and each is parsed the first time it, or a pref
+  // under it, is accessed. Startup doesn't wait on the parsing of the prefs
+  // which aren't used, and the others are parsed as they are needed. The prefs
+  // which were never accessed are parsed on the task runner when the file is
+  // written. Files in the binary format, and those with a journal, are read
+  // in full. Must be set before the prefs are read, and isn't supported with a
+  // |pref_filter_|, which needs all the prefs when they are loaded.
+  void set_lazy_loading_enabled(bool lazy_loading_enabled);
+
   // Just like RemoveValue(), but doesn't notify observers. Used when doing some
   // cleanup that shouldn't otherwise alert observers.
   void RemoveValueSilently(const std::string& key);
 
   // Registers |on_next_successful_write| to be called once, on the next
-  // successful write event of |writer_|.
+  // successful write event of |writer_|, or append to the journal.
   void RegisterOnNextSuccessfulWriteCallback(
       const base::Closure& on_next_successful_write);
 
@@ -110,8 +147,32 @@ class BASE_PREFS_EXPORT JsonPrefStore
   // is invoked directly.
   void OnFileRead(scoped_ptr<ReadResult> read_result);
 
-  // ImportantFileWriter::DataSerializer overrides:
-  virtual bool SerializeData(std::string* output) override;
+  // Schedules a write of the prefs after a change of |key|. When journaling,
+  // only the prefs which changed are written.
+  void ScheduleWrite(const std::string& key);
+
+  // Appends the changes of |dirty_keys_| to the journal, as one batch.
+  void WriteJournalBatch();
+
+  // Runs |on_next_successful_journal_write_| once a batch has been appended.
+  void OnJournalBatchWritten(bool success);
+
+  // If the top-level pref of |key| is lazy and wasn't modified, parses it
+  // into |loaded_lazy_prefs_| unless it already is there, and returns
+  // |loaded_lazy_prefs_|. Otherwise returns NULL.
+  const base::DictionaryValue* GetLoadedLazyPrefs(
+      const std::string& key) const;
+
+  // Moves the top-level pref of |key| to |prefs_| if it is lazy, so that it
+  // can be modified.
+  void LoadLazyPrefForUpdate(const std::string& key);
+
+  // Moves the lazy prefs to |prefs_| and releases their text once they are
+  // all parsed.
+  void ReleaseLazyPrefsIfParsed();
+
+  // ImportantFileWriter::BackgroundDataSerializer overrides:
+  virtual DataProducer GetSerializedDataProducer() override;
 
   // This method is called after the JSON file has been read and the result has
   // potentially been intercepted and modified by |pref_filter_|.
@@ -132,9 +193,43 @@ class BASE_PREFS_EXPORT JsonPrefStore
 
   bool read_only_;
 
+  FileFormat file_format_;
+
   // Helper for safely writing pref data.
   base::ImportantFileWriter writer_;
 
+  bool journal_enabled_;
+
+  // The keys which changed since the last batch was appended to the journal,
+  // or handed to |write_mirror_|.
+  std::set<std::string> dirty_keys_;
+
+  // The timer which appends the next batch to the journal.
+  base::OneShotTimer<JsonPrefStore> journal_timer_;
+
+  base::Closure on_next_successful_journal_write_;
+
+  bool lazy_loading_enabled_;
+
+  // The top-level prefs of a file read lazily, or NULL once they are all in
+  // |prefs_|. Never modified, so that pending writes share it.
+  scoped_refptr<LazyPrefs> lazy_prefs_;
+
+  // The lazy prefs parsed to be read. They are kept apart from |prefs_| so
+  // that reading doesn't modify |prefs_|, and are moved there when first
+  // modified, so that pointers to them stay valid.
+  mutable scoped_ptr<base::DictionaryValue> loaded_lazy_prefs_;
+
+  // The lazy prefs which were moved to |prefs_|, and may since have been
+  // modified or removed there.
+  std::set<std::string> modified_lazy_prefs_;
+
+  // The copy of the prefs which the writes serialize on the file task runner.
+  // It is brought up to date with the changes since the previous write, or,
+  // when |write_mirror_needs_copy_|, replaced by a copy of all the prefs.
+  scoped_refptr<WriteMirror> write_mirror_;
+  bool write_mirror_needs_copy_;
+
   scoped_ptr<PrefFilter> pref_filter_;
   ObserverList<PrefStore::Observer, true> observers_;
 
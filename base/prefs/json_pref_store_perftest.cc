@@ -0,0 +1,135 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <string>
+
+#include "base/files/file_path.h"
+#include "base/files/file_util.h"
+#include "base/files/scoped_temp_dir.h"
+#include "base/json/json_string_value_serializer.h"
+#include "base/memory/ref_counted.h"
+#include "base/memory/scoped_ptr.h"
+#include "base/message_loop/message_loop.h"
+#include "base/prefs/json_pref_store.h"
+#include "base/prefs/pref_filter.h"
+#include "base/run_loop.h"
+#include "base/strings/stringprintf.h"
+#include "base/time/time.h"
+#include "base/values.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "testing/perf/perf_test.h"
+
+namespace {
+
+// About 20 MB of prefs, in sections of 100 KB like those of extensions.
+const int kNumSections = 200;
+const int kNumPrefsPerSection = 1000;
+
+// The prefs used at startup, a few of the sections.
+const int kNumSectionsUsed = 5;
+
+// The writes timed after the first one.
+const int kNumWrites = 10;
+
+std::string GetSectionName(int section) {
+  return base::StringPrintf("section_%d", section);
+}
+
+// Writes a large preferences file at |path|.
+void WritePrefsFile(const base::FilePath& path) {
+  base::DictionaryValue prefs;
+  for (int i = 0; i < kNumSections; ++i) {
+    base::DictionaryValue* section = new base::DictionaryValue;
+    for (int j = 0; j < kNumPrefsPerSection; ++j) {
+      base::DictionaryValue* pref = new base::DictionaryValue;
+      pref->SetInteger("count", j);
+      pref->SetString("value", base::StringPrintf("value of pref %d", j));
+      section->SetWithoutPathExpansion(base::StringPrintf("pref_%d", j), pref);
+    }
+    prefs.SetWithoutPathExpansion(GetSectionName(i), section);
+  }
+  std::string data;
+  JSONStringValueSerializer serializer(&data);
+  serializer.set_pretty_print(true);
+  ASSERT_TRUE(serializer.Serialize(prefs));
+  int size = static_cast<int>(data.size());
+  ASSERT_EQ(size, base::WriteFile(path, data.data(), size));
+  perf_test::PrintResult("json_pref_store", "", "file_size", data.size(),
+                         "bytes", false);
+}
+
+// Returns the time it takes for a store to read the file at |path| and
+// return the prefs of a few sections.
+base::TimeDelta TimeStartup(const base::FilePath& path, bool lazy) {
+  base::TimeTicks start = base::TimeTicks::HighResNow();
+  scoped_refptr<JsonPrefStore> pref_store = new JsonPrefStore(
+      path, base::MessageLoopProxy::current(), scoped_ptr<PrefFilter>());
+  pref_store->set_lazy_loading_enabled(lazy);
+  EXPECT_EQ(PersistentPrefStore::PREF_READ_ERROR_NONE,
+            pref_store->ReadPrefs());
+  for (int i = 0; i < kNumSectionsUsed; ++i) {
+    EXPECT_TRUE(pref_store->GetValue(GetSectionName(i) + ".pref_0.value",
+                                     NULL));
+  }
+  base::TimeDelta elapsed = base::TimeTicks::HighResNow() - start;
+  pref_store = NULL;
+  base::RunLoop().RunUntilIdle();
+  return elapsed;
+}
+
+// Returns the time a write after a change of |key| takes on the thread of
+// |pref_store|, before the prefs are serialized on the task runner.
+base::TimeDelta TimeWrite(JsonPrefStore* pref_store, const std::string& key) {
+  pref_store->SetValue(key, new base::FundamentalValue(-1));
+  base::TimeTicks start = base::TimeTicks::HighResNow();
+  pref_store->CommitPendingWrite();
+  base::TimeDelta elapsed = base::TimeTicks::HighResNow() - start;
+  base::RunLoop().RunUntilIdle();
+  return elapsed;
+}
+
+}  // namespace
+
+// Compares the time until the prefs used at startup can be read, when the
+// whole file is parsed and when it is loaded lazily.
+TEST(JsonPrefStorePerfTest, Startup) {
+  base::MessageLoop message_loop;
+  base::ScopedTempDir temp_dir;
+  ASSERT_TRUE(temp_dir.CreateUniqueTempDir());
+  base::FilePath path = temp_dir.path().AppendASCII("Preferences");
+  WritePrefsFile(path);
+
+  perf_test::PrintResult("json_pref_store", "", "full_startup",
+                         TimeStartup(path, false).InMillisecondsF(), "ms",
+                         true);
+  perf_test::PrintResult("json_pref_store", "", "lazy_startup",
+                         TimeStartup(path, true).InMillisecondsF(), "ms",
+                         true);
+}
+
+// Compares the time the thread of a store spends on the first write, which
+// copies all the prefs, and on the next ones, which only copy those which
+// changed.
+TEST(JsonPrefStorePerfTest, Write) {
+  base::MessageLoop message_loop;
+  base::ScopedTempDir temp_dir;
+  ASSERT_TRUE(temp_dir.CreateUniqueTempDir());
+  base::FilePath path = temp_dir.path().AppendASCII("Preferences");
+  WritePrefsFile(path);
+
+  scoped_refptr<JsonPrefStore> pref_store = new JsonPrefStore(
+      path, base::MessageLoopProxy::current(), scoped_ptr<PrefFilter>());
+  ASSERT_EQ(PersistentPrefStore::PREF_READ_ERROR_NONE,
+            pref_store->ReadPrefs());
+  base::TimeDelta first_write =
+      TimeWrite(pref_store.get(), GetSectionName(0) + ".pref_0.count");
+  base::TimeDelta write;
+  for (int i = 1; i <= kNumWrites; ++i)
+    write += TimeWrite(pref_store.get(), GetSectionName(i) + ".pref_0.count");
+
+  perf_test::PrintResult("json_pref_store", "", "first_write",
+                         first_write.InMillisecondsF(), "ms", true);
+  perf_test::PrintResult("json_pref_store", "", "write",
+                         (write / kNumWrites).InMillisecondsF(), "ms", true);
+}
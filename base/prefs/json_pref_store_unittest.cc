@@ -4,9 +4,13 @@
 
 #include "base/prefs/json_pref_store.h"
 
+#include <algorithm>
+
 #include "base/bind.h"
 #include "base/files/file_util.h"
 #include "base/files/scoped_temp_dir.h"
+#include "base/json/binary_value_serializer.h"
+#include "base/json/json_file_value_serializer.h"
 #include "base/memory/ref_counted.h"
 #include "base/memory/scoped_ptr.h"
 #include "base/message_loop/message_loop.h"
@@ -27,6 +31,10 @@ namespace {
 
 const char kHomePage[] = "homepage";
 
+void SetTrue(bool* flag) {
+  *flag = true;
+}
+
 // A PrefFilter that will intercept all calls to FilterOnLoad() and hold on
 // to the |prefs| until explicitly asked to release them.
 class InterceptingPrefFilter : public PrefFilter {
@@ -329,8 +337,286 @@ TEST_F(JsonPrefStoreTest, PreserveEmptyValues) {
   EXPECT_TRUE(DictionaryValue().Equals(result));
 }
 
+TEST_F(JsonPrefStoreTest, BinaryFileFormat) {
+  base::FilePath pref_file = temp_dir_.path().AppendASCII("write.json");
+  ASSERT_TRUE(base::CopyFile(data_dir_.AppendASCII("read.json"), pref_file));
+
+  // A store writing the binary format reads JSON.
+  scoped_refptr<JsonPrefStore> pref_store = new JsonPrefStore(
+      pref_file,
+      message_loop_.message_loop_proxy(),
+      scoped_ptr<PrefFilter>());
+  pref_store->set_file_format(JsonPrefStore::FILE_FORMAT_BINARY);
+  ASSERT_EQ(PersistentPrefStore::PREF_READ_ERROR_NONE, pref_store->ReadPrefs());
+  pref_store->SetValue(kHomePage, new StringValue("http://www.example.com"));
+  pref_store->CommitPendingWrite();
+  RunLoop().RunUntilIdle();
+
+  std::string contents;
+  ASSERT_TRUE(ReadFileToString(pref_file, &contents));
+  EXPECT_TRUE(BinaryValueSerializer::HasBinaryHeader(contents));
+
+  // A store writing JSON reads the binary format.
+  pref_store = new JsonPrefStore(
+      pref_file,
+      message_loop_.message_loop_proxy(),
+      scoped_ptr<PrefFilter>());
+  ASSERT_EQ(PersistentPrefStore::PREF_READ_ERROR_NONE, pref_store->ReadPrefs());
+  const Value* actual = NULL;
+  std::string string_value;
+  EXPECT_TRUE(pref_store->GetValue(kHomePage, &actual));
+  EXPECT_TRUE(actual->GetAsString(&string_value));
+  EXPECT_EQ("http://www.example.com", string_value);
+  int integer = 0;
+  EXPECT_TRUE(pref_store->GetValue("tabs.max_tabs", &actual));
+  EXPECT_TRUE(actual->GetAsInteger(&integer));
+  EXPECT_EQ(20, integer);
+
+  // Corrupt binary files are treated like invalid JSON.
+  int size = static_cast<int>(contents.size() / 2);
+  ASSERT_EQ(size, WriteFile(pref_file, contents.data(), size));
+  pref_store = new JsonPrefStore(
+      pref_file,
+      message_loop_.message_loop_proxy(),
+      scoped_ptr<PrefFilter>());
+  EXPECT_EQ(PersistentPrefStore::PREF_READ_ERROR_JSON_PARSE,
+            pref_store->ReadPrefs());
+  EXPECT_FALSE(PathExists(pref_file));
+  EXPECT_TRUE(PathExists(temp_dir_.path().AppendASCII("write.bad")));
+}
+
+TEST_F(JsonPrefStoreTest, Journal) {
+  base::FilePath pref_file = temp_dir_.path().AppendASCII("write.json");
+  base::FilePath journal_file = temp_dir_.path().AppendASCII(
+      "write.json.journal");
+  ASSERT_TRUE(base::CopyFile(data_dir_.AppendASCII("read.json"), pref_file));
+  std::string original_contents;
+  ASSERT_TRUE(ReadFileToString(pref_file, &original_contents));
+
+  scoped_refptr<JsonPrefStore> pref_store = new JsonPrefStore(
+      pref_file,
+      message_loop_.message_loop_proxy(),
+      scoped_ptr<PrefFilter>());
+  pref_store->set_journal_enabled(true);
+  ASSERT_EQ(PersistentPrefStore::PREF_READ_ERROR_NONE, pref_store->ReadPrefs());
+  bool written = false;
+  pref_store->RegisterOnNextSuccessfulWriteCallback(
+      base::Bind(&SetTrue, &written));
+  pref_store->SetValue(kHomePage, new StringValue("http://www.example.com"));
+  pref_store->SetValue("journal.path", new StringValue("/a"));
+  pref_store->CommitPendingWrite();
+  RunLoop().RunUntilIdle();
+  EXPECT_TRUE(written);
+  pref_store->RemoveValue("tabs.max_tabs");
+  pref_store->SetValue("journal.path", new StringValue("/b"));
+  // The parent replaced by a dictionary, then left empty, is removed.
+  pref_store->SetValue("journal.path.child", new FundamentalValue(1));
+  pref_store->RemoveValue("journal.path.child");
+  pref_store->CommitPendingWrite();
+  RunLoop().RunUntilIdle();
+
+  // The changes are only in the journal.
+  std::string contents;
+  ASSERT_TRUE(ReadFileToString(pref_file, &contents));
+  EXPECT_EQ(original_contents, contents);
+  ASSERT_TRUE(ReadFileToString(journal_file, &contents));
+  EXPECT_EQ(2, std::count(contents.begin(), contents.end(), '\n'));
+
+  // Reading the prefs replays the journal, and folds it into the file.
+  pref_store = new JsonPrefStore(
+      pref_file,
+      message_loop_.message_loop_proxy(),
+      scoped_ptr<PrefFilter>());
+  ASSERT_EQ(PersistentPrefStore::PREF_READ_ERROR_NONE, pref_store->ReadPrefs());
+  EXPECT_FALSE(PathExists(journal_file));
+  std::string string_value;
+  const Value* actual = NULL;
+  EXPECT_TRUE(pref_store->GetValue(kHomePage, &actual));
+  EXPECT_TRUE(actual->GetAsString(&string_value));
+  EXPECT_EQ("http://www.example.com", string_value);
+  EXPECT_FALSE(pref_store->GetValue("journal.path", NULL));
+  EXPECT_FALSE(pref_store->GetValue("tabs.max_tabs", NULL));
+  EXPECT_TRUE(pref_store->GetValue("tabs.new_windows_in_tabs", NULL));
+
+  scoped_ptr<Value> value(
+      JSONFileValueSerializer(pref_file).Deserialize(NULL, NULL));
+  ASSERT_TRUE(value);
+  const DictionaryValue* prefs = NULL;
+  ASSERT_TRUE(value->GetAsDictionary(&prefs));
+  EXPECT_TRUE(prefs->GetString(kHomePage, &string_value));
+  EXPECT_EQ("http://www.example.com", string_value);
+}
+
+TEST_F(JsonPrefStoreTest, JournalCompaction) {
+  base::FilePath pref_file = temp_dir_.path().AppendASCII("write.json");
+  base::FilePath journal_file = temp_dir_.path().AppendASCII(
+      "write.json.journal");
+  ASSERT_TRUE(base::CopyFile(data_dir_.AppendASCII("read.json"), pref_file));
+
+  scoped_refptr<JsonPrefStore> pref_store = new JsonPrefStore(
+      pref_file,
+      message_loop_.message_loop_proxy(),
+      scoped_ptr<PrefFilter>());
+  pref_store->set_journal_enabled(true);
+  ASSERT_EQ(PersistentPrefStore::PREF_READ_ERROR_NONE, pref_store->ReadPrefs());
+  pref_store->SetValue("small", new FundamentalValue(1));
+  pref_store->CommitPendingWrite();
+  RunLoop().RunUntilIdle();
+  EXPECT_TRUE(PathExists(journal_file));
+
+  // A journal much larger than the file is folded into it.
+  const std::string large_value(100 * 1024, 'x');
+  pref_store->SetValue("large", new StringValue(large_value));
+  pref_store->CommitPendingWrite();
+  RunLoop().RunUntilIdle();
+  EXPECT_FALSE(PathExists(journal_file));
+
+  scoped_ptr<Value> value(
+      JSONFileValueSerializer(pref_file).Deserialize(NULL, NULL));
+  ASSERT_TRUE(value);
+  const DictionaryValue* prefs = NULL;
+  ASSERT_TRUE(value->GetAsDictionary(&prefs));
+  std::string string_value;
+  int integer = 0;
+  EXPECT_TRUE(prefs->GetString("large", &string_value));
+  EXPECT_EQ(large_value, string_value);
+  EXPECT_TRUE(prefs->GetInteger("small", &integer));
+  EXPECT_EQ(1, integer);
+  EXPECT_TRUE(prefs->GetString(kHomePage, &string_value));
+  EXPECT_EQ("http://www.cnn.com", string_value);
+}
+
+TEST_F(JsonPrefStoreTest, JournalIncompleteBatch) {
+  base::FilePath pref_file = temp_dir_.path().AppendASCII("write.json");
+  base::FilePath journal_file = temp_dir_.path().AppendASCII(
+      "write.json.journal");
+  ASSERT_TRUE(base::CopyFile(data_dir_.AppendASCII("read.json"), pref_file));
+
+  // The last batch was cut short by a crash, and isn't applied.
+  const char kJournal[] =
+      "[[\"homepage\", \"http://www.example.com\"], [\"some_directory\"]]\n"
+      "[[\"tabs.max_tabs\", 5], [\"homepage\", \"http://www.exa";
+  ASSERT_EQ(static_cast<int>(strlen(kJournal)),
+            WriteFile(journal_file, kJournal, strlen(kJournal)));
+
+  scoped_refptr<JsonPrefStore> pref_store = new JsonPrefStore(
+      pref_file,
+      message_loop_.message_loop_proxy(),
+      scoped_ptr<PrefFilter>());
+  ASSERT_EQ(PersistentPrefStore::PREF_READ_ERROR_NONE, pref_store->ReadPrefs());
+  EXPECT_FALSE(PathExists(journal_file));
+  const Value* actual = NULL;
+  std::string string_value;
+  int integer = 0;
+  EXPECT_TRUE(pref_store->GetValue(kHomePage, &actual));
+  EXPECT_TRUE(actual->GetAsString(&string_value));
+  EXPECT_EQ("http://www.example.com", string_value);
+  EXPECT_FALSE(pref_store->GetValue("some_directory", NULL));
+  EXPECT_TRUE(pref_store->GetValue("tabs.max_tabs", &actual));
+  EXPECT_TRUE(actual->GetAsInteger(&integer));
+  EXPECT_EQ(20, integer);
+}
+
 // This test is just documenting some potentially non-obvious behavior. It
 // shouldn't be taken as normative.
+TEST_F(JsonPrefStoreTest, LazyLoading) {
+  ASSERT_TRUE(base::CopyFile(data_dir_.AppendASCII("read.json"),
+                             temp_dir_.path().AppendASCII("write.json")));
+
+  base::FilePath input_file = temp_dir_.path().AppendASCII("write.json");
+  scoped_refptr<JsonPrefStore> pref_store = new JsonPrefStore(
+      input_file,
+      message_loop_.message_loop_proxy().get(),
+      scoped_ptr<PrefFilter>());
+  pref_store->set_lazy_loading_enabled(true);
+  ASSERT_EQ(PersistentPrefStore::PREF_READ_ERROR_NONE, pref_store->ReadPrefs());
+  EXPECT_FALSE(pref_store->ReadOnly());
+  EXPECT_TRUE(pref_store->IsInitializationComplete());
+
+  RunBasicJsonPrefStoreTest(
+      pref_store.get(), input_file, data_dir_.AppendASCII("write.golden.json"));
+}
+
+TEST_F(JsonPrefStoreTest, LazyLoadingWritesUnusedPrefs) {
+  base::FilePath pref_file = temp_dir_.path().AppendASCII("write.json");
+  ASSERT_TRUE(base::CopyFile(data_dir_.AppendASCII("read.json"), pref_file));
+
+  scoped_refptr<JsonPrefStore> pref_store = new JsonPrefStore(
+      pref_file,
+      message_loop_.message_loop_proxy(),
+      scoped_ptr<PrefFilter>());
+  pref_store->set_lazy_loading_enabled(true);
+  ASSERT_EQ(PersistentPrefStore::PREF_READ_ERROR_NONE, pref_store->ReadPrefs());
+  pref_store->SetValue("tabs.max_tabs", new FundamentalValue(5));
+  pref_store->CommitPendingWrite();
+  RunLoop().RunUntilIdle();
+
+  // The prefs which were never parsed are written along with the others.
+  pref_store = new JsonPrefStore(
+      pref_file,
+      message_loop_.message_loop_proxy(),
+      scoped_ptr<PrefFilter>());
+  ASSERT_EQ(PersistentPrefStore::PREF_READ_ERROR_NONE, pref_store->ReadPrefs());
+  std::string string_value;
+  const Value* actual = NULL;
+  EXPECT_TRUE(pref_store->GetValue(kHomePage, &actual));
+  EXPECT_TRUE(actual->GetAsString(&string_value));
+  EXPECT_EQ("http://www.cnn.com", string_value);
+  int int_value = 0;
+  EXPECT_TRUE(pref_store->GetValue("tabs.max_tabs", &actual));
+  EXPECT_TRUE(actual->GetAsInteger(&int_value));
+  EXPECT_EQ(5, int_value);
+  EXPECT_TRUE(pref_store->GetValue("tabs.new_windows_in_tabs", NULL));
+}
+
+// Values read from a lazy store stay valid when the prefs next to them are
+// modified, and once every pref was parsed.
+TEST_F(JsonPrefStoreTest, LazyLoadingKeepsValues) {
+  base::FilePath pref_file = temp_dir_.path().AppendASCII("write.json");
+  ASSERT_TRUE(base::CopyFile(data_dir_.AppendASCII("read.json"), pref_file));
+
+  scoped_refptr<JsonPrefStore> pref_store = new JsonPrefStore(
+      pref_file,
+      message_loop_.message_loop_proxy(),
+      scoped_ptr<PrefFilter>());
+  pref_store->set_lazy_loading_enabled(true);
+  ASSERT_EQ(PersistentPrefStore::PREF_READ_ERROR_NONE, pref_store->ReadPrefs());
+  const Value* max_tabs = NULL;
+  ASSERT_TRUE(pref_store->GetValue("tabs.max_tabs", &max_tabs));
+  const Value* home_page = NULL;
+  ASSERT_TRUE(pref_store->GetValue(kHomePage, &home_page));
+
+  pref_store->SetValue("tabs.new_windows_in_tabs", new FundamentalValue(false));
+  pref_store->RemoveValue("some_directory");
+  const Value* actual = NULL;
+  ASSERT_TRUE(pref_store->GetValue("tabs.max_tabs", &actual));
+  EXPECT_EQ(max_tabs, actual);
+  ASSERT_TRUE(pref_store->GetValue(kHomePage, &actual));
+  EXPECT_EQ(home_page, actual);
+  int int_value = 0;
+  EXPECT_TRUE(max_tabs->GetAsInteger(&int_value));
+  EXPECT_EQ(20, int_value);
+  std::string string_value;
+  EXPECT_TRUE(home_page->GetAsString(&string_value));
+  EXPECT_EQ("http://www.cnn.com", string_value);
+
+  // Prefs which were only read are written as they were.
+  pref_store->CommitPendingWrite();
+  RunLoop().RunUntilIdle();
+  pref_store = new JsonPrefStore(
+      pref_file,
+      message_loop_.message_loop_proxy(),
+      scoped_ptr<PrefFilter>());
+  ASSERT_EQ(PersistentPrefStore::PREF_READ_ERROR_NONE, pref_store->ReadPrefs());
+  EXPECT_TRUE(pref_store->GetValue(kHomePage, &actual));
+  EXPECT_TRUE(pref_store->GetValue("tabs.max_tabs", &actual));
+  bool bool_value = true;
+  EXPECT_TRUE(pref_store->GetValue("tabs.new_windows_in_tabs", &actual));
+  EXPECT_TRUE(actual->GetAsBoolean(&bool_value));
+  EXPECT_FALSE(bool_value);
+  EXPECT_FALSE(pref_store->GetValue("some_directory", NULL));
+}
+
 TEST_F(JsonPrefStoreTest, RemoveClearsEmptyParent) {
   FilePath pref_file = temp_dir_.path().AppendASCII("empty_values.json");
 
@@ -350,6 +636,96 @@ TEST_F(JsonPrefStoreTest, RemoveClearsEmptyParent) {
   EXPECT_FALSE(has_dict);
 }
 
+// Values returned by GetValue() stay valid while a write of an earlier
+// snapshot is pending and other prefs are modified.
+TEST_F(JsonPrefStoreTest, GetValueDuringPendingWrite) {
+  FilePath pref_file = temp_dir_.path().AppendASCII("write.json");
+
+  scoped_refptr<JsonPrefStore> pref_store = new JsonPrefStore(
+      pref_file,
+      message_loop_.message_loop_proxy(),
+      scoped_ptr<PrefFilter>());
+  base::ListValue* list = new base::ListValue;
+  list->AppendString("value");
+  pref_store->SetValue("list", list);
+  const Value* result = NULL;
+  ASSERT_TRUE(pref_store->GetValue("list", &result));
+
+  // The write is posted to the message loop, but doesn't run yet.
+  pref_store->CommitPendingWrite();
+  pref_store->SetValue("other", new FundamentalValue(1));
+  const Value* list_now = NULL;
+  ASSERT_TRUE(pref_store->GetValue("list", &list_now));
+  EXPECT_EQ(result, list_now);
+  std::string string_value;
+  const base::ListValue* list_value = NULL;
+  ASSERT_TRUE(result->GetAsList(&list_value));
+  EXPECT_TRUE(list_value->GetString(0, &string_value));
+  EXPECT_EQ("value", string_value);
+
+  // The pending write has the prefs as they were when it was committed.
+  RunLoop().RunUntilIdle();
+  std::string contents;
+  ASSERT_TRUE(ReadFileToString(pref_file, &contents));
+  EXPECT_NE(std::string::npos, contents.find("\"list\""));
+  EXPECT_EQ(std::string::npos, contents.find("\"other\""));
+}
+
+// The writes after the first only hand over the prefs which changed, and
+// the file still has all the prefs, including those of writes which were
+// committed before the previous ones ran.
+TEST_F(JsonPrefStoreTest, SuccessiveWrites) {
+  FilePath pref_file = temp_dir_.path().AppendASCII("write.json");
+  ASSERT_TRUE(base::CopyFile(data_dir_.AppendASCII("read.json"), pref_file));
+
+  scoped_refptr<JsonPrefStore> pref_store = new JsonPrefStore(
+      pref_file,
+      message_loop_.message_loop_proxy(),
+      scoped_ptr<PrefFilter>());
+  ASSERT_EQ(PersistentPrefStore::PREF_READ_ERROR_NONE, pref_store->ReadPrefs());
+  pref_store->SetValue("dict.a", new FundamentalValue(1));
+  pref_store->SetValue("other", new StringValue("x"));
+  pref_store->CommitPendingWrite();
+  RunLoop().RunUntilIdle();
+
+  pref_store->SetValue("dict.b", new FundamentalValue(2));
+  pref_store->RemoveValue("other");
+  pref_store->RemoveValue("tabs.max_tabs");
+  pref_store->CommitPendingWrite();
+  // Setting a pref under one which isn't a dictionary replaces it, and
+  // removing it then removes the parent left empty.
+  pref_store->SetValue("replaced", new FundamentalValue(3));
+  pref_store->CommitPendingWrite();
+  pref_store->SetValue("replaced.child", new FundamentalValue(4));
+  pref_store->RemoveValue("replaced.child");
+  Value* dict = NULL;
+  ASSERT_TRUE(pref_store->GetMutableValue("dict", &dict));
+  static_cast<DictionaryValue*>(dict)->SetInteger("c", 5);
+  pref_store->ReportValueChanged("dict");
+  pref_store->CommitPendingWrite();
+  RunLoop().RunUntilIdle();
+
+  scoped_ptr<Value> value(
+      JSONFileValueSerializer(pref_file).Deserialize(NULL, NULL));
+  ASSERT_TRUE(value);
+  const DictionaryValue* file_prefs = NULL;
+  ASSERT_TRUE(value->GetAsDictionary(&file_prefs));
+  const Value* file_dict = NULL;
+  ASSERT_TRUE(file_prefs->Get("dict", &file_dict));
+  const Value* actual = NULL;
+  ASSERT_TRUE(pref_store->GetValue("dict", &actual));
+  EXPECT_TRUE(actual->Equals(file_dict));
+  int int_value = 0;
+  EXPECT_TRUE(file_prefs->GetInteger("dict.c", &int_value));
+  EXPECT_EQ(5, int_value);
+  EXPECT_FALSE(file_prefs->HasKey("other"));
+  EXPECT_FALSE(file_prefs->HasKey("replaced"));
+  EXPECT_FALSE(file_prefs->Get("tabs.max_tabs", NULL));
+  std::string string_value;
+  EXPECT_TRUE(file_prefs->GetString(kHomePage, &string_value));
+  EXPECT_EQ("http://www.cnn.com", string_value);
+}
+
 // Tests asynchronous reading of the file when there is no file.
 TEST_F(JsonPrefStoreTest, AsyncNonExistingFile) {
   base::FilePath bogus_input_file = data_dir_.AppendASCII("read.txt");
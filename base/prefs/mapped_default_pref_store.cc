@@ -0,0 +1,199 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/prefs/mapped_default_pref_store.h"
+
+#include <string.h>
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+#include "base/files/file_path.h"
+#include "base/files/important_file_writer.h"
+#include "base/json/binary_value_serializer.h"
+#include "base/logging.h"
+#include "base/prefs/pref_registry.h"
+#include "base/values.h"
+
+namespace {
+
+const char kImageMagic[] = "CrPrefD1";
+const size_t kImageMagicSize = arraysize(kImageMagic) - 1;
+
+struct ImageHeader {
+  char magic[kImageMagicSize];
+  uint32 entry_count;
+  uint32 reserved;
+};
+
+typedef std::pair<std::string, const base::Value*> NamedValue;
+
+bool CompareNames(const NamedValue& a, const NamedValue& b) {
+  return a.first < b.first;
+}
+
+}  // namespace
+
+// An entry of the index. The offsets are from the start of the image.
+struct MappedDefaultPrefStore::Entry {
+  uint32 name_offset;
+  uint32 name_length;
+  uint32 value_offset;
+  uint32 value_length;
+};
+
+// static
+void MappedDefaultPrefStore::SerializeImage(const PrefRegistry& registry,
+                                            std::string* image) {
+  std::vector<NamedValue> prefs;
+  for (PrefRegistry::const_iterator it = registry.begin();
+       it != registry.end(); ++it) {
+    prefs.push_back(NamedValue(it->first, it->second));
+  }
+  std::sort(prefs.begin(), prefs.end(), &CompareNames);
+
+  ImageHeader header;
+  memcpy(header.magic, kImageMagic, kImageMagicSize);
+  header.entry_count = static_cast<uint32>(prefs.size());
+  header.reserved = 0;
+  image->assign(reinterpret_cast<const char*>(&header), sizeof(header));
+
+  // The names and values follow the index.
+  std::vector<Entry> entries(prefs.size());
+  std::string data;
+  size_t data_offset = sizeof(header) + entries.size() * sizeof(Entry);
+  for (size_t i = 0; i < prefs.size(); ++i) {
+    entries[i].name_offset = static_cast<uint32>(data_offset + data.size());
+    entries[i].name_length = static_cast<uint32>(prefs[i].first.size());
+    data.append(prefs[i].first);
+
+    std::string value;
+    BinaryValueSerializer serializer(&value);
+    CHECK(serializer.Serialize(*prefs[i].second));
+    entries[i].value_offset = static_cast<uint32>(data_offset + data.size());
+    entries[i].value_length = static_cast<uint32>(value.size());
+    data.append(value);
+  }
+  if (!entries.empty()) {
+    image->append(reinterpret_cast<const char*>(&entries[0]),
+                  entries.size() * sizeof(Entry));
+  }
+  image->append(data);
+}
+
+// static
+bool MappedDefaultPrefStore::WriteImage(const PrefRegistry& registry,
+                                        const base::FilePath& path) {
+  std::string image;
+  SerializeImage(registry, &image);
+  return base::ImportantFileWriter::WriteFileAtomically(path, image);
+}
+
+MappedDefaultPrefStore::MappedDefaultPrefStore()
+    : entries_(NULL),
+      entry_count_(0) {
+}
+
+bool MappedDefaultPrefStore::Initialize(const base::FilePath& path) {
+  DCHECK(!file_.IsValid());
+  if (!file_.Initialize(path))
+    return false;
+  if (!ParseImage()) {
+    DLOG(WARNING) << "Malformed defaults image: " << path.value();
+    entries_ = NULL;
+    entry_count_ = 0;
+    return false;
+  }
+  values_.resize(entry_count_);
+  return true;
+}
+
+base::StringPiece MappedDefaultPrefStore::GetName(size_t index) const {
+  DCHECK_LT(index, entry_count_);
+  const Entry& entry = entries_[index];
+  return base::StringPiece(
+      reinterpret_cast<const char*>(file_.data()) + entry.name_offset,
+      entry.name_length);
+}
+
+bool MappedDefaultPrefStore::GetValue(const std::string& key,
+                                      const base::Value** result) const {
+  size_t index = 0;
+  if (!FindEntry(key, &index))
+    return false;
+  if (!result)
+    return true;
+
+  if (!values_[index]) {
+    const Entry& entry = entries_[index];
+    BinaryValueSerializer serializer(base::StringPiece(
+        reinterpret_cast<const char*>(file_.data()) + entry.value_offset,
+        entry.value_length));
+    values_[index] = serializer.Deserialize(NULL, NULL);
+    if (!values_[index]) {
+      DLOG(WARNING) << "Malformed default value of " << key;
+      return false;
+    }
+  }
+  *result = values_[index];
+  return true;
+}
+
+MappedDefaultPrefStore::~MappedDefaultPrefStore() {
+}
+
+bool MappedDefaultPrefStore::ParseImage() {
+  const uint8* data = file_.data();
+  size_t length = file_.length();
+  if (length < sizeof(ImageHeader))
+    return false;
+  const ImageHeader* header = reinterpret_cast<const ImageHeader*>(data);
+  if (memcmp(header->magic, kImageMagic, kImageMagicSize) != 0)
+    return false;
+  size_t entry_count = header->entry_count;
+  if (entry_count > (length - sizeof(ImageHeader)) / sizeof(Entry))
+    return false;
+
+  const Entry* entries =
+      reinterpret_cast<const Entry*>(data + sizeof(ImageHeader));
+  for (size_t i = 0; i < entry_count; ++i) {
+    const Entry& entry = entries[i];
+    if (entry.name_offset > length ||
+        entry.name_length > length - entry.name_offset ||
+        entry.value_offset > length ||
+        entry.value_length > length - entry.value_offset) {
+      return false;
+    }
+  }
+  entries_ = entries;
+  entry_count_ = entry_count;
+
+  // FindEntry() relies on the names being sorted.
+  for (size_t i = 1; i < entry_count_; ++i) {
+    if (!(GetName(i - 1) < GetName(i)))
+      return false;
+  }
+  return true;
+}
+
+bool MappedDefaultPrefStore::FindEntry(const std::string& key,
+                                       size_t* index) const {
+  size_t begin = 0;
+  size_t end = entry_count_;
+  base::StringPiece name(key);
+  while (begin < end) {
+    size_t middle = begin + (end - begin) / 2;
+    int comparison = GetName(middle).compare(name);
+    if (comparison == 0) {
+      *index = middle;
+      return true;
+    }
+    if (comparison < 0)
+      begin = middle + 1;
+    else
+      end = middle;
+  }
+  return false;
+}
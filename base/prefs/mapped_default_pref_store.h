@@ -0,0 +1,85 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef BASE_PREFS_MAPPED_DEFAULT_PREF_STORE_H_
+#define BASE_PREFS_MAPPED_DEFAULT_PREF_STORE_H_
+
+#include <string>
+
+#include "base/basictypes.h"
+#include "base/files/memory_mapped_file.h"
+#include "base/memory/scoped_vector.h"
+#include "base/prefs/base_prefs_export.h"
+#include "base/prefs/pref_store.h"
+#include "base/strings/string_piece.h"
+
+class PrefRegistry;
+
+namespace base {
+class FilePath;
+class Value;
+}
+
+// A read-only PrefStore of default values, read from a compact binary image
+// of the defaults of a PrefRegistry. The image is precompiled with
+// WriteImage(), e.g. at build time, and memory-mapped by Initialize(), so a
+// process which uses it doesn't build the Values of the thousands of defaults
+// it registers, and the pages of the image are shared by all the processes
+// which map it.
+//
+// The image is an index of the prefs, sorted by name, followed by their names
+// and their values in the format of BinaryValueSerializer. A value is only
+// deserialized the first time it is read, and kept until the store is
+// destroyed. Images are written in the byte order of the machine, and must be
+// read on a machine of the same byte order.
+//
+// Hand the store to PrefRegistry::SetDefaultsImage() to register its prefs.
+class BASE_PREFS_EXPORT MappedDefaultPrefStore : public PrefStore {
+ public:
+  // Serializes the defaults registered in |registry| as an image.
+  static void SerializeImage(const PrefRegistry& registry, std::string* image);
+
+  // Writes the image of the defaults registered in |registry| at |path|.
+  static bool WriteImage(const PrefRegistry& registry,
+                         const base::FilePath& path);
+
+  MappedDefaultPrefStore();
+
+  // Maps the image at |path|. Returns false if it can't be mapped, or isn't a
+  // well-formed image, in which case the store is empty.
+  bool Initialize(const base::FilePath& path);
+
+  // The number of prefs in the image, and the name of the pref at |index|,
+  // in the order of the names.
+  size_t size() const { return entry_count_; }
+  base::StringPiece GetName(size_t index) const;
+
+  // PrefStore overrides:
+  virtual bool GetValue(const std::string& key,
+                        const base::Value** result) const override;
+
+ private:
+  struct Entry;
+
+  virtual ~MappedDefaultPrefStore();
+
+  // Checks that the mapped image is well-formed, and sets |entries_|.
+  bool ParseImage();
+
+  // Sets |index| to the index of the entry of |key|, if there is one.
+  bool FindEntry(const std::string& key, size_t* index) const;
+
+  base::MemoryMappedFile file_;
+
+  // The index of the image, in the mapping.
+  const Entry* entries_;
+  size_t entry_count_;
+
+  // The values which were deserialized, by index, and NULL for the others.
+  mutable ScopedVector<base::Value> values_;
+
+  DISALLOW_COPY_AND_ASSIGN(MappedDefaultPrefStore);
+};
+
+#endif  // BASE_PREFS_MAPPED_DEFAULT_PREF_STORE_H_
@@ -0,0 +1,186 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/prefs/mapped_default_pref_store.h"
+
+#include <string>
+
+#include "base/files/file_path.h"
+#include "base/files/file_util.h"
+#include "base/files/scoped_temp_dir.h"
+#include "base/memory/ref_counted.h"
+#include "base/memory/scoped_ptr.h"
+#include "base/prefs/pref_key.h"
+#include "base/prefs/pref_registry_simple.h"
+#include "base/prefs/testing_pref_service.h"
+#include "base/strings/string_util.h"
+#include "base/values.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace {
+
+const char kIntegerPref[] = "test.integer";
+const char kStringPref[] = "test.string";
+const char kListPref[] = "a_list";
+const char kDictionaryPref[] = "test.dictionary";
+
+class MappedDefaultPrefStoreTest : public testing::Test {
+ protected:
+  virtual void SetUp() override {
+    ASSERT_TRUE(temp_dir_.CreateUniqueTempDir());
+    image_path_ = temp_dir_.path().Append(FILE_PATH_LITERAL("Defaults"));
+
+    scoped_refptr<PrefRegistrySimple> registry(new PrefRegistrySimple);
+    registry->RegisterIntegerPref(kIntegerPref, 42);
+    registry->RegisterStringPref(kStringPref, "default");
+    base::ListValue* list = new base::ListValue;
+    list->AppendString("item");
+    registry->RegisterListPref(kListPref, list);
+    base::DictionaryValue* dictionary = new base::DictionaryValue;
+    dictionary->SetBoolean("enabled", true);
+    registry->RegisterDictionaryPref(kDictionaryPref, dictionary);
+    ASSERT_TRUE(MappedDefaultPrefStore::WriteImage(*registry, image_path_));
+  }
+
+  base::ScopedTempDir temp_dir_;
+  base::FilePath image_path_;
+};
+
+}  // namespace
+
+TEST_F(MappedDefaultPrefStoreTest, GetValue) {
+  scoped_refptr<MappedDefaultPrefStore> store(new MappedDefaultPrefStore);
+  ASSERT_TRUE(store->Initialize(image_path_));
+
+  ASSERT_EQ(4u, store->size());
+  EXPECT_EQ(kListPref, store->GetName(0).as_string());
+  EXPECT_EQ(kDictionaryPref, store->GetName(1).as_string());
+  EXPECT_EQ(kIntegerPref, store->GetName(2).as_string());
+  EXPECT_EQ(kStringPref, store->GetName(3).as_string());
+
+  const base::Value* value = NULL;
+  ASSERT_TRUE(store->GetValue(kIntegerPref, &value));
+  EXPECT_TRUE(base::FundamentalValue(42).Equals(value));
+  // The value is deserialized once.
+  const base::Value* same_value = NULL;
+  ASSERT_TRUE(store->GetValue(kIntegerPref, &same_value));
+  EXPECT_EQ(value, same_value);
+
+  ASSERT_TRUE(store->GetValue(kStringPref, &value));
+  EXPECT_TRUE(base::StringValue("default").Equals(value));
+
+  base::ListValue expected_list;
+  expected_list.AppendString("item");
+  ASSERT_TRUE(store->GetValue(kListPref, &value));
+  EXPECT_TRUE(expected_list.Equals(value));
+
+  base::DictionaryValue expected_dictionary;
+  expected_dictionary.SetBoolean("enabled", true);
+  ASSERT_TRUE(store->GetValue(kDictionaryPref, &value));
+  EXPECT_TRUE(expected_dictionary.Equals(value));
+
+  EXPECT_TRUE(store->GetValue(kStringPref, NULL));
+  EXPECT_FALSE(store->GetValue("test.missing", &value));
+  EXPECT_FALSE(store->GetValue("", NULL));
+  EXPECT_FALSE(store->GetValue("zzz", NULL));
+}
+
+TEST_F(MappedDefaultPrefStoreTest, MalformedImage) {
+  scoped_refptr<MappedDefaultPrefStore> missing_store(
+      new MappedDefaultPrefStore);
+  EXPECT_FALSE(missing_store->Initialize(
+      temp_dir_.path().Append(FILE_PATH_LITERAL("Missing"))));
+  EXPECT_EQ(0u, missing_store->size());
+
+  std::string image;
+  ASSERT_TRUE(base::ReadFileToString(image_path_, &image));
+  base::FilePath truncated_path =
+      temp_dir_.path().Append(FILE_PATH_LITERAL("Truncated"));
+  ASSERT_EQ(24, base::WriteFile(truncated_path, image.data(), 24));
+  scoped_refptr<MappedDefaultPrefStore> truncated_store(
+      new MappedDefaultPrefStore);
+  EXPECT_FALSE(truncated_store->Initialize(truncated_path));
+  EXPECT_EQ(0u, truncated_store->size());
+  EXPECT_FALSE(truncated_store->GetValue(kIntegerPref, NULL));
+
+  base::FilePath json_path =
+      temp_dir_.path().Append(FILE_PATH_LITERAL("Json"));
+  const char kJson[] = "{\"test\": {\"integer\": 42}}";
+  ASSERT_EQ(static_cast<int>(arraysize(kJson) - 1),
+            base::WriteFile(json_path, kJson, arraysize(kJson) - 1));
+  scoped_refptr<MappedDefaultPrefStore> json_store(new MappedDefaultPrefStore);
+  EXPECT_FALSE(json_store->Initialize(json_path));
+}
+
+TEST_F(MappedDefaultPrefStoreTest, DefaultsImage) {
+  scoped_refptr<MappedDefaultPrefStore> store(new MappedDefaultPrefStore);
+  ASSERT_TRUE(store->Initialize(image_path_));
+
+  TestingPrefServiceSimple prefs;
+  prefs.registry()->SetDefaultsImage(store);
+  prefs.registry()->RegisterIntegerPref("test.registered", 1);
+
+  ASSERT_TRUE(prefs.FindPreference(kIntegerPref));
+  EXPECT_TRUE(prefs.FindPreference(kIntegerPref)->IsDefaultValue());
+  EXPECT_EQ(42, prefs.GetInteger(kIntegerPref));
+  EXPECT_EQ("default", prefs.GetString(kStringPref));
+  EXPECT_EQ(1, prefs.GetInteger("test.registered"));
+
+  prefs.SetInteger(kIntegerPref, 7);
+  EXPECT_EQ(7, prefs.GetInteger(kIntegerPref));
+  prefs.ClearPref(kIntegerPref);
+  EXPECT_EQ(42, prefs.GetInteger(kIntegerPref));
+
+  scoped_ptr<base::DictionaryValue> values = prefs.GetPreferenceValues();
+  int integer_value = 0;
+  EXPECT_TRUE(values->GetInteger(kIntegerPref, &integer_value));
+  EXPECT_EQ(42, integer_value);
+  EXPECT_TRUE(values->GetInteger("test.registered", &integer_value));
+  EXPECT_EQ(1, integer_value);
+  EXPECT_TRUE(values->HasKey(kListPref));
+}
+
+// The prefs of an image are found by name even if no registry of the process
+// registered them, and their names are only interned once they are used.
+TEST_F(MappedDefaultPrefStoreTest, DefaultsImageWithUnknownNames) {
+  // Any registered name is interned, so rename the prefs of the image to names
+  // of the same length which never were.
+  scoped_refptr<PrefRegistrySimple> registry(new PrefRegistrySimple);
+  registry->RegisterIntegerPref("image_only.integer", 5);
+  registry->RegisterStringPref("image_only.string", "image");
+  std::string image;
+  MappedDefaultPrefStore::SerializeImage(*registry, &image);
+  ReplaceSubstringsAfterOffset(&image, 0, "image_only", "never_seen");
+  base::FilePath renamed_path =
+      temp_dir_.path().Append(FILE_PATH_LITERAL("Renamed"));
+  ASSERT_EQ(static_cast<int>(image.size()),
+            base::WriteFile(renamed_path, image.data(), image.size()));
+
+  scoped_refptr<MappedDefaultPrefStore> store(new MappedDefaultPrefStore);
+  ASSERT_TRUE(store->Initialize(renamed_path));
+  EXPECT_FALSE(PrefKey::Find("never_seen.integer").is_valid());
+
+  TestingPrefServiceSimple prefs;
+  prefs.registry()->SetDefaultsImage(store);
+  EXPECT_FALSE(PrefKey::Find("never_seen.integer").is_valid());
+  EXPECT_EQ(5, prefs.GetInteger("never_seen.integer"));
+  EXPECT_EQ("image", prefs.GetString("never_seen.string"));
+  EXPECT_FALSE(PrefKey::Find("never_seen.integer").is_valid());
+  EXPECT_FALSE(prefs.FindPreference("image_only.integer"));
+
+  prefs.SetUserPref("never_seen.string", new base::StringValue("user"));
+  EXPECT_EQ("user", prefs.GetString("never_seen.string"));
+  EXPECT_FALSE(PrefKey::Find("never_seen.string").is_valid());
+
+  const PrefService::Preference* pref =
+      prefs.FindPreference("never_seen.integer");
+  ASSERT_TRUE(pref);
+  EXPECT_TRUE(PrefKey::Find("never_seen.integer").is_valid());
+  EXPECT_TRUE(pref->IsDefaultValue());
+  prefs.SetInteger("never_seen.integer", 7);
+  EXPECT_EQ(7, prefs.GetInteger("never_seen.integer"));
+  EXPECT_TRUE(pref->HasUserSetting());
+  ASSERT_TRUE(prefs.FindPreference("never_seen.string"));
+  EXPECT_TRUE(prefs.FindPreference("never_seen.string")->HasUserSetting());
+}
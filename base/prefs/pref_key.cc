@@ -0,0 +1,125 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/prefs/pref_key.h"
+
+#include "base/atomicops.h"
+#include "base/hash.h"
+#include "base/lazy_instance.h"
+#include "base/synchronization/lock.h"
+
+namespace {
+
+// An interned name, with its ID. Entries are never freed, so that the keys can
+// point to their names.
+struct Entry {
+  Entry(const std::string& name, int id, uint32 hash)
+      : name(name), id(id), hash(hash) {}
+
+  const std::string name;
+  const int id;
+  const uint32 hash;
+};
+
+// An open-addressed table of entries, probed linearly, and at most half full.
+// A slot is only ever set once, from NULL to an entry, so readers probe the
+// table without locking. When the table fills up, a bigger copy replaces it,
+// and it is leaked, as readers may still be probing it.
+struct Table {
+  explicit Table(size_t capacity)
+      : mask(capacity - 1),
+        slots(new base::subtle::AtomicWord[capacity]()) {}
+
+  const size_t mask;
+  base::subtle::AtomicWord* const slots;
+};
+
+// Enough for the prefs registered by a browser process without growing.
+const size_t kInitialCapacity = 4096;
+
+// The current Table, and the number of interned names. Only changed under
+// |g_intern_lock|, and published with release stores.
+base::subtle::AtomicWord g_table = 0;
+base::subtle::Atomic32 g_interned_count = 0;
+
+base::LazyInstance<base::Lock>::Leaky g_intern_lock =
+    LAZY_INSTANCE_INITIALIZER;
+
+const Entry* FindEntry(const Table* table,
+                       const std::string& name,
+                       uint32 hash) {
+  for (size_t i = hash & table->mask; ; i = (i + 1) & table->mask) {
+    const Entry* entry = reinterpret_cast<const Entry*>(
+        base::subtle::Acquire_Load(&table->slots[i]));
+    if (!entry)
+      return NULL;
+    if (entry->hash == hash && entry->name == name)
+      return entry;
+  }
+}
+
+void InsertEntry(Table* table, const Entry* entry) {
+  size_t i = entry->hash & table->mask;
+  while (base::subtle::NoBarrier_Load(&table->slots[i]))
+    i = (i + 1) & table->mask;
+  base::subtle::Release_Store(
+      &table->slots[i], reinterpret_cast<base::subtle::AtomicWord>(entry));
+}
+
+}  // namespace
+
+// static
+PrefKey PrefKey::Intern(const std::string& name) {
+  PrefKey key = Find(name);
+  if (key.is_valid())
+    return key;
+
+  base::AutoLock auto_lock(g_intern_lock.Get());
+  uint32 hash = base::Hash(name);
+  Table* table = reinterpret_cast<Table*>(
+      base::subtle::NoBarrier_Load(&g_table));
+  // Another thread may have interned the name since it was looked up.
+  const Entry* entry = table ? FindEntry(table, name, hash) : NULL;
+  if (entry)
+    return PrefKey(entry->id, &entry->name);
+
+  int id = base::subtle::NoBarrier_Load(&g_interned_count);
+  if (!table || 2 * static_cast<size_t>(id + 1) > table->mask + 1) {
+    Table* bigger =
+        new Table(table ? 2 * (table->mask + 1) : kInitialCapacity);
+    for (size_t i = 0; table && i <= table->mask; ++i) {
+      const Entry* old_entry = reinterpret_cast<const Entry*>(
+          base::subtle::NoBarrier_Load(&table->slots[i]));
+      if (old_entry)
+        InsertEntry(bigger, old_entry);
+    }
+    base::subtle::Release_Store(
+        &g_table, reinterpret_cast<base::subtle::AtomicWord>(bigger));
+    table = bigger;
+  }
+
+  entry = new Entry(name, id, hash);
+  InsertEntry(table, entry);
+  // Published after the entry, so that a reader which sees the count finds
+  // every name with a lower ID.
+  base::subtle::Release_Store(&g_interned_count, id + 1);
+  return PrefKey(entry->id, &entry->name);
+}
+
+// static
+PrefKey PrefKey::Find(const std::string& name) {
+  const Table* table =
+      reinterpret_cast<const Table*>(base::subtle::Acquire_Load(&g_table));
+  if (!table)
+    return PrefKey();
+  const Entry* entry = FindEntry(table, name, base::Hash(name));
+  if (!entry)
+    return PrefKey();
+  return PrefKey(entry->id, &entry->name);
+}
+
+// static
+int PrefKey::GetInternedCount() {
+  return base::subtle::Acquire_Load(&g_interned_count);
+}
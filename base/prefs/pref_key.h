@@ -0,0 +1,81 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef BASE_PREFS_PREF_KEY_H_
+#define BASE_PREFS_PREF_KEY_H_
+
+#include <string>
+
+#include "base/basictypes.h"
+#include "base/containers/hash_tables.h"
+#include "base/prefs/base_prefs_export.h"
+
+// An interned pref name. Each name is interned once per process, when the
+// pref is registered or observed, and keeps the same compact ID for the life
+// of the process. The maps of the prefs stack are keyed by PrefKey, so that a
+// pref name is hashed once per access, by Find(), rather than once per map the
+// access goes through. Interned names are never freed, so only the names of
+// registered prefs are interned, and not those of arbitrary stored values.
+//
+// Interning is thread-safe, and Find() doesn't lock. A PrefKey is a small
+// value type which is cheap to copy, hash and compare.
+class BASE_PREFS_EXPORT PrefKey {
+ public:
+  // Returns the key of |name|, interning it the first time.
+  static PrefKey Intern(const std::string& name);
+
+  // Returns the key of |name| if it has been interned, and an invalid key
+  // otherwise. Doesn't lock.
+  static PrefKey Find(const std::string& name);
+
+  // Returns the number of interned names. The names with a lower ID than the
+  // number returned are all found by a later Find().
+  static int GetInternedCount();
+
+  // Constructs an invalid key.
+  PrefKey() : id_(-1), name_(NULL) {}
+
+  bool is_valid() const { return name_ != NULL; }
+
+  // The ID of the key, from 0 in the order of interning. Must be valid.
+  int id() const { return id_; }
+
+  // The interned name. Must be valid.
+  const std::string& name() const { return *name_; }
+
+  bool operator==(const PrefKey& that) const { return id_ == that.id_; }
+  bool operator!=(const PrefKey& that) const { return id_ != that.id_; }
+  bool operator<(const PrefKey& that) const { return id_ < that.id_; }
+
+ private:
+  PrefKey(int id, const std::string* name) : id_(id), name_(name) {}
+
+  int id_;
+  // Owned by the table of interned names, and never freed.
+  const std::string* name_;
+};
+
+// Provide a hash function so that hash_sets and maps can contain PrefKey
+// objects.
+namespace BASE_HASH_NAMESPACE {
+#if defined(COMPILER_GCC)
+
+template<>
+struct hash<PrefKey> {
+  size_t operator()(const PrefKey& key) const {
+    return static_cast<size_t>(key.id());
+  }
+};
+
+#elif defined(COMPILER_MSVC)
+
+inline size_t hash_value(const PrefKey& key) {
+  return static_cast<size_t>(key.id());
+}
+
+#endif  // COMPILER
+
+}  // namespace BASE_HASH_NAMESPACE
+
+#endif  // BASE_PREFS_PREF_KEY_H_
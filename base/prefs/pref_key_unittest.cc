@@ -0,0 +1,65 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/prefs/pref_key.h"
+
+#include <vector>
+
+#include "base/strings/stringprintf.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+TEST(PrefKeyTest, Intern) {
+  PrefKey key = PrefKey::Intern("pref_key_test.intern");
+  ASSERT_TRUE(key.is_valid());
+  EXPECT_EQ("pref_key_test.intern", key.name());
+
+  PrefKey same_key = PrefKey::Intern("pref_key_test.intern");
+  EXPECT_EQ(key, same_key);
+  EXPECT_EQ(key.id(), same_key.id());
+  EXPECT_EQ(&key.name(), &same_key.name());
+
+  PrefKey other_key = PrefKey::Intern("pref_key_test.intern_other");
+  ASSERT_TRUE(other_key.is_valid());
+  EXPECT_NE(key, other_key);
+  EXPECT_EQ("pref_key_test.intern_other", other_key.name());
+}
+
+TEST(PrefKeyTest, Find) {
+  EXPECT_FALSE(PrefKey().is_valid());
+  EXPECT_FALSE(PrefKey::Find("pref_key_test.find").is_valid());
+  // Finding a name doesn't intern it.
+  EXPECT_FALSE(PrefKey::Find("pref_key_test.find").is_valid());
+
+  PrefKey key = PrefKey::Intern("pref_key_test.find");
+  PrefKey found_key = PrefKey::Find("pref_key_test.find");
+  ASSERT_TRUE(found_key.is_valid());
+  EXPECT_EQ(key, found_key);
+}
+
+TEST(PrefKeyTest, HashMap) {
+  base::hash_map<PrefKey, int> map;
+  map[PrefKey::Intern("pref_key_test.hash_map_a")] = 1;
+  map[PrefKey::Intern("pref_key_test.hash_map_b")] = 2;
+  EXPECT_EQ(2u, map.size());
+  EXPECT_EQ(1, map[PrefKey::Find("pref_key_test.hash_map_a")]);
+  EXPECT_EQ(2, map[PrefKey::Find("pref_key_test.hash_map_b")]);
+  EXPECT_TRUE(map.find(PrefKey()) == map.end());
+}
+
+// The keys stay valid, and are found, as the table of interned names grows.
+TEST(PrefKeyTest, Growth) {
+  int count = PrefKey::GetInternedCount();
+  std::vector<PrefKey> keys;
+  for (int i = 0; i < 10000; ++i) {
+    keys.push_back(
+        PrefKey::Intern(base::StringPrintf("pref_key_test.growth_%d", i)));
+  }
+  EXPECT_EQ(count + 10000, PrefKey::GetInternedCount());
+  for (int i = 0; i < 10000; ++i) {
+    std::string name = base::StringPrintf("pref_key_test.growth_%d", i);
+    EXPECT_EQ(name, keys[i].name());
+    EXPECT_EQ(count + i, keys[i].id());
+    EXPECT_EQ(keys[i], PrefKey::Find(name));
+  }
+}
@@ -9,11 +9,13 @@
 #include "base/stl_util.h"
 
 PrefNotifierImpl::PrefNotifierImpl()
-    : pref_service_(NULL) {
+    : pref_service_(NULL),
+      batch_depth_(0) {
 }
 
 PrefNotifierImpl::PrefNotifierImpl(PrefService* service)
-    : pref_service_(service) {
+    : pref_service_(service),
+      batch_depth_(0) {
 }
 
 PrefNotifierImpl::~PrefNotifierImpl() {
@@ -22,9 +24,12 @@ PrefNotifierImpl::~PrefNotifierImpl() {
   // Verify that there are no pref observers when we shut down.
   for (PrefObserverMap::iterator it = pref_observers_.begin();
        it != pref_observers_.end(); ++it) {
-    PrefObserverList::Iterator obs_iterator(*(it->second));
+    if (!*it)
+      continue;
+    PrefObserverList::Iterator obs_iterator(**it);
     if (obs_iterator.GetNext()) {
-      LOG(WARNING) << "pref observer found at shutdown " << it->first;
+      LOG(WARNING) << "pref observer found at shutdown for the pref of ID "
+                   << it - pref_observers_.begin();
     }
   }
 
@@ -32,24 +37,24 @@ PrefNotifierImpl::~PrefNotifierImpl() {
   if (!init_observers_.empty())
     LOG(WARNING) << "Init observer found at shutdown.";
 
-  STLDeleteContainerPairSecondPointers(pref_observers_.begin(),
-                                       pref_observers_.end());
+  DCHECK_EQ(0, batch_depth_);
+
+  STLDeleteElements(&pref_observers_);
   pref_observers_.clear();
   init_observers_.clear();
 }
 
 void PrefNotifierImpl::AddPrefObserver(const char* path,
                                        PrefObserver* obs) {
-  // Get the pref observer list associated with the path.
-  PrefObserverList* observer_list = NULL;
-  const PrefObserverMap::iterator observer_iterator =
-      pref_observers_.find(path);
-  if (observer_iterator == pref_observers_.end()) {
+  // Get the pref observer list associated with the path. The name is interned
+  // even if the pref isn't registered yet, as it may be registered later; the
+  // observed names are a fixed set of constants.
+  PrefKey key = PrefKey::Intern(path);
+  if (static_cast<size_t>(key.id()) >= pref_observers_.size())
+    pref_observers_.resize(key.id() + 1);
+  PrefObserverList*& observer_list = pref_observers_[key.id()];
+  if (!observer_list)
     observer_list = new PrefObserverList;
-    pref_observers_[path] = observer_list;
-  } else {
-    observer_list = observer_iterator->second;
-  }
 
   // Add the pref observer. ObserverList will DCHECK if it already is
   // in the list.
@@ -60,13 +65,10 @@ void PrefNotifierImpl::RemovePrefObserver(const char* path,
                                           PrefObserver* obs) {
   DCHECK(thread_checker_.CalledOnValidThread());
 
-  const PrefObserverMap::iterator observer_iterator =
-      pref_observers_.find(path);
-  if (observer_iterator == pref_observers_.end()) {
+  PrefObserverList* observer_list = GetObserverList(path);
+  if (!observer_list)
     return;
-  }
 
-  PrefObserverList* observer_list = observer_iterator->second;
   observer_list->RemoveObserver(obs);
 }
 
@@ -75,6 +77,11 @@ void PrefNotifierImpl::AddInitObserver(base::Callback<void(bool)> obs) {
 }
 
 void PrefNotifierImpl::OnPreferenceChanged(const std::string& path) {
+  if (batch_depth_ > 0) {
+    if (batched_path_set_.insert(path).second)
+      batched_paths_.push_back(path);
+    return;
+  }
   FireObservers(path);
 }
 
@@ -97,20 +104,54 @@ void PrefNotifierImpl::OnInitializationCompleted(bool succeeded) {
 void PrefNotifierImpl::FireObservers(const std::string& path) {
   DCHECK(thread_checker_.CalledOnValidThread());
 
-  // Only send notifications for registered preferences.
-  if (!pref_service_->FindPreference(path.c_str()))
+  // Most prefs have no observers, so look for them first.
+  PrefObserverList* observer_list = GetObserverList(path);
+  if (!observer_list)
     return;
 
-  const PrefObserverMap::iterator observer_iterator =
-      pref_observers_.find(path);
-  if (observer_iterator == pref_observers_.end())
+  // Only send notifications for registered preferences.
+  if (!pref_service_->FindPreference(path.c_str()))
     return;
 
   FOR_EACH_OBSERVER(PrefObserver,
-                    *(observer_iterator->second),
+                    *observer_list,
                     OnPreferenceChanged(pref_service_, path));
 }
 
+void PrefNotifierImpl::BeginBatch() {
+  DCHECK(thread_checker_.CalledOnValidThread());
+
+  ++batch_depth_;
+}
+
+void PrefNotifierImpl::EndBatch() {
+  DCHECK(thread_checker_.CalledOnValidThread());
+
+  DCHECK_GT(batch_depth_, 0);
+  if (--batch_depth_ > 0)
+    return;
+
+  // The observers may change prefs, whose notifications are sent right away,
+  // or start a new batch.
+  std::vector<std::string> paths;
+  paths.swap(batched_paths_);
+  batched_path_set_.clear();
+  for (std::vector<std::string>::const_iterator it = paths.begin();
+       it != paths.end(); ++it) {
+    FireObservers(*it);
+  }
+}
+
+PrefNotifierImpl::PrefObserverList* PrefNotifierImpl::GetObserverList(
+    const std::string& path) const {
+  PrefKey key = PrefKey::Find(path);
+  if (!key.is_valid() ||
+      static_cast<size_t>(key.id()) >= pref_observers_.size()) {
+    return NULL;
+  }
+  return pref_observers_[key.id()];
+}
+
 void PrefNotifierImpl::SetPrefService(PrefService* pref_service) {
   DCHECK(pref_service_ == NULL);
   pref_service_ = pref_service;
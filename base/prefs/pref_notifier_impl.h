@@ -7,12 +7,14 @@
 
 #include <list>
 #include <string>
+#include <vector>
 
 #include "base/callback.h"
 #include "base/compiler_specific.h"
 #include "base/containers/hash_tables.h"
 #include "base/observer_list.h"
 #include "base/prefs/base_prefs_export.h"
+#include "base/prefs/pref_key.h"
 #include "base/prefs/pref_notifier.h"
 #include "base/prefs/pref_observer.h"
 #include "base/threading/thread_checker.h"
@@ -39,20 +41,30 @@ class BASE_PREFS_EXPORT PrefNotifierImpl
 
   void SetPrefService(PrefService* pref_service);
 
+  // Between BeginBatch() and the matching EndBatch(), the observers of the
+  // prefs which change aren't notified. Once the outermost batch ends, the
+  // observers of each pref which changed in it are notified once, in the
+  // order of the first change of each pref.
+  void BeginBatch();
+  void EndBatch();
+
  protected:
   // PrefNotifier overrides.
   virtual void OnPreferenceChanged(const std::string& pref_name) override;
   virtual void OnInitializationCompleted(bool succeeded) override;
 
-  // A map from pref names to a list of observers. Observers get fired in the
-  // order they are added. These should only be accessed externally for unit
-  // testing.
+  // The observers of a pref. Observers get fired in the order they are added.
   typedef ObserverList<PrefObserver> PrefObserverList;
-  typedef base::hash_map<std::string, PrefObserverList*> PrefObserverMap;
+
+  // The lists of observers, indexed by the IDs of the keys of their prefs,
+  // with NULL for the prefs which were never observed.
+  typedef std::vector<PrefObserverList*> PrefObserverMap;
 
   typedef std::list<base::Callback<void(bool)> > PrefInitObserverList;
 
-  const PrefObserverMap* pref_observers() const { return &pref_observers_; }
+  // Returns the observers of the pref at |path|, or NULL if it was never
+  // observed. This should only be used externally for unit testing.
+  PrefObserverList* GetObserverList(const std::string& path) const;
 
  private:
   // For the given pref_name, fire any observer of the pref. Virtual so it can
@@ -65,6 +77,12 @@ class BASE_PREFS_EXPORT PrefNotifierImpl
   PrefObserverMap pref_observers_;
   PrefInitObserverList init_observers_;
 
+  // The number of batches which haven't ended, and the prefs which changed
+  // during them, without duplicates.
+  int batch_depth_;
+  std::vector<std::string> batched_paths_;
+  base::hash_set<std::string> batched_path_set_;
+
   base::ThreadChecker thread_checker_;
 
   DISALLOW_COPY_AND_ASSIGN(PrefNotifierImpl);
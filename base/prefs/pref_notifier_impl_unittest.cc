@@ -52,12 +52,10 @@ class MockPrefNotifier : public PrefNotifierImpl {
   MOCK_METHOD1(FireObservers, void(const std::string& path));
 
   size_t CountObserver(const char* path, PrefObserver* obs) {
-    PrefObserverMap::const_iterator observer_iterator =
-        pref_observers()->find(path);
-    if (observer_iterator == pref_observers()->end())
+    PrefObserverList* observer_list = GetObserverList(path);
+    if (!observer_list)
       return false;
 
-    PrefObserverList* observer_list = observer_iterator->second;
     PrefObserverList::Iterator it(*observer_list);
     PrefObserver* existing_obs;
     size_t count = 0;
@@ -217,4 +215,32 @@ TEST_F(PrefNotifierTest, FireObservers) {
   notifier.RemovePrefObserver(kUnchangedPref, &obs2_);
 }
 
+TEST_F(PrefNotifierTest, Batch) {
+  MockPrefNotifier notifier(&pref_service_);
+
+  // Nothing is fired until the outermost batch ends.
+  EXPECT_CALL(notifier, FireObservers(_)).Times(0);
+  notifier.BeginBatch();
+  notifier.OnPreferenceChanged(kChangedPref);
+  notifier.BeginBatch();
+  notifier.OnPreferenceChanged(kUnchangedPref);
+  notifier.OnPreferenceChanged(kChangedPref);
+  notifier.EndBatch();
+  notifier.OnPreferenceChanged(kChangedPref);
+  Mock::VerifyAndClearExpectations(&notifier);
+
+  // Then each pref is fired once, in the order of their first change.
+  {
+    testing::InSequence sequence;
+    EXPECT_CALL(notifier, FireObservers(kChangedPref)).Times(1);
+    EXPECT_CALL(notifier, FireObservers(kUnchangedPref)).Times(1);
+  }
+  notifier.EndBatch();
+  Mock::VerifyAndClearExpectations(&notifier);
+
+  // Later changes are fired right away.
+  EXPECT_CALL(notifier, FireObservers(kChangedPref)).Times(1);
+  notifier.OnPreferenceChanged(kChangedPref);
+}
+
 }  // namespace
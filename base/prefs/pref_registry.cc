@@ -6,6 +6,7 @@
 
 #include "base/logging.h"
 #include "base/prefs/default_pref_store.h"
+#include "base/prefs/mapped_default_pref_store.h"
 #include "base/prefs/pref_store.h"
 #include "base/values.h"
 
@@ -28,6 +29,20 @@ PrefRegistry::const_iterator PrefRegistry::end() const {
   return defaults_->end();
 }
 
+void PrefRegistry::GetPrefNames(std::vector<std::string>* names) const {
+  names->clear();
+  for (const_iterator it = begin(); it != end(); ++it)
+    names->push_back(it->first);
+  const MappedDefaultPrefStore* image = defaults_->image();
+  for (size_t i = 0; image && i < image->size(); ++i)
+    names->push_back(image->GetName(i).as_string());
+}
+
+void PrefRegistry::SetDefaultsImage(
+    const scoped_refptr<MappedDefaultPrefStore>& image) {
+  defaults_->SetImage(image);
+}
+
 void PrefRegistry::SetDefaultPrefValue(const char* pref_name,
                                        base::Value* value) {
   DCHECK(value);
@@ -5,6 +5,9 @@
 #ifndef BASE_PREFS_PREF_REGISTRY_H_
 #define BASE_PREFS_PREF_REGISTRY_H_
 
+#include <string>
+#include <vector>
+
 #include "base/memory/ref_counted.h"
 #include "base/prefs/base_prefs_export.h"
 #include "base/prefs/pref_value_map.h"
@@ -14,6 +17,7 @@ class Value;
 }
 
 class DefaultPrefStore;
+class MappedDefaultPrefStore;
 class PrefStore;
 
 // Preferences need to be registered with a type and default value
@@ -34,10 +38,19 @@ class BASE_PREFS_EXPORT PrefRegistry : public base::RefCounted<PrefRegistry> {
   // Gets the registered defaults.
   scoped_refptr<PrefStore> defaults();
 
-  // Allows iteration over defaults.
+  // Allows iteration over defaults, without those of the defaults image.
   const_iterator begin() const;
   const_iterator end() const;
 
+  // Gets the names of all the registered preferences, including those of the
+  // defaults image.
+  void GetPrefNames(std::vector<std::string>* names) const;
+
+  // Registers the preferences of |image|, with the defaults it holds, instead
+  // of building their default values. The preferences of the image must not
+  // be registered otherwise. Can only be called once.
+  void SetDefaultsImage(const scoped_refptr<MappedDefaultPrefStore>& image);
+
   // Changes the default value for a preference. Takes ownership of |value|.
   //
   // |pref_name| must be a previously registered preference.
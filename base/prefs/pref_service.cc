@@ -5,6 +5,7 @@
 #include "base/prefs/pref_service.h"
 
 #include <algorithm>
+#include <vector>
 
 #include "base/bind.h"
 #include "base/files/file_path.h"
@@ -86,6 +87,16 @@ void PrefService::CommitPendingWrite() {
   user_pref_store_->CommitPendingWrite();
 }
 
+void PrefService::BeginNotificationBatch() {
+  DCHECK(CalledOnValidThread());
+  pref_notifier_->BeginBatch();
+}
+
+void PrefService::CommitNotificationBatch() {
+  DCHECK(CalledOnValidThread());
+  pref_notifier_->EndBatch();
+}
+
 bool PrefService::GetBoolean(const char* path) const {
   DCHECK(CalledOnValidThread());
 
@@ -169,11 +180,12 @@ bool PrefService::HasPrefPath(const char* path) const {
 scoped_ptr<base::DictionaryValue> PrefService::GetPreferenceValues() const {
   DCHECK(CalledOnValidThread());
   scoped_ptr<base::DictionaryValue> out(new base::DictionaryValue);
-  PrefRegistry::const_iterator i = pref_registry_->begin();
-  for (; i != pref_registry_->end(); ++i) {
-    const base::Value* value = GetPreferenceValue(i->first);
+  std::vector<std::string> names;
+  pref_registry_->GetPrefNames(&names);
+  for (size_t i = 0; i < names.size(); ++i) {
+    const base::Value* value = GetPreferenceValue(names[i]);
     DCHECK(value);
-    out->Set(i->first, value->DeepCopy());
+    out->Set(names[i], value->DeepCopy());
   }
   return out.Pass();
 }
@@ -182,11 +194,12 @@ scoped_ptr<base::DictionaryValue>
 PrefService::GetPreferenceValuesWithoutPathExpansion() const {
   DCHECK(CalledOnValidThread());
   scoped_ptr<base::DictionaryValue> out(new base::DictionaryValue);
-  PrefRegistry::const_iterator i = pref_registry_->begin();
-  for (; i != pref_registry_->end(); ++i) {
-    const base::Value* value = GetPreferenceValue(i->first);
+  std::vector<std::string> names;
+  pref_registry_->GetPrefNames(&names);
+  for (size_t i = 0; i < names.size(); ++i) {
+    const base::Value* value = GetPreferenceValue(names[i]);
     DCHECK(value);
-    out->SetWithoutPathExpansion(i->first, value->DeepCopy());
+    out->SetWithoutPathExpansion(names[i], value->DeepCopy());
   }
   return out.Pass();
 }
@@ -194,15 +207,26 @@ PrefService::GetPreferenceValuesWithoutPathExpansion() const {
 const PrefService::Preference* PrefService::FindPreference(
     const char* pref_name) const {
   DCHECK(CalledOnValidThread());
-  PreferenceMap::iterator it = prefs_map_.find(pref_name);
-  if (it != prefs_map_.end())
-    return &(it->second);
+  PrefKey key = PrefKey::Find(pref_name);
+  if (key.is_valid()) {
+    PreferenceMap::iterator it = prefs_map_.find(key);
+    if (it != prefs_map_.end())
+      return &(it->second);
+  }
+  // Registered prefs are interned when they are registered, except those of
+  // a defaults image, which are looked up by name, and interned the first
+  // time they are found here.
   const base::Value* default_value = NULL;
-  if (!pref_registry_->defaults()->GetValue(pref_name, &default_value))
+  if (key.is_valid() ?
+          !pref_registry_->defaults()->GetValueForKey(key, &default_value) :
+          !pref_registry_->defaults()->GetValue(pref_name, &default_value)) {
     return NULL;
-  it = prefs_map_.insert(
-      std::make_pair(pref_name, Preference(
-          this, pref_name, default_value->GetType()))).first;
+  }
+  if (!key.is_valid())
+    key = PrefKey::Intern(pref_name);
+  PreferenceMap::iterator it = prefs_map_.insert(
+      std::make_pair(key, Preference(
+          this, key, default_value->GetType()))).first;
   return &(it->second);
 }
 
@@ -459,16 +483,30 @@ void PrefService::UpdateCommandLinePrefStore(PrefStore* command_line_store) {
   pref_value_store_->UpdateCommandLinePrefStore(command_line_store);
 }
 
+///////////////////////////////////////////////////////////////////////////////
+// PrefService::ScopedNotificationBatch
+
+PrefService::ScopedNotificationBatch::ScopedNotificationBatch(
+    PrefService* service)
+    : service_(service) {
+  service_->BeginNotificationBatch();
+}
+
+PrefService::ScopedNotificationBatch::~ScopedNotificationBatch() {
+  service_->CommitNotificationBatch();
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 // PrefService::Preference
 
 PrefService::Preference::Preference(const PrefService* service,
-                                    const char* name,
+                                    PrefKey key,
                                     base::Value::Type type)
-      : name_(name),
+      : name_(key.name()),
+        key_(key),
         type_(type),
         pref_service_(service) {
-  DCHECK(name);
+  DCHECK(key.is_valid());
   DCHECK(service);
 }
 
@@ -481,7 +519,7 @@ base::Value::Type PrefService::Preference::GetType() const {
 }
 
 const base::Value* PrefService::Preference::GetValue() const {
-  const base::Value* result= pref_service_->GetPreferenceValue(name_);
+  const base::Value* result= pref_service_->GetPreferenceValue(key_);
   DCHECK(result) << "Must register pref before getting its value";
   return result;
 }
@@ -539,16 +577,41 @@ bool PrefService::Preference::IsExtensionModifiable() const {
 const base::Value* PrefService::GetPreferenceValue(
     const std::string& path) const {
   DCHECK(CalledOnValidThread());
+  PrefKey key = PrefKey::Find(path);
+  if (key.is_valid())
+    return GetPreferenceValue(key);
+
+  // The prefs of a defaults image aren't interned until FindPreference()
+  // finds them, so look them up by name.
+  const base::Value* default_value = NULL;
+  if (!pref_registry_->defaults()->GetValue(path, &default_value))
+    return NULL;
+  const base::Value* found_value = NULL;
+  base::Value::Type default_type = default_value->GetType();
+  if (!pref_value_store_->GetValue(path, default_type, &found_value)) {
+    // Every registered preference has at least a default value.
+    NOTREACHED() << "no valid value found for registered pref " << path;
+    return NULL;
+  }
+  DCHECK(found_value->IsType(default_type));
+  return found_value;
+}
+
+const base::Value* PrefService::GetPreferenceValue(PrefKey key) const {
+  DCHECK(CalledOnValidThread());
+  if (!key.is_valid())
+    return NULL;
   const base::Value* default_value = NULL;
-  if (pref_registry_->defaults()->GetValue(path, &default_value)) {
+  if (pref_registry_->defaults()->GetValueForKey(key, &default_value)) {
     const base::Value* found_value = NULL;
     base::Value::Type default_type = default_value->GetType();
-    if (pref_value_store_->GetValue(path, default_type, &found_value)) {
+    if (pref_value_store_->GetValue(key, default_type, &found_value)) {
       DCHECK(found_value->IsType(default_type));
       return found_value;
     } else {
       // Every registered preference has at least a default value.
-      NOTREACHED() << "no valid value found for registered pref " << path;
+      NOTREACHED() << "no valid value found for registered pref "
+                   << key.name();
     }
   }
 
@@ -22,6 +22,7 @@
 #include "base/observer_list.h"
 #include "base/prefs/base_prefs_export.h"
 #include "base/prefs/persistent_pref_store.h"
+#include "base/prefs/pref_key.h"
 #include "base/threading/non_thread_safe.h"
 #include "base/values.h"
 
@@ -63,9 +64,10 @@ class BASE_PREFS_EXPORT PrefService : public base::NonThreadSafe {
     // The type of the preference is determined by the type with which it is
     // registered. This type needs to be a boolean, integer, double, string,
     // dictionary (a branch), or list.  You shouldn't need to construct this on
-    // your own; use the PrefService::Register*Pref methods instead.
+    // your own; use the PrefService::Register*Pref methods instead. |key| is
+    // the interned name, which was interned when the pref was registered.
     Preference(const PrefService* service,
-               const char* name,
+               PrefKey key,
                base::Value::Type type);
     ~Preference() {}
 
@@ -132,12 +134,34 @@ class BASE_PREFS_EXPORT PrefService : public base::NonThreadSafe {
 
     const std::string name_;
 
+    // The interned |name_|, looked up once, by FindPreference().
+    const PrefKey key_;
+
     const base::Value::Type type_;
 
     // Reference to the PrefService in which this pref was created.
     const PrefService* pref_service_;
   };
 
+  // Batches the notifications of the pref observers for as long as it is
+  // alive: see BeginNotificationBatch(). For example:
+  //   {
+  //     PrefService::ScopedNotificationBatch batch(prefs);
+  //     prefs->SetInteger(kFooCount, 1);
+  //     prefs->SetInteger(kFooCount, 2);
+  //     prefs->ClearPref(kFooName);
+  //   }  // The observers of kFooCount and kFooName are notified once each.
+  class BASE_PREFS_EXPORT ScopedNotificationBatch {
+   public:
+    explicit ScopedNotificationBatch(PrefService* service);
+    ~ScopedNotificationBatch();
+
+   private:
+    PrefService* service_;
+
+    DISALLOW_COPY_AND_ASSIGN(ScopedNotificationBatch);
+  };
+
   // You may wish to use PrefServiceFactory or one of its subclasses
   // for simplified construction.
   PrefService(
@@ -154,6 +178,15 @@ class BASE_PREFS_EXPORT PrefService : public base::NonThreadSafe {
   // immediately (basically, during shutdown).
   void CommitPendingWrite();
 
+  // Defers the notifications of the pref observers until the matching
+  // CommitNotificationBatch(), which then notifies the observers of each pref
+  // which changed in between once, with its final value. Bulk updates thus
+  // notify each observer once per pref rather than once per change. Batches
+  // may be nested, in which case the notifications are sent when the outermost
+  // one is committed. The values themselves change right away.
+  void BeginNotificationBatch();
+  void CommitNotificationBatch();
+
   // Returns true if the preference for the given preference name is available
   // and is managed.
   bool IsManagedPreference(const char* pref_name) const;
@@ -293,7 +326,9 @@ class BASE_PREFS_EXPORT PrefService : public base::NonThreadSafe {
   // string comparisons. Order is unimportant, and deletions are rare.
   // Confirmed on Android where this speeded Chrome startup by roughly 50ms
   // vs. std::map, and by roughly 180ms vs. std::set of Preference pointers.
-  typedef base::hash_map<std::string, Preference> PreferenceMap;
+  // Keyed by the interned pref names, which are cheaper to hash than the
+  // names themselves.
+  typedef base::hash_map<PrefKey, Preference> PreferenceMap;
 
   // Give access to ReportUserPrefChanged() and GetMutableUserPref().
   friend class subtle::ScopedUserPrefUpdateBase;
@@ -347,6 +382,7 @@ class BASE_PREFS_EXPORT PrefService : public base::NonThreadSafe {
   // value (GetValue() calls back though the preference service to
   // actually get the value.).
   const base::Value* GetPreferenceValue(const std::string& path) const;
+  const base::Value* GetPreferenceValue(PrefKey key) const;
 
   // Local cache of registered Preference objects. The pref_registry_
   // is authoritative with respect to what the types and default values
@@ -0,0 +1,76 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <string>
+#include <vector>
+
+#include "base/prefs/pref_registry_simple.h"
+#include "base/prefs/testing_pref_service.h"
+#include "base/strings/stringprintf.h"
+#include "base/time/time.h"
+#include "base/values.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "testing/perf/perf_test.h"
+
+namespace {
+
+// About as many prefs as a profile registers, with names of the same shape.
+const int kNumSections = 40;
+const int kNumPrefsPerSection = 50;
+const int kNumIterations = 200;
+
+class PrefServicePerfTest : public testing::Test {
+ protected:
+  virtual void SetUp() override {
+    for (int i = 0; i < kNumSections; ++i) {
+      for (int j = 0; j < kNumPrefsPerSection; ++j) {
+        std::string name = base::StringPrintf(
+            "browser.settings_section_%d.integer_pref_%d", i, j);
+        pref_service_.registry()->RegisterIntegerPref(name.c_str(), j);
+        // A few prefs are managed, and more have user values, as usual.
+        if (j % 10 == 0)
+          pref_service_.SetManagedPref(name.c_str(),
+                                       new base::FundamentalValue(-j));
+        else if (j % 2 == 0)
+          pref_service_.SetUserPref(name.c_str(),
+                                    new base::FundamentalValue(2 * j));
+        names_.push_back(name);
+      }
+    }
+  }
+
+  // Prints the time per call of |elapsed| for |trace|.
+  void PrintResult(const std::string& trace, const base::TimeDelta& elapsed) {
+    perf_test::PrintResult(
+        "pref_service", "", trace,
+        elapsed.InMillisecondsF() * 1e6 / (kNumIterations * names_.size()),
+        "ns/call", true);
+  }
+
+  TestingPrefServiceSimple pref_service_;
+  std::vector<std::string> names_;
+};
+
+}  // namespace
+
+TEST_F(PrefServicePerfTest, GetInteger) {
+  int sum = 0;
+  base::TimeTicks start = base::TimeTicks::HighResNow();
+  for (int i = 0; i < kNumIterations; ++i) {
+    for (size_t j = 0; j < names_.size(); ++j)
+      sum += pref_service_.GetInteger(names_[j].c_str());
+  }
+  PrintResult("get_integer", base::TimeTicks::HighResNow() - start);
+  EXPECT_NE(0, sum);
+}
+
+TEST_F(PrefServicePerfTest, SetInteger) {
+  base::TimeTicks start = base::TimeTicks::HighResNow();
+  for (int i = 0; i < kNumIterations; ++i) {
+    for (size_t j = 0; j < names_.size(); ++j)
+      pref_service_.SetInteger(names_[j].c_str(), i);
+  }
+  PrintResult("set_integer", base::TimeTicks::HighResNow() - start);
+  EXPECT_EQ(kNumIterations - 1, pref_service_.GetInteger(names_[1].c_str()));
+}
@@ -129,6 +129,47 @@ TEST(PrefServiceTest, Observers) {
   Mock::VerifyAndClearExpectations(&obs2);
 }
 
+TEST(PrefServiceTest, NotificationBatch) {
+  const char pref_name[] = "homepage";
+  const char other_pref_name[] = "count";
+
+  TestingPrefServiceSimple prefs;
+  prefs.registry()->RegisterStringPref(pref_name, std::string());
+  prefs.registry()->RegisterIntegerPref(other_pref_name, 0);
+
+  MockPrefChangeCallback obs(&prefs);
+  PrefChangeRegistrar registrar;
+  registrar.Init(&prefs);
+  registrar.Add(pref_name, obs.GetCallback());
+  registrar.Add(other_pref_name, obs.GetCallback());
+
+  // Without a batch, every change is notified.
+  EXPECT_CALL(obs, OnPreferenceChanged(pref_name)).Times(3);
+  prefs.SetString(pref_name, "http://www.cnn.com/");
+  prefs.SetString(pref_name, "http://www.google.com/");
+  prefs.SetString(pref_name, "http://www.youtube.com/");
+  Mock::VerifyAndClearExpectations(&obs);
+
+  // In a batch, the observers of each pref are notified once, after the
+  // batch, with the final value.
+  const base::StringValue expected_value((std::string()));
+  const base::FundamentalValue expected_other_value(2);
+  EXPECT_CALL(obs, OnPreferenceChanged(_)).Times(0);
+  {
+    PrefService::ScopedNotificationBatch batch(&prefs);
+    prefs.SetString(pref_name, "http://www.cnn.com/");
+    prefs.SetInteger(other_pref_name, 1);
+    prefs.SetString(pref_name, "http://www.google.com/");
+    prefs.SetInteger(other_pref_name, 2);
+    prefs.ClearPref(pref_name);
+    Mock::VerifyAndClearExpectations(&obs);
+
+    obs.Expect(pref_name, &expected_value);
+    obs.Expect(other_pref_name, &expected_other_value);
+  }
+  Mock::VerifyAndClearExpectations(&obs);
+}
+
 // Make sure that if a preference changes type, so the wrong type is stored in
 // the user pref file, it uses the correct fallback value instead.
 TEST(PrefServiceTest, GetValueChangedType) {
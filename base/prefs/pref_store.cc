@@ -11,3 +11,7 @@ bool PrefStore::HasObservers() const {
 bool PrefStore::IsInitializationComplete() const {
   return true;
 }
+
+bool PrefStore::GetValueForKey(PrefKey key, const base::Value** result) const {
+  return GetValue(key.name(), result);
+}
@@ -10,6 +10,7 @@
 #include "base/basictypes.h"
 #include "base/memory/ref_counted.h"
 #include "base/prefs/base_prefs_export.h"
+#include "base/prefs/pref_key.h"
 
 namespace base {
 class Value;
@@ -52,6 +53,10 @@ class BASE_PREFS_EXPORT PrefStore : public base::RefCounted<PrefStore> {
   virtual bool GetValue(const std::string& key,
                         const base::Value** result) const = 0;
 
+  // Same as GetValue() for the interned |key|. Stores which keep their values
+  // by PrefKey override this to skip the lookup of the name.
+  virtual bool GetValueForKey(PrefKey key, const base::Value** result) const;
+
  protected:
   friend class base::RefCounted<PrefStore>;
   virtual ~PrefStore() {}
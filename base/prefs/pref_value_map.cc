@@ -4,12 +4,17 @@
 
 #include "base/prefs/pref_value_map.h"
 
+#include <algorithm>
+
 #include "base/logging.h"
 #include "base/memory/scoped_ptr.h"
 #include "base/stl_util.h"
 #include "base/values.h"
 
-PrefValueMap::PrefValueMap() {}
+PrefValueMap::PrefValueMap()
+    : unindexed_count_(0),
+      unindexed_since_(0) {
+}
 
 PrefValueMap::~PrefValueMap() {
   Clear();
@@ -17,61 +22,77 @@ PrefValueMap::~PrefValueMap() {
 
 bool PrefValueMap::GetValue(const std::string& key,
                             const base::Value** value) const {
-  const Map::const_iterator entry = prefs_.find(key);
-  if (entry != prefs_.end()) {
-    if (value)
-      *value = entry->second;
-    return true;
-  }
-
-  return false;
+  Map::iterator entry = const_cast<PrefValueMap*>(this)->FindEntry(
+      PrefKey::Find(key), key);
+  if (entry == prefs_.end())
+    return false;
+  if (value)
+    *value = entry->second;
+  return true;
 }
 
 bool PrefValueMap::GetValue(const std::string& key, base::Value** value) {
-  const Map::const_iterator entry = prefs_.find(key);
-  if (entry != prefs_.end()) {
-    if (value)
-      *value = entry->second;
-    return true;
-  }
+  Map::iterator entry = FindEntry(PrefKey::Find(key), key);
+  if (entry == prefs_.end())
+    return false;
+  if (value)
+    *value = entry->second;
+  return true;
+}
 
-  return false;
+bool PrefValueMap::GetValue(PrefKey key, const base::Value** value) const {
+  if (!key.is_valid())
+    return false;
+  Map::iterator entry = const_cast<PrefValueMap*>(this)->FindEntry(
+      key, key.name());
+  if (entry == prefs_.end())
+    return false;
+  if (value)
+    *value = entry->second;
+  return true;
 }
 
 bool PrefValueMap::SetValue(const std::string& key, base::Value* value) {
-  DCHECK(value);
-  scoped_ptr<base::Value> value_ptr(value);
-  const Map::iterator entry = prefs_.find(key);
-  if (entry != prefs_.end()) {
-    if (base::Value::Equals(entry->second, value))
-      return false;
-    delete entry->second;
-    entry->second = value_ptr.release();
-  } else {
-    prefs_[key] = value_ptr.release();
-  }
+  // Read before the name is looked up, as names interned since then are set
+  // unindexed.
+  int interned_count = PrefKey::GetInternedCount();
+  return SetEntryValue(PrefKey::Find(key), key, value, interned_count);
+}
 
-  return true;
+bool PrefValueMap::SetValue(PrefKey key, base::Value* value) {
+  DCHECK(key.is_valid());
+  return SetEntryValue(key, key.name(), value, 0);
 }
 
 bool PrefValueMap::RemoveValue(const std::string& key) {
-  const Map::iterator entry = prefs_.find(key);
-  if (entry != prefs_.end()) {
-    delete entry->second;
-    prefs_.erase(entry);
-    return true;
-  }
-
-  return false;
+  PrefKey pref_key = PrefKey::Find(key);
+  Map::iterator entry = FindEntry(pref_key, key);
+  if (entry == prefs_.end())
+    return false;
+
+  base::hash_map<PrefKey, Map::iterator>::iterator indexed_entry =
+      entries_by_key_.find(pref_key);
+  if (indexed_entry != entries_by_key_.end())
+    entries_by_key_.erase(indexed_entry);
+  else
+    --unindexed_count_;
+  delete entry->second;
+  prefs_.erase(entry);
+  return true;
 }
 
 void PrefValueMap::Clear() {
   STLDeleteValues(&prefs_);
   prefs_.clear();
+  entries_by_key_.clear();
+  unindexed_count_ = 0;
 }
 
 void PrefValueMap::Swap(PrefValueMap* other) {
   prefs_.swap(other->prefs_);
+  entries_by_key_.swap(other->entries_by_key_);
+  std::swap(unindexed_count_, other->unindexed_count_);
+  std::swap(unindexed_since_, other->unindexed_since_);
 }
 
 PrefValueMap::iterator PrefValueMap::begin() {
@@ -154,3 +175,45 @@ void PrefValueMap::GetDifferingKeys(
   for ( ; other_pref != other->prefs_.end(); ++other_pref)
       differing_keys->push_back(other_pref->first);
 }
+
+PrefValueMap::Map::iterator PrefValueMap::FindEntry(PrefKey key,
+                                                    const std::string& name) {
+  if (key.is_valid()) {
+    base::hash_map<PrefKey, Map::iterator>::const_iterator entry =
+        entries_by_key_.find(key);
+    if (entry != entries_by_key_.end())
+      return entry->second;
+  }
+  if (unindexed_count_ == 0 || (key.is_valid() && key.id() < unindexed_since_))
+    return prefs_.end();
+  return prefs_.find(name);
+}
+
+bool PrefValueMap::SetEntryValue(PrefKey key,
+                                 const std::string& name,
+                                 base::Value* value,
+                                 int interned_count) {
+  DCHECK(value);
+  scoped_ptr<base::Value> value_ptr(value);
+  Map::iterator entry = FindEntry(key, name);
+  if (entry == prefs_.end()) {
+    entry = prefs_.insert(std::make_pair(name, value_ptr.release())).first;
+    if (key.is_valid()) {
+      entries_by_key_[key] = entry;
+    } else if (unindexed_count_++ == 0) {
+      unindexed_since_ = interned_count;
+    }
+    return true;
+  }
+
+  // Index the entry if its name was interned since it was set.
+  if (key.is_valid() && entries_by_key_.insert(
+          std::make_pair(key, entry)).second) {
+    --unindexed_count_;
+  }
+  if (base::Value::Equals(entry->second, value))
+    return false;
+  delete entry->second;
+  entry->second = value_ptr.release();
+  return true;
+}
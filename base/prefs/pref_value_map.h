@@ -10,13 +10,18 @@
 #include <vector>
 
 #include "base/basictypes.h"
+#include "base/containers/hash_tables.h"
 #include "base/prefs/base_prefs_export.h"
+#include "base/prefs/pref_key.h"
 
 namespace base {
 class Value;
 }
 
-// A generic string to value map used by the PrefStore implementations.
+// A generic string to value map used by the PrefStore implementations. The
+// values of registered prefs are also indexed by their interned names, for
+// lookups through PrefKey. Names which aren't interned yet are left out of the
+// index, rather than interned, as a store may hold any name.
 class BASE_PREFS_EXPORT PrefValueMap {
  public:
   typedef std::map<std::string, base::Value*>::iterator iterator;
@@ -31,10 +36,16 @@ class BASE_PREFS_EXPORT PrefValueMap {
   bool GetValue(const std::string& key, const base::Value** value) const;
   bool GetValue(const std::string& key, base::Value** value);
 
+  // Same as GetValue() for the interned |key|, without the lookup of the name.
+  bool GetValue(PrefKey key, const base::Value** value) const;
+
   // Sets a new |value| for |key|. Takes ownership of |value|, which must be
   // non-NULL. Returns true if the value changed.
   bool SetValue(const std::string& key, base::Value* value);
 
+  // Same as SetValue() for the interned |key|, without the lookup of the name.
+  bool SetValue(PrefKey key, base::Value* value);
+
   // Removes the value for |key| from the map. Returns true if a value was
   // removed.
   bool RemoveValue(const std::string& key);
@@ -75,16 +86,39 @@ class BASE_PREFS_EXPORT PrefValueMap {
   void SetDouble(const std::string& key, const double value);
 
   // Compares this value map against |other| and stores all key names that have
-  // different values in |differing_keys|. This includes keys that are present
-  // only in one of the maps.
+  // different values in |differing_keys|, in order. This includes keys that
+  // are present only in one of the maps.
   void GetDifferingKeys(const PrefValueMap* other,
                         std::vector<std::string>* differing_keys) const;
 
  private:
   typedef std::map<std::string, base::Value*> Map;
 
+  // Returns the entry for |key|, whose name is |name|, or prefs_.end(). |key|
+  // is invalid if |name| isn't interned.
+  Map::iterator FindEntry(PrefKey key, const std::string& name);
+
+  // Sets the value of the entry for |key| and |name|, as SetValue() does.
+  // |interned_count| is the number of interned names before |name| was looked
+  // up, if |key| is invalid.
+  bool SetEntryValue(PrefKey key,
+                     const std::string& name,
+                     base::Value* value,
+                     int interned_count);
+
   Map prefs_;
 
+  // The entries of |prefs_| by interned name.
+  base::hash_map<PrefKey, Map::iterator> entries_by_key_;
+
+  // The number of entries of |prefs_| which aren't in |entries_by_key_|, as
+  // their names weren't interned when they were set, and the number of
+  // interned names when the first of them was set. Names interned before then
+  // would have been indexed, so only keys with a higher ID may be missing from
+  // the index.
+  size_t unindexed_count_;
+  int unindexed_since_;
+
   DISALLOW_COPY_AND_ASSIGN(PrefValueMap);
 };
 
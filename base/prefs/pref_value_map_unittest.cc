@@ -4,6 +4,9 @@
 
 #include "base/prefs/pref_value_map.h"
 
+#include <string>
+#include <vector>
+
 #include "base/values.h"
 #include "testing/gtest/include/gtest/gtest.h"
 
@@ -122,5 +125,57 @@ TEST(PrefValueMapTest, SwapTwoMaps) {
   EXPECT_TRUE(second_map.GetValue("c", NULL));
 }
 
+// Iteration is by name, in order, whichever order the values were set in.
+TEST(PrefValueMapTest, Iterate) {
+  PrefValueMap map;
+  EXPECT_TRUE(map.SetValue("c", new FundamentalValue(3)));
+  EXPECT_TRUE(map.SetValue("a", new FundamentalValue(1)));
+  EXPECT_TRUE(map.SetValue("b", new FundamentalValue(2)));
+  EXPECT_TRUE(map.RemoveValue("b"));
+  EXPECT_TRUE(map.SetValue("b", new FundamentalValue(4)));
+
+  std::vector<std::string> names;
+  for (PrefValueMap::const_iterator it = map.begin(); it != map.end(); ++it)
+    names.push_back(it->first);
+  ASSERT_EQ(3u, names.size());
+  EXPECT_EQ("a", names[0]);
+  EXPECT_EQ("b", names[1]);
+  EXPECT_EQ("c", names[2]);
+  int int_value = 0;
+  EXPECT_TRUE(map.GetInteger("b", &int_value));
+  EXPECT_EQ(4, int_value);
+}
+
+// Setting a value doesn't intern its name, and a value set before its name
+// is interned is found by key afterwards.
+TEST(PrefValueMapTest, InternedLater) {
+  const char kEarly[] = "pref_value_map_test.interned_later.early";
+  const char kLate[] = "pref_value_map_test.interned_later.late";
+  PrefKey early_key = PrefKey::Intern(kEarly);
+
+  PrefValueMap map;
+  EXPECT_TRUE(map.SetValue(kLate, new FundamentalValue(1)));
+  EXPECT_FALSE(PrefKey::Find(kLate).is_valid());
+  EXPECT_TRUE(map.GetValue(kLate, static_cast<const Value**>(NULL)));
+
+  PrefKey late_key = PrefKey::Intern(kLate);
+  const Value* value = NULL;
+  ASSERT_TRUE(map.GetValue(late_key, &value));
+  EXPECT_TRUE(FundamentalValue(1).Equals(value));
+  EXPECT_FALSE(map.GetValue(early_key, &value));
+
+  EXPECT_TRUE(map.SetValue(early_key, new FundamentalValue(2)));
+  EXPECT_TRUE(map.SetValue(kLate, new FundamentalValue(3)));
+  ASSERT_TRUE(map.GetValue(late_key, &value));
+  EXPECT_TRUE(FundamentalValue(3).Equals(value));
+  ASSERT_TRUE(map.GetValue(early_key, &value));
+  EXPECT_TRUE(FundamentalValue(2).Equals(value));
+
+  EXPECT_TRUE(map.RemoveValue(kLate));
+  EXPECT_FALSE(map.GetValue(late_key, &value));
+  EXPECT_TRUE(map.RemoveValue(kEarly));
+  EXPECT_FALSE(map.GetValue(early_key, &value));
+}
+
 }  // namespace
 }  // namespace base
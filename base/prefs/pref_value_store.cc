@@ -106,10 +106,22 @@ void PrefValueStore::set_callback(const PrefChangedCallback& callback) {
 bool PrefValueStore::GetValue(const std::string& name,
                               base::Value::Type type,
                               const base::Value** out_value) const {
+  PrefKey key = PrefKey::Find(name);
+  for (size_t i = 0; i <= PREF_STORE_TYPE_MAX; ++i) {
+    if (GetValueFromStoreWithType(key, name, type,
+                                  static_cast<PrefStoreType>(i), out_value))
+      return true;
+  }
+  return false;
+}
+
+bool PrefValueStore::GetValue(PrefKey key,
+                              base::Value::Type type,
+                              const base::Value** out_value) const {
   // Check the |PrefStore|s in order of their priority from highest to lowest,
-  // looking for the first preference value with the given |name| and |type|.
+  // looking for the first preference value with the given |key| and |type|.
   for (size_t i = 0; i <= PREF_STORE_TYPE_MAX; ++i) {
-    if (GetValueFromStoreWithType(name.c_str(), type,
+    if (GetValueFromStoreWithType(key, key.name(), type,
                                   static_cast<PrefStoreType>(i), out_value))
       return true;
   }
@@ -119,8 +131,8 @@ bool PrefValueStore::GetValue(const std::string& name,
 bool PrefValueStore::GetRecommendedValue(const std::string& name,
                                          base::Value::Type type,
                                          const base::Value** out_value) const {
-  return GetValueFromStoreWithType(name.c_str(), type, RECOMMENDED_STORE,
-                                   out_value);
+  return GetValueFromStoreWithType(PrefKey::Find(name), name, type,
+                                   RECOMMENDED_STORE, out_value);
 }
 
 void PrefValueStore::NotifyPrefChanged(
@@ -136,41 +148,46 @@ void PrefValueStore::NotifyPrefChanged(
 }
 
 bool PrefValueStore::PrefValueInManagedStore(const char* name) const {
-  return PrefValueInStore(name, MANAGED_STORE);
+  return PrefValueInStore(PrefKey::Find(name), name, MANAGED_STORE);
 }
 
 bool PrefValueStore::PrefValueInExtensionStore(const char* name) const {
-  return PrefValueInStore(name, EXTENSION_STORE);
+  return PrefValueInStore(PrefKey::Find(name), name, EXTENSION_STORE);
 }
 
 bool PrefValueStore::PrefValueInUserStore(const char* name) const {
-  return PrefValueInStore(name, USER_STORE);
+  return PrefValueInStore(PrefKey::Find(name), name, USER_STORE);
 }
 
 bool PrefValueStore::PrefValueFromExtensionStore(const char* name) const {
-  return ControllingPrefStoreForPref(name) == EXTENSION_STORE;
+  return ControllingPrefStoreForPref(PrefKey::Find(name), name) ==
+      EXTENSION_STORE;
 }
 
 bool PrefValueStore::PrefValueFromUserStore(const char* name) const {
-  return ControllingPrefStoreForPref(name) == USER_STORE;
+  return ControllingPrefStoreForPref(PrefKey::Find(name), name) == USER_STORE;
 }
 
 bool PrefValueStore::PrefValueFromRecommendedStore(const char* name) const {
-  return ControllingPrefStoreForPref(name) == RECOMMENDED_STORE;
+  return ControllingPrefStoreForPref(PrefKey::Find(name), name) ==
+      RECOMMENDED_STORE;
 }
 
 bool PrefValueStore::PrefValueFromDefaultStore(const char* name) const {
-  return ControllingPrefStoreForPref(name) == DEFAULT_STORE;
+  return ControllingPrefStoreForPref(PrefKey::Find(name), name) ==
+      DEFAULT_STORE;
 }
 
 bool PrefValueStore::PrefValueUserModifiable(const char* name) const {
-  PrefStoreType effective_store = ControllingPrefStoreForPref(name);
+  PrefStoreType effective_store =
+      ControllingPrefStoreForPref(PrefKey::Find(name), name);
   return effective_store >= USER_STORE ||
          effective_store == INVALID_STORE;
 }
 
 bool PrefValueStore::PrefValueExtensionModifiable(const char* name) const {
-  PrefStoreType effective_store = ControllingPrefStoreForPref(name);
+  PrefStoreType effective_store =
+      ControllingPrefStoreForPref(PrefKey::Find(name), name);
   return effective_store >= EXTENSION_STORE ||
          effective_store == INVALID_STORE;
 }
@@ -180,16 +197,18 @@ void PrefValueStore::UpdateCommandLinePrefStore(PrefStore* command_line_prefs) {
 }
 
 bool PrefValueStore::PrefValueInStore(
-    const char* name,
+    PrefKey key,
+    const std::string& name,
     PrefValueStore::PrefStoreType store) const {
   // Declare a temp Value* and call GetValueFromStore,
   // ignoring the output value.
   const base::Value* tmp_value = NULL;
-  return GetValueFromStore(name, store, &tmp_value);
+  return GetValueFromStore(key, name, store, &tmp_value);
 }
 
 bool PrefValueStore::PrefValueInStoreRange(
-    const char* name,
+    PrefKey key,
+    const std::string& name,
     PrefValueStore::PrefStoreType first_checked_store,
     PrefValueStore::PrefStoreType last_checked_store) const {
   if (first_checked_store > last_checked_store) {
@@ -199,29 +218,34 @@ bool PrefValueStore::PrefValueInStoreRange(
 
   for (size_t i = first_checked_store;
        i <= static_cast<size_t>(last_checked_store); ++i) {
-    if (PrefValueInStore(name, static_cast<PrefStoreType>(i)))
+    if (PrefValueInStore(key, name, static_cast<PrefStoreType>(i)))
       return true;
   }
   return false;
 }
 
 PrefValueStore::PrefStoreType PrefValueStore::ControllingPrefStoreForPref(
-    const char* name) const {
+    PrefKey key,
+    const std::string& name) const {
   for (size_t i = 0; i <= PREF_STORE_TYPE_MAX; ++i) {
-    if (PrefValueInStore(name, static_cast<PrefStoreType>(i)))
+    if (PrefValueInStore(key, name, static_cast<PrefStoreType>(i)))
       return static_cast<PrefStoreType>(i);
   }
   return INVALID_STORE;
 }
 
-bool PrefValueStore::GetValueFromStore(const char* name,
+bool PrefValueStore::GetValueFromStore(PrefKey key,
+                                       const std::string& name,
                                        PrefValueStore::PrefStoreType store_type,
                                        const base::Value** out_value) const {
   // Only return true if we find a value and it is the correct type, so stale
-  // values with the incorrect type will be ignored.
+  // values with the incorrect type will be ignored. The names of registered
+  // prefs are interned; other names are looked up as such.
   const PrefStore* store = GetPrefStore(static_cast<PrefStoreType>(store_type));
-  if (store && store->GetValue(name, out_value))
+  if (store && (key.is_valid() ? store->GetValueForKey(key, out_value)
+                               : store->GetValue(name, out_value))) {
     return true;
+  }
 
   // No valid value found for the given preference name: set the return value
   // to false.
@@ -230,11 +254,12 @@ bool PrefValueStore::GetValueFromStore(const char* name,
 }
 
 bool PrefValueStore::GetValueFromStoreWithType(
-    const char* name,
+    PrefKey key,
+    const std::string& name,
     base::Value::Type type,
     PrefStoreType store,
     const base::Value** out_value) const {
-  if (GetValueFromStore(name, store, out_value)) {
+  if (GetValueFromStore(key, name, store, out_value)) {
     if ((*out_value)->IsType(type))
       return true;
 
@@ -5,15 +5,16 @@
 #ifndef BASE_PREFS_PREF_VALUE_STORE_H_
 #define BASE_PREFS_PREF_VALUE_STORE_H_
 
-#include <map>
 #include <string>
 #include <vector>
 
 #include "base/basictypes.h"
 #include "base/callback.h"
+#include "base/containers/hash_tables.h"
 #include "base/gtest_prod_util.h"
 #include "base/memory/ref_counted.h"
 #include "base/prefs/base_prefs_export.h"
+#include "base/prefs/pref_key.h"
 #include "base/prefs/pref_store.h"
 #include "base/values.h"
 
@@ -82,6 +83,11 @@ class BASE_PREFS_EXPORT PrefValueStore {
                 base::Value::Type type,
                 const base::Value** out_value) const;
 
+  // Same as GetValue() for the interned |key|.
+  bool GetValue(PrefKey key,
+                base::Value::Type type,
+                const base::Value** out_value) const;
+
   // Gets the recommended value for the given preference name that has the
   // specified value type. A value stored in the recommended PrefStore that has
   // the matching |name| but a non-matching |type| is silently ignored. Returns
@@ -176,7 +182,7 @@ class BASE_PREFS_EXPORT PrefValueStore {
     DISALLOW_COPY_AND_ASSIGN(PrefStoreKeeper);
   };
 
-  typedef std::map<std::string, base::Value::Type> PrefTypeMap;
+  typedef base::hash_map<PrefKey, base::Value::Type> PrefTypeMap;
 
   friend class PrefValueStorePolicyRefreshTest;
   FRIEND_TEST_ALL_PREFIXES(PrefValueStorePolicyRefreshTest, TestPolicyRefresh);
@@ -185,33 +191,41 @@ class BASE_PREFS_EXPORT PrefValueStore {
   FRIEND_TEST_ALL_PREFIXES(PrefValueStorePolicyRefreshTest,
                            TestConcurrentPolicyRefresh);
 
-  // Returns true if the preference with the given name has a value in the
+  // Returns true if the preference with the given key has a value in the
   // given PrefStoreType, of the same value type as the preference was
-  // registered with.
-  bool PrefValueInStore(const char* name, PrefStoreType store) const;
+  // registered with. The private methods below take the |name| of the pref
+  // along with its |key|, which is invalid if |name| isn't interned, in which
+  // case the stores are searched by name.
+  bool PrefValueInStore(PrefKey key,
+                        const std::string& name,
+                        PrefStoreType store) const;
 
   // Returns true if a preference has an explicit value in any of the
   // stores in the range specified by |first_checked_store| and
   // |last_checked_store|, even if that value is currently being
   // overridden by a higher-priority store.
-  bool PrefValueInStoreRange(const char* name,
+  bool PrefValueInStoreRange(PrefKey key,
+                             const std::string& name,
                              PrefStoreType first_checked_store,
                              PrefStoreType last_checked_store) const;
 
   // Returns the pref store type identifying the source that controls the
-  // Preference identified by |name|. If none of the sources has a value,
+  // Preference identified by |key|. If none of the sources has a value,
   // INVALID_STORE is returned. In practice, the default PrefStore
   // should always have a value for any registered preferencem, so INVALID_STORE
   // indicates an error.
-  PrefStoreType ControllingPrefStoreForPref(const char* name) const;
+  PrefStoreType ControllingPrefStoreForPref(PrefKey key,
+                                            const std::string& name) const;
 
   // Get a value from the specified |store|.
-  bool GetValueFromStore(const char* name,
+  bool GetValueFromStore(PrefKey key,
+                         const std::string& name,
                          PrefStoreType store,
                          const base::Value** out_value) const;
 
   // Get a value from the specified |store| if its |type| matches.
-  bool GetValueFromStoreWithType(const char* name,
+  bool GetValueFromStoreWithType(PrefKey key,
+                                 const std::string& name,
                                  base::Value::Type type,
                                  PrefStoreType store,
                                  const base::Value** out_value) const;
@@ -255,7 +269,7 @@ class BASE_PREFS_EXPORT PrefValueStore {
   // since the notifier is owned by the corresponding PrefService.
   PrefNotifier* pref_notifier_;
 
-  // A mapping of preference names to their registered types.
+  // A mapping of preference keys to their registered types.
   PrefTypeMap pref_types_;
 
   // True if not all of the PrefStores were initialized successfully.
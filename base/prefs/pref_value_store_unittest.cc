@@ -7,6 +7,7 @@
 #include "base/bind.h"
 #include "base/memory/ref_counted.h"
 #include "base/memory/scoped_ptr.h"
+#include "base/prefs/pref_key.h"
 #include "base/prefs/pref_notifier.h"
 #include "base/prefs/pref_value_store.h"
 #include "base/prefs/testing_pref_store.h"
@@ -517,6 +518,17 @@ TEST_F(PrefValueStoreTest, PrefValueInManagedStore) {
       prefs::kMissingPref));
 }
 
+// Looking up names which aren't registered doesn't intern them.
+TEST_F(PrefValueStoreTest, UnknownNamesNotInterned) {
+  const char kUnknownPref[] = "this.pref.is.not.registered";
+  const base::Value* value = NULL;
+  EXPECT_FALSE(pref_value_store_->GetValue(
+      kUnknownPref, base::Value::TYPE_STRING, &value));
+  EXPECT_FALSE(pref_value_store_->PrefValueInUserStore(kUnknownPref));
+  EXPECT_TRUE(pref_value_store_->PrefValueUserModifiable(kUnknownPref));
+  EXPECT_FALSE(PrefKey::Find(kUnknownPref).is_valid());
+}
+
 TEST_F(PrefValueStoreTest, PrefValueInExtensionStore) {
   EXPECT_TRUE(pref_value_store_->PrefValueInExtensionStore(
       prefs::kManagedPref));
@@ -21,6 +21,11 @@ bool TestingPrefStore::GetValue(const std::string& key,
   return prefs_.GetValue(key, value);
 }
 
+bool TestingPrefStore::GetValueForKey(PrefKey key,
+                                      const base::Value** value) const {
+  return prefs_.GetValue(key, value);
+}
+
 bool TestingPrefStore::GetMutableValue(const std::string& key,
                                        base::Value** value) {
   return prefs_.GetValue(key, value);
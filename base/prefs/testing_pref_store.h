@@ -23,6 +23,8 @@ class TestingPrefStore : public PersistentPrefStore {
   // Overriden from PrefStore.
   virtual bool GetValue(const std::string& key,
                         const base::Value** result) const override;
+  virtual bool GetValueForKey(PrefKey key,
+                              const base::Value** result) const override;
   virtual void AddObserver(PrefStore::Observer* observer) override;
   virtual void RemoveObserver(PrefStore::Observer* observer) override;
   virtual bool HasObservers() const override;
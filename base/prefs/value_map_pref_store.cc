@@ -16,6 +16,11 @@ bool ValueMapPrefStore::GetValue(const std::string& key,
   return prefs_.GetValue(key, value);
 }
 
+bool ValueMapPrefStore::GetValueForKey(PrefKey key,
+                                       const base::Value** value) const {
+  return prefs_.GetValue(key, value);
+}
+
 void ValueMapPrefStore::AddObserver(PrefStore::Observer* observer) {
   observers_.AddObserver(observer);
 }
@@ -23,6 +23,8 @@ class BASE_PREFS_EXPORT ValueMapPrefStore : public WriteablePrefStore {
   // PrefStore overrides:
   virtual bool GetValue(const std::string& key,
                         const base::Value** value) const override;
+  virtual bool GetValueForKey(PrefKey key,
+                              const base::Value** value) const override;
   virtual void AddObserver(PrefStore::Observer* observer) override;
   virtual void RemoveObserver(PrefStore::Observer* observer) override;
   virtual bool HasObservers() const override;
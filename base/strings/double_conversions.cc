@@ -0,0 +1,1158 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+//
+// This follows the reference implementation of Ryu, d2s.c and s2d.c in
+// https://github.com/ulfjack/ryu, which is available under the Apache
+// License 2.0 or the Boost Software License 1.0.
+
+#include "base/strings/double_conversions.h"
+
+#include <string.h>
+
+#include <algorithm>
+
+#include "base/basictypes.h"
+#include "base/logging.h"
+#include "build/build_config.h"
+
+#if defined(COMPILER_MSVC) && defined(ARCH_CPU_X86_64)
+#include <intrin.h>
+#endif
+
+namespace base {
+
+namespace {
+
+const int kMantissaBits = 52;
+const int kExponentBits = 11;
+const int kExponentBias = 1023;
+
+// Number of bits of the powers of five, and of their inverses, in the
+// tables below.
+const int kPow5Bits = 125;
+const int kPow5InvBits = 125;
+
+const int kPow5TableSize = 326;
+const int kPow5InvTableSize = 342;
+
+// kPow5InvSplit[i] is floor(2^(pow5bits(i) - 1 + kPow5InvBits) / 5^i) + 1,
+// and kPow5Split[i] is 5^i shifted to be exactly kPow5Bits long, both as
+// {low, high} 64-bit halves. Generated with:
+//   for i in range(342):
+//     p = 5 ** i
+//     inv = (1 << (p.bit_length() - 1 + 125)) // p + 1
+//   for i in range(326):
+//     p = 5 ** i
+//     l = p.bit_length()
+//     split = p >> (l - 125) if l > 125 else p << (125 - l)
+const uint64 kPow5InvSplit[kPow5InvTableSize][2] = {
+  { GG_UINT64_C(1), GG_UINT64_C(2305843009213693952) },
+  { GG_UINT64_C(11068046444225730970), GG_UINT64_C(1844674407370955161) },
+  { GG_UINT64_C(5165088340638674453), GG_UINT64_C(1475739525896764129) },
+  { GG_UINT64_C(7821419487252849886), GG_UINT64_C(1180591620717411303) },
+  { GG_UINT64_C(8824922364862649494), GG_UINT64_C(1888946593147858085) },
+  { GG_UINT64_C(7059937891890119595), GG_UINT64_C(1511157274518286468) },
+  { GG_UINT64_C(13026647942995916322), GG_UINT64_C(1208925819614629174) },
+  { GG_UINT64_C(9774590264567735146), GG_UINT64_C(1934281311383406679) },
+  { GG_UINT64_C(11509021026396098440), GG_UINT64_C(1547425049106725343) },
+  { GG_UINT64_C(16585914450600699399), GG_UINT64_C(1237940039285380274) },
+  { GG_UINT64_C(15469416676735388068), GG_UINT64_C(1980704062856608439) },
+  { GG_UINT64_C(16064882156130220778), GG_UINT64_C(1584563250285286751) },
+  { GG_UINT64_C(9162556910162266299), GG_UINT64_C(1267650600228229401) },
+  { GG_UINT64_C(7281393426775805432), GG_UINT64_C(2028240960365167042) },
+  { GG_UINT64_C(16893161185646375315), GG_UINT64_C(1622592768292133633) },
+  { GG_UINT64_C(2446482504291369283), GG_UINT64_C(1298074214633706907) },
+  { GG_UINT64_C(7603720821608101175), GG_UINT64_C(2076918743413931051) },
+  { GG_UINT64_C(2393627842544570617), GG_UINT64_C(1661534994731144841) },
+  { GG_UINT64_C(16672297533003297786), GG_UINT64_C(1329227995784915872) },
+  { GG_UINT64_C(11918280793837635165), GG_UINT64_C(2126764793255865396) },
+  { GG_UINT64_C(5845275820328197809), GG_UINT64_C(1701411834604692317) },
+  { GG_UINT64_C(15744267100488289217), GG_UINT64_C(1361129467683753853) },
+  { GG_UINT64_C(3054734472329800808), GG_UINT64_C(2177807148294006166) },
+  { GG_UINT64_C(17201182836831481939), GG_UINT64_C(1742245718635204932) },
+  { GG_UINT64_C(6382248639981364905), GG_UINT64_C(1393796574908163946) },
+  { GG_UINT64_C(2832900194486363201), GG_UINT64_C(2230074519853062314) },
+  { GG_UINT64_C(5955668970331000884), GG_UINT64_C(1784059615882449851) },
+  { GG_UINT64_C(1075186361522890384), GG_UINT64_C(1427247692705959881) },
+  { GG_UINT64_C(12788344622662355584), GG_UINT64_C(2283596308329535809) },
+  { GG_UINT64_C(13920024512871794791), GG_UINT64_C(1826877046663628647) },
+  { GG_UINT64_C(3757321980813615186), GG_UINT64_C(1461501637330902918) },
+  { GG_UINT64_C(10384555214134712795), GG_UINT64_C(1169201309864722334) },
+  { GG_UINT64_C(5547241898389809503), GG_UINT64_C(1870722095783555735) },
+  { GG_UINT64_C(4437793518711847602), GG_UINT64_C(1496577676626844588) },
+  { GG_UINT64_C(10928932444453298728), GG_UINT64_C(1197262141301475670) },
+  { GG_UINT64_C(17486291911125277965), GG_UINT64_C(1915619426082361072) },
+  { GG_UINT64_C(6610335899416401726), GG_UINT64_C(1532495540865888858) },
+  { GG_UINT64_C(12666966349016942027), GG_UINT64_C(1225996432692711086) },
+  { GG_UINT64_C(12888448528943286597), GG_UINT64_C(1961594292308337738) },
+  { GG_UINT64_C(17689456452638449924), GG_UINT64_C(1569275433846670190) },
+  { GG_UINT64_C(14151565162110759939), GG_UINT64_C(1255420347077336152) },
+  { GG_UINT64_C(7885109000409574610), GG_UINT64_C(2008672555323737844) },
+  { GG_UINT64_C(9997436015069570011), GG_UINT64_C(1606938044258990275) },
+  { GG_UINT64_C(7997948812055656009), GG_UINT64_C(1285550435407192220) },
+  { GG_UINT64_C(12796718099289049614), GG_UINT64_C(2056880696651507552) },
+  { GG_UINT64_C(2858676849947419045), GG_UINT64_C(1645504557321206042) },
+  { GG_UINT64_C(13354987924183666206), GG_UINT64_C(1316403645856964833) },
+  { GG_UINT64_C(17678631863951955605), GG_UINT64_C(2106245833371143733) },
+  { GG_UINT64_C(3074859046935833515), GG_UINT64_C(1684996666696914987) },
+  { GG_UINT64_C(13527933681774397782), GG_UINT64_C(1347997333357531989) },
+  { GG_UINT64_C(10576647446613305481), GG_UINT64_C(2156795733372051183) },
+  { GG_UINT64_C(15840015586774465031), GG_UINT64_C(1725436586697640946) },
+  { GG_UINT64_C(8982663654677661702), GG_UINT64_C(1380349269358112757) },
+  { GG_UINT64_C(18061610662226169046), GG_UINT64_C(2208558830972980411) },
+  { GG_UINT64_C(10759939715039024913), GG_UINT64_C(1766847064778384329) },
+  { GG_UINT64_C(12297300586773130254), GG_UINT64_C(1413477651822707463) },
+  { GG_UINT64_C(15986332124095098083), GG_UINT64_C(2261564242916331941) },
+  { GG_UINT64_C(9099716884534168143), GG_UINT64_C(1809251394333065553) },
+  { GG_UINT64_C(14658471137111155161), GG_UINT64_C(1447401115466452442) },
+  { GG_UINT64_C(4348079280205103483), GG_UINT64_C(1157920892373161954) },
+  { GG_UINT64_C(14335624477811986218), GG_UINT64_C(1852673427797059126) },
+  { GG_UINT64_C(7779150767507678651), GG_UINT64_C(1482138742237647301) },
+  { GG_UINT64_C(2533971799264232598), GG_UINT64_C(1185710993790117841) },
+  { GG_UINT64_C(15122401323048503126), GG_UINT64_C(1897137590064188545) },
+  { GG_UINT64_C(12097921058438802501), GG_UINT64_C(1517710072051350836) },
+  { GG_UINT64_C(5988988032009131678), GG_UINT64_C(1214168057641080669) },
+  { GG_UINT64_C(16961078480698431330), GG_UINT64_C(1942668892225729070) },
+  { GG_UINT64_C(13568862784558745064), GG_UINT64_C(1554135113780583256) },
+  { GG_UINT64_C(7165741412905085728), GG_UINT64_C(1243308091024466605) },
+  { GG_UINT64_C(11465186260648137165), GG_UINT64_C(1989292945639146568) },
+  { GG_UINT64_C(16550846638002330379), GG_UINT64_C(1591434356511317254) },
+  { GG_UINT64_C(16930026125143774626), GG_UINT64_C(1273147485209053803) },
+  { GG_UINT64_C(4951948911778577463), GG_UINT64_C(2037035976334486086) },
+  { GG_UINT64_C(272210314680951647), GG_UINT64_C(1629628781067588869) },
+  { GG_UINT64_C(3907117066486671641), GG_UINT64_C(1303703024854071095) },
+  { GG_UINT64_C(6251387306378674625), GG_UINT64_C(2085924839766513752) },
+  { GG_UINT64_C(16069156289328670670), GG_UINT64_C(1668739871813211001) },
+  { GG_UINT64_C(9165976216721026213), GG_UINT64_C(1334991897450568801) },
+  { GG_UINT64_C(7286864317269821294), GG_UINT64_C(2135987035920910082) },
+  { GG_UINT64_C(16897537898041588005), GG_UINT64_C(1708789628736728065) },
+  { GG_UINT64_C(13518030318433270404), GG_UINT64_C(1367031702989382452) },
+  { GG_UINT64_C(6871453250525591353), GG_UINT64_C(2187250724783011924) },
+  { GG_UINT64_C(9186511415162383406), GG_UINT64_C(1749800579826409539) },
+  { GG_UINT64_C(11038557946871817048), GG_UINT64_C(1399840463861127631) },
+  { GG_UINT64_C(10282995085511086630), GG_UINT64_C(2239744742177804210) },
+  { GG_UINT64_C(8226396068408869304), GG_UINT64_C(1791795793742243368) },
+  { GG_UINT64_C(13959814484210916090), GG_UINT64_C(1433436634993794694) },
+  { GG_UINT64_C(11267656730511734774), GG_UINT64_C(2293498615990071511) },
+  { GG_UINT64_C(5324776569667477496), GG_UINT64_C(1834798892792057209) },
+  { GG_UINT64_C(7949170070475892320), GG_UINT64_C(1467839114233645767) },
+  { GG_UINT64_C(17427382500606444826), GG_UINT64_C(1174271291386916613) },
+  { GG_UINT64_C(5747719112518849781), GG_UINT64_C(1878834066219066582) },
+  { GG_UINT64_C(15666221734240810795), GG_UINT64_C(1503067252975253265) },
+  { GG_UINT64_C(12532977387392648636), GG_UINT64_C(1202453802380202612) },
+  { GG_UINT64_C(5295368560860596524), GG_UINT64_C(1923926083808324180) },
+  { GG_UINT64_C(4236294848688477220), GG_UINT64_C(1539140867046659344) },
+  { GG_UINT64_C(7078384693692692099), GG_UINT64_C(1231312693637327475) },
+  { GG_UINT64_C(11325415509908307358), GG_UINT64_C(1970100309819723960) },
+  { GG_UINT64_C(9060332407926645887), GG_UINT64_C(1576080247855779168) },
+  { GG_UINT64_C(14626963555825137356), GG_UINT64_C(1260864198284623334) },
+  { GG_UINT64_C(12335095245094488799), GG_UINT64_C(2017382717255397335) },
+  { GG_UINT64_C(9868076196075591040), GG_UINT64_C(1613906173804317868) },
+  { GG_UINT64_C(15273158586344293478), GG_UINT64_C(1291124939043454294) },
+  { GG_UINT64_C(13369007293925138595), GG_UINT64_C(2065799902469526871) },
+  { GG_UINT64_C(7005857020398200553), GG_UINT64_C(1652639921975621497) },
+  { GG_UINT64_C(16672732060544291412), GG_UINT64_C(1322111937580497197) },
+  { GG_UINT64_C(11918976037903224966), GG_UINT64_C(2115379100128795516) },
+  { GG_UINT64_C(5845832015580669650), GG_UINT64_C(1692303280103036413) },
+  { GG_UINT64_C(12055363241948356366), GG_UINT64_C(1353842624082429130) },
+  { GG_UINT64_C(841837113407818570), GG_UINT64_C(2166148198531886609) },
+  { GG_UINT64_C(4362818505468165179), GG_UINT64_C(1732918558825509287) },
+  { GG_UINT64_C(14558301248600263113), GG_UINT64_C(1386334847060407429) },
+  { GG_UINT64_C(12225235553534690011), GG_UINT64_C(2218135755296651887) },
+  { GG_UINT64_C(2401490813343931363), GG_UINT64_C(1774508604237321510) },
+  { GG_UINT64_C(1921192650675145090), GG_UINT64_C(1419606883389857208) },
+  { GG_UINT64_C(17831303500047873437), GG_UINT64_C(2271371013423771532) },
+  { GG_UINT64_C(6886345170554478103), GG_UINT64_C(1817096810739017226) },
+  { GG_UINT64_C(1819727321701672159), GG_UINT64_C(1453677448591213781) },
+  { GG_UINT64_C(16213177116328979020), GG_UINT64_C(1162941958872971024) },
+  { GG_UINT64_C(14873036941900635463), GG_UINT64_C(1860707134196753639) },
+  { GG_UINT64_C(15587778368262418694), GG_UINT64_C(1488565707357402911) },
+  { GG_UINT64_C(8780873879868024632), GG_UINT64_C(1190852565885922329) },
+  { GG_UINT64_C(2981351763563108441), GG_UINT64_C(1905364105417475727) },
+  { GG_UINT64_C(13453127855076217722), GG_UINT64_C(1524291284333980581) },
+  { GG_UINT64_C(7073153469319063855), GG_UINT64_C(1219433027467184465) },
+  { GG_UINT64_C(11317045550910502167), GG_UINT64_C(1951092843947495144) },
+  { GG_UINT64_C(12742985255470312057), GG_UINT64_C(1560874275157996115) },
+  { GG_UINT64_C(10194388204376249646), GG_UINT64_C(1248699420126396892) },
+  { GG_UINT64_C(1553625868034358140), GG_UINT64_C(1997919072202235028) },
+  { GG_UINT64_C(8621598323911307159), GG_UINT64_C(1598335257761788022) },
+  { GG_UINT64_C(17965325103354776697), GG_UINT64_C(1278668206209430417) },
+  { GG_UINT64_C(13987124906400001422), GG_UINT64_C(2045869129935088668) },
+  { GG_UINT64_C(121653480894270168), GG_UINT64_C(1636695303948070935) },
+  { GG_UINT64_C(97322784715416134), GG_UINT64_C(1309356243158456748) },
+  { GG_UINT64_C(14913111714512307107), GG_UINT64_C(2094969989053530796) },
+  { GG_UINT64_C(8241140556867935363), GG_UINT64_C(1675975991242824637) },
+  { GG_UINT64_C(17660958889720079260), GG_UINT64_C(1340780792994259709) },
+  { GG_UINT64_C(17189487779326395846), GG_UINT64_C(2145249268790815535) },
+  { GG_UINT64_C(13751590223461116677), GG_UINT64_C(1716199415032652428) },
+  { GG_UINT64_C(18379969808252713988), GG_UINT64_C(1372959532026121942) },
+  { GG_UINT64_C(14650556434236701088), GG_UINT64_C(2196735251241795108) },
+  { GG_UINT64_C(652398703163629901), GG_UINT64_C(1757388200993436087) },
+  { GG_UINT64_C(11589965406756634890), GG_UINT64_C(1405910560794748869) },
+  { GG_UINT64_C(7475898206584884855), GG_UINT64_C(2249456897271598191) },
+  { GG_UINT64_C(2291369750525997561), GG_UINT64_C(1799565517817278553) },
+  { GG_UINT64_C(9211793429904618695), GG_UINT64_C(1439652414253822842) },
+  { GG_UINT64_C(18428218302589300235), GG_UINT64_C(2303443862806116547) },
+  { GG_UINT64_C(7363877012587619542), GG_UINT64_C(1842755090244893238) },
+  { GG_UINT64_C(13269799239553916280), GG_UINT64_C(1474204072195914590) },
+  { GG_UINT64_C(10615839391643133024), GG_UINT64_C(1179363257756731672) },
+  { GG_UINT64_C(2227947767661371545), GG_UINT64_C(1886981212410770676) },
+  { GG_UINT64_C(16539753473096738529), GG_UINT64_C(1509584969928616540) },
+  { GG_UINT64_C(13231802778477390823), GG_UINT64_C(1207667975942893232) },
+  { GG_UINT64_C(6413489186596184024), GG_UINT64_C(1932268761508629172) },
+  { GG_UINT64_C(16198837793502678189), GG_UINT64_C(1545815009206903337) },
+  { GG_UINT64_C(5580372605318321905), GG_UINT64_C(1236652007365522670) },
+  { GG_UINT64_C(8928596168509315048), GG_UINT64_C(1978643211784836272) },
+  { GG_UINT64_C(18210923379033183008), GG_UINT64_C(1582914569427869017) },
+  { GG_UINT64_C(7190041073742725760), GG_UINT64_C(1266331655542295214) },
+  { GG_UINT64_C(436019273762630246), GG_UINT64_C(2026130648867672343) },
+  { GG_UINT64_C(7727513048493924843), GG_UINT64_C(1620904519094137874) },
+  { GG_UINT64_C(9871359253537050198), GG_UINT64_C(1296723615275310299) },
+  { GG_UINT64_C(4726128361433549347), GG_UINT64_C(2074757784440496479) },
+  { GG_UINT64_C(7470251503888749801), GG_UINT64_C(1659806227552397183) },
+  { GG_UINT64_C(13354898832594820487), GG_UINT64_C(1327844982041917746) },
+  { GG_UINT64_C(13989140502667892133), GG_UINT64_C(2124551971267068394) },
+  { GG_UINT64_C(14880661216876224029), GG_UINT64_C(1699641577013654715) },
+  { GG_UINT64_C(11904528973500979224), GG_UINT64_C(1359713261610923772) },
+  { GG_UINT64_C(4289851098633925465), GG_UINT64_C(2175541218577478036) },
+  { GG_UINT64_C(18189276137874781665), GG_UINT64_C(1740432974861982428) },
+  { GG_UINT64_C(3483374466074094362), GG_UINT64_C(1392346379889585943) },
+  { GG_UINT64_C(1884050330976640656), GG_UINT64_C(2227754207823337509) },
+  { GG_UINT64_C(5196589079523222848), GG_UINT64_C(1782203366258670007) },
+  { GG_UINT64_C(15225317707844309248), GG_UINT64_C(1425762693006936005) },
+  { GG_UINT64_C(5913764258841343181), GG_UINT64_C(2281220308811097609) },
+  { GG_UINT64_C(8420360221814984868), GG_UINT64_C(1824976247048878087) },
+  { GG_UINT64_C(17804334621677718864), GG_UINT64_C(1459980997639102469) },
+  { GG_UINT64_C(17932816512084085415), GG_UINT64_C(1167984798111281975) },
+  { GG_UINT64_C(10245762345624985047), GG_UINT64_C(1868775676978051161) },
+  { GG_UINT64_C(4507261061758077715), GG_UINT64_C(1495020541582440929) },
+  { GG_UINT64_C(7295157664148372495), GG_UINT64_C(1196016433265952743) },
+  { GG_UINT64_C(7982903447895485668), GG_UINT64_C(1913626293225524389) },
+  { GG_UINT64_C(10075671573058298858), GG_UINT64_C(1530901034580419511) },
+  { GG_UINT64_C(4371188443704728763), GG_UINT64_C(1224720827664335609) },
+  { GG_UINT64_C(14372599139411386667), GG_UINT64_C(1959553324262936974) },
+  { GG_UINT64_C(15187428126271019657), GG_UINT64_C(1567642659410349579) },
+  { GG_UINT64_C(15839291315758726049), GG_UINT64_C(1254114127528279663) },
+  { GG_UINT64_C(3206773216762499739), GG_UINT64_C(2006582604045247462) },
+  { GG_UINT64_C(13633465017635730761), GG_UINT64_C(1605266083236197969) },
+  { GG_UINT64_C(14596120828850494932), GG_UINT64_C(1284212866588958375) },
+  { GG_UINT64_C(4907049252451240275), GG_UINT64_C(2054740586542333401) },
+  { GG_UINT64_C(236290587219081897), GG_UINT64_C(1643792469233866721) },
+  { GG_UINT64_C(14946427728742906810), GG_UINT64_C(1315033975387093376) },
+  { GG_UINT64_C(16535586736504830250), GG_UINT64_C(2104054360619349402) },
+  { GG_UINT64_C(5849771759720043554), GG_UINT64_C(1683243488495479522) },
+  { GG_UINT64_C(15747863852001765813), GG_UINT64_C(1346594790796383617) },
+  { GG_UINT64_C(10439186904235184007), GG_UINT64_C(2154551665274213788) },
+  { GG_UINT64_C(15730047152871967852), GG_UINT64_C(1723641332219371030) },
+  { GG_UINT64_C(12584037722297574282), GG_UINT64_C(1378913065775496824) },
+  { GG_UINT64_C(9066413911450387881), GG_UINT64_C(2206260905240794919) },
+  { GG_UINT64_C(10942479943902220628), GG_UINT64_C(1765008724192635935) },
+  { GG_UINT64_C(8753983955121776503), GG_UINT64_C(1412006979354108748) },
+  { GG_UINT64_C(10317025513452932081), GG_UINT64_C(2259211166966573997) },
+  { GG_UINT64_C(874922781278525018), GG_UINT64_C(1807368933573259198) },
+  { GG_UINT64_C(8078635854506640661), GG_UINT64_C(1445895146858607358) },
+  { GG_UINT64_C(13841606313089133175), GG_UINT64_C(1156716117486885886) },
+  { GG_UINT64_C(14767872471458792434), GG_UINT64_C(1850745787979017418) },
+  { GG_UINT64_C(746251532941302978), GG_UINT64_C(1480596630383213935) },
+  { GG_UINT64_C(597001226353042382), GG_UINT64_C(1184477304306571148) },
+  { GG_UINT64_C(15712597221132509104), GG_UINT64_C(1895163686890513836) },
+  { GG_UINT64_C(8880728962164096960), GG_UINT64_C(1516130949512411069) },
+  { GG_UINT64_C(10793931984473187891), GG_UINT64_C(1212904759609928855) },
+  { GG_UINT64_C(17270291175157100626), GG_UINT64_C(1940647615375886168) },
+  { GG_UINT64_C(2748186495899949531), GG_UINT64_C(1552518092300708935) },
+  { GG_UINT64_C(2198549196719959625), GG_UINT64_C(1242014473840567148) },
+  { GG_UINT64_C(18275073973719576693), GG_UINT64_C(1987223158144907436) },
+  { GG_UINT64_C(10930710364233751031), GG_UINT64_C(1589778526515925949) },
+  { GG_UINT64_C(12433917106128911148), GG_UINT64_C(1271822821212740759) },
+  { GG_UINT64_C(8826220925580526867), GG_UINT64_C(2034916513940385215) },
+  { GG_UINT64_C(7060976740464421494), GG_UINT64_C(1627933211152308172) },
+  { GG_UINT64_C(16716827836597268165), GG_UINT64_C(1302346568921846537) },
+  { GG_UINT64_C(11989529279587987770), GG_UINT64_C(2083754510274954460) },
+  { GG_UINT64_C(9591623423670390216), GG_UINT64_C(1667003608219963568) },
+  { GG_UINT64_C(15051996368420132820), GG_UINT64_C(1333602886575970854) },
+  { GG_UINT64_C(13015147745246481542), GG_UINT64_C(2133764618521553367) },
+  { GG_UINT64_C(3033420566713364587), GG_UINT64_C(1707011694817242694) },
+  { GG_UINT64_C(6116085268112601993), GG_UINT64_C(1365609355853794155) },
+  { GG_UINT64_C(9785736428980163188), GG_UINT64_C(2184974969366070648) },
+  { GG_UINT64_C(15207286772667951197), GG_UINT64_C(1747979975492856518) },
+  { GG_UINT64_C(1097782973908629988), GG_UINT64_C(1398383980394285215) },
+  { GG_UINT64_C(1756452758253807981), GG_UINT64_C(2237414368630856344) },
+  { GG_UINT64_C(5094511021344956708), GG_UINT64_C(1789931494904685075) },
+  { GG_UINT64_C(4075608817075965366), GG_UINT64_C(1431945195923748060) },
+  { GG_UINT64_C(6520974107321544586), GG_UINT64_C(2291112313477996896) },
+  { GG_UINT64_C(1527430471115325346), GG_UINT64_C(1832889850782397517) },
+  { GG_UINT64_C(12289990821117991246), GG_UINT64_C(1466311880625918013) },
+  { GG_UINT64_C(17210690286378213644), GG_UINT64_C(1173049504500734410) },
+  { GG_UINT64_C(9090360384495590213), GG_UINT64_C(1876879207201175057) },
+  { GG_UINT64_C(18340334751822203140), GG_UINT64_C(1501503365760940045) },
+  { GG_UINT64_C(14672267801457762512), GG_UINT64_C(1201202692608752036) },
+  { GG_UINT64_C(16096930852848599373), GG_UINT64_C(1921924308174003258) },
+  { GG_UINT64_C(1809498238053148529), GG_UINT64_C(1537539446539202607) },
+  { GG_UINT64_C(12515645034668249793), GG_UINT64_C(1230031557231362085) },
+  { GG_UINT64_C(1578287981759648052), GG_UINT64_C(1968050491570179337) },
+  { GG_UINT64_C(12330676829633449412), GG_UINT64_C(1574440393256143469) },
+  { GG_UINT64_C(13553890278448669853), GG_UINT64_C(1259552314604914775) },
+  { GG_UINT64_C(3239480371808320148), GG_UINT64_C(2015283703367863641) },
+  { GG_UINT64_C(17348979556414297411), GG_UINT64_C(1612226962694290912) },
+  { GG_UINT64_C(6500486015647617283), GG_UINT64_C(1289781570155432730) },
+  { GG_UINT64_C(10400777625036187652), GG_UINT64_C(2063650512248692368) },
+  { GG_UINT64_C(15699319729512770768), GG_UINT64_C(1650920409798953894) },
+  { GG_UINT64_C(16248804598352126938), GG_UINT64_C(1320736327839163115) },
+  { GG_UINT64_C(7551343283653851484), GG_UINT64_C(2113178124542660985) },
+  { GG_UINT64_C(6041074626923081187), GG_UINT64_C(1690542499634128788) },
+  { GG_UINT64_C(12211557331022285596), GG_UINT64_C(1352433999707303030) },
+  { GG_UINT64_C(1091747655926105338), GG_UINT64_C(2163894399531684849) },
+  { GG_UINT64_C(4562746939482794594), GG_UINT64_C(1731115519625347879) },
+  { GG_UINT64_C(7339546366328145998), GG_UINT64_C(1384892415700278303) },
+  { GG_UINT64_C(8053925371383123274), GG_UINT64_C(2215827865120445285) },
+  { GG_UINT64_C(6443140297106498619), GG_UINT64_C(1772662292096356228) },
+  { GG_UINT64_C(12533209867169019542), GG_UINT64_C(1418129833677084982) },
+  { GG_UINT64_C(5295740528502789974), GG_UINT64_C(2269007733883335972) },
+  { GG_UINT64_C(15304638867027962949), GG_UINT64_C(1815206187106668777) },
+  { GG_UINT64_C(4865013464138549713), GG_UINT64_C(1452164949685335022) },
+  { GG_UINT64_C(14960057215536570740), GG_UINT64_C(1161731959748268017) },
+  { GG_UINT64_C(9178696285890871890), GG_UINT64_C(1858771135597228828) },
+  { GG_UINT64_C(14721654658196518159), GG_UINT64_C(1487016908477783062) },
+  { GG_UINT64_C(4398626097073393881), GG_UINT64_C(1189613526782226450) },
+  { GG_UINT64_C(7037801755317430209), GG_UINT64_C(1903381642851562320) },
+  { GG_UINT64_C(5630241404253944167), GG_UINT64_C(1522705314281249856) },
+  { GG_UINT64_C(814844308661245011), GG_UINT64_C(1218164251424999885) },
+  { GG_UINT64_C(1303750893857992017), GG_UINT64_C(1949062802279999816) },
+  { GG_UINT64_C(15800395974054034906), GG_UINT64_C(1559250241823999852) },
+  { GG_UINT64_C(5261619149759407279), GG_UINT64_C(1247400193459199882) },
+  { GG_UINT64_C(12107939454356961969), GG_UINT64_C(1995840309534719811) },
+  { GG_UINT64_C(5997002748743659252), GG_UINT64_C(1596672247627775849) },
+  { GG_UINT64_C(8486951013736837725), GG_UINT64_C(1277337798102220679) },
+  { GG_UINT64_C(2511075177753209390), GG_UINT64_C(2043740476963553087) },
+  { GG_UINT64_C(13076906586428298482), GG_UINT64_C(1634992381570842469) },
+  { GG_UINT64_C(14150874083884549109), GG_UINT64_C(1307993905256673975) },
+  { GG_UINT64_C(4194654460505726958), GG_UINT64_C(2092790248410678361) },
+  { GG_UINT64_C(18113118827372222859), GG_UINT64_C(1674232198728542688) },
+  { GG_UINT64_C(3422448617672047318), GG_UINT64_C(1339385758982834151) },
+  { GG_UINT64_C(16543964232501006678), GG_UINT64_C(2143017214372534641) },
+  { GG_UINT64_C(9545822571258895019), GG_UINT64_C(1714413771498027713) },
+  { GG_UINT64_C(15015355686490936662), GG_UINT64_C(1371531017198422170) },
+  { GG_UINT64_C(5577825024675947042), GG_UINT64_C(2194449627517475473) },
+  { GG_UINT64_C(11840957649224578280), GG_UINT64_C(1755559702013980378) },
+  { GG_UINT64_C(16851463748863483271), GG_UINT64_C(1404447761611184302) },
+  { GG_UINT64_C(12204946739213931940), GG_UINT64_C(2247116418577894884) },
+  { GG_UINT64_C(13453306206113055875), GG_UINT64_C(1797693134862315907) },
+  { GG_UINT64_C(3383947335406624054), GG_UINT64_C(1438154507889852726) },
+  { GG_UINT64_C(16482362180876329456), GG_UINT64_C(2301047212623764361) },
+  { GG_UINT64_C(9496540929959153242), GG_UINT64_C(1840837770099011489) },
+  { GG_UINT64_C(11286581558709232917), GG_UINT64_C(1472670216079209191) },
+  { GG_UINT64_C(5339916432225476010), GG_UINT64_C(1178136172863367353) },
+  { GG_UINT64_C(4854517476818851293), GG_UINT64_C(1885017876581387765) },
+  { GG_UINT64_C(3883613981455081034), GG_UINT64_C(1508014301265110212) },
+  { GG_UINT64_C(14174937629389795797), GG_UINT64_C(1206411441012088169) },
+  { GG_UINT64_C(11611853762797942306), GG_UINT64_C(1930258305619341071) },
+  { GG_UINT64_C(5600134195496443521), GG_UINT64_C(1544206644495472857) },
+  { GG_UINT64_C(15548153800622885787), GG_UINT64_C(1235365315596378285) },
+  { GG_UINT64_C(6430302007287065643), GG_UINT64_C(1976584504954205257) },
+  { GG_UINT64_C(16212288050055383484), GG_UINT64_C(1581267603963364205) },
+  { GG_UINT64_C(12969830440044306787), GG_UINT64_C(1265014083170691364) },
+  { GG_UINT64_C(9683682259845159889), GG_UINT64_C(2024022533073106183) },
+  { GG_UINT64_C(15125643437359948558), GG_UINT64_C(1619218026458484946) },
+  { GG_UINT64_C(8411165935146048523), GG_UINT64_C(1295374421166787957) },
+  { GG_UINT64_C(17147214310975587960), GG_UINT64_C(2072599073866860731) },
+  { GG_UINT64_C(10028422634038560045), GG_UINT64_C(1658079259093488585) },
+  { GG_UINT64_C(8022738107230848036), GG_UINT64_C(1326463407274790868) },
+  { GG_UINT64_C(9147032156827446534), GG_UINT64_C(2122341451639665389) },
+  { GG_UINT64_C(11006974540203867551), GG_UINT64_C(1697873161311732311) },
+  { GG_UINT64_C(5116230817421183718), GG_UINT64_C(1358298529049385849) },
+  { GG_UINT64_C(15564666937357714594), GG_UINT64_C(2173277646479017358) },
+  { GG_UINT64_C(1383687105660440706), GG_UINT64_C(1738622117183213887) },
+  { GG_UINT64_C(12174996128754083534), GG_UINT64_C(1390897693746571109) },
+  { GG_UINT64_C(8411947361780802685), GG_UINT64_C(2225436309994513775) },
+  { GG_UINT64_C(6729557889424642148), GG_UINT64_C(1780349047995611020) },
+  { GG_UINT64_C(5383646311539713719), GG_UINT64_C(1424279238396488816) },
+  { GG_UINT64_C(1235136468979721303), GG_UINT64_C(2278846781434382106) },
+  { GG_UINT64_C(15745504434151418335), GG_UINT64_C(1823077425147505684) },
+  { GG_UINT64_C(16285752362063044992), GG_UINT64_C(1458461940118004547) },
+  { GG_UINT64_C(5649904260166615347), GG_UINT64_C(1166769552094403638) },
+  { GG_UINT64_C(5350498001524674232), GG_UINT64_C(1866831283351045821) },
+  { GG_UINT64_C(591049586477829062), GG_UINT64_C(1493465026680836657) },
+  { GG_UINT64_C(11540886113407994219), GG_UINT64_C(1194772021344669325) },
+  { GG_UINT64_C(18673707743239135), GG_UINT64_C(1911635234151470921) },
+  { GG_UINT64_C(14772334225162232601), GG_UINT64_C(1529308187321176736) },
+  { GG_UINT64_C(8128518565387875758), GG_UINT64_C(1223446549856941389) },
+  { GG_UINT64_C(1937583260394870242), GG_UINT64_C(1957514479771106223) },
+  { GG_UINT64_C(8928764237799716840), GG_UINT64_C(1566011583816884978) },
+  { GG_UINT64_C(14521709019723594119), GG_UINT64_C(1252809267053507982) },
+  { GG_UINT64_C(8477339172590109297), GG_UINT64_C(2004494827285612772) },
+  { GG_UINT64_C(17849917782297818407), GG_UINT64_C(1603595861828490217) },
+  { GG_UINT64_C(6901236596354434079), GG_UINT64_C(1282876689462792174) },
+  { GG_UINT64_C(18420676183650915173), GG_UINT64_C(2052602703140467478) },
+  { GG_UINT64_C(3668494502695001169), GG_UINT64_C(1642082162512373983) },
+  { GG_UINT64_C(10313493231639821582), GG_UINT64_C(1313665730009899186) },
+  { GG_UINT64_C(9122891541139893884), GG_UINT64_C(2101865168015838698) },
+  { GG_UINT64_C(14677010862395735754), GG_UINT64_C(1681492134412670958) },
+  { GG_UINT64_C(673562245690857633), GG_UINT64_C(1345193707530136767) },
+};
+
+const uint64 kPow5Split[kPow5TableSize][2] = {
+  { GG_UINT64_C(0), GG_UINT64_C(1152921504606846976) },
+  { GG_UINT64_C(0), GG_UINT64_C(1441151880758558720) },
+  { GG_UINT64_C(0), GG_UINT64_C(1801439850948198400) },
+  { GG_UINT64_C(0), GG_UINT64_C(2251799813685248000) },
+  { GG_UINT64_C(0), GG_UINT64_C(1407374883553280000) },
+  { GG_UINT64_C(0), GG_UINT64_C(1759218604441600000) },
+  { GG_UINT64_C(0), GG_UINT64_C(2199023255552000000) },
+  { GG_UINT64_C(0), GG_UINT64_C(1374389534720000000) },
+  { GG_UINT64_C(0), GG_UINT64_C(1717986918400000000) },
+  { GG_UINT64_C(0), GG_UINT64_C(2147483648000000000) },
+  { GG_UINT64_C(0), GG_UINT64_C(1342177280000000000) },
+  { GG_UINT64_C(0), GG_UINT64_C(1677721600000000000) },
+  { GG_UINT64_C(0), GG_UINT64_C(2097152000000000000) },
+  { GG_UINT64_C(0), GG_UINT64_C(1310720000000000000) },
+  { GG_UINT64_C(0), GG_UINT64_C(1638400000000000000) },
+  { GG_UINT64_C(0), GG_UINT64_C(2048000000000000000) },
+  { GG_UINT64_C(0), GG_UINT64_C(1280000000000000000) },
+  { GG_UINT64_C(0), GG_UINT64_C(1600000000000000000) },
+  { GG_UINT64_C(0), GG_UINT64_C(2000000000000000000) },
+  { GG_UINT64_C(0), GG_UINT64_C(1250000000000000000) },
+  { GG_UINT64_C(0), GG_UINT64_C(1562500000000000000) },
+  { GG_UINT64_C(0), GG_UINT64_C(1953125000000000000) },
+  { GG_UINT64_C(0), GG_UINT64_C(1220703125000000000) },
+  { GG_UINT64_C(0), GG_UINT64_C(1525878906250000000) },
+  { GG_UINT64_C(0), GG_UINT64_C(1907348632812500000) },
+  { GG_UINT64_C(0), GG_UINT64_C(1192092895507812500) },
+  { GG_UINT64_C(0), GG_UINT64_C(1490116119384765625) },
+  { GG_UINT64_C(4611686018427387904), GG_UINT64_C(1862645149230957031) },
+  { GG_UINT64_C(9799832789158199296), GG_UINT64_C(1164153218269348144) },
+  { GG_UINT64_C(12249790986447749120), GG_UINT64_C(1455191522836685180) },
+  { GG_UINT64_C(15312238733059686400), GG_UINT64_C(1818989403545856475) },
+  { GG_UINT64_C(14528612397897220096), GG_UINT64_C(2273736754432320594) },
+  { GG_UINT64_C(13692068767113150464), GG_UINT64_C(1421085471520200371) },
+  { GG_UINT64_C(12503399940464050176), GG_UINT64_C(1776356839400250464) },
+  { GG_UINT64_C(15629249925580062720), GG_UINT64_C(2220446049250313080) },
+  { GG_UINT64_C(9768281203487539200), GG_UINT64_C(1387778780781445675) },
+  { GG_UINT64_C(7598665485932036096), GG_UINT64_C(1734723475976807094) },
+  { GG_UINT64_C(274959820560269312), GG_UINT64_C(2168404344971008868) },
+  { GG_UINT64_C(9395221924704944128), GG_UINT64_C(1355252715606880542) },
+  { GG_UINT64_C(2520655369026404352), GG_UINT64_C(1694065894508600678) },
+  { GG_UINT64_C(12374191248137781248), GG_UINT64_C(2117582368135750847) },
+  { GG_UINT64_C(14651398557727195136), GG_UINT64_C(1323488980084844279) },
+  { GG_UINT64_C(13702562178731606016), GG_UINT64_C(1654361225106055349) },
+  { GG_UINT64_C(3293144668132343808), GG_UINT64_C(2067951531382569187) },
+  { GG_UINT64_C(18199116482078572544), GG_UINT64_C(1292469707114105741) },
+  { GG_UINT64_C(8913837547316051968), GG_UINT64_C(1615587133892632177) },
+  { GG_UINT64_C(15753982952572452864), GG_UINT64_C(2019483917365790221) },
+  { GG_UINT64_C(12152082354571476992), GG_UINT64_C(1262177448353618888) },
+  { GG_UINT64_C(15190102943214346240), GG_UINT64_C(1577721810442023610) },
+  { GG_UINT64_C(9764256642163156992), GG_UINT64_C(1972152263052529513) },
+  { GG_UINT64_C(17631875447420442880), GG_UINT64_C(1232595164407830945) },
+  { GG_UINT64_C(8204786253993389888), GG_UINT64_C(1540743955509788682) },
+  { GG_UINT64_C(1032610780636961552), GG_UINT64_C(1925929944387235853) },
+  { GG_UINT64_C(2951224747111794922), GG_UINT64_C(1203706215242022408) },
+  { GG_UINT64_C(3689030933889743652), GG_UINT64_C(1504632769052528010) },
+  { GG_UINT64_C(13834660704216955373), GG_UINT64_C(1880790961315660012) },
+  { GG_UINT64_C(17870034976990372916), GG_UINT64_C(1175494350822287507) },
+  { GG_UINT64_C(17725857702810578241), GG_UINT64_C(1469367938527859384) },
+  { GG_UINT64_C(3710578054803671186), GG_UINT64_C(1836709923159824231) },
+  { GG_UINT64_C(26536550077201078), GG_UINT64_C(2295887403949780289) },
+  { GG_UINT64_C(11545800389866720434), GG_UINT64_C(1434929627468612680) },
+  { GG_UINT64_C(14432250487333400542), GG_UINT64_C(1793662034335765850) },
+  { GG_UINT64_C(8816941072311974870), GG_UINT64_C(2242077542919707313) },
+  { GG_UINT64_C(17039803216263454053), GG_UINT64_C(1401298464324817070) },
+  { GG_UINT64_C(12076381983474541759), GG_UINT64_C(1751623080406021338) },
+  { GG_UINT64_C(5872105442488401391), GG_UINT64_C(2189528850507526673) },
+  { GG_UINT64_C(15199280947623720629), GG_UINT64_C(1368455531567204170) },
+  { GG_UINT64_C(9775729147674874978), GG_UINT64_C(1710569414459005213) },
+  { GG_UINT64_C(16831347453020981627), GG_UINT64_C(2138211768073756516) },
+  { GG_UINT64_C(1296220121283337709), GG_UINT64_C(1336382355046097823) },
+  { GG_UINT64_C(15455333206886335848), GG_UINT64_C(1670477943807622278) },
+  { GG_UINT64_C(10095794471753144002), GG_UINT64_C(2088097429759527848) },
+  { GG_UINT64_C(6309871544845715001), GG_UINT64_C(1305060893599704905) },
+  { GG_UINT64_C(12499025449484531656), GG_UINT64_C(1631326116999631131) },
+  { GG_UINT64_C(11012095793428276666), GG_UINT64_C(2039157646249538914) },
+  { GG_UINT64_C(11494245889320060820), GG_UINT64_C(1274473528905961821) },
+  { GG_UINT64_C(532749306367912313), GG_UINT64_C(1593091911132452277) },
+  { GG_UINT64_C(5277622651387278295), GG_UINT64_C(1991364888915565346) },
+  { GG_UINT64_C(7910200175544436838), GG_UINT64_C(1244603055572228341) },
+  { GG_UINT64_C(14499436237857933952), GG_UINT64_C(1555753819465285426) },
+  { GG_UINT64_C(8900923260467641632), GG_UINT64_C(1944692274331606783) },
+  { GG_UINT64_C(12480606065433357876), GG_UINT64_C(1215432671457254239) },
+  { GG_UINT64_C(10989071563364309441), GG_UINT64_C(1519290839321567799) },
+  { GG_UINT64_C(9124653435777998898), GG_UINT64_C(1899113549151959749) },
+  { GG_UINT64_C(8008751406574943263), GG_UINT64_C(1186945968219974843) },
+  { GG_UINT64_C(5399253239791291175), GG_UINT64_C(1483682460274968554) },
+  { GG_UINT64_C(15972438586593889776), GG_UINT64_C(1854603075343710692) },
+  { GG_UINT64_C(759402079766405302), GG_UINT64_C(1159126922089819183) },
+  { GG_UINT64_C(14784310654990170340), GG_UINT64_C(1448908652612273978) },
+  { GG_UINT64_C(9257016281882937117), GG_UINT64_C(1811135815765342473) },
+  { GG_UINT64_C(16182956370781059300), GG_UINT64_C(2263919769706678091) },
+  { GG_UINT64_C(7808504722524468110), GG_UINT64_C(1414949856066673807) },
+  { GG_UINT64_C(5148944884728197234), GG_UINT64_C(1768687320083342259) },
+  { GG_UINT64_C(1824495087482858639), GG_UINT64_C(2210859150104177824) },
+  { GG_UINT64_C(1140309429676786649), GG_UINT64_C(1381786968815111140) },
+  { GG_UINT64_C(1425386787095983311), GG_UINT64_C(1727233711018888925) },
+  { GG_UINT64_C(6393419502297367043), GG_UINT64_C(2159042138773611156) },
+  { GG_UINT64_C(13219259225790630210), GG_UINT64_C(1349401336733506972) },
+  { GG_UINT64_C(16524074032238287762), GG_UINT64_C(1686751670916883715) },
+  { GG_UINT64_C(16043406521870471799), GG_UINT64_C(2108439588646104644) },
+  { GG_UINT64_C(803757039314269066), GG_UINT64_C(1317774742903815403) },
+  { GG_UINT64_C(14839754354425000045), GG_UINT64_C(1647218428629769253) },
+  { GG_UINT64_C(4714634887749086344), GG_UINT64_C(2059023035787211567) },
+  { GG_UINT64_C(9864175832484260821), GG_UINT64_C(1286889397367007229) },
+  { GG_UINT64_C(16941905809032713930), GG_UINT64_C(1608611746708759036) },
+  { GG_UINT64_C(2730638187581340797), GG_UINT64_C(2010764683385948796) },
+  { GG_UINT64_C(10930020904093113806), GG_UINT64_C(1256727927116217997) },
+  { GG_UINT64_C(18274212148543780162), GG_UINT64_C(1570909908895272496) },
+  { GG_UINT64_C(4396021111970173586), GG_UINT64_C(1963637386119090621) },
+  { GG_UINT64_C(5053356204195052443), GG_UINT64_C(1227273366324431638) },
+  { GG_UINT64_C(15540067292098591362), GG_UINT64_C(1534091707905539547) },
+  { GG_UINT64_C(14813398096695851299), GG_UINT64_C(1917614634881924434) },
+  { GG_UINT64_C(13870059828862294966), GG_UINT64_C(1198509146801202771) },
+  { GG_UINT64_C(12725888767650480803), GG_UINT64_C(1498136433501503464) },
+  { GG_UINT64_C(15907360959563101004), GG_UINT64_C(1872670541876879330) },
+  { GG_UINT64_C(14553786618154326031), GG_UINT64_C(1170419088673049581) },
+  { GG_UINT64_C(4357175217410743827), GG_UINT64_C(1463023860841311977) },
+  { GG_UINT64_C(10058155040190817688), GG_UINT64_C(1828779826051639971) },
+  { GG_UINT64_C(7961007781811134206), GG_UINT64_C(2285974782564549964) },
+  { GG_UINT64_C(14199001900486734687), GG_UINT64_C(1428734239102843727) },
+  { GG_UINT64_C(13137066357181030455), GG_UINT64_C(1785917798878554659) },
+  { GG_UINT64_C(11809646928048900164), GG_UINT64_C(2232397248598193324) },
+  { GG_UINT64_C(16604401366885338411), GG_UINT64_C(1395248280373870827) },
+  { GG_UINT64_C(16143815690179285109), GG_UINT64_C(1744060350467338534) },
+  { GG_UINT64_C(10956397575869330579), GG_UINT64_C(2180075438084173168) },
+  { GG_UINT64_C(6847748484918331612), GG_UINT64_C(1362547148802608230) },
+  { GG_UINT64_C(17783057643002690323), GG_UINT64_C(1703183936003260287) },
+  { GG_UINT64_C(17617136035325974999), GG_UINT64_C(2128979920004075359) },
+  { GG_UINT64_C(17928239049719816230), GG_UINT64_C(1330612450002547099) },
+  { GG_UINT64_C(17798612793722382384), GG_UINT64_C(1663265562503183874) },
+  { GG_UINT64_C(13024893955298202172), GG_UINT64_C(2079081953128979843) },
+  { GG_UINT64_C(5834715712847682405), GG_UINT64_C(1299426220705612402) },
+  { GG_UINT64_C(16516766677914378815), GG_UINT64_C(1624282775882015502) },
+  { GG_UINT64_C(11422586310538197711), GG_UINT64_C(2030353469852519378) },
+  { GG_UINT64_C(11750802462513761473), GG_UINT64_C(1268970918657824611) },
+  { GG_UINT64_C(10076817059714813937), GG_UINT64_C(1586213648322280764) },
+  { GG_UINT64_C(12596021324643517422), GG_UINT64_C(1982767060402850955) },
+  { GG_UINT64_C(5566670318688504437), GG_UINT64_C(1239229412751781847) },
+  { GG_UINT64_C(2346651879933242642), GG_UINT64_C(1549036765939727309) },
+  { GG_UINT64_C(7545000868343941206), GG_UINT64_C(1936295957424659136) },
+  { GG_UINT64_C(4715625542714963254), GG_UINT64_C(1210184973390411960) },
+  { GG_UINT64_C(5894531928393704067), GG_UINT64_C(1512731216738014950) },
+  { GG_UINT64_C(16591536947346905892), GG_UINT64_C(1890914020922518687) },
+  { GG_UINT64_C(17287239619732898039), GG_UINT64_C(1181821263076574179) },
+  { GG_UINT64_C(16997363506238734644), GG_UINT64_C(1477276578845717724) },
+  { GG_UINT64_C(2799960309088866689), GG_UINT64_C(1846595723557147156) },
+  { GG_UINT64_C(10973347230035317489), GG_UINT64_C(1154122327223216972) },
+  { GG_UINT64_C(13716684037544146861), GG_UINT64_C(1442652909029021215) },
+  { GG_UINT64_C(12534169028502795672), GG_UINT64_C(1803316136286276519) },
+  { GG_UINT64_C(11056025267201106687), GG_UINT64_C(2254145170357845649) },
+  { GG_UINT64_C(18439230838069161439), GG_UINT64_C(1408840731473653530) },
+  { GG_UINT64_C(13825666510731675991), GG_UINT64_C(1761050914342066913) },
+  { GG_UINT64_C(3447025083132431277), GG_UINT64_C(2201313642927583642) },
+  { GG_UINT64_C(6766076695385157452), GG_UINT64_C(1375821026829739776) },
+  { GG_UINT64_C(8457595869231446815), GG_UINT64_C(1719776283537174720) },
+  { GG_UINT64_C(10571994836539308519), GG_UINT64_C(2149720354421468400) },
+  { GG_UINT64_C(6607496772837067824), GG_UINT64_C(1343575221513417750) },
+  { GG_UINT64_C(17482743002901110588), GG_UINT64_C(1679469026891772187) },
+  { GG_UINT64_C(17241742735199000331), GG_UINT64_C(2099336283614715234) },
+  { GG_UINT64_C(15387775227926763111), GG_UINT64_C(1312085177259197021) },
+  { GG_UINT64_C(5399660979626290177), GG_UINT64_C(1640106471573996277) },
+  { GG_UINT64_C(11361262242960250625), GG_UINT64_C(2050133089467495346) },
+  { GG_UINT64_C(11712474920277544544), GG_UINT64_C(1281333180917184591) },
+  { GG_UINT64_C(10028907631919542777), GG_UINT64_C(1601666476146480739) },
+  { GG_UINT64_C(7924448521472040567), GG_UINT64_C(2002083095183100924) },
+  { GG_UINT64_C(14176152362774801162), GG_UINT64_C(1251301934489438077) },
+  { GG_UINT64_C(3885132398186337741), GG_UINT64_C(1564127418111797597) },
+  { GG_UINT64_C(9468101516160310080), GG_UINT64_C(1955159272639746996) },
+  { GG_UINT64_C(15140935484454969608), GG_UINT64_C(1221974545399841872) },
+  { GG_UINT64_C(479425281859160394), GG_UINT64_C(1527468181749802341) },
+  { GG_UINT64_C(5210967620751338397), GG_UINT64_C(1909335227187252926) },
+  { GG_UINT64_C(17091912818251750210), GG_UINT64_C(1193334516992033078) },
+  { GG_UINT64_C(12141518985959911954), GG_UINT64_C(1491668146240041348) },
+  { GG_UINT64_C(15176898732449889943), GG_UINT64_C(1864585182800051685) },
+  { GG_UINT64_C(11791404716994875166), GG_UINT64_C(1165365739250032303) },
+  { GG_UINT64_C(10127569877816206054), GG_UINT64_C(1456707174062540379) },
+  { GG_UINT64_C(8047776328842869663), GG_UINT64_C(1820883967578175474) },
+  { GG_UINT64_C(836348374198811271), GG_UINT64_C(2276104959472719343) },
+  { GG_UINT64_C(7440246761515338900), GG_UINT64_C(1422565599670449589) },
+  { GG_UINT64_C(13911994470321561530), GG_UINT64_C(1778206999588061986) },
+  { GG_UINT64_C(8166621051047176104), GG_UINT64_C(2222758749485077483) },
+  { GG_UINT64_C(2798295147690791113), GG_UINT64_C(1389224218428173427) },
+  { GG_UINT64_C(17332926989895652603), GG_UINT64_C(1736530273035216783) },
+  { GG_UINT64_C(17054472718942177850), GG_UINT64_C(2170662841294020979) },
+  { GG_UINT64_C(8353202440125167204), GG_UINT64_C(1356664275808763112) },
+  { GG_UINT64_C(10441503050156459005), GG_UINT64_C(1695830344760953890) },
+  { GG_UINT64_C(3828506775840797949), GG_UINT64_C(2119787930951192363) },
+  { GG_UINT64_C(86973725686804766), GG_UINT64_C(1324867456844495227) },
+  { GG_UINT64_C(13943775212390669669), GG_UINT64_C(1656084321055619033) },
+  { GG_UINT64_C(3594660960206173375), GG_UINT64_C(2070105401319523792) },
+  { GG_UINT64_C(2246663100128858359), GG_UINT64_C(1293815875824702370) },
+  { GG_UINT64_C(12031700912015848757), GG_UINT64_C(1617269844780877962) },
+  { GG_UINT64_C(5816254103165035138), GG_UINT64_C(2021587305976097453) },
+  { GG_UINT64_C(5941001823691840913), GG_UINT64_C(1263492066235060908) },
+  { GG_UINT64_C(7426252279614801142), GG_UINT64_C(1579365082793826135) },
+  { GG_UINT64_C(4671129331091113523), GG_UINT64_C(1974206353492282669) },
+  { GG_UINT64_C(5225298841145639904), GG_UINT64_C(1233878970932676668) },
+  { GG_UINT64_C(6531623551432049880), GG_UINT64_C(1542348713665845835) },
+  { GG_UINT64_C(3552843420862674446), GG_UINT64_C(1927935892082307294) },
+  { GG_UINT64_C(16055585193321335241), GG_UINT64_C(1204959932551442058) },
+  { GG_UINT64_C(10846109454796893243), GG_UINT64_C(1506199915689302573) },
+  { GG_UINT64_C(18169322836923504458), GG_UINT64_C(1882749894611628216) },
+  { GG_UINT64_C(11355826773077190286), GG_UINT64_C(1176718684132267635) },
+  { GG_UINT64_C(9583097447919099954), GG_UINT64_C(1470898355165334544) },
+  { GG_UINT64_C(11978871809898874942), GG_UINT64_C(1838622943956668180) },
+  { GG_UINT64_C(14973589762373593678), GG_UINT64_C(2298278679945835225) },
+  { GG_UINT64_C(2440964573842414192), GG_UINT64_C(1436424174966147016) },
+  { GG_UINT64_C(3051205717303017741), GG_UINT64_C(1795530218707683770) },
+  { GG_UINT64_C(13037379183483547984), GG_UINT64_C(2244412773384604712) },
+  { GG_UINT64_C(8148361989677217490), GG_UINT64_C(1402757983365377945) },
+  { GG_UINT64_C(14797138505523909766), GG_UINT64_C(1753447479206722431) },
+  { GG_UINT64_C(13884737113477499304), GG_UINT64_C(2191809349008403039) },
+  { GG_UINT64_C(15595489723564518921), GG_UINT64_C(1369880843130251899) },
+  { GG_UINT64_C(14882676136028260747), GG_UINT64_C(1712351053912814874) },
+  { GG_UINT64_C(9379973133180550126), GG_UINT64_C(2140438817391018593) },
+  { GG_UINT64_C(17391698254306313589), GG_UINT64_C(1337774260869386620) },
+  { GG_UINT64_C(3292878744173340370), GG_UINT64_C(1672217826086733276) },
+  { GG_UINT64_C(4116098430216675462), GG_UINT64_C(2090272282608416595) },
+  { GG_UINT64_C(266718509671728212), GG_UINT64_C(1306420176630260372) },
+  { GG_UINT64_C(333398137089660265), GG_UINT64_C(1633025220787825465) },
+  { GG_UINT64_C(5028433689789463235), GG_UINT64_C(2041281525984781831) },
+  { GG_UINT64_C(10060300083759496378), GG_UINT64_C(1275800953740488644) },
+  { GG_UINT64_C(12575375104699370472), GG_UINT64_C(1594751192175610805) },
+  { GG_UINT64_C(1884160825592049379), GG_UINT64_C(1993438990219513507) },
+  { GG_UINT64_C(17318501580490888525), GG_UINT64_C(1245899368887195941) },
+  { GG_UINT64_C(7813068920331446945), GG_UINT64_C(1557374211108994927) },
+  { GG_UINT64_C(5154650131986920777), GG_UINT64_C(1946717763886243659) },
+  { GG_UINT64_C(915813323278131534), GG_UINT64_C(1216698602428902287) },
+  { GG_UINT64_C(14979824709379828129), GG_UINT64_C(1520873253036127858) },
+  { GG_UINT64_C(9501408849870009354), GG_UINT64_C(1901091566295159823) },
+  { GG_UINT64_C(12855909558809837702), GG_UINT64_C(1188182228934474889) },
+  { GG_UINT64_C(2234828893230133415), GG_UINT64_C(1485227786168093612) },
+  { GG_UINT64_C(2793536116537666769), GG_UINT64_C(1856534732710117015) },
+  { GG_UINT64_C(8663489100477123587), GG_UINT64_C(1160334207943823134) },
+  { GG_UINT64_C(1605989338741628675), GG_UINT64_C(1450417759929778918) },
+  { GG_UINT64_C(11230858710281811652), GG_UINT64_C(1813022199912223647) },
+  { GG_UINT64_C(9426887369424876662), GG_UINT64_C(2266277749890279559) },
+  { GG_UINT64_C(12809333633531629769), GG_UINT64_C(1416423593681424724) },
+  { GG_UINT64_C(16011667041914537212), GG_UINT64_C(1770529492101780905) },
+  { GG_UINT64_C(6179525747111007803), GG_UINT64_C(2213161865127226132) },
+  { GG_UINT64_C(13085575628799155685), GG_UINT64_C(1383226165704516332) },
+  { GG_UINT64_C(16356969535998944606), GG_UINT64_C(1729032707130645415) },
+  { GG_UINT64_C(15834525901571292854), GG_UINT64_C(2161290883913306769) },
+  { GG_UINT64_C(2979049660840976177), GG_UINT64_C(1350806802445816731) },
+  { GG_UINT64_C(17558870131333383934), GG_UINT64_C(1688508503057270913) },
+  { GG_UINT64_C(8113529608884566205), GG_UINT64_C(2110635628821588642) },
+  { GG_UINT64_C(9682642023980241782), GG_UINT64_C(1319147268013492901) },
+  { GG_UINT64_C(16714988548402690132), GG_UINT64_C(1648934085016866126) },
+  { GG_UINT64_C(11670363648648586857), GG_UINT64_C(2061167606271082658) },
+  { GG_UINT64_C(11905663298832754689), GG_UINT64_C(1288229753919426661) },
+  { GG_UINT64_C(1047021068258779650), GG_UINT64_C(1610287192399283327) },
+  { GG_UINT64_C(15143834390605638274), GG_UINT64_C(2012858990499104158) },
+  { GG_UINT64_C(4853210475701136017), GG_UINT64_C(1258036869061940099) },
+  { GG_UINT64_C(1454827076199032118), GG_UINT64_C(1572546086327425124) },
+  { GG_UINT64_C(1818533845248790147), GG_UINT64_C(1965682607909281405) },
+  { GG_UINT64_C(3442426662494187794), GG_UINT64_C(1228551629943300878) },
+  { GG_UINT64_C(13526405364972510550), GG_UINT64_C(1535689537429126097) },
+  { GG_UINT64_C(3072948650933474476), GG_UINT64_C(1919611921786407622) },
+  { GG_UINT64_C(15755650962115585259), GG_UINT64_C(1199757451116504763) },
+  { GG_UINT64_C(15082877684217093670), GG_UINT64_C(1499696813895630954) },
+  { GG_UINT64_C(9630225068416591280), GG_UINT64_C(1874621017369538693) },
+  { GG_UINT64_C(8324733676974063502), GG_UINT64_C(1171638135855961683) },
+  { GG_UINT64_C(5794231077790191473), GG_UINT64_C(1464547669819952104) },
+  { GG_UINT64_C(7242788847237739342), GG_UINT64_C(1830684587274940130) },
+  { GG_UINT64_C(18276858095901949986), GG_UINT64_C(2288355734093675162) },
+  { GG_UINT64_C(16034722328366106645), GG_UINT64_C(1430222333808546976) },
+  { GG_UINT64_C(1596658836748081690), GG_UINT64_C(1787777917260683721) },
+  { GG_UINT64_C(6607509564362490017), GG_UINT64_C(2234722396575854651) },
+  { GG_UINT64_C(1823850468512862308), GG_UINT64_C(1396701497859909157) },
+  { GG_UINT64_C(6891499104068465790), GG_UINT64_C(1745876872324886446) },
+  { GG_UINT64_C(17837745916940358045), GG_UINT64_C(2182346090406108057) },
+  { GG_UINT64_C(4231062170446641922), GG_UINT64_C(1363966306503817536) },
+  { GG_UINT64_C(5288827713058302403), GG_UINT64_C(1704957883129771920) },
+  { GG_UINT64_C(6611034641322878003), GG_UINT64_C(2131197353912214900) },
+  { GG_UINT64_C(13355268687681574560), GG_UINT64_C(1331998346195134312) },
+  { GG_UINT64_C(16694085859601968200), GG_UINT64_C(1664997932743917890) },
+  { GG_UINT64_C(11644235287647684442), GG_UINT64_C(2081247415929897363) },
+  { GG_UINT64_C(4971804045566108824), GG_UINT64_C(1300779634956185852) },
+  { GG_UINT64_C(6214755056957636030), GG_UINT64_C(1625974543695232315) },
+  { GG_UINT64_C(3156757802769657134), GG_UINT64_C(2032468179619040394) },
+  { GG_UINT64_C(6584659645158423613), GG_UINT64_C(1270292612261900246) },
+  { GG_UINT64_C(17454196593302805324), GG_UINT64_C(1587865765327375307) },
+  { GG_UINT64_C(17206059723201118751), GG_UINT64_C(1984832206659219134) },
+  { GG_UINT64_C(6142101308573311315), GG_UINT64_C(1240520129162011959) },
+  { GG_UINT64_C(3065940617289251240), GG_UINT64_C(1550650161452514949) },
+  { GG_UINT64_C(8444111790038951954), GG_UINT64_C(1938312701815643686) },
+  { GG_UINT64_C(665883850346957067), GG_UINT64_C(1211445438634777304) },
+  { GG_UINT64_C(832354812933696334), GG_UINT64_C(1514306798293471630) },
+  { GG_UINT64_C(10263815553021896226), GG_UINT64_C(1892883497866839537) },
+  { GG_UINT64_C(17944099766707154901), GG_UINT64_C(1183052186166774710) },
+  { GG_UINT64_C(13206752671529167818), GG_UINT64_C(1478815232708468388) },
+  { GG_UINT64_C(16508440839411459773), GG_UINT64_C(1848519040885585485) },
+  { GG_UINT64_C(12623618533845856310), GG_UINT64_C(1155324400553490928) },
+  { GG_UINT64_C(15779523167307320387), GG_UINT64_C(1444155500691863660) },
+  { GG_UINT64_C(1277659885424598868), GG_UINT64_C(1805194375864829576) },
+  { GG_UINT64_C(1597074856780748586), GG_UINT64_C(2256492969831036970) },
+  { GG_UINT64_C(5609857803915355770), GG_UINT64_C(1410308106144398106) },
+  { GG_UINT64_C(16235694291748970521), GG_UINT64_C(1762885132680497632) },
+  { GG_UINT64_C(1847873790976661535), GG_UINT64_C(2203606415850622041) },
+  { GG_UINT64_C(12684136165428883219), GG_UINT64_C(1377254009906638775) },
+  { GG_UINT64_C(11243484188358716120), GG_UINT64_C(1721567512383298469) },
+  { GG_UINT64_C(219297180166231438), GG_UINT64_C(2151959390479123087) },
+  { GG_UINT64_C(7054589765244976505), GG_UINT64_C(1344974619049451929) },
+  { GG_UINT64_C(13429923224983608535), GG_UINT64_C(1681218273811814911) },
+  { GG_UINT64_C(12175718012802122765), GG_UINT64_C(2101522842264768639) },
+  { GG_UINT64_C(14527352785642408584), GG_UINT64_C(1313451776415480399) },
+  { GG_UINT64_C(13547504963625622826), GG_UINT64_C(1641814720519350499) },
+  { GG_UINT64_C(12322695186104640628), GG_UINT64_C(2052268400649188124) },
+  { GG_UINT64_C(16925056528170176201), GG_UINT64_C(1282667750405742577) },
+  { GG_UINT64_C(7321262604930556539), GG_UINT64_C(1603334688007178222) },
+  { GG_UINT64_C(18374950293017971482), GG_UINT64_C(2004168360008972777) },
+  { GG_UINT64_C(4566814905495150320), GG_UINT64_C(1252605225005607986) },
+  { GG_UINT64_C(14931890668723713708), GG_UINT64_C(1565756531257009982) },
+  { GG_UINT64_C(9441491299049866327), GG_UINT64_C(1957195664071262478) },
+  { GG_UINT64_C(1289246043478778550), GG_UINT64_C(1223247290044539049) },
+  { GG_UINT64_C(6223243572775861092), GG_UINT64_C(1529059112555673811) },
+  { GG_UINT64_C(3167368447542438461), GG_UINT64_C(1911323890694592264) },
+  { GG_UINT64_C(1979605279714024038), GG_UINT64_C(1194577431684120165) },
+  { GG_UINT64_C(7086192618069917952), GG_UINT64_C(1493221789605150206) },
+  { GG_UINT64_C(18081112809442173248), GG_UINT64_C(1866527237006437757) },
+  { GG_UINT64_C(13606538515115052232), GG_UINT64_C(1166579523129023598) },
+  { GG_UINT64_C(7784801107039039482), GG_UINT64_C(1458224403911279498) },
+  { GG_UINT64_C(507629346944023544), GG_UINT64_C(1822780504889099373) },
+  { GG_UINT64_C(5246222702107417334), GG_UINT64_C(2278475631111374216) },
+  { GG_UINT64_C(3278889188817135834), GG_UINT64_C(1424047269444608885) },
+  { GG_UINT64_C(8710297504448807696), GG_UINT64_C(1780059086805761106) },
+};
+
+// Returns the number of bits of 5^e, i.e. ceil(log2(5^e)), or 1 for e == 0.
+// Exact for 0 <= e <= 3528.
+inline int Pow5Bits(int e) {
+  return static_cast<int>((static_cast<uint32>(e) * 1217359) >> 19) + 1;
+}
+
+// Returns floor(log2(5^e)), for 0 <= e <= 3528.
+inline int Log2Pow5(int e) {
+  return static_cast<int>((static_cast<uint32>(e) * 1217359) >> 19);
+}
+
+// Returns floor(log10(2^e)), for 0 <= e <= 1650.
+inline uint32 Log10Pow2(int e) {
+  return (static_cast<uint32>(e) * 78913) >> 18;
+}
+
+// Returns floor(log10(5^e)), for 0 <= e <= 2620.
+inline uint32 Log10Pow5(int e) {
+  return (static_cast<uint32>(e) * 732923) >> 20;
+}
+
+inline int FloorLog2(uint64 value) {
+  DCHECK_NE(0u, value);
+  int result = 63;
+  while (!(value >> result))
+    --result;
+  return result;
+}
+
+inline uint32 Pow5Factor(uint64 value) {
+  uint32 count = 0;
+  while (value % 5 == 0) {
+    value /= 5;
+    ++count;
+  }
+  return count;
+}
+
+inline bool MultipleOfPowerOf5(uint64 value, uint32 p) {
+  return Pow5Factor(value) >= p;
+}
+
+inline bool MultipleOfPowerOf2(uint64 value, uint32 p) {
+  DCHECK_LT(p, 64u);
+  return (value & ((GG_UINT64_C(1) << p) - 1)) == 0;
+}
+
+#if !defined(COMPILER_GCC) || !defined(ARCH_CPU_64_BITS)
+// Computes the 128-bit product of |a| and |b|.
+inline void Multiply(uint64 a, uint64 b, uint64* low, uint64* high) {
+#if defined(COMPILER_MSVC) && defined(ARCH_CPU_X86_64)
+  *low = _umul128(a, b, high);
+#else
+  uint64 a_low = a & 0xFFFFFFFF;
+  uint64 a_high = a >> 32;
+  uint64 b_low = b & 0xFFFFFFFF;
+  uint64 b_high = b >> 32;
+  uint64 low_low = a_low * b_low;
+  uint64 low_high = a_low * b_high;
+  uint64 high_low = a_high * b_low;
+  uint64 high_high = a_high * b_high;
+  uint64 middle = (low_low >> 32) + (high_low & 0xFFFFFFFF) +
+                  (low_high & 0xFFFFFFFF);
+  *low = (middle << 32) | (low_low & 0xFFFFFFFF);
+  *high = high_high + (high_low >> 32) + (low_high >> 32) + (middle >> 32);
+#endif
+}
+#endif
+
+// Returns floor(m * mul / 2^j), where |mul| is a 128-bit {low, high} pair
+// and 64 < j < 128.
+inline uint64 MulShift(uint64 m, const uint64* mul, int j) {
+  DCHECK_GT(j, 64);
+  DCHECK_LT(j, 128);
+#if defined(COMPILER_GCC) && defined(ARCH_CPU_64_BITS)
+  typedef unsigned __int128 uint128;
+  uint128 low = static_cast<uint128>(m) * mul[0];
+  uint128 high = static_cast<uint128>(m) * mul[1];
+  return static_cast<uint64>(((low >> 64) + high) >> (j - 64));
+#else
+  uint64 low_low, low_high, high_low, high_high;
+  Multiply(m, mul[0], &low_low, &low_high);
+  Multiply(m, mul[1], &high_low, &high_high);
+  uint64 sum_low = low_high + high_low;
+  uint64 sum_high = high_high + (sum_low < low_high ? 1 : 0);
+  int shift = j - 64;
+  return (sum_high << (64 - shift)) | (sum_low >> shift);
+#endif
+}
+
+// The shortest decimal representation of a double: |mantissa| * 10^exponent.
+struct Decimal {
+  uint64 mantissa;
+  int exponent;
+};
+
+// Computes the shortest decimal representation of the finite, non-zero
+// double with the given IEEE fields. This is d2d() from d2s.c.
+Decimal ToShortestDecimal(uint64 ieee_mantissa, uint32 ieee_exponent) {
+  int e2;
+  uint64 m2;
+  if (ieee_exponent == 0) {
+    // Subnormal. The -2 leaves room for the interval bounds below.
+    e2 = 1 - kExponentBias - kMantissaBits - 2;
+    m2 = ieee_mantissa;
+  } else {
+    e2 = static_cast<int>(ieee_exponent) - kExponentBias - kMantissaBits - 2;
+    m2 = (GG_UINT64_C(1) << kMantissaBits) | ieee_mantissa;
+  }
+  // Round to nearest even accepts the bounds of the interval if the
+  // mantissa is even.
+  const bool accept_bounds = (m2 & 1) == 0;
+
+  // The interval of decimals which read back as this double is
+  // [mm, mp] * 2^e2 (excluding the bounds for odd mantissas), where the
+  // lower bound is closer at the boundary between two exponents.
+  const uint64 mv = 4 * m2;
+  const uint32 mm_shift = ieee_mantissa != 0 || ieee_exponent <= 1;
+  const uint64 mp = mv + 2;
+  const uint64 mm = mv - 1 - mm_shift;
+
+  // Converts the interval to base 10: vr, vp and vm are mv, mp and mm
+  // times 2^e2 / 10^e10, rounded down.
+  uint64 vr, vp, vm;
+  int e10;
+  bool vm_is_trailing_zeros = false;
+  bool vr_is_trailing_zeros = false;
+  if (e2 >= 0) {
+    const uint32 q = Log10Pow2(e2) - (e2 > 3);
+    e10 = static_cast<int>(q);
+    const int k = kPow5InvBits + Pow5Bits(static_cast<int>(q)) - 1;
+    const int i = -e2 + static_cast<int>(q) + k;
+    vr = MulShift(mv, kPow5InvSplit[q], i);
+    vp = MulShift(mp, kPow5InvSplit[q], i);
+    vm = MulShift(mm, kPow5InvSplit[q], i);
+    if (q <= 21) {
+      // Only one of mp, mv and mm can be a multiple of 5, if any.
+      if (mv % 5 == 0) {
+        vr_is_trailing_zeros = MultipleOfPowerOf5(mv, q);
+      } else if (accept_bounds) {
+        vm_is_trailing_zeros = MultipleOfPowerOf5(mm, q);
+      } else {
+        vp -= MultipleOfPowerOf5(mp, q);
+      }
+    }
+  } else {
+    const uint32 q = Log10Pow5(-e2) - (-e2 > 1);
+    e10 = static_cast<int>(q) + e2;
+    const int i = -e2 - static_cast<int>(q);
+    const int k = Pow5Bits(i) - kPow5Bits;
+    const int j = static_cast<int>(q) - k;
+    vr = MulShift(mv, kPow5Split[i], j);
+    vp = MulShift(mp, kPow5Split[i], j);
+    vm = MulShift(mm, kPow5Split[i], j);
+    if (q <= 1) {
+      // mv = 4 * m2 always has at least two trailing zero bits, and mp one.
+      vr_is_trailing_zeros = true;
+      if (accept_bounds)
+        vm_is_trailing_zeros = mm_shift == 1;
+      else
+        --vp;
+    } else if (q < 63) {
+      vr_is_trailing_zeros = MultipleOfPowerOf2(mv, q);
+    }
+  }
+
+  // Removes as many digits as possible while staying in the interval.
+  int removed = 0;
+  uint32 last_removed_digit = 0;
+  uint64 output;
+  if (vm_is_trailing_zeros || vr_is_trailing_zeros) {
+    // Rare general case, where the removed digits may be exactly zero.
+    while (vp / 10 > vm / 10) {
+      vm_is_trailing_zeros &= vm % 10 == 0;
+      vr_is_trailing_zeros &= last_removed_digit == 0;
+      last_removed_digit = static_cast<uint32>(vr % 10);
+      vr /= 10;
+      vp /= 10;
+      vm /= 10;
+      ++removed;
+    }
+    if (vm_is_trailing_zeros) {
+      while (vm % 10 == 0) {
+        vr_is_trailing_zeros &= last_removed_digit == 0;
+        last_removed_digit = static_cast<uint32>(vr % 10);
+        vr /= 10;
+        vp /= 10;
+        vm /= 10;
+        ++removed;
+      }
+    }
+    // Rounds to even if the exact value ends in 5 followed by zeros.
+    if (vr_is_trailing_zeros && last_removed_digit == 5 && vr % 2 == 0)
+      last_removed_digit = 4;
+    // Takes vr + 1 if vr is outside the interval or rounding requires it.
+    output = vr + ((vr == vm && (!accept_bounds || !vm_is_trailing_zeros)) ||
+                   last_removed_digit >= 5);
+  } else {
+    bool round_up = false;
+    if (vp / 100 > vm / 100) {
+      // Two digits at a time, which is the common case.
+      round_up = vr % 100 >= 50;
+      vr /= 100;
+      vp /= 100;
+      vm /= 100;
+      removed += 2;
+    }
+    while (vp / 10 > vm / 10) {
+      round_up = vr % 10 >= 5;
+      vr /= 10;
+      vp /= 10;
+      vm /= 10;
+      ++removed;
+    }
+    output = vr + (vr == vm || round_up);
+  }
+
+  Decimal result;
+  result.mantissa = output;
+  result.exponent = e10 + removed;
+  return result;
+}
+
+// Appends |value| to |buffer| and returns the end of the output.
+char* CopyString(const char* value, char* buffer) {
+  size_t length = strlen(value);
+  memcpy(buffer, value, length);
+  return buffer + length;
+}
+
+}  // namespace
+
+size_t FormatDoubleShortest(double value, char* buffer) {
+  const uint64 bits = bit_cast<uint64>(value);
+  const bool sign = (bits >> (kMantissaBits + kExponentBits)) != 0;
+  const uint64 ieee_mantissa =
+      bits & ((GG_UINT64_C(1) << kMantissaBits) - 1);
+  const uint32 ieee_exponent = static_cast<uint32>(
+      (bits >> kMantissaBits) & ((1u << kExponentBits) - 1));
+
+  char* out = buffer;
+  if (sign)
+    *out++ = '-';
+
+  if (ieee_exponent == (1u << kExponentBits) - 1) {
+    out = CopyString(ieee_mantissa ? "NaN" : "Infinity", out);
+    *out = '\0';
+    return out - buffer;
+  }
+  if (ieee_exponent == 0 && ieee_mantissa == 0) {
+    *out++ = '0';
+    *out = '\0';
+    return out - buffer;
+  }
+
+  Decimal decimal = ToShortestDecimal(ieee_mantissa, ieee_exponent);
+
+  // At most 17 digits.
+  char digits[20];
+  int length = 0;
+  for (uint64 mantissa = decimal.mantissa; mantissa; mantissa /= 10)
+    digits[length++] = static_cast<char>('0' + mantissa % 10);
+  std::reverse(digits, digits + length);
+
+  // Formats the digits like g_fmt(): |point| is the position of the decimal
+  // point relative to the first digit.
+  int point = decimal.exponent + length;
+  if (point <= -4 || point > length + 5) {
+    *out++ = digits[0];
+    if (length > 1) {
+      *out++ = '.';
+      memcpy(out, digits + 1, length - 1);
+      out += length - 1;
+    }
+    *out++ = 'e';
+    int exponent = point - 1;
+    if (exponent < 0) {
+      *out++ = '-';
+      exponent = -exponent;
+    } else {
+      *out++ = '+';
+    }
+    // At least two digits, as with "%+.2d".
+    if (exponent >= 100)
+      *out++ = static_cast<char>('0' + exponent / 100);
+    *out++ = static_cast<char>('0' + exponent / 10 % 10);
+    *out++ = static_cast<char>('0' + exponent % 10);
+  } else if (point <= 0) {
+    *out++ = '.';
+    memset(out, '0', -point);
+    out += -point;
+    memcpy(out, digits, length);
+    out += length;
+  } else if (point < length) {
+    memcpy(out, digits, point);
+    out += point;
+    *out++ = '.';
+    memcpy(out, digits + point, length - point);
+    out += length - point;
+  } else {
+    memcpy(out, digits, length);
+    out += length;
+    memset(out, '0', point - length);
+    out += point - length;
+  }
+  *out = '\0';
+  return out - buffer;
+}
+
+bool ParseDoubleFast(const char* begin, const char* end, double* output) {
+  const char* p = begin;
+  bool negative = false;
+  if (p != end && (*p == '+' || *p == '-')) {
+    negative = *p == '-';
+    ++p;
+  }
+
+  // Reads the significant digits into |m10|, such that the value is
+  // m10 * 10^e10. Zeros are held back until a non-zero digit follows, so
+  // that trailing zeros only change the exponent.
+  uint64 m10 = 0;
+  int m10_digits = 0;
+  int pending_zeros = 0;
+  int e10 = 0;
+  bool has_digits = false;
+  bool seen_point = false;
+  for (; p != end; ++p) {
+    if (*p == '.') {
+      if (seen_point)
+        return false;
+      seen_point = true;
+      continue;
+    }
+    if (*p < '0' || *p > '9')
+      break;
+    has_digits = true;
+    if (seen_point)
+      --e10;
+    if (*p == '0') {
+      if (m10_digits)
+        ++pending_zeros;
+      continue;
+    }
+    if (m10_digits + pending_zeros + 1 > 17)
+      return false;
+    for (; pending_zeros; --pending_zeros) {
+      m10 *= 10;
+      ++m10_digits;
+    }
+    m10 = m10 * 10 + (*p - '0');
+    ++m10_digits;
+  }
+  if (!has_digits)
+    return false;
+  e10 += pending_zeros;
+
+  if (p != end) {
+    if (*p != 'e' && *p != 'E')
+      return false;
+    ++p;
+    bool negative_exponent = false;
+    if (p != end && (*p == '+' || *p == '-')) {
+      negative_exponent = *p == '-';
+      ++p;
+    }
+    if (p == end)
+      return false;
+    int exponent = 0;
+    for (; p != end; ++p) {
+      if (*p < '0' || *p > '9')
+        return false;
+      // Anything this large is out of range anyway.
+      if (exponent < 100000)
+        exponent = exponent * 10 + (*p - '0');
+    }
+    e10 += negative_exponent ? -exponent : exponent;
+  }
+
+  if (m10 == 0) {
+    *output = negative ? -0.0 : 0.0;
+    return true;
+  }
+  // Leaves values which certainly underflow or overflow to dmg_fp, which
+  // reports them with ERANGE.
+  if (m10_digits + e10 <= -324 || m10_digits + e10 >= 310)
+    return false;
+
+  // Computes the top bits of m10 * 10^e10 as m2 * 2^e2, and whether the
+  // computation was exact. This is s2d_n() from s2d.c.
+  int e2;
+  uint64 m2;
+  bool trailing_zeros;
+  if (e10 >= 0) {
+    e2 = FloorLog2(m10) + e10 + Log2Pow5(e10) - (kMantissaBits + 1);
+    const int j = e2 - e10 - Pow5Bits(e10) + kPow5Bits;
+    DCHECK_GE(j, 0);
+    m2 = MulShift(m10, kPow5Split[e10], j);
+    trailing_zeros =
+        e2 < e10 || (e2 - e10 < 64 && MultipleOfPowerOf2(m10, e2 - e10));
+  } else {
+    e2 = FloorLog2(m10) + e10 - Pow5Bits(-e10) - (kMantissaBits + 1);
+    const int j = e2 - e10 + Pow5Bits(-e10) - 1 + kPow5InvBits;
+    m2 = MulShift(m10, kPow5InvSplit[-e10], j);
+    trailing_zeros = MultipleOfPowerOf5(m10, -e10);
+  }
+
+  const int ieee_e2 = e2 + kExponentBias + FloorLog2(m2);
+  // Leaves subnormals and infinities to dmg_fp as well.
+  if (ieee_e2 <= 0 || ieee_e2 > 0x7FE)
+    return false;
+
+  // Shifts m2 to the mantissa width and rounds to nearest even.
+  const int shift = ieee_e2 - e2 - kExponentBias - kMantissaBits;
+  DCHECK_GT(shift, 0);
+  trailing_zeros &= (m2 & ((GG_UINT64_C(1) << (shift - 1)) - 1)) == 0;
+  const uint64 last_removed_bit = (m2 >> (shift - 1)) & 1;
+  const bool round_up = last_removed_bit != 0 &&
+                        (!trailing_zeros || ((m2 >> shift) & 1) != 0);
+  uint64 ieee_m2 = (m2 >> shift) + round_up;
+  uint64 ieee_exponent = static_cast<uint64>(ieee_e2);
+  if (ieee_m2 == (GG_UINT64_C(1) << (kMantissaBits + 1))) {
+    // Rounding carried into the next exponent.
+    ++ieee_exponent;
+    if (ieee_exponent > 0x7FE)
+      return false;
+  }
+  ieee_m2 &= (GG_UINT64_C(1) << kMantissaBits) - 1;
+
+  const uint64 bits =
+      (static_cast<uint64>(negative) << (kMantissaBits + kExponentBits)) |
+      (ieee_exponent << kMantissaBits) | ieee_m2;
+  *output = bit_cast<double>(bits);
+  return true;
+}
+
+}  // namespace base
@@ -0,0 +1,47 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+//
+// Conversions between doubles and their shortest decimal representation,
+// using the Ryu algorithm (Ulf Adams, "Ryu: Fast Float-to-String Conversion",
+// PLDI 2018). Unlike dmg_fp, these use fixed-size integer arithmetic only:
+// they neither allocate nor take a lock, and are several times faster.
+//
+// DoubleToString() and StringToDouble() in string_number_conversions.h use
+// these, and fall back to dmg_fp for the inputs ParseDoubleFast() does not
+// handle. Most callers should use those instead.
+
+#ifndef BASE_STRINGS_DOUBLE_CONVERSIONS_H_
+#define BASE_STRINGS_DOUBLE_CONVERSIONS_H_
+
+#include <stddef.h>
+
+#include "base/base_export.h"
+
+namespace base {
+
+// Size of a buffer large enough for the output of FormatDoubleShortest(),
+// including the terminating NUL.
+const size_t kFormatDoubleBufferSize = 32;
+
+// Writes the shortest decimal representation of |value| that converts back
+// to the same double into |buffer|, NUL-terminated, and returns its length.
+// If several are equally short, the one closest to |value| is chosen. The
+// output is exactly that of dmg_fp::g_fmt(), e.g. "0.1", "1e+21", "-0",
+// "Infinity" or "NaN".
+BASE_EXPORT size_t FormatDoubleShortest(double value, char* buffer);
+
+// Parses [|begin|, |end|) if it is a decimal number of the form
+// [+-]digits[.digits][(e|E)[+-]digits], with at least one digit before or
+// after the point and at most 17 significant digits, whose value rounds to
+// zero or to a normal double. Stores the correctly rounded result in
+// |output| and returns true. Returns false, leaving |output| unchanged, for
+// anything else, including valid numbers which need more digits or which
+// overflow, underflow or are subnormal; dmg_fp::strtod() handles those.
+BASE_EXPORT bool ParseDoubleFast(const char* begin,
+                                 const char* end,
+                                 double* output);
+
+}  // namespace base
+
+#endif  // BASE_STRINGS_DOUBLE_CONVERSIONS_H_
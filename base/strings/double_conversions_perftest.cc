@@ -0,0 +1,100 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <string.h>
+
+#include <string>
+#include <vector>
+
+#include "base/basictypes.h"
+#include "base/strings/double_conversions.h"
+#include "base/third_party/dmg_fp/dmg_fp.h"
+#include "base/time/time.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "testing/perf/perf_test.h"
+
+namespace base {
+
+namespace {
+
+const int kNumValues = 1000000;
+
+// Returns a mix of the doubles found in number-heavy JSON: small integers,
+// values with a few decimals, and arbitrary doubles.
+std::vector<double> BuildValues() {
+  std::vector<double> values;
+  values.reserve(kNumValues);
+  uint64 state = GG_UINT64_C(0x2545F4914F6CDD1D);
+  for (int i = 0; i < kNumValues; ++i) {
+    state = state * GG_UINT64_C(6364136223846793005) +
+            GG_UINT64_C(1442695040888963407);
+    uint32 random = static_cast<uint32>(state >> 32);
+    switch (i % 3) {
+      case 0:
+        values.push_back(random % 100000);
+        break;
+      case 1:
+        values.push_back((random % 1000000) / 1000.0);
+        break;
+      default:
+        values.push_back(random * 1e-3 / (1 + (state & 0xFFFF)));
+        break;
+    }
+  }
+  return values;
+}
+
+void PrintRate(const std::string& trace, TimeDelta elapsed) {
+  perf_test::PrintResult("double_conversions", "", trace,
+                         kNumValues / elapsed.InSecondsF() / 1e6,
+                         "Mvalues/s", true);
+}
+
+}  // namespace
+
+TEST(DoubleConversionsPerfTest, Format) {
+  std::vector<double> values = BuildValues();
+  char buffer[kFormatDoubleBufferSize];
+  size_t total = 0;
+
+  TimeTicks start = TimeTicks::HighResNow();
+  for (size_t i = 0; i < values.size(); ++i)
+    total += strlen(dmg_fp::g_fmt(buffer, values[i]));
+  PrintRate("format_dmg_fp", TimeTicks::HighResNow() - start);
+
+  size_t shortest_total = 0;
+  start = TimeTicks::HighResNow();
+  for (size_t i = 0; i < values.size(); ++i)
+    shortest_total += FormatDoubleShortest(values[i], buffer);
+  PrintRate("format_shortest", TimeTicks::HighResNow() - start);
+  EXPECT_EQ(total, shortest_total);
+}
+
+TEST(DoubleConversionsPerfTest, Parse) {
+  std::vector<double> values = BuildValues();
+  std::vector<std::string> strings(values.size());
+  char buffer[kFormatDoubleBufferSize];
+  for (size_t i = 0; i < values.size(); ++i)
+    strings[i].assign(buffer, FormatDoubleShortest(values[i], buffer));
+
+  double sum = 0;
+  TimeTicks start = TimeTicks::HighResNow();
+  for (size_t i = 0; i < strings.size(); ++i)
+    sum += dmg_fp::strtod(strings[i].c_str(), NULL);
+  PrintRate("parse_dmg_fp", TimeTicks::HighResNow() - start);
+
+  double fast_sum = 0;
+  start = TimeTicks::HighResNow();
+  for (size_t i = 0; i < strings.size(); ++i) {
+    double value = 0;
+    EXPECT_TRUE(ParseDoubleFast(strings[i].data(),
+                                strings[i].data() + strings[i].size(),
+                                &value));
+    fast_sum += value;
+  }
+  PrintRate("parse_fast", TimeTicks::HighResNow() - start);
+  EXPECT_EQ(sum, fast_sum);
+}
+
+}  // namespace base
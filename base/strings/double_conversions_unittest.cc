@@ -0,0 +1,226 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/strings/double_conversions.h"
+
+#include <math.h>
+#include <string.h>
+
+#include <limits>
+#include <string>
+
+#include "base/basictypes.h"
+#include "base/strings/string_number_conversions.h"
+#include "base/strings/stringprintf.h"
+#include "base/third_party/dmg_fp/dmg_fp.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace base {
+
+namespace {
+
+// A fixed pseudo-random sequence, so that failures are reproducible.
+class Random {
+ public:
+  Random() : state_(GG_UINT64_C(0x2545F4914F6CDD1D)) {}
+
+  uint64 Next() {
+    state_ ^= state_ >> 12;
+    state_ ^= state_ << 25;
+    state_ ^= state_ >> 27;
+    return state_ * GG_UINT64_C(2685821657736338717);
+  }
+
+ private:
+  uint64 state_;
+};
+
+std::string Format(double value) {
+  char buffer[kFormatDoubleBufferSize];
+  size_t length = FormatDoubleShortest(value, buffer);
+  EXPECT_EQ(strlen(buffer), length);
+  EXPECT_GT(kFormatDoubleBufferSize, length);
+  return std::string(buffer, length);
+}
+
+std::string FormatWithDmgFp(double value) {
+  char buffer[32];
+  return dmg_fp::g_fmt(buffer, value);
+}
+
+bool Parse(const std::string& input, double* output) {
+  return ParseDoubleFast(input.data(), input.data() + input.size(), output);
+}
+
+// Formats |bits| with both formatters, and reads the output back with
+// ParseDoubleFast(), which must handle every normal double's output.
+void CheckRoundTrip(uint64 bits) {
+  double value = bit_cast<double>(bits);
+  std::string output = Format(value);
+  ASSERT_EQ(FormatWithDmgFp(value), output) << bits;
+  const uint64 kExponentMask = GG_UINT64_C(0x7FF) << 52;
+  if ((bits & kExponentMask) == kExponentMask)
+    return;
+
+  double parsed = 0;
+  bool is_subnormal =
+      value != 0 && fabs(value) < std::numeric_limits<double>::min();
+  ASSERT_EQ(!is_subnormal, Parse(output, &parsed)) << output;
+  if (!is_subnormal)
+    ASSERT_EQ(bits, bit_cast<uint64>(parsed)) << output;
+}
+
+// Parses |input| with ParseDoubleFast(), and if it is handled compares the
+// result with dmg_fp::strtod().
+void CheckParse(const std::string& input) {
+  double parsed = 0;
+  if (!Parse(input, &parsed))
+    return;
+  char* end = NULL;
+  double expected = dmg_fp::strtod(input.c_str(), &end);
+  ASSERT_EQ(bit_cast<uint64>(expected), bit_cast<uint64>(parsed)) << input;
+}
+
+}  // namespace
+
+TEST(DoubleConversionsTest, Format) {
+  static const struct {
+    double input;
+    const char* expected;
+  } cases[] = {
+    {0.0, "0"},
+    {-0.0, "-0"},
+    {1.0, "1"},
+    {-1.5, "-1.5"},
+    {0.1, ".1"},
+    {-0.3, "-.3"},
+    {1e-4, ".0001"},
+    {1e-5, "1e-05"},
+    {123456.0, "123456"},
+    {1e21, "1e+21"},
+    {1.5e300, "1.5e+300"},
+    {2.2250738585072014e-308, "2.2250738585072014e-308"},
+    {4.9406564584124654e-324, "5e-324"},
+    {1.7976931348623157e308, "1.7976931348623157e+308"},
+    {9007199254740993.0, "9007199254740992"},
+    {std::numeric_limits<double>::infinity(), "Infinity"},
+    {-std::numeric_limits<double>::infinity(), "-Infinity"},
+    {std::numeric_limits<double>::quiet_NaN(), "NaN"},
+  };
+  for (size_t i = 0; i < arraysize(cases); ++i) {
+    EXPECT_EQ(cases[i].expected, Format(cases[i].input));
+    EXPECT_EQ(FormatWithDmgFp(cases[i].input), Format(cases[i].input));
+  }
+}
+
+// Checks every exponent, with the boundary mantissas and random ones, then
+// random bit patterns. Each value is formatted, compared with g_fmt(), and
+// parsed back.
+TEST(DoubleConversionsTest, RoundTripAllExponents) {
+  const uint64 kMantissaMask = (GG_UINT64_C(1) << 52) - 1;
+  const uint64 kSignBit = GG_UINT64_C(1) << 63;
+  Random random;
+  for (uint64 exponent = 0; exponent < 0x7FF; ++exponent) {
+    const uint64 kMantissas[] = {
+      0, 1, 2, 3, kMantissaMask, kMantissaMask - 1, GG_UINT64_C(1) << 51,
+    };
+    for (size_t i = 0; i < arraysize(kMantissas); ++i) {
+      ASSERT_NO_FATAL_FAILURE(
+          CheckRoundTrip((exponent << 52) | kMantissas[i]));
+      ASSERT_NO_FATAL_FAILURE(
+          CheckRoundTrip(kSignBit | (exponent << 52) | kMantissas[i]));
+    }
+    for (int i = 0; i < 20; ++i) {
+      ASSERT_NO_FATAL_FAILURE(
+          CheckRoundTrip((exponent << 52) | (random.Next() & kMantissaMask)));
+    }
+  }
+
+  for (int i = 0; i < 100000; ++i)
+    ASSERT_NO_FATAL_FAILURE(CheckRoundTrip(random.Next()));
+}
+
+TEST(DoubleConversionsTest, ParseMatchesDmgFp) {
+  // Random mantissas of every length with random exponents.
+  Random random;
+  for (int i = 0; i < 100000; ++i) {
+    int digits = 1 + static_cast<int>(random.Next() % 17);
+    std::string input;
+    for (int j = 0; j < digits; ++j)
+      input.push_back(static_cast<char>('0' + random.Next() % 10));
+    int exponent = static_cast<int>(random.Next() % 660) - 345;
+    input += StringPrintf("e%d", exponent);
+    ASSERT_NO_FATAL_FAILURE(CheckParse(input));
+  }
+
+  // Exact halfway points between consecutive doubles above 2^53, which must
+  // round to even.
+  const uint64 kTwoTo53 = GG_UINT64_C(1) << 53;
+  for (uint64 i = kTwoTo53 - 100; i < kTwoTo53 + 10000; ++i) {
+    std::string input = Uint64ToString(i);
+    ASSERT_NO_FATAL_FAILURE(CheckParse(input));
+    ASSERT_NO_FATAL_FAILURE(CheckParse(input + "e-10"));
+    ASSERT_NO_FATAL_FAILURE(CheckParse(input + "e10"));
+  }
+
+  // Values near the ends of the normal range.
+  const char* const kInputs[] = {
+    "2.2250738585072014e-308",
+    "1.7976931348623157e308",
+    "1.7976931348623158e308",
+    "1e-307",
+    "1e308",
+    "1000000000000000000000000",
+    "0.000000000000000000000000000001",
+    "0000123.4500000",
+    "-0",
+    "+.5",
+    "7.",
+  };
+  for (size_t i = 0; i < arraysize(kInputs); ++i) {
+    double parsed = 0;
+    EXPECT_TRUE(Parse(kInputs[i], &parsed)) << kInputs[i];
+    ASSERT_NO_FATAL_FAILURE(CheckParse(kInputs[i]));
+  }
+}
+
+TEST(DoubleConversionsTest, ParseRejects) {
+  // Syntax ParseDoubleFast() does not handle, and numbers it leaves to
+  // dmg_fp::strtod().
+  const char* const kInputs[] = {
+    "",
+    "+",
+    "-",
+    ".",
+    "e5",
+    "1e",
+    "1e+",
+    "1.2.3",
+    " 1",
+    "1 ",
+    "1x",
+    "0x10",
+    "inf",
+    "nan",
+    "123456789012345678",
+    "1.23456789012345678",
+    "1e400",
+    "1e-400",
+    "4.9e-324",
+    "1e-310",
+    "2e308",
+  };
+  for (size_t i = 0; i < arraysize(kInputs); ++i) {
+    double parsed = 42;
+    EXPECT_FALSE(Parse(kInputs[i], &parsed)) << kInputs[i];
+    EXPECT_EQ(42, parsed);
+  }
+
+  // Embedded NUL.
+  const char kWithNul[] = "1\0" "2";
+  double parsed = 0;
+  EXPECT_FALSE(ParseDoubleFast(kWithNul, kWithNul + 3, &parsed));
+}
+
+}  // namespace base
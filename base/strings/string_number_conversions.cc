@@ -13,6 +13,7 @@
 
 #include "base/logging.h"
 #include "base/scoped_clear_errno.h"
+#include "base/strings/double_conversions.h"
 #include "base/strings/utf_string_conversions.h"
 #include "base/third_party/dmg_fp/dmg_fp.h"
 
@@ -412,10 +413,10 @@ string16 SizeTToString16(size_t value) {
 }
 
 std::string DoubleToString(double value) {
-  // According to g_fmt.cc, it is sufficient to declare a buffer of size 32.
-  char buffer[32];
-  dmg_fp::g_fmt(buffer, value);
-  return std::string(buffer);
+  // Same output as dmg_fp::g_fmt(), without its locks and allocations.
+  char buffer[kFormatDoubleBufferSize];
+  size_t length = FormatDoubleShortest(value, buffer);
+  return std::string(buffer, length);
 }
 
 bool StringToInt(const StringPiece& input, int* output) {
@@ -459,6 +460,10 @@ bool StringToSizeT(const StringPiece16& input, size_t* output) {
 }
 
 bool StringToDouble(const std::string& input, double* output) {
+  // Most numbers are short enough for the lock-free parser.
+  if (ParseDoubleFast(input.data(), input.data() + input.size(), output))
+    return true;
+
   // Thread-safe?  It is on at least Mac, Linux, and Windows.
   ScopedClearErrno clear_errno;
 
@@ -20,6 +20,14 @@ namespace base {
 
 namespace {
 
+// Compares the entries of a FlatValueMap with keys.
+struct FlatValueMapKeyLess {
+  bool operator()(const FlatValueMap::value_type& entry,
+                  const std::string& key) const {
+    return entry.first < key;
+  }
+};
+
 // Make a deep copy of |node|, but don't include empty lists or dictionaries
 // in the copy. It's possible for this function to return NULL and it
 // expects |node| to always be non-NULL.
@@ -334,6 +342,9 @@ bool BinaryValue::Equals(const Value* other) const {
 
 ///////////////////// DictionaryValue ////////////////////
 
+// static
+const size_t DictionaryValue::kMaxFlatSize = 32;
+
 DictionaryValue::DictionaryValue()
     : Value(TYPE_DICTIONARY) {
 }
@@ -356,19 +367,18 @@ bool DictionaryValue::GetAsDictionary(const DictionaryValue** out_value) const {
 
 bool DictionaryValue::HasKey(const std::string& key) const {
   DCHECK(IsStringUTF8(key));
-  ValueMap::const_iterator current_entry = dictionary_.find(key);
-  DCHECK((current_entry == dictionary_.end()) || current_entry->second);
-  return current_entry != dictionary_.end();
+  return FindWithoutPathExpansion(key) != NULL;
 }
 
 void DictionaryValue::Clear() {
-  ValueMap::iterator dict_iterator = dictionary_.begin();
-  while (dict_iterator != dictionary_.end()) {
-    delete dict_iterator->second;
-    ++dict_iterator;
+  if (map_) {
+    for (ValueMap::iterator it = map_->begin(); it != map_->end(); ++it)
+      delete it->second;
+    map_.reset();
   }
-
-  dictionary_.clear();
+  for (FlatValueMap::iterator it = flat_.begin(); it != flat_.end(); ++it)
+    delete it->second;
+  flat_.clear();
 }
 
 void DictionaryValue::Set(const std::string& path, Value* in_value) {
@@ -419,10 +429,30 @@ void DictionaryValue::SetString(const std::string& path,
 
 void DictionaryValue::SetWithoutPathExpansion(const std::string& key,
                                               Value* in_value) {
+  if (!map_) {
+    FlatValueMap::iterator it = std::lower_bound(
+        flat_.begin(), flat_.end(), key, FlatValueMapKeyLess());
+    if (it != flat_.end() && it->first == key) {
+      // We own all our children, so the existing value must be deleted.
+      DCHECK_NE(it->second, in_value);  // This would be bogus
+      delete it->second;
+      it->second = in_value;
+      return;
+    }
+    if (flat_.size() < kMaxFlatSize) {
+      flat_.insert(it, std::make_pair(key, in_value));
+      return;
+    }
+
+    // The entries are sorted, so this takes linear time.
+    map_.reset(new ValueMap(flat_.begin(), flat_.end()));
+    FlatValueMap().swap(flat_);
+  }
+
   // If there's an existing value here, we need to delete it, because
   // we own all our children.
   std::pair<ValueMap::iterator, bool> ins_res =
-      dictionary_.insert(std::make_pair(key, in_value));
+      map_->insert(std::make_pair(key, in_value));
   if (!ins_res.second) {
     DCHECK_NE(ins_res.first->second, in_value);  // This would be bogus
     delete ins_res.first->second;
@@ -603,11 +633,10 @@ bool DictionaryValue::GetList(const std::string& path, ListValue** out_value) {
 bool DictionaryValue::GetWithoutPathExpansion(const std::string& key,
                                               const Value** out_value) const {
   DCHECK(IsStringUTF8(key));
-  ValueMap::const_iterator entry_iterator = dictionary_.find(key);
-  if (entry_iterator == dictionary_.end())
+  const Value* entry = FindWithoutPathExpansion(key);
+  if (!entry)
     return false;
 
-  const Value* entry = entry_iterator->second;
   if (out_value)
     *out_value = entry;
   return true;
@@ -732,16 +761,26 @@ bool DictionaryValue::Remove(const std::string& path,
 bool DictionaryValue::RemoveWithoutPathExpansion(const std::string& key,
                                                  scoped_ptr<Value>* out_value) {
   DCHECK(IsStringUTF8(key));
-  ValueMap::iterator entry_iterator = dictionary_.find(key);
-  if (entry_iterator == dictionary_.end())
-    return false;
+  Value* entry = NULL;
+  if (map_) {
+    ValueMap::iterator entry_iterator = map_->find(key);
+    if (entry_iterator == map_->end())
+      return false;
+    entry = entry_iterator->second;
+    map_->erase(entry_iterator);
+  } else {
+    FlatValueMap::iterator entry_iterator = std::lower_bound(
+        flat_.begin(), flat_.end(), key, FlatValueMapKeyLess());
+    if (entry_iterator == flat_.end() || entry_iterator->first != key)
+      return false;
+    entry = entry_iterator->second;
+    flat_.erase(entry_iterator);
+  }
 
-  Value* entry = entry_iterator->second;
   if (out_value)
     out_value->reset(entry);
   else
     delete entry;
-  dictionary_.erase(entry_iterator);
   return true;
 }
 
@@ -788,22 +827,49 @@ void DictionaryValue::MergeDictionary(const DictionaryValue* dictionary) {
 }
 
 void DictionaryValue::Swap(DictionaryValue* other) {
-  dictionary_.swap(other->dictionary_);
+  flat_.swap(other->flat_);
+  map_.swap(other->map_);
+}
+
+Value* DictionaryValue::FindWithoutPathExpansion(
+    const std::string& key) const {
+  if (map_) {
+    ValueMap::const_iterator it = map_->find(key);
+    return it == map_->end() ? NULL : it->second;
+  }
+  FlatValueMap::const_iterator it = std::lower_bound(
+      flat_.begin(), flat_.end(), key, FlatValueMapKeyLess());
+  return it == flat_.end() || it->first != key ? NULL : it->second;
 }
 
 DictionaryValue::Iterator::Iterator(const DictionaryValue& target)
-    : target_(target),
-      it_(target.dictionary_.begin()) {}
+    : target_(&target),
+      flat_it_(target.flat_.begin()) {
+  if (target.map_)
+    map_it_ = target.map_->begin();
+}
 
 DictionaryValue::Iterator::~Iterator() {}
 
 DictionaryValue* DictionaryValue::DeepCopy() const {
   DictionaryValue* result = new DictionaryValue;
 
-  for (ValueMap::const_iterator current_entry(dictionary_.begin());
-       current_entry != dictionary_.end(); ++current_entry) {
-    result->SetWithoutPathExpansion(current_entry->first,
-                                    current_entry->second->DeepCopy());
+  // Copies the entries in order, without searching.
+  if (map_) {
+    result->map_.reset(new ValueMap);
+    for (ValueMap::const_iterator current_entry(map_->begin());
+         current_entry != map_->end(); ++current_entry) {
+      result->map_->insert(result->map_->end(),
+                           std::make_pair(current_entry->first,
+                                          current_entry->second->DeepCopy()));
+    }
+  } else {
+    result->flat_.reserve(flat_.size());
+    for (FlatValueMap::const_iterator current_entry(flat_.begin());
+         current_entry != flat_.end(); ++current_entry) {
+      result->flat_.push_back(std::make_pair(
+          current_entry->first, current_entry->second->DeepCopy()));
+    }
   }
 
   return result;
@@ -41,6 +41,7 @@ class Value;
 
 typedef std::vector<Value*> ValueVector;
 typedef std::map<std::string, Value*> ValueMap;
+typedef std::vector<std::pair<std::string, Value*> > FlatValueMap;
 
 // The Value class is the base class for Values. A Value can be instantiated
 // via the Create*Value() factory methods, or by directly creating instances of
@@ -93,6 +94,8 @@ class BASE_EXPORT Value {
 
   // This creates a deep copy of the entire Value tree, and returns a pointer
   // to the copy.  The caller gets ownership of the copy, of course.
+  // The copy shares nothing with the original, so that the pointers taken
+  // from either stay valid until their own child is removed or replaced.
   //
   // Subclasses return their own type directly in their overrides;
   // this works because C++ supports covariant return types.
@@ -215,10 +218,10 @@ class BASE_EXPORT DictionaryValue : public Value {
   bool HasKey(const std::string& key) const;
 
   // Returns the number of Values in this dictionary.
-  size_t size() const { return dictionary_.size(); }
+  size_t size() const { return map_ ? map_->size() : flat_.size(); }
 
   // Returns whether the dictionary is empty.
-  bool empty() const { return dictionary_.empty(); }
+  bool empty() const { return size() == 0; }
 
   // Clears any current contents of this dictionary.
   void Clear();
@@ -350,15 +353,28 @@ class BASE_EXPORT DictionaryValue : public Value {
     explicit Iterator(const DictionaryValue& target);
     ~Iterator();
 
-    bool IsAtEnd() const { return it_ == target_.dictionary_.end(); }
-    void Advance() { ++it_; }
-
-    const std::string& key() const { return it_->first; }
-    const Value& value() const { return *it_->second; }
+    bool IsAtEnd() const {
+      return target_->map_ ? map_it_ == target_->map_->end()
+                             : flat_it_ == target_->flat_.end();
+    }
+    void Advance() {
+      if (target_->map_)
+        ++map_it_;
+      else
+        ++flat_it_;
+    }
+
+    const std::string& key() const {
+      return target_->map_ ? map_it_->first : flat_it_->first;
+    }
+    const Value& value() const {
+      return *(target_->map_ ? map_it_->second : flat_it_->second);
+    }
 
    private:
-    const DictionaryValue& target_;
-    ValueMap::const_iterator it_;
+    const DictionaryValue* target_;
+    FlatValueMap::const_iterator flat_it_;
+    ValueMap::const_iterator map_it_;
   };
 
   // Overridden from Value:
@@ -366,7 +382,18 @@ class BASE_EXPORT DictionaryValue : public Value {
   virtual bool Equals(const Value* other) const override;
 
  private:
-  ValueMap dictionary_;
+  // Most dictionaries are small, and are stored as a vector sorted by key,
+  // which needs one allocation and is fast to search. Once a dictionary
+  // grows past this size it moves to a map, which it keeps until it is
+  // cleared. Either way children are iterated in key order.
+  static const size_t kMaxFlatSize;
+
+  // Returns the child for |key|, or NULL.
+  Value* FindWithoutPathExpansion(const std::string& key) const;
+
+  // Children while the dictionary is flat, in which case |map_| is NULL.
+  FlatValueMap flat_;
+  scoped_ptr<ValueMap> map_;
 
   DISALLOW_COPY_AND_ASSIGN(DictionaryValue);
 };
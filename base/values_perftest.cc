@@ -0,0 +1,136 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <algorithm>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "base/memory/scoped_ptr.h"
+#include "base/memory/scoped_vector.h"
+#include "base/stl_util.h"
+#include "base/strings/stringprintf.h"
+#include "base/time/time.h"
+#include "base/values.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "testing/perf/perf_test.h"
+
+namespace base {
+
+namespace {
+
+// Total number of entries per measurement, split into dictionaries of the
+// size being measured.
+const size_t kTotalEntries = 1000000;
+
+// Returns |size| keys of the kind found in JSON, shuffled.
+std::vector<std::string> BuildKeys(size_t size) {
+  std::vector<std::string> keys;
+  for (size_t i = 0; i < size; ++i)
+    keys.push_back(StringPrintf("key_%d", static_cast<int>(i * 7919 % size)));
+  std::reverse(keys.begin(), keys.end());
+  return keys;
+}
+
+void PrintTime(size_t size,
+               const std::string& trace,
+               TimeDelta elapsed) {
+  perf_test::PrintResult(
+      "dictionary_value", StringPrintf("_%d", static_cast<int>(size)), trace,
+      elapsed.InMillisecondsF() * 1e6 / kTotalEntries, "ns/entry", true);
+}
+
+// Measures DictionaryValue, and as a reference the std::map of pointers it
+// used to be, for dictionaries of |size| entries.
+void MeasureSize(size_t size) {
+  const std::vector<std::string> keys = BuildKeys(size);
+  const size_t count = kTotalEntries / size;
+
+  TimeTicks start = TimeTicks::HighResNow();
+  ScopedVector<DictionaryValue> dictionaries;
+  dictionaries.reserve(count);
+  for (size_t i = 0; i < count; ++i) {
+    DictionaryValue* dictionary = new DictionaryValue;
+    for (size_t j = 0; j < size; ++j)
+      dictionary->SetWithoutPathExpansion(keys[j], new FundamentalValue(1));
+    dictionaries.push_back(dictionary);
+  }
+  TimeTicks built = TimeTicks::HighResNow();
+  int sum = 0;
+  for (size_t i = 0; i < count; ++i) {
+    for (size_t j = 0; j < size; ++j) {
+      int value = 0;
+      dictionaries[i]->GetIntegerWithoutPathExpansion(keys[j], &value);
+      sum += value;
+    }
+  }
+  TimeTicks looked_up = TimeTicks::HighResNow();
+  size_t key_length = 0;
+  for (size_t i = 0; i < count; ++i) {
+    for (DictionaryValue::Iterator it(*dictionaries[i]); !it.IsAtEnd();
+         it.Advance()) {
+      key_length += it.key().size();
+    }
+  }
+  TimeTicks iterated = TimeTicks::HighResNow();
+  dictionaries.clear();
+  TimeTicks destroyed = TimeTicks::HighResNow();
+  EXPECT_EQ(static_cast<int>(count * size), sum);
+
+  PrintTime(size, "build", built - start);
+  PrintTime(size, "lookup", looked_up - built);
+  PrintTime(size, "iterate", iterated - looked_up);
+  PrintTime(size, "destroy", destroyed - iterated);
+
+  typedef std::map<std::string, Value*> Map;
+  start = TimeTicks::HighResNow();
+  std::vector<Map*> maps;
+  maps.reserve(count);
+  for (size_t i = 0; i < count; ++i) {
+    Map* map = new Map;
+    for (size_t j = 0; j < size; ++j)
+      map->insert(std::make_pair(keys[j], new FundamentalValue(1)));
+    maps.push_back(map);
+  }
+  built = TimeTicks::HighResNow();
+  sum = 0;
+  for (size_t i = 0; i < count; ++i) {
+    for (size_t j = 0; j < size; ++j) {
+      int value = 0;
+      Map::const_iterator it = maps[i]->find(keys[j]);
+      if (it != maps[i]->end())
+        it->second->GetAsInteger(&value);
+      sum += value;
+    }
+  }
+  looked_up = TimeTicks::HighResNow();
+  size_t map_key_length = 0;
+  for (size_t i = 0; i < count; ++i) {
+    for (Map::const_iterator it = maps[i]->begin(); it != maps[i]->end(); ++it)
+      map_key_length += it->first.size();
+  }
+  iterated = TimeTicks::HighResNow();
+  for (size_t i = 0; i < count; ++i) {
+    STLDeleteValues(maps[i]);
+    delete maps[i];
+  }
+  destroyed = TimeTicks::HighResNow();
+  EXPECT_EQ(static_cast<int>(count * size), sum);
+  EXPECT_EQ(key_length, map_key_length);
+
+  PrintTime(size, "map_build", built - start);
+  PrintTime(size, "map_lookup", looked_up - built);
+  PrintTime(size, "map_iterate", iterated - looked_up);
+  PrintTime(size, "map_destroy", destroyed - iterated);
+}
+
+}  // namespace
+
+TEST(DictionaryValuePerfTest, Sizes) {
+  const size_t kSizes[] = { 1, 4, 16, 32, 64, 256, 1000, 10000 };
+  for (size_t i = 0; i < arraysize(kSizes); ++i)
+    MeasureSize(kSizes[i]);
+}
+
+}  // namespace base
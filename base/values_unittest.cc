@@ -6,6 +6,7 @@
 
 #include "base/memory/scoped_ptr.h"
 #include "base/strings/string16.h"
+#include "base/strings/stringprintf.h"
 #include "base/strings/utf_string_conversions.h"
 #include "base/values.h"
 #include "testing/gtest/include/gtest/gtest.h"
@@ -809,6 +810,87 @@ TEST(ValuesTest, DictionaryIterator) {
   EXPECT_TRUE(seen2);
 }
 
+TEST(ValuesTest, LargeDictionary) {
+  // Enough keys for the dictionary to move from its flat storage to a map,
+  // inserted out of order.
+  const int kSize = 200;
+  DictionaryValue dict;
+  for (int i = kSize - 1; i >= 0; --i)
+    dict.SetIntegerWithoutPathExpansion(StringPrintf("key%03d", i), i);
+  dict.SetIntegerWithoutPathExpansion("key100", -1);
+  EXPECT_EQ(static_cast<size_t>(kSize), dict.size());
+
+  int expected = 0;
+  for (DictionaryValue::Iterator it(dict); !it.IsAtEnd(); it.Advance()) {
+    EXPECT_EQ(StringPrintf("key%03d", expected), it.key());
+    int value = 0;
+    EXPECT_TRUE(it.value().GetAsInteger(&value));
+    EXPECT_EQ(expected == 100 ? -1 : expected, value);
+    ++expected;
+  }
+  EXPECT_EQ(kSize, expected);
+
+  // Removing keys keeps the map, which compares equal to a flat dictionary
+  // with the same contents.
+  for (int i = 5; i < kSize; ++i)
+    EXPECT_TRUE(dict.RemoveWithoutPathExpansion(StringPrintf("key%03d", i),
+                                                NULL));
+  EXPECT_FALSE(dict.RemoveWithoutPathExpansion("key005", NULL));
+  DictionaryValue flat;
+  for (int i = 0; i < 5; ++i)
+    flat.SetIntegerWithoutPathExpansion(StringPrintf("key%03d", i), i);
+  EXPECT_TRUE(dict.Equals(&flat));
+  EXPECT_TRUE(flat.Equals(&dict));
+  scoped_ptr<DictionaryValue> copy(dict.DeepCopy());
+  EXPECT_TRUE(copy->Equals(&flat));
+  EXPECT_TRUE(copy->HasKey("key004"));
+  EXPECT_FALSE(copy->HasKey("key005"));
+
+  // Swapping exchanges the storage too.
+  dict.SetIntegerWithoutPathExpansion("key999", 999);
+  dict.Swap(&flat);
+  EXPECT_EQ(6u, flat.size());
+  EXPECT_EQ(5u, dict.size());
+  int value = 0;
+  EXPECT_TRUE(flat.GetInteger("key999", &value));
+  EXPECT_EQ(999, value);
+  EXPECT_FALSE(dict.HasKey("key999"));
+
+  flat.Clear();
+  EXPECT_TRUE(flat.empty());
+  flat.SetIntegerWithoutPathExpansion("a", 1);
+  EXPECT_EQ(1u, flat.size());
+}
+
+// Pointers to children stay valid when unrelated children of the same
+// container, or of a copy of it, are modified.
+TEST(ValuesTest, CopyKeepsChildren) {
+  DictionaryValue original;
+  original.SetInteger("a.b", 1);
+  ListValue* list = new ListValue;
+  list->AppendInteger(2);
+  original.Set("list", list);
+
+  const ListValue* original_list = NULL;
+  ASSERT_TRUE(original.GetList("list", &original_list));
+  scoped_ptr<DictionaryValue> copy(original.DeepCopy());
+  original.SetInteger("c", 3);
+  original.SetInteger("a.b", 4);
+  copy->SetInteger("a.b", 5);
+
+  const ListValue* list_now = NULL;
+  ASSERT_TRUE(original.GetList("list", &list_now));
+  EXPECT_EQ(original_list, list_now);
+  EXPECT_EQ(1u, original_list->GetSize());
+
+  int value = 0;
+  EXPECT_TRUE(copy->GetInteger("a.b", &value));
+  EXPECT_EQ(5, value);
+  EXPECT_TRUE(original.GetInteger("a.b", &value));
+  EXPECT_EQ(4, value);
+  EXPECT_FALSE(copy->HasKey("c"));
+}
+
 // DictionaryValue/ListValue's Get*() methods should accept NULL as an out-value
 // and still return true/false based on success.
 TEST(ValuesTest, GetWithNullOutValue) {